@@ -17,3 +17,8 @@
 -keep class io.mockk.** { *; }
 -keep class io.mockk.impl.** { *; }
 -dontwarn io.mockk.**
+
+# Tunnel callback interfaces are looked up by name in JNI_OnLoad (jni_bridge.cpp)
+-keep interface com.multiregionvpn.core.vpnclient.TunnelIpCallback { *; }
+-keep interface com.multiregionvpn.core.vpnclient.TunnelDnsCallback { *; }
+-keep interface com.multiregionvpn.core.vpnclient.TunnelStateCallback { *; }
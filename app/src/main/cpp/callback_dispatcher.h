@@ -0,0 +1,191 @@
+#ifndef CALLBACK_DISPATCHER_H
+#define CALLBACK_DISPATCHER_H
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "mpsc_queue.h"
+
+namespace openvpn {
+
+/**
+ * Runs callbacks posted from any thread, in post order, on one long-lived thread.
+ *
+ * post() pushes onto an MpscQueue and signals an eventfd, so the posting thread
+ * (an OpenVPN event loop) never takes a lock or waits for the callback to run.
+ * The dispatcher thread calls on_start once before its first task and on_stop
+ * after its last, which is where JniBridge attaches it to the JVM for good.
+ */
+class CallbackDispatcher {
+public:
+    using Task = std::function<void()>;
+    using Hook = std::function<void()>;
+
+    // Posts beyond this many undispatched tasks are dropped rather than queued
+    static constexpr size_t DEFAULT_MAX_PENDING = 4096;
+
+    explicit CallbackDispatcher(size_t max_pending = DEFAULT_MAX_PENDING)
+        : max_pending_(max_pending > 0 ? max_pending : 1) {}
+
+    ~CallbackDispatcher() {
+        stop();
+        if (wake_fd_ >= 0) {
+            close(wake_fd_);
+        }
+    }
+
+    CallbackDispatcher(const CallbackDispatcher&) = delete;
+    CallbackDispatcher& operator=(const CallbackDispatcher&) = delete;
+
+    /**
+     * Starts the dispatcher thread; returns false if already running or the
+     * wakeup eventfd cannot be created
+     */
+    bool start(Hook on_start = nullptr, Hook on_stop = nullptr) {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        if (thread_.joinable()) {
+            return false;
+        }
+        if (wake_fd_ < 0) {
+            wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        }
+        if (wake_fd_ < 0) {
+            return false;
+        }
+        stopping_.store(false, std::memory_order_relaxed);
+        running_.store(true, std::memory_order_release);
+        thread_ = std::thread([this, on_start = std::move(on_start), on_stop = std::move(on_stop)] {
+            thread_id_.store(std::this_thread::get_id(), std::memory_order_release);
+            if (on_start) {
+                on_start();
+            }
+            run();
+            if (on_stop) {
+                on_stop();
+            }
+        });
+        return true;
+    }
+
+    /**
+     * Runs every task posted before the call, then joins the dispatcher thread.
+     * Must not be called from a task. The eventfd stays open until destruction
+     * so a post() racing with stop() never writes to a recycled descriptor.
+     */
+    void stop() {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        if (!thread_.joinable()) {
+            return;
+        }
+        running_.store(false, std::memory_order_release);
+        stopping_.store(true, std::memory_order_release);
+        wake();
+        thread_.join();
+        thread_id_.store(std::thread::id(), std::memory_order_release);
+    }
+
+    /**
+     * Queues task without blocking. Returns false if the dispatcher is not
+     * running or max_pending tasks are already waiting.
+     */
+    bool post(Task task) {
+        return push(std::move(task), true);
+    }
+
+    /**
+     * Queues task even past max_pending, for cleanup that must run after the
+     * tasks already queued (e.g. releasing a reference they use). Returns false
+     * only if the dispatcher is not running.
+     */
+    bool post_uncapped(Task task) {
+        return push(std::move(task), false);
+    }
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    bool on_dispatcher_thread() const {
+        return thread_id_.load(std::memory_order_acquire) == std::this_thread::get_id();
+    }
+
+    size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+    uint64_t posted() const { return posted_.load(std::memory_order_relaxed); }
+    uint64_t dispatched() const { return dispatched_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    bool push(Task task, bool capped) {
+        if (!task || !running_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (pending_.fetch_add(1, std::memory_order_acq_rel) >= max_pending_ && capped) {
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push(std::move(task));
+        posted_.fetch_add(1, std::memory_order_relaxed);
+        wake();
+        return true;
+    }
+
+    void wake() {
+        const uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void run() {
+        for (;;) {
+            drain();
+            if (stopping_.load(std::memory_order_acquire)) {
+                drain();
+                return;
+            }
+            pollfd pfd{wake_fd_, POLLIN, 0};
+            if (poll(&pfd, 1, -1) > 0) {
+                uint64_t count;
+                ssize_t ignored = read(wake_fd_, &count, sizeof(count));
+                (void)ignored;
+            }
+        }
+    }
+
+    void drain() {
+        Task task;
+        while (queue_.pop(task)) {
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            try {
+                task();
+            } catch (...) {
+                // A failing callback must not take down the dispatcher
+            }
+            task = nullptr;
+            dispatched_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const size_t max_pending_;
+    MpscQueue<Task> queue_;
+    int wake_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> pending_{0};
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> dispatched_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<std::thread::id> thread_id_{};
+
+    std::mutex control_mutex_;
+    std::thread thread_;
+};
+
+} // namespace openvpn
+
+#endif // CALLBACK_DISPATCHER_H
@@ -0,0 +1,115 @@
+# Hot-path logging lint for the TUN data path
+#
+# Usage: cmake -DSOURCE_DIR=<app/src/main/cpp> -P check_hot_path_logging.cmake
+#
+# Rules:
+# 1. custom_tun_client.h and tun_*.h never call __android_log_print directly;
+#    they log through the logging_config.h macros so the level applies.
+# 2. Per-packet functions in custom_tun_client.h only use LOG_HOT_PATH (compiled
+#    out unless VERBOSE) or LOG_ERROR. Anything else would make RELEASE and
+#    DEBUG builds format a logcat line per packet.
+# 3. Every function in HOT_FUNCTIONS is still defined in custom_tun_client.h,
+#    so a rename cannot silently drop it from rule 2.
+
+if(NOT SOURCE_DIR)
+    get_filename_component(SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}" ABSOLUTE)
+endif()
+
+# Functions invoked once per packet or per batch
+set(HOT_FUNCTIONS
+    tun_send
+    send_to_app
+    ring_send
+    queue_read
+    handle_read
+    handle_ring_read
+    prepare_read_slots
+    prepare_slot
+    enqueue_egress
+    queue_write
+    handle_write
+    flush_egress
+    flush_pre_connect
+)
+
+set(BANNED_IN_HOT_FUNCTIONS "__android_log_print|OPENVPN_LOG|LOGI|LOGD|LOG_INFO|LOG_DEBUG")
+
+set(violations "")
+
+# Rule 1: no direct logcat calls anywhere in data-path headers
+file(GLOB data_path_files "${SOURCE_DIR}/tun_*.h")
+list(APPEND data_path_files "${SOURCE_DIR}/custom_tun_client.h")
+foreach(path IN LISTS data_path_files)
+    file(READ "${path}" content)
+    string(REGEX MATCHALL "__android_log_print[ \t]*\\(" hits "${content}")
+    list(LENGTH hits count)
+    if(count GREATER 0)
+        get_filename_component(name "${path}" NAME)
+        list(APPEND violations "${name}: ${count} direct __android_log_print call(s)")
+    endif()
+endforeach()
+
+# Rule 2: walk custom_tun_client.h line by line, tracking brace depth inside hot functions
+file(READ "${SOURCE_DIR}/custom_tun_client.h" content)
+string(REPLACE ";" "<semicolon>" content "${content}")
+string(REPLACE "\n" ";" lines "${content}")
+
+string(REPLACE ";" "|" hot_alternatives "${HOT_FUNCTIONS}")
+set(current "")
+set(pending "")
+set(depth 0)
+set(lineno 0)
+set(defined_hot "")
+foreach(line IN LISTS lines)
+    math(EXPR lineno "${lineno} + 1")
+
+    if(current STREQUAL "")
+        # Definition: return type, name and open paren; the opening brace may
+        # follow on a later line when the parameter list wraps
+        if(pending STREQUAL "" AND line MATCHES "^[ \t]*[A-Za-z_].*[ \t\\*&](${hot_alternatives})\\(")
+            set(pending "${CMAKE_MATCH_1}")
+        endif()
+        if(pending STREQUAL "")
+            continue()
+        elseif(line MATCHES "<semicolon>")
+            # A call or declaration, not a definition
+            set(pending "")
+            continue()
+        elseif(NOT line MATCHES "{")
+            continue()
+        endif()
+        set(current "${pending}")
+        set(pending "")
+        set(depth 0)
+        list(APPEND defined_hot "${current}")
+    endif()
+
+    if(line MATCHES "(${BANNED_IN_HOT_FUNCTIONS})[ \t]*\\(")
+        list(APPEND violations "custom_tun_client.h:${lineno}: ${CMAKE_MATCH_1} in hot function ${current}()")
+    endif()
+
+    string(REGEX MATCHALL "{" opens "${line}")
+    string(REGEX MATCHALL "}" closes "${line}")
+    list(LENGTH opens n_open)
+    list(LENGTH closes n_close)
+    math(EXPR depth "${depth} + ${n_open} - ${n_close}")
+    if(depth LESS_EQUAL 0)
+        set(current "")
+    endif()
+endforeach()
+
+# Rule 3: stale entries in HOT_FUNCTIONS
+foreach(name IN LISTS HOT_FUNCTIONS)
+    list(FIND defined_hot "${name}" index)
+    if(index EQUAL -1)
+        list(APPEND violations "HOT_FUNCTIONS: ${name}() is not defined in custom_tun_client.h")
+    endif()
+endforeach()
+
+if(violations)
+    list(JOIN violations "\n  " report)
+    message(FATAL_ERROR "Hot-path logging lint failed:\n  ${report}\n"
+        "Use LOG_HOT_PATH for per-packet diagnostics (see logging_config.h).")
+endif()
+
+message(STATUS "Hot-path logging lint passed")
@@ -0,0 +1,167 @@
+#ifndef CONFIG_NORMALIZER_H
+#define CONFIG_NORMALIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace openvpn {
+
+/**
+ * Result of normalize_profile(): the rewritten profile and what changed
+ */
+struct NormalizedProfile {
+    std::string content;
+    uint32_t removed_lines = 0;             // OpenVPN 2.x-only directives dropped
+    bool auth_user_pass_rewritten = false;  // auth-user-pass <file> reduced to auth-user-pass
+    bool auth_user_pass_added = false;
+    bool client_cert_not_required_added = false;
+    bool verb_replaced = false;
+};
+
+/**
+ * Bump when normalize_profile() output changes, so cached profiles are rebuilt
+ */
+constexpr uint32_t PROFILE_NORMALIZER_VERSION = 1;
+
+namespace detail {
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline std::string_view trimmed(std::string_view line) {
+    size_t begin = 0;
+    size_t end = line.size();
+    while (begin < end && is_space(line[begin])) {
+        ++begin;
+    }
+    while (end > begin && is_space(line[end - 1])) {
+        --end;
+    }
+    return line.substr(begin, end - begin);
+}
+
+/**
+ * First whitespace-delimited token of line, e.g. "verb" for "verb 3"
+ */
+inline std::string_view directive_of(std::string_view line) {
+    line = trimmed(line);
+    size_t stop = 0;
+    while (stop < line.size() && !is_space(line[stop])) {
+        ++stop;
+    }
+    return line.substr(0, stop);
+}
+
+inline bool is_unsupported_directive(std::string_view directive) {
+    // OpenVPN 2.x only; OpenVPN 3 rejects or ignores them (comp-lzo is supported)
+    return directive == "ping-timer-rem" || directive == "remote-random" || directive == "fast-io";
+}
+
+/**
+ * True if directive opens an inline block, e.g. "<ca>"
+ */
+inline bool is_inline_open(std::string_view directive) {
+    return directive.size() > 2 && directive.front() == '<' && directive.back() == '>' && directive[1] != '/';
+}
+
+} // namespace detail
+
+/**
+ * Rewrites an .ovpn profile for the OpenVPN 3 ClientAPI in one pass over its lines:
+ *
+ * - drops ping-timer-rem, remote-random and fast-io
+ * - reduces auth-user-pass to its bare form so OpenVPN 3 asks provide_creds()
+ *   instead of reading a file (and does not treat the profile as autologin)
+ * - adds client-cert-not-required before the first auth directive
+ * - sets verb to verbosity
+ *
+ * Inline blocks such as <ca>...</ca> are copied through untouched, and lines are
+ * matched on their directive only, so keys and comments never trigger a rewrite.
+ */
+inline NormalizedProfile normalize_profile(std::string_view config, int verbosity = 5) {
+    NormalizedProfile out;
+    out.content.reserve(config.size() + 64);
+
+    const std::string verb_line = "verb " + std::to_string(verbosity) + "\n";
+    bool have_auth_user_pass = false;
+    bool have_client_cert_not_required = false;
+    bool have_verb = false;
+    size_t auth_insert_at = std::string::npos;  // Offset in out.content of the first "auth" line
+
+    size_t begin = 0;
+    while (begin < config.size()) {
+        size_t end = config.find('\n', begin);
+        const size_t next = end == std::string_view::npos ? config.size() : end + 1;
+        if (end == std::string_view::npos) {
+            end = config.size();
+        }
+        const std::string_view line = config.substr(begin, end - begin);
+        const std::string_view raw_line = config.substr(begin, next - begin);
+        const std::string_view directive = detail::directive_of(line);
+
+        if (detail::is_inline_open(directive)) {
+            // Copy the whole block (PEM/base64 never contains '<') through its closing tag
+            const std::string close_tag = "</" + std::string(directive.substr(1));
+            const size_t close_at = config.find(close_tag, next);
+            const size_t close_end = close_at == std::string_view::npos
+                ? std::string_view::npos : config.find('\n', close_at);
+            const size_t block_end = close_end == std::string_view::npos ? config.size() : close_end + 1;
+            out.content.append(config.substr(begin, block_end - begin));
+            begin = block_end;
+            continue;
+        } else if (detail::is_unsupported_directive(directive)) {
+            out.removed_lines++;
+        } else if (directive == "auth-user-pass") {
+            if (!have_auth_user_pass) {
+                have_auth_user_pass = true;
+                out.auth_user_pass_rewritten = detail::trimmed(line) != "auth-user-pass";
+                out.content += "auth-user-pass\n";
+            } else {
+                out.removed_lines++;
+            }
+        } else if (directive == "verb") {
+            if (!have_verb) {
+                have_verb = true;
+                out.verb_replaced = true;
+                out.content += verb_line;
+            } else {
+                out.removed_lines++;
+            }
+        } else {
+            if (directive == "client-cert-not-required") {
+                have_client_cert_not_required = true;
+            } else if (directive == "auth" && auth_insert_at == std::string::npos) {
+                auth_insert_at = out.content.size();
+            }
+            out.content.append(raw_line);
+        }
+        begin = next;
+    }
+    if (!out.content.empty() && out.content.back() != '\n') {
+        out.content += '\n';
+    }
+
+    if (!have_auth_user_pass) {
+        out.auth_user_pass_added = true;
+        out.content += "auth-user-pass\n";
+    }
+    if (!have_client_cert_not_required) {
+        out.client_cert_not_required_added = true;
+        if (auth_insert_at != std::string::npos) {
+            out.content.insert(auth_insert_at, "client-cert-not-required\n");
+        } else {
+            out.content += "client-cert-not-required\n";
+        }
+    }
+    if (!have_verb) {
+        out.content += verb_line;
+    }
+    return out;
+}
+
+} // namespace openvpn
+
+#endif // CONFIG_NORMALIZER_H
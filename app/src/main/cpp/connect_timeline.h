@@ -0,0 +1,281 @@
+#ifndef CONNECT_TIMELINE_H
+#define CONNECT_TIMELINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openvpn {
+
+/**
+ * Milestones of one connect attempt, in the order OpenVPN 3 normally reaches them.
+ *
+ * Index of each mark in a packed timeline record (see ConnectTimelineField);
+ * never reorder, the Kotlin decoder (ConnectTimeline.kt) mirrors these values.
+ */
+enum ConnectMark : size_t {
+    MARK_CONNECT_START = 0,  // connect() called, or RECONNECTING
+    MARK_RESOLVE,            // RESOLVE: server hostname lookup
+    MARK_TRANSPORT,          // WAIT: transport socket connect
+    MARK_TLS,                // CONNECTING: transport up, TLS handshake
+    MARK_AUTH_OK,            // AUTH_OK: credentials accepted
+    MARK_PUSH_REQUEST,       // GET_CONFIG / PUSH_REQUEST: options requested
+    MARK_PUSH_REPLY,         // PUSH_REPLY / ASSIGN_IP: options received
+    MARK_TUN_START,          // CustomTunClient::tun_start()
+    MARK_CONNECTED,          // CONNECTED
+    MARK_FIRST_PACKET,       // First decrypted packet handed to the app
+    MARK_COUNT
+};
+
+inline const char* connect_mark_name(ConnectMark mark) {
+    switch (mark) {
+        case MARK_CONNECT_START: return "start";
+        case MARK_RESOLVE: return "resolve";
+        case MARK_TRANSPORT: return "transport";
+        case MARK_TLS: return "tls";
+        case MARK_AUTH_OK: return "auth";
+        case MARK_PUSH_REQUEST: return "push_request";
+        case MARK_PUSH_REPLY: return "push_reply";
+        case MARK_TUN_START: return "tun_start";
+        case MARK_CONNECTED: return "connected";
+        case MARK_FIRST_PACKET: return "first_packet";
+        case MARK_COUNT: break;
+    }
+    return "unknown";
+}
+
+/**
+ * Maps an OpenVPN 3 ClientAPI event name to its mark; returns MARK_COUNT for
+ * events that are not connect milestones.
+ */
+inline ConnectMark connect_mark_for_event(const std::string& name) {
+    if (name == "RESOLVE") return MARK_RESOLVE;
+    if (name == "WAIT" || name == "WAIT_PROXY") return MARK_TRANSPORT;
+    if (name == "CONNECTING") return MARK_TLS;
+    if (name == "AUTH_OK") return MARK_AUTH_OK;
+    if (name == "GET_CONFIG" || name == "PUSH_REQUEST") return MARK_PUSH_REQUEST;
+    if (name == "PUSH_REPLY" || name == "ASSIGN_IP") return MARK_PUSH_REPLY;
+    if (name == "CONNECTED") return MARK_CONNECTED;
+    return MARK_COUNT;
+}
+
+/**
+ * Index of each value in one packed timeline record.
+ *
+ * nativeGetConnectTimelines() returns [TIMELINE_LAYOUT_VERSION, record count,
+ * TIMELINE_FIELD_COUNT, records...], oldest record first. Append new fields
+ * before TIMELINE_FIELD_COUNT and bump the version.
+ */
+enum ConnectTimelineField : size_t {
+    TIMELINE_ID = 0,
+    TIMELINE_RECONNECT,       // 1 if started by RECONNECTING
+    TIMELINE_OPEN,            // 1 while marks are still being recorded
+    TIMELINE_MARK_0,          // Microseconds from start per ConnectMark, -1 if not reached
+    TIMELINE_FIELD_COUNT = TIMELINE_MARK_0 + MARK_COUNT
+};
+
+/**
+ * Monotonic timestamps of one connect attempt
+ */
+struct ConnectTimeline {
+    uint64_t id = 0;
+    std::string tunnel_id;
+    bool reconnect = false;
+    bool open = true;
+    int64_t start_us = 0;            // Monotonic clock at MARK_CONNECT_START
+    int64_t marks_us[MARK_COUNT];    // Offsets from start_us, -1 if not reached
+
+    ConnectTimeline() {
+        for (size_t i = 0; i < MARK_COUNT; ++i) {
+            marks_us[i] = -1;
+        }
+    }
+
+    bool reached(ConnectMark mark) const { return marks_us[mark] >= 0; }
+
+    /**
+     * Time spent after mark until the next mark that was reached, or -1 if mark
+     * was not reached or nothing followed it. Skipped milestones fold into the
+     * preceding phase.
+     */
+    int64_t phase_us(ConnectMark mark) const {
+        if (!reached(mark)) {
+            return -1;
+        }
+        for (size_t next = mark + 1; next < MARK_COUNT; ++next) {
+            if (marks_us[next] >= 0) {
+                return marks_us[next] - marks_us[mark];
+            }
+        }
+        return -1;
+    }
+
+    void pack(int64_t* out) const {
+        out[TIMELINE_ID] = static_cast<int64_t>(id);
+        out[TIMELINE_RECONNECT] = reconnect ? 1 : 0;
+        out[TIMELINE_OPEN] = open ? 1 : 0;
+        for (size_t i = 0; i < MARK_COUNT; ++i) {
+            out[TIMELINE_MARK_0 + i] = marks_us[i];
+        }
+    }
+};
+
+/**
+ * Ring of the most recent connect timelines across all tunnels.
+ *
+ * A timeline opens on connect() or RECONNECTING and records the first time each
+ * milestone is reached. It closes at the first data packet, on DISCONNECTED or a
+ * fatal event, or when the tunnel starts another attempt. Writers are the
+ * session's connection thread and its tun client, a handful of times per
+ * connect; the mutex is never taken per packet.
+ */
+class ConnectTimelineRing {
+public:
+    static constexpr int64_t TIMELINE_LAYOUT_VERSION = 1;
+    static constexpr size_t DEFAULT_CAPACITY = 32;
+
+    static ConnectTimelineRing& instance() {
+        static ConnectTimelineRing ring(DEFAULT_CAPACITY);
+        return ring;
+    }
+
+    explicit ConnectTimelineRing(size_t capacity)
+        : slots_(capacity > 0 ? capacity : 1) {}
+
+    ConnectTimelineRing(const ConnectTimelineRing&) = delete;
+    ConnectTimelineRing& operator=(const ConnectTimelineRing&) = delete;
+
+    size_t capacity() const { return slots_.size(); }
+
+    /**
+     * Opens a new timeline for tunnel_id, closing any open one. Overwrites the
+     * oldest timeline once the ring is full. Returns the timeline id.
+     */
+    uint64_t begin(const std::string& tunnel_id, bool reconnect, int64_t now = now_us()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        close_locked(tunnel_id);
+
+        const uint64_t id = ++next_id_;
+        ConnectTimeline& slot = slots_[id % slots_.size()];
+        auto evicted = open_.find(slot.tunnel_id);
+        if (slot.id != 0 && evicted != open_.end() && evicted->second == slot.id) {
+            open_.erase(evicted);
+        }
+        slot = ConnectTimeline();
+        slot.id = id;
+        slot.tunnel_id = tunnel_id;
+        slot.reconnect = reconnect;
+        slot.start_us = now;
+        slot.marks_us[MARK_CONNECT_START] = 0;
+        open_[tunnel_id] = id;
+        return id;
+    }
+
+    /**
+     * Records mark on tunnel_id's open timeline if it has not been reached yet.
+     * MARK_FIRST_PACKET closes the timeline. Returns true if recorded.
+     */
+    bool mark(const std::string& tunnel_id, ConnectMark mark, int64_t now = now_us()) {
+        if (mark >= MARK_COUNT) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        ConnectTimeline* timeline = open_locked(tunnel_id);
+        if (!timeline || timeline->reached(mark)) {
+            return false;
+        }
+        timeline->marks_us[mark] = now > timeline->start_us ? now - timeline->start_us : 0;
+        if (mark == MARK_FIRST_PACKET) {
+            close_locked(tunnel_id);
+        }
+        return true;
+    }
+
+    /**
+     * Feeds an OpenVPN 3 event: milestones are marked, RECONNECTING opens a new
+     * timeline, and DISCONNECTED or a fatal event closes the open one.
+     * Returns true if the timeline changed.
+     */
+    bool on_event(const std::string& tunnel_id, const std::string& name, bool fatal,
+                  int64_t now = now_us()) {
+        if (name == "RECONNECTING") {
+            begin(tunnel_id, true, now);
+            return true;
+        }
+        if (name == "DISCONNECTED" || fatal) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return close_locked(tunnel_id);
+        }
+        const ConnectMark mark_for_event = connect_mark_for_event(name);
+        return mark_for_event != MARK_COUNT && mark(tunnel_id, mark_for_event, now);
+    }
+
+    /**
+     * Timelines for tunnel_id (all tunnels if empty), oldest first
+     */
+    std::vector<ConnectTimeline> snapshot(const std::string& tunnel_id = std::string()) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<ConnectTimeline> out;
+        const uint64_t oldest = next_id_ >= slots_.size() ? next_id_ - slots_.size() + 1 : 1;
+        for (uint64_t id = oldest; id <= next_id_; ++id) {
+            const ConnectTimeline& slot = slots_[id % slots_.size()];
+            if (slot.id == id && (tunnel_id.empty() || slot.tunnel_id == tunnel_id)) {
+                out.push_back(slot);
+            }
+        }
+        return out;
+    }
+
+    /**
+     * snapshot() in the layout documented on ConnectTimelineField
+     */
+    std::vector<int64_t> pack(const std::string& tunnel_id = std::string()) const {
+        const std::vector<ConnectTimeline> timelines = snapshot(tunnel_id);
+        std::vector<int64_t> out(3 + timelines.size() * TIMELINE_FIELD_COUNT);
+        out[0] = TIMELINE_LAYOUT_VERSION;
+        out[1] = static_cast<int64_t>(timelines.size());
+        out[2] = TIMELINE_FIELD_COUNT;
+        for (size_t i = 0; i < timelines.size(); ++i) {
+            timelines[i].pack(&out[3 + i * TIMELINE_FIELD_COUNT]);
+        }
+        return out;
+    }
+
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    ConnectTimeline* open_locked(const std::string& tunnel_id) {
+        auto it = open_.find(tunnel_id);
+        if (it == open_.end()) {
+            return nullptr;
+        }
+        ConnectTimeline& slot = slots_[it->second % slots_.size()];
+        return slot.id == it->second ? &slot : nullptr;
+    }
+
+    bool close_locked(const std::string& tunnel_id) {
+        ConnectTimeline* timeline = open_locked(tunnel_id);
+        open_.erase(tunnel_id);
+        if (!timeline) {
+            return false;
+        }
+        timeline->open = false;
+        return true;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<ConnectTimeline> slots_;
+    std::map<std::string, uint64_t> open_;  // tunnel_id -> id of its open timeline
+    uint64_t next_id_ = 0;
+};
+
+} // namespace openvpn
+
+#endif // CONNECT_TIMELINE_H
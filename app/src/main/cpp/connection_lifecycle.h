@@ -0,0 +1,173 @@
+#ifndef CONNECTION_LIFECYCLE_H
+#define CONNECTION_LIFECYCLE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace openvpn {
+
+/**
+ * Tunnel lifecycle states. Values are shared with Kotlin (ConnectionState).
+ */
+enum class LifecycleState : int {
+    DISCONNECTED = 0,
+    CONNECTING = 1,
+    CONNECTED = 2,
+    RECONNECTING = 3,
+};
+
+inline const char* lifecycle_state_name(LifecycleState state) {
+    switch (state) {
+        case LifecycleState::DISCONNECTED: return "DISCONNECTED";
+        case LifecycleState::CONNECTING: return "CONNECTING";
+        case LifecycleState::CONNECTED: return "CONNECTED";
+        case LifecycleState::RECONNECTING: return "RECONNECTING";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * Per-session connection state machine driven by OpenVPN 3 event() callbacks.
+ *
+ * Threads that need a state (connect, disconnect) block on a condition variable
+ * instead of sleeping and polling. A listener is told about every change, in
+ * order, so the Kotlin side gets one push per transition.
+ */
+class ConnectionLifecycle {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Listener = std::function<void(LifecycleState state, int64_t connect_latency_ms)>;
+
+    LifecycleState state() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_;
+    }
+
+    /**
+     * Enters CONNECTING and starts the connect latency clock
+     */
+    void begin_connect() {
+        std::lock_guard<std::mutex> notify_lock(listener_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connect_started_ = Clock::now();
+            connect_latency_ms_ = -1;
+        }
+        apply_locked(LifecycleState::CONNECTING);
+    }
+
+    /**
+     * Maps an OpenVPN 3 ClientAPI event onto the state machine.
+     * Returns true if the event changed the state.
+     */
+    bool on_event(const std::string& name, bool fatal) {
+        if (name == "CONNECTED") {
+            return transition(LifecycleState::CONNECTED);
+        }
+        if (name == "RECONNECTING") {
+            return transition(LifecycleState::RECONNECTING);
+        }
+        if (name == "DISCONNECTED" || fatal) {
+            return transition(LifecycleState::DISCONNECTED);
+        }
+        return false;
+    }
+
+    /**
+     * Moves to state, waking waiters and notifying the listener if it changed
+     */
+    bool transition(LifecycleState next) {
+        std::lock_guard<std::mutex> notify_lock(listener_mutex_);
+        return apply_locked(next);
+    }
+
+    /**
+     * Blocks until the state is target or timeout elapses; returns the final state
+     */
+    LifecycleState wait_for(LifecycleState target, std::chrono::milliseconds timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [&] { return state_ == target; });
+        return state_;
+    }
+
+    /**
+     * Blocks until the state is no longer current or timeout elapses
+     */
+    LifecycleState wait_while(LifecycleState current, std::chrono::milliseconds timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [&] { return state_ != current; });
+        return state_;
+    }
+
+    /**
+     * Milliseconds from begin_connect() to the first CONNECTED, or -1
+     */
+    int64_t connect_latency_ms() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connect_latency_ms_;
+    }
+
+    /**
+     * Installs the change listener and immediately reports the current state to it.
+     * The listener runs on the thread that caused the transition and must not block.
+     */
+    void set_listener(Listener listener) {
+        std::lock_guard<std::mutex> notify_lock(listener_mutex_);
+        listener_ = std::move(listener);
+        if (listener_) {
+            LifecycleState current;
+            int64_t latency;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                current = state_;
+                latency = connect_latency_ms_;
+            }
+            listener_(current, latency);
+        }
+    }
+
+    void clear_listener() {
+        std::lock_guard<std::mutex> notify_lock(listener_mutex_);
+        listener_ = nullptr;
+    }
+
+private:
+    // Caller holds listener_mutex_, which keeps listener calls in transition order
+    bool apply_locked(LifecycleState next) {
+        int64_t latency;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ == next) {
+                return false;
+            }
+            state_ = next;
+            if (next == LifecycleState::CONNECTED && connect_latency_ms_ < 0) {
+                connect_latency_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    Clock::now() - connect_started_).count();
+            }
+            latency = connect_latency_ms_;
+        }
+        cv_.notify_all();
+        if (listener_) {
+            listener_(next, latency);
+        }
+        return true;
+    }
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cv_;
+    LifecycleState state_ = LifecycleState::DISCONNECTED;
+    Clock::time_point connect_started_ = Clock::now();
+    int64_t connect_latency_ms_ = -1;
+
+    std::mutex listener_mutex_;
+    Listener listener_;
+};
+
+} // namespace openvpn
+
+#endif // CONNECTION_LIFECYCLE_H
@@ -11,6 +11,9 @@
 #include <sstream>
 #include <array>
 #include <memory>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -19,6 +22,17 @@
 
 // Logging configuration (compile-time flags)
 #include "logging_config.h"
+#include "tun_batch_reader.h"
+#include "tun_buffer_pool.h"
+#include "tun_egress_queue.h"
+#include "tun_traffic_stats.h"
+#include "tunnel_stats.h"
+#include "connect_timeline.h"
+#include "dns_forwarder.h"
+#include "network_handoff.h"
+#include "packet_ring.h"
+#include "pre_connect_queue.h"
+#include "tcp_mss_clamp.h"
 
 // Note: OPENVPN_LOG is now defined globally via openvpn_log_override.h (force-included)
 
@@ -32,6 +46,10 @@ public:
     virtual ~CustomTunCallback() {}
     virtual void on_ip_assigned(const std::string& tunnel_id, const std::string& ip, int prefix_len) = 0;
     virtual void on_dns_configured(const std::string& tunnel_id, const std::vector<std::string>& dns_servers) = 0;
+    // Transport and pushed options relevant to network handoff, once per tun_start()
+    virtual void on_transport_started(const std::string& tunnel_id, const TransportTraits& traits) {}
+    // The session is being torn down along with its transport socket
+    virtual void on_transport_stopped(const std::string& tunnel_id) {}
 };
 
 /**
@@ -49,6 +67,12 @@ public:
  * Packet Flow:
  * - Outbound: App writes plaintext to app_fd → OpenVPN reads from lib_fd → Encrypts → Sends to server
  * - Inbound: Server sends encrypted → OpenVPN decrypts → Writes to lib_fd → App reads from app_fd
+ *
+ * Built with TUN_SHM_RING, tun_start() also maps a PacketRingPair and publishes
+ * it in PacketRingRegistry. Once the TUN pump attaches to it, both directions
+ * move through the shared-memory rings and their eventfd doorbells instead of
+ * lib_fd; the socketpair remains the path when the rings cannot be mapped or
+ * no pump is attached.
  */
 class CustomTunClient : public TunClient {
 public:
@@ -66,8 +90,15 @@ public:
           lib_fd_(-1),
           stream_(nullptr),
           halt_(false),
-          mtu_(1500) {
+          write_pending_(false),
+          mtu_(1500),
+          stats_(TunnelStatsRegistry::instance().acquire(tunnel_id)),
+          pre_connect_(PreConnectQueueRegistry::instance().acquire(tunnel_id)) {
         
+        egress_.attach_stats(stats_->egress);
+        dns_.attach_stats(stats_->dns);
+        reader_.attach_stats(stats_->batch);
+        pool_.attach_stats(stats_->pool);
         OPENVPN_LOG("CustomTunClient created for tunnel: " << tunnel_id_);
     }
     
@@ -83,6 +114,7 @@ public:
                           TransportClient& transcli,
                           CryptoDCSettings& dc_settings) override {
         OPENVPN_LOG("CustomTunClient::tun_start() for tunnel: " << tunnel_id_);
+        ConnectTimelineRing::instance().mark(tunnel_id_, MARK_TUN_START);
         
         // Create socketpair for bidirectional communication
         int sockets[2];
@@ -109,13 +141,35 @@ public:
             fcntl(app_fd_, F_SETFL, flags | O_NONBLOCK);
         }
         
+#if TUN_SHM_RING
+        // Shared-memory rings for the TUN pump; the socketpair stays as the fallback
+        rings_ = PacketRingPair::create();
+        if (rings_) {
+            PacketRingRegistry::instance().publish(tunnel_id_, rings_);
+        } else {
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "Packet rings unavailable for %s (%s), using socketpair only", tunnel_id_.c_str(), strerror(errno));
+        }
+#endif
+        
         // Extract TUN configuration from options
         extract_tun_config(opt);
+        configure_mss_clamp(transcli, dc_settings);
+        if (callback_) {
+            callback_->on_transport_started(tunnel_id_, transport_traits(opt, transcli));
+        }
         
         // Notify parent
         parent_.tun_pre_tun_config();
         parent_.tun_pre_route_config();
         start_async_read();  // CRITICAL: Start reading from lib_fd to feed packets to OpenVPN
+        const size_t held = pre_connect_->size();
+        const size_t left = flush_pre_connect();
+        if (held > 0) {
+            LOG_INFO("OpenVPN-CustomTUN",
+                "📤 %s: drained %zu pre-connect packet(s) (expired ones dropped), %zu waiting for app_fd space",
+                tunnel_id_.c_str(), held - left, left);
+        }
         parent_.tun_connected();
         
         OPENVPN_LOG("CustomTunClient started for tunnel: " << tunnel_id_);
@@ -127,6 +181,9 @@ public:
     virtual void stop() override {
         OPENVPN_LOG("CustomTunClient::stop() for tunnel: " << tunnel_id_);
         halt_ = true;
+        if (callback_) {
+            callback_->on_transport_stopped(tunnel_id_);
+        }
         cleanup();
     }
     
@@ -146,42 +203,75 @@ public:
      * @return true if send succeeded
      */
     virtual bool tun_send(BufferAllocated& buf) override {
-        // CRITICAL LOGGING: Log EVERY call to tun_send to verify OpenVPN is calling it
-        __android_log_print(ANDROID_LOG_INFO, "OpenVPN-CustomTUN", 
-            "🔔🔔🔔 tun_send() CALLED! tunnel=%s, packet_size=%zu bytes, halt=%d, lib_fd=%d", 
+        LOG_HOT_PATH("OpenVPN-CustomTUN",
+            "🔔 tun_send(): tunnel=%s, packet_size=%zu bytes, halt=%d, lib_fd=%d",
             tunnel_id_.c_str(), buf.size(), halt_, lib_fd_);
         
         if (halt_ || lib_fd_ < 0) {
-            __android_log_print(ANDROID_LOG_WARN, "OpenVPN-CustomTUN",
+            LOG_HOT_PATH("OpenVPN-CustomTUN",
                 "❌ tun_send: Cannot send - halt=%d, lib_fd=%d", halt_, lib_fd_);
+            stats_->drop_halted.fetch_add(1, std::memory_order_relaxed);
             return false;
         }
         
+        if (!first_packet_marked_) {
+            first_packet_marked_ = true;
+            ConnectTimelineRing::instance().mark(tunnel_id_, MARK_FIRST_PACKET);
+        }
+        
+        // A server's SYN-ACK sets the segment size the app sends us
+        if (clamp_tcp_mss(buf.data(), buf.size(), mss_limit_)) {
+            stats_->mss_clamped.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        // Resolver responses are cached and given back the address the app queried
+        dns_.on_inbound(buf.data(), buf.size(), now_us());
+        
+        return send_to_app(buf);
+    }
+    
+    /**
+     * Deliver one packet to the app through the egress queue, the inbound
+     * ring or lib_fd, keeping packet order
+     */
+    bool send_to_app(BufferAllocated& buf) {
+        // Keep packet order: once anything is queued, new packets go behind it
+        if (!egress_.empty()) {
+            return enqueue_egress(buf);
+        }
+        
+        if (ring_active()) {
+            return ring_send(buf);
+        }
+        
         // Write decrypted packet to lib_fd
         // Our app will read this from app_fd
         ssize_t n = write(lib_fd_, buf.c_data(), buf.size());
         
         if (n < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Would block - queue for later (or drop)
-                __android_log_print(ANDROID_LOG_WARN, "OpenVPN-CustomTUN",
-                    "⚠️  tun_send: Would block, dropping packet");
-                return false;
+                // lib_fd is full - hold the packet until it becomes writable
+                stats_->eagain_write.fetch_add(1, std::memory_order_relaxed);
+                LOG_HOT_PATH("OpenVPN-CustomTUN",
+                    "⏸️  tun_send: lib_fd full, queuing packet (depth=%zu)", egress_.size());
+                return enqueue_egress(buf);
             }
-            __android_log_print(ANDROID_LOG_ERROR, "OpenVPN-CustomTUN",
+            LOG_ERROR("OpenVPN-CustomTUN",
                 "❌ tun_send: write error: %s (errno=%d)", strerror(errno), errno);
+            stats_->drop_write_error.fetch_add(1, std::memory_order_relaxed);
             return false;
         }
         
         if (static_cast<size_t>(n) != buf.size()) {
-            __android_log_print(ANDROID_LOG_WARN, "OpenVPN-CustomTUN",
+            LOG_ERROR("OpenVPN-CustomTUN",
                 "⚠️  tun_send: partial write (%zd/%zu bytes)", n, buf.size());
+            stats_->drop_write_error.fetch_add(1, std::memory_order_relaxed);
             return false;
         }
         
-        // Successfully wrote packet
-        __android_log_print(ANDROID_LOG_INFO, "OpenVPN-CustomTUN",
-            "✅ tun_send: Successfully wrote %zu bytes to lib_fd=%d", buf.size(), lib_fd_);
+        stats_->traffic.add_in(buf.size());
+        LOG_HOT_PATH("OpenVPN-CustomTUN",
+            "✅ tun_send: wrote %zu bytes to lib_fd=%d", buf.size(), lib_fd_);
         return true;
     }
     
@@ -227,7 +317,25 @@ public:
         return lib_fd_;
     }
     
+    /**
+     * True while inbound packets go through the shared-memory ring instead of lib_fd
+     */
+    bool ring_active() const {
+        return rings_ && ring_data_stream_ && rings_->app_attached();
+    }
+    
 private:
+    // Minimum payload size of a pooled packet buffer (raised to mtu_ when larger)
+    static constexpr size_t READ_SLOT_SIZE = 2048;
+    
+    // OpenVPN needs space at the front of the buffer to add encryption overhead
+    // Typically needs 128-256 bytes of headroom for:
+    // - Protocol headers (up to 100 bytes)
+    // - Encryption/HMAC overhead (up to 100 bytes)
+    // - Alignment padding
+    static constexpr size_t HEADROOM = 256;
+    static constexpr size_t TAILROOM = 128;
+    
     /**
      * Start async reading from lib_fd
      * CRITICAL: This implements the OUTBOUND path (app → OpenVPN → server)
@@ -242,119 +350,358 @@ private:
             // Create Asio stream descriptor to register lib_fd with OpenVPN's io_context
             // This makes OpenVPN's event loop poll lib_fd for readability
             stream_ = new openvpn_io::posix::stream_descriptor(io_context_, lib_fd_);
-            __android_log_print(ANDROID_LOG_INFO, "OpenVPN-CustomTUN",
+            LOG_INFO("OpenVPN-CustomTUN",
                 "✅ Registered lib_fd=%d with OpenVPN io_context - OUTBOUND path ready", lib_fd_);
             
+            // Size pooled buffers for the negotiated MTU plus encryption head/tailroom
+            const size_t payload = std::max(static_cast<size_t>(mtu_), READ_SLOT_SIZE);
+            pool_.configure(HEADROOM + payload + TAILROOM, TunBufferPool<BufferAllocated>::DEFAULT_POOL_SIZE);
+            pool_.prefill(reader_.batch_size());
+            
+            // Lets nativeGetTunnelStats() report socket queue depths
+            stats_->lib_fd.store(lib_fd_, std::memory_order_relaxed);
+            
+            // One recycled packet buffer per recvmmsg() slot, filled from pool_ on first use
+            read_bufs_.clear();
+            read_bufs_.resize(TunBatchReader::MAX_BATCH_SIZE);
+            
             // Start async read loop
             queue_read();
+            start_ring_read();
+            
+            // Periodic packet/byte rate summary in place of per-packet logging
+            stats_timer_.reset(new openvpn_io::steady_timer(io_context_));
+            rate_summary_.sample(stats_->traffic, now_ms());
+            schedule_rate_log();
         } catch (const std::exception& e) {
-            __android_log_print(ANDROID_LOG_ERROR, "OpenVPN-CustomTUN",
+            LOG_ERROR("OpenVPN-CustomTUN",
                 "❌ Failed to register lib_fd with io_context: %s", e.what());
         }
     }
     
     /**
-     * Queue async read from lib_fd
+     * Queue async readiness wait on lib_fd
      * This is the OUTBOUND path: App writes to app_fd → we read from lib_fd → OpenVPN encrypts
      */
     void queue_read() {
         if (halt_ || !stream_) {
-            __android_log_print(ANDROID_LOG_WARN, "OpenVPN-CustomTUN",
+            LOG_HOT_PATH("OpenVPN-CustomTUN",
                 "⚠️  queue_read() skipped: halt=%d, stream=%p", halt_, (void*)stream_);
             return;
         }
         
-        __android_log_print(ANDROID_LOG_DEBUG, "OpenVPN-CustomTUN",
-            "📖 Queuing next async read from lib_fd...");
-        
-        // Use a simple byte buffer for reading, then copy to BufferAllocated
-        auto read_buf = std::make_shared<std::array<uint8_t, 2048>>();
+        LOG_HOT_PATH("OpenVPN-CustomTUN", "📖 Waiting for lib_fd readability...");
         
-        stream_->async_read_some(
-            openvpn_io::buffer(read_buf->data(), read_buf->size()),
-            [this, read_buf](const openvpn_io::error_code& error, std::size_t bytes_read) mutable {
-                handle_read(error, bytes_read, read_buf);
+        stream_->async_wait(
+            openvpn_io::posix::stream_descriptor::wait_read,
+            [this](const openvpn_io::error_code& error) {
+                handle_read(error);
             }
         );
     }
     
     /**
-     * Handle packet read from lib_fd
-     * Feed packet to OpenVPN for encryption and transmission
+     * Drain pending packets from lib_fd in one recvmmsg() batch
+     * and feed each one to OpenVPN for encryption and transmission
      */
-    void handle_read(const openvpn_io::error_code& error, std::size_t bytes_read,
-                     const std::shared_ptr<std::array<uint8_t, 2048>>& read_buf) {
-        // Hot path logging - only enabled in VERBOSE mode
+    void handle_read(const openvpn_io::error_code& error) {
         LOG_HOT_PATH("OpenVPN-CustomTUN",
-            "📬 handle_read() called: error=%d, bytes_read=%zu, halt=%d",
-            error.value(), bytes_read, halt_);
+            "📬 handle_read() called: error=%d, halt=%d", error.value(), halt_);
         
         if (halt_) {
-            LOG_DEBUG("OpenVPN-CustomTUN",
+            LOG_HOT_PATH("OpenVPN-CustomTUN",
                 "   handle_read() exiting early: halt=true");
             return;
         }
         
-        if (!error && bytes_read > 0) {
-            LOG_HOT_PATH("OpenVPN-CustomTUN",
-                "📤 OUTBOUND: Read %zu bytes from lib_fd (from app) - feeding to OpenVPN", bytes_read);
-            
-            try {
-                // CRITICAL: Allocate buffer with headroom for encryption headers!
-                // OpenVPN needs space at the front of the buffer to add encryption overhead
-                // Typically needs 128-256 bytes of headroom for:
-                // - Protocol headers (up to 100 bytes)
-                // - Encryption/HMAC overhead (up to 100 bytes)
-                // - Alignment padding
-                constexpr size_t HEADROOM = 256;
-                constexpr size_t TAILROOM = 128;
-                
-                // Allocate buffer with total capacity: headroom + packet + tailroom
-                BufferAllocated buf(HEADROOM + bytes_read + TAILROOM, BufAllocFlags::CONSTRUCT_ZERO);
-                
-                // Initialize headroom (sets offset to start of headroom region)
-                buf.init_headroom(HEADROOM);
-                
-                // Copy packet data to buffer (after headroom)
-                std::memcpy(buf.write_alloc(bytes_read), read_buf->data(), bytes_read);
-                
-                LOG_HOT_PATH("OpenVPN-CustomTUN",
-                    "   Calling parent_.tun_recv() with %zu byte buffer (capacity=%zu with headroom)...", 
-                    bytes_read, buf.capacity());
-                LOG_HOT_PATH("OpenVPN-CustomTUN",
-                    "   Buffer: size=%zu, offset=%zu, capacity=%zu", 
-                    buf.size(), buf.offset(), buf.capacity());
-                
-                // CRITICAL: Call parent_.tun_recv() to feed packet into OpenVPN's pipeline
-                // This is documented in TunClientParent interface (tunbase.hpp line 85)
-                // This should encrypt the packet and send it via UDP to the server
-                parent_.tun_recv(buf);
-                
-                LOG_HOT_PATH("OpenVPN-CustomTUN",
-                    "✅ OUTBOUND: Successfully fed %zu byte packet to OpenVPN!", bytes_read);
-                LOG_HOT_PATH("OpenVPN-CustomTUN",
-                    "   OpenVPN should now encrypt and send this packet to server");
-                LOG_HOT_PATH("OpenVPN-CustomTUN",
-                    "   If server responds, tun_send() will be called with decrypted response");
-                
-                // Queue next read
-                queue_read();
-            } catch (const std::exception& e) {
+        if (error) {
+            if (error != openvpn_io::error::operation_aborted) {
                 LOG_ERROR("OpenVPN-CustomTUN",
-                    "❌ OUTBOUND: Exception in handle_read: %s", e.what());
-                // Still queue next read to avoid getting stuck
+                    "❌ OUTBOUND: Wait error on lib_fd: %s", error.message().c_str());
+            }
+            return;
+        }
+        
+        prepare_read_slots();
+        
+        int count = reader_.read_batch(lib_fd_);
+        if (count < 0) {
+            const int err = errno;
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "❌ OUTBOUND: recvmmsg error on lib_fd: %s (errno=%d)", strerror(err), err);
+            if (err == ENOBUFS || err == ENOMEM) {
+                // Kernel memory pressure: the packets are still queued, try again
                 queue_read();
-            } catch (...) {
+                return;
+            }
+            // Anything else leaves lib_fd unusable, so fail the tunnel rather than go quiet
+            parent_.tun_error(Error::TUN_READ_ERROR,
+                std::string("recvmmsg on lib_fd failed: ") + strerror(err));
+            return;
+        }
+        const auto read_time = std::chrono::steady_clock::now();
+        
+        LOG_HOT_PATH("OpenVPN-CustomTUN",
+            "📤 OUTBOUND: Read batch of %d packet(s) from lib_fd", count);
+        
+        for (int i = 0; i < count && !halt_; ++i) {
+            size_t bytes_read = reader_.length(i);
+            if (bytes_read == 0) {
+                // Zero-length message: app_fd was closed, stop the read loop
+                on_peer_closed();
+                return;
+            }
+            if (reader_.truncated(i)) {
                 LOG_ERROR("OpenVPN-CustomTUN",
-                    "❌ OUTBOUND: Unknown exception in handle_read");
-                // Still queue next read to avoid getting stuck
-                queue_read();
+                    "❌ OUTBOUND: Dropping oversized packet from lib_fd (%zu bytes)", bytes_read);
+                stats_->drop_oversized.fetch_add(1, std::memory_order_relaxed);
+                continue;
             }
-        } else {
-            if (error && error != openvpn_io::error::operation_aborted) {
+            feed_packet(read_bufs_[i], bytes_read, read_time);
+        }
+        
+        // This batch freed room in app_fd for more of the pre-connect backlog
+        if (pre_connect_->backlog()) {
+            pre_connect_->flush(now_ms());
+        }
+        
+        queue_read();
+    }
+    
+    /**
+     * Hands packets the app routed here while connecting to OpenVPN via
+     * app_fd; they are read back from lib_fd with the first batch
+     *
+     * @return packets still waiting for app_fd space
+     */
+    size_t flush_pre_connect() {
+        if (halt_ || app_fd_ < 0) {
+            return pre_connect_->size();
+        }
+        return pre_connect_->open(app_fd_, now_ms());
+    }
+    
+    /**
+     * Register the ring doorbells with the io_context. The streams own dups
+     * of the eventfds; the ring pair keeps the originals.
+     */
+    void start_ring_read() {
+        if (!rings_) {
+            return;
+        }
+        const int data_fd = dup(rings_->outbound().data_fd());
+        const int space_fd = dup(rings_->inbound().space_fd());
+        if (data_fd < 0 || space_fd < 0) {
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "❌ Failed to dup ring doorbells: %s, using socketpair only", strerror(errno));
+            for (int fd : {data_fd, space_fd}) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+            drop_rings();
+            return;
+        }
+        ring_data_stream_ = new openvpn_io::posix::stream_descriptor(io_context_, data_fd);
+        ring_space_stream_ = new openvpn_io::posix::stream_descriptor(io_context_, space_fd);
+        LOG_INFO("OpenVPN-CustomTUN",
+            "✅ Registered packet ring doorbells for %s (%zu bytes per direction)",
+            tunnel_id_.c_str(), rings_->outbound().capacity());
+        queue_ring_read();
+    }
+    
+    /**
+     * Park on the outbound ring's doorbell, or come straight back through the
+     * io_context if packets were published in the meantime
+     */
+    void queue_ring_read() {
+        if (halt_ || !ring_data_stream_) {
+            return;
+        }
+        if (!rings_->outbound().park_consumer()) {
+            openvpn_io::post(io_context_, [this]() {
+                handle_ring_read(openvpn_io::error_code());
+            });
+            return;
+        }
+        ring_data_stream_->async_wait(
+            openvpn_io::posix::stream_descriptor::wait_read,
+            [this](const openvpn_io::error_code& error) {
+                handle_ring_read(error);
+            }
+        );
+    }
+    
+    /**
+     * Feed up to one read batch of packets from the outbound ring to OpenVPN
+     */
+    void handle_ring_read(const openvpn_io::error_code& error) {
+        if (halt_ || !rings_) {
+            return;
+        }
+        if (error) {
+            if (error != openvpn_io::error::operation_aborted) {
                 LOG_ERROR("OpenVPN-CustomTUN",
-                    "❌ OUTBOUND: Read error from lib_fd: %s", error.message().c_str());
+                    "❌ OUTBOUND: Wait error on ring doorbell: %s", error.message().c_str());
             }
+            return;
+        }
+        
+        PacketRing& ring = rings_->outbound();
+        PacketRing::drain_doorbell(ring.data_fd());
+        const auto read_time = std::chrono::steady_clock::now();
+        
+        const size_t batch = reader_.batch_size();
+        size_t count = 0;
+        for (; count < batch && !halt_; ++count) {
+            size_t len;
+            const uint8_t* packet = ring.front(len);
+            if (!packet) {
+                break;
+            }
+            BufferAllocated& buf = read_bufs_[0];
+            prepare_slot(buf);
+            if (len > buf.remaining(TAILROOM)) {
+                LOG_ERROR("OpenVPN-CustomTUN",
+                    "❌ OUTBOUND: Dropping oversized packet from ring (%zu bytes)", len);
+                stats_->drop_oversized.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::memcpy(buf.data(), packet, len);
+                feed_packet(buf, len, read_time);
+            }
+            ring.pop();
+        }
+        ring.release();
+        
+        LOG_HOT_PATH("OpenVPN-CustomTUN",
+            "📤 OUTBOUND: Fed batch of %zu packet(s) from ring", count);
+        
+        queue_ring_read();
+    }
+    
+    /**
+     * Push one decrypted packet into the inbound ring. Publishing is deferred
+     * to the end of the current io_context handler so a burst of tun_send()
+     * calls costs at most one doorbell.
+     */
+    bool ring_send(const BufferAllocated& buf) {
+        PacketRing& ring = rings_->inbound();
+        if (buf.size() > ring.max_packet()) {
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "❌ tun_send: %zu byte packet exceeds ring packet limit, dropping", buf.size());
+            stats_->drop_oversized.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!ring.push(buf.c_data(), buf.size())) {
+            stats_->eagain_write.fetch_add(1, std::memory_order_relaxed);
+            schedule_ring_publish();
+            return enqueue_egress(buf);
+        }
+        stats_->traffic.add_in(buf.size());
+        schedule_ring_publish();
+        return true;
+    }
+    
+    void schedule_ring_publish() {
+        if (publish_pending_) {
+            return;
+        }
+        publish_pending_ = true;
+        openvpn_io::post(io_context_, [this]() {
+            publish_pending_ = false;
+            if (!halt_ && rings_) {
+                rings_->inbound().publish();
+            }
+        });
+    }
+    
+    void drop_rings() {
+        if (rings_) {
+            PacketRingRegistry::instance().erase(tunnel_id_, rings_.get());
+            rings_.reset();
+        }
+    }
+    
+    void on_peer_closed() {
+        LOG_INFO("OpenVPN-CustomTUN", "OUTBOUND: lib_fd peer closed for %s, stopping reads", tunnel_id_.c_str());
+    }
+    
+    /**
+     * Reset each slot buffer to an empty payload region after HEADROOM and
+     * point the matching recvmmsg() iovec at it.
+     *
+     * A slot only goes back to pool_ when it is empty (first use) or when
+     * OpenVPN swapped a smaller buffer into it during encryption, so the
+     * steady state is allocation-free and never zero-fills.
+     */
+    void prepare_read_slots() {
+        const size_t slots = reader_.batch_size();
+        for (size_t i = 0; i < slots; ++i) {
+            BufferAllocated& buf = read_bufs_[i];
+            prepare_slot(buf);
+            reader_.set_slot(i, buf.data(), buf.remaining(TAILROOM));
+        }
+    }
+    
+    void prepare_slot(BufferAllocated& buf) {
+        if (buf.capacity() < pool_.buffer_size()) {
+            if (buf.capacity() > 0) {
+                pool_.release(std::move(buf));
+            }
+            buf = pool_.acquire();
+        }
+        buf.init_headroom(HEADROOM);
+    }
+    
+    /**
+     * Hand a packet that was read in place into its slot buffer to OpenVPN
+     * and record the read → tun_recv() return latency
+     */
+    void feed_packet(BufferAllocated& buf, size_t bytes_read,
+                     std::chrono::steady_clock::time_point read_time) {
+        try {
+            // Payload already sits after HEADROOM; just publish its length
+            buf.set_size(bytes_read);
+            stats_->traffic.add_out(bytes_read);
+            
+            // Cached DNS answers go straight back to the app; misses are
+            // readdressed to this tunnel's resolver
+            size_t len = bytes_read;
+            if (dns_.on_outbound(buf.data(), len, buf.size() + buf.remaining(TAILROOM), now_us()) ==
+                DnsForwarder::Action::ANSWERED) {
+                buf.set_size(len);
+                if (!halt_ && lib_fd_ >= 0) {
+                    send_to_app(buf);
+                }
+                return;
+            }
+            
+            if (clamp_tcp_mss(buf.data(), bytes_read, mss_limit_)) {
+                stats_->mss_clamped.fetch_add(1, std::memory_order_relaxed);
+            }
+            
+            LOG_HOT_PATH("OpenVPN-CustomTUN",
+                "   Buffer: size=%zu, offset=%zu, capacity=%zu", 
+                buf.size(), buf.offset(), buf.capacity());
+            
+            // Feed packet into OpenVPN's pipeline (TunClientParent::tun_recv, tunbase.hpp)
+            // OpenVPN encrypts the packet and sends it to the server
+            parent_.tun_recv(buf);
+            
+            stats_->record_latency(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - read_time).count());
+            
+            LOG_HOT_PATH("OpenVPN-CustomTUN",
+                "✅ OUTBOUND: Fed %zu byte packet to OpenVPN", bytes_read);
+        } catch (const std::exception& e) {
+            // Continue processing subsequent packets
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "❌ OUTBOUND: Exception in handle_read: %s", e.what());
+            stats_->drop_encrypt_error.fetch_add(1, std::memory_order_relaxed);
+        } catch (...) {
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "❌ OUTBOUND: Unknown exception in handle_read");
+            stats_->drop_encrypt_error.fetch_add(1, std::memory_order_relaxed);
         }
     }
     
@@ -396,6 +743,8 @@ private:
             }
         }
         
+        dns_.set_resolvers(dns_servers);
+        
         // Notify callback about DNS configuration
         if (callback_ && !dns_servers.empty()) {
             OPENVPN_LOG("Notifying callback: DNS servers count=" << dns_servers.size());
@@ -414,12 +763,288 @@ private:
         }
     }
     
+    /**
+     * Derive the TCP MSS limit from tun-mtu and the transport and cipher in
+     * use, so a full-size segment still fits the path after encryption
+     */
+    void configure_mss_clamp(TransportClient& transcli, const CryptoDCSettings& dc_settings) {
+        TunnelOverhead overhead;
+        const Protocol protocol = transcli.transport_protocol();
+        overhead.udp = protocol.is_udp();
+        overhead.ipv6_transport = protocol.is_ipv6();
+        auto alg_name = [](CryptoAlgs::Type type) {
+            const char* name = CryptoAlgs::name(type);
+            return std::string(name ? name : "");
+        };
+        overhead.aead = cipher_is_aead(alg_name(dc_settings.cipher()));
+        overhead.hmac_bytes = hmac_size(alg_name(dc_settings.digest()));
+        mss_limit_ = mss_limit(mtu_, overhead);
+        OPENVPN_LOG("TCP MSS clamp: ipv4=" << mss_limit_.ipv4 << " ipv6=" << mss_limit_.ipv6
+                    << " (overhead " << tunnel_overhead_bytes(overhead) << " bytes, tun-mtu " << mtu_ << ")");
+    }
+    
+    /**
+     * What a network change can keep: a UDP transport to a server that pushed
+     * peer-id floats, and the tunnel addresses let us probe the data channel
+     */
+    TransportTraits transport_traits(const OptionList& opt, TransportClient& transcli) const {
+        TransportTraits traits;
+        traits.udp = transcli.transport_protocol().is_udp();
+        traits.peer_id = opt.exists("peer-id");
+        traits.local_ip4 = vpn_ip4_;
+        const Option* gateway_opt = opt.get_ptr("route-gateway");
+        const Option* ip_opt = opt.get_ptr("ifconfig");
+        if (gateway_opt && gateway_opt->size() >= 2) {
+            traits.gateway_ip4 = gateway_opt->get(1, 256);
+        } else if (ip_opt && ip_opt->size() >= 3 && ip_opt->get(2, 256).rfind("255.", 0) != 0) {
+            traits.gateway_ip4 = ip_opt->get(2, 256);  // net30/p2p: "ifconfig local remote"
+        }
+        OPENVPN_LOG("Transport: udp=" << traits.udp << " peer-id=" << traits.peer_id
+                    << " gateway=" << traits.gateway_ip4);
+        return traits;
+    }
+    
+    /**
+     * Copy a decrypted packet into a pooled buffer and queue it for lib_fd
+     * 
+     * @return true if the packet was queued, false if the drop policy rejected it
+     */
+    bool enqueue_egress(const BufferAllocated& packet) {
+        BufferAllocated copy = pool_.acquire();
+        copy.init_headroom(0);
+        if (packet.size() > copy.capacity()) {
+            LOG_ERROR("OpenVPN-CustomTUN",
+                "❌ tun_send: %zu byte packet exceeds egress buffer size %zu, dropping",
+                packet.size(), copy.capacity());
+            pool_.release(std::move(copy));
+            stats_->drop_oversized.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::memcpy(copy.write_alloc(packet.size()), packet.c_data(), packet.size());
+        
+        bool queued = egress_.push(std::move(copy), now_ms(), [this](BufferAllocated&& dropped) {
+            pool_.release(std::move(dropped));
+        });
+        if (!queued) {
+            LOG_HOT_PATH("OpenVPN-CustomTUN",
+                "⚠️  tun_send: egress queue full (%zu), dropping packet", egress_.capacity());
+        }
+        stats_->egress_depth.store(egress_.size(), std::memory_order_relaxed);
+        
+        queue_write();
+        return queued;
+    }
+    
+    /**
+     * Wait for lib_fd to become writable while the egress queue is non-empty
+     */
+    void queue_write() {
+        if (write_pending_ || halt_ || !stream_ || egress_.empty()) {
+            return;
+        }
+        
+        write_pending_ = true;
+        if (ring_active()) {
+            // Wait for the pump to free ring space instead of lib_fd writability
+            if (!rings_->inbound().park_producer(egress_.front().size())) {
+                openvpn_io::post(io_context_, [this]() {
+                    handle_write(openvpn_io::error_code());
+                });
+                return;
+            }
+            ring_space_stream_->async_wait(
+                openvpn_io::posix::stream_descriptor::wait_read,
+                [this](const openvpn_io::error_code& error) {
+                    if (!error && rings_) {
+                        PacketRing::drain_doorbell(rings_->inbound().space_fd());
+                    }
+                    handle_write(error);
+                }
+            );
+            return;
+        }
+        stream_->async_wait(
+            openvpn_io::posix::stream_descriptor::wait_write,
+            [this](const openvpn_io::error_code& error) {
+                handle_write(error);
+            }
+        );
+    }
+    
+    void handle_write(const openvpn_io::error_code& error) {
+        write_pending_ = false;
+        
+        if (halt_) {
+            return;
+        }
+        
+        if (error) {
+            if (error != openvpn_io::error::operation_aborted) {
+                LOG_ERROR("OpenVPN-CustomTUN",
+                    "❌ INBOUND: Wait error on lib_fd: %s", error.message().c_str());
+            }
+            return;
+        }
+        
+        flush_egress();
+    }
+    
+    /**
+     * Write queued packets to lib_fd in order until it would block again
+     */
+    void flush_egress() {
+        auto release = [this](BufferAllocated&& buf) {
+            pool_.release(std::move(buf));
+        };
+        egress_.expire(now_ms(), release);
+        
+        const bool ring = ring_active();
+        while (!egress_.empty()) {
+            BufferAllocated& packet = egress_.front();
+            if (ring) {
+                if (!rings_->inbound().push(packet.c_data(), packet.size())) {
+                    break;
+                }
+                stats_->traffic.add_in(packet.size());
+                release(egress_.pop());
+                continue;
+            }
+            ssize_t n = write(lib_fd_, packet.c_data(), packet.size());
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    stats_->eagain_write.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+                LOG_ERROR("OpenVPN-CustomTUN",
+                    "❌ INBOUND: queued write error: %s (errno=%d), dropping packet", strerror(errno), errno);
+                stats_->drop_write_error.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                stats_->traffic.add_in(packet.size());
+            }
+            release(egress_.pop());
+        }
+        if (ring) {
+            rings_->inbound().publish();
+        }
+        stats_->egress_depth.store(egress_.size(), std::memory_order_relaxed);
+        
+        LOG_HOT_PATH("OpenVPN-CustomTUN",
+            "▶️  INBOUND: egress flush done, depth=%zu", egress_.size());
+        
+        queue_write();
+    }
+    
+    /**
+     * Arm the next rate summary; compiled out when info logging is disabled
+     */
+    void schedule_rate_log() {
+        if (!LOGGING_INFO_ENABLED || TUN_STATS_LOG_INTERVAL_SEC <= 0 || halt_ || !stats_timer_) {
+            return;
+        }
+        
+        stats_timer_->expires_after(std::chrono::seconds(TUN_STATS_LOG_INTERVAL_SEC));
+        stats_timer_->async_wait([this](const openvpn_io::error_code& error) {
+            if (error || halt_) {
+                return;
+            }
+            log_rates();
+            schedule_rate_log();
+        });
+    }
+    
+    void log_rates() {
+        TunRateSummary::Rates rates = rate_summary_.sample(stats_->traffic, now_ms());
+        if (rates.idle()) {
+            return;
+        }
+        char line[160];
+        TunRateSummary::format(line, sizeof(line), rates);
+        LOG_INFO("OpenVPN-CustomTUN", "📊 %s: %s", tunnel_id_.c_str(), line);
+    }
+    
+    static uint64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    static uint64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
     /**
      * Clean up resources
      */
     void cleanup() {
         halt_ = true;
         
+#if LOGGING_INFO_ENABLED
+        if (stream_) {
+            const TunBatchStats& stats = reader_.stats();
+            LOG_INFO("OpenVPN-CustomTUN",
+                "Outbound batch stats for %s: batches=%llu packets=%llu avg_fill=%llu.%02llu full=%llu empty=%llu",
+                tunnel_id_.c_str(),
+                (unsigned long long)stats.batches.load(),
+                (unsigned long long)stats.packets.load(),
+                (unsigned long long)(stats.average_fill_x100() / 100),
+                (unsigned long long)(stats.average_fill_x100() % 100),
+                (unsigned long long)stats.full_batches.load(),
+                (unsigned long long)stats.empty_reads.load());
+            
+            const TunBufferPoolStats& pool_stats = pool_.stats();
+            LOG_INFO("OpenVPN-CustomTUN",
+                "Buffer pool stats for %s: hits=%llu misses=%llu discards=%llu high_water=%llu",
+                tunnel_id_.c_str(),
+                (unsigned long long)pool_stats.hits.load(),
+                (unsigned long long)pool_stats.misses.load(),
+                (unsigned long long)pool_stats.discards.load(),
+                (unsigned long long)pool_stats.high_water.load());
+            
+            const TunEgressStats& egress_stats = egress_.stats();
+            LOG_INFO("OpenVPN-CustomTUN",
+                "Egress queue stats for %s (%s, cap=%zu): queued=%llu flushed=%llu tail_drops=%llu head_drops=%llu age_drops=%llu high_water=%llu",
+                tunnel_id_.c_str(), drop_policy_name(egress_.policy()), egress_.capacity(),
+                (unsigned long long)egress_stats.enqueued.load(),
+                (unsigned long long)egress_stats.flushed.load(),
+                (unsigned long long)egress_stats.tail_drops.load(),
+                (unsigned long long)egress_stats.head_drops.load(),
+                (unsigned long long)egress_stats.age_drops.load(),
+                (unsigned long long)egress_stats.high_water.load());
+        }
+#endif
+        
+        stats_->lib_fd.store(-1, std::memory_order_relaxed);
+        stats_->egress_depth.store(0, std::memory_order_relaxed);
+        
+        // Pool counters live in the tunnel's TunnelStats across reconnects, so
+        // every buffer this client still holds goes back before it is destroyed
+        for (BufferAllocated& buf : read_bufs_) {
+            if (buf.capacity() > 0) {
+                pool_.release(std::move(buf));
+            }
+        }
+        read_bufs_.clear();
+        egress_.drain([this](BufferAllocated&& buf) { pool_.release(std::move(buf)); });
+        
+        if (stats_timer_) {
+            stats_timer_->cancel();
+            stats_timer_.reset();
+        }
+        
+        for (openvpn_io::posix::stream_descriptor** ring_stream : {&ring_data_stream_, &ring_space_stream_}) {
+            if (*ring_stream) {
+                try {
+                    (*ring_stream)->cancel();
+                    delete *ring_stream;
+                } catch (...) {}
+                *ring_stream = nullptr;
+            }
+        }
+        drop_rings();
+        
         // Cancel and delete stream
         if (stream_) {
             try {
@@ -429,6 +1054,7 @@ private:
             stream_ = nullptr;
         }
         
+        pre_connect_->close();
         if (app_fd_ >= 0) {
             close(app_fd_);
             app_fd_ = -1;
@@ -447,9 +1073,25 @@ private:
     int lib_fd_;      // OpenVPN 3's FD
     openvpn_io::posix::stream_descriptor* stream_;  // Asio stream for async reading from lib_fd
     bool halt_;
+    bool write_pending_;  // async_wait(wait_write) outstanding for egress_
+    bool first_packet_marked_ = false;  // MARK_FIRST_PACKET recorded for this connect
     int mtu_;
+    MssLimit mss_limit_;  // From mtu_ and tunnel overhead; applied to SYNs both ways
     std::string vpn_ip4_;
     std::string vpn_ip6_;
+    TunBatchReader reader_;  // Batched recvmmsg() reader for the outbound path
+    TunBufferPool<BufferAllocated> pool_;     // Per-tunnel packet buffers sized from mtu_
+    std::vector<BufferAllocated> read_bufs_;  // Recycled headroom-reserved buffers, one per reader_ slot
+    TunEgressQueue<BufferAllocated> egress_;  // Inbound packets held while lib_fd is full
+    std::shared_ptr<TunnelStats> stats_;      // Per-tunnel counters, shared with TunnelStatsRegistry
+    std::shared_ptr<PreConnectQueue> pre_connect_;  // Packets routed here before tun_start()
+    DnsForwarder dns_;                        // Per-tunnel DNS cache and resolver forwarding
+    TunRateSummary rate_summary_;             // Converts stats_->traffic snapshots to rates
+    std::unique_ptr<openvpn_io::steady_timer> stats_timer_;  // Drives the periodic rate summary
+    std::shared_ptr<PacketRingPair> rings_;   // Shared-memory transport to the TUN pump (TUN_SHM_RING)
+    openvpn_io::posix::stream_descriptor* ring_data_stream_ = nullptr;   // Outbound ring doorbell
+    openvpn_io::posix::stream_descriptor* ring_space_stream_ = nullptr;  // Inbound ring free-space doorbell
+    bool publish_pending_ = false;            // Inbound ring publish() posted to io_context_
 };
 
 /**
@@ -498,16 +1140,16 @@ public:
      * Get the app FD from the created TunClient
      */
     int getAppFd() const {
-        __android_log_print(ANDROID_LOG_INFO, "OpenVPN-CustomTUN",
+        LOG_DEBUG("OpenVPN-CustomTUN",
             "CustomTunClientFactory::getAppFd() - tun_client_=%p", (void*)tun_client_);
         
         if (tun_client_) {
             int fd = tun_client_->getAppFd();
-            __android_log_print(ANDROID_LOG_INFO, "OpenVPN-CustomTUN",
+            LOG_DEBUG("OpenVPN-CustomTUN",
                 "CustomTunClient::getAppFd() returned: %d", fd);
             return fd;
         }
-        __android_log_print(ANDROID_LOG_WARN, "OpenVPN-CustomTUN",
+        LOG_ERROR("OpenVPN-CustomTUN",
             "CustomTunClientFactory::getAppFd() - tun_client_ is NULL!");
         return -1;
     }
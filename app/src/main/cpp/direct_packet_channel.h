@@ -0,0 +1,286 @@
+#ifndef DIRECT_PACKET_CHANNEL_H
+#define DIRECT_PACKET_CHANNEL_H
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace openvpn {
+
+/**
+ * Memory of a direct ByteBuffer registered from Kotlin. The Kotlin side keeps
+ * the buffer reachable for as long as it is registered.
+ */
+struct DirectPacketBuffer {
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+};
+
+/**
+ * Counters for one DirectPacketChannel, readable from any thread
+ */
+struct DirectPacketStats {
+    std::atomic<uint64_t> packets_sent{0};
+    std::atomic<uint64_t> packets_received{0};
+    std::atomic<uint64_t> send_calls{0};      // send() / send_batch() calls that sent something
+    std::atomic<uint64_t> receive_calls{0};   // receive() / receive_batch() calls that returned packets
+    std::atomic<uint64_t> truncated{0};       // Received messages larger than their slot, dropped
+    std::atomic<uint64_t> invalid{0};         // Offset/length outside the registered buffer
+};
+
+/**
+ * Moves packets between the Kotlin end of a tunnel's socketpair and a pair of
+ * direct ByteBuffers that Kotlin registers once per tunnel, so JNI calls
+ * carry only offsets, lengths and counts: no Java arrays, no per-packet
+ * allocation on either side, and the kernel copies straight to or from the
+ * Java-visible memory.
+ *
+ * Batch layout of both buffers (mirrored by DirectPacketChannel.kt):
+ *
+ *   [0, DATA_OFFSET)         MAX_BATCH descriptors, each {int32 offset, int32 length}
+ *                            in native byte order
+ *   [DATA_OFFSET, capacity)  packet bytes
+ *
+ * send_batch() sends the first count descriptors of the send buffer with one
+ * sendmmsg(). receive_batch() reads into SLOT_SIZE slots after DATA_OFFSET
+ * with one recvmmsg() and describes each packet in the receive buffer's
+ * descriptors. The single-packet calls ignore the descriptors.
+ *
+ * Every call is non-blocking. JNI callers pin the tunnel slot while using
+ * the channel, so they wait for POLLIN / POLLOUT with the pin released.
+ * The send and receive sides may run on different threads; each side must
+ * only be driven by one thread at a time.
+ */
+class DirectPacketChannel {
+public:
+    static constexpr size_t MAX_BATCH = 64;
+    static constexpr size_t DESCRIPTOR_SIZE = 8;
+    static constexpr size_t DATA_OFFSET = MAX_BATCH * DESCRIPTOR_SIZE;
+    // Fits the 1500-byte TUN MTU with room for a larger tun-mtu push
+    static constexpr size_t SLOT_SIZE = 2048;
+
+    DirectPacketChannel(int fd, DirectPacketBuffer send, DirectPacketBuffer receive)
+        : fd_(fd), send_(send), receive_(receive) {}
+
+    DirectPacketChannel(const DirectPacketChannel&) = delete;
+    DirectPacketChannel& operator=(const DirectPacketChannel&) = delete;
+
+    /**
+     * True if the socket is set and both buffers can hold the descriptors and
+     * at least one slot
+     */
+    bool valid() const {
+        return fd_ >= 0 && send_.data && receive_.data &&
+               send_.capacity >= DATA_OFFSET + SLOT_SIZE && receive_.capacity >= DATA_OFFSET + SLOT_SIZE;
+    }
+
+    /**
+     * Sends send buffer bytes [offset, offset + length) as one packet.
+     *
+     * @return length, or -1 on error (errno set; EAGAIN if the socket is full,
+     *         EINVAL for a bad range)
+     */
+    int send(size_t offset, size_t length) {
+        if (!in_bounds(send_, offset, length)) {
+            stats_.invalid.fetch_add(1, std::memory_order_relaxed);
+            errno = EINVAL;
+            return -1;
+        }
+        ssize_t n;
+        do {
+            n = ::send(fd_, send_.data + offset, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) {
+            return -1;
+        }
+        stats_.packets_sent.fetch_add(1, std::memory_order_relaxed);
+        stats_.send_calls.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<int>(n);
+    }
+
+    /**
+     * Sends the packets described by the first count send descriptors, in order.
+     *
+     * @return packets sent, which is fewer than count if the socket filled
+     *         up; -1 if none were (errno set). A descriptor outside the buffer
+     *         stops the batch before it.
+     */
+    int send_batch(size_t count) {
+        mmsghdr msgs[MAX_BATCH];
+        iovec iovs[MAX_BATCH];
+        if (count > MAX_BATCH) {
+            count = MAX_BATCH;
+        }
+        size_t valid_count = 0;
+        for (; valid_count < count; ++valid_count) {
+            size_t offset;
+            size_t length;
+            read_descriptor(send_, valid_count, offset, length);
+            if (!in_bounds(send_, offset, length)) {
+                stats_.invalid.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            iovs[valid_count].iov_base = send_.data + offset;
+            iovs[valid_count].iov_len = length;
+            msgs[valid_count] = {};
+            msgs[valid_count].msg_hdr.msg_iov = &iovs[valid_count];
+            msgs[valid_count].msg_hdr.msg_iovlen = 1;
+        }
+        if (valid_count == 0) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        size_t sent = 0;
+        while (sent < valid_count) {
+            const int n = sendmmsg(fd_, msgs + sent, static_cast<unsigned int>(valid_count - sent),
+                                   MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        if (sent == 0) {
+            return -1;
+        }
+        stats_.packets_sent.fetch_add(sent, std::memory_order_relaxed);
+        stats_.send_calls.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<int>(sent);
+    }
+
+    /**
+     * Receives one packet into the receive buffer at offset.
+     *
+     * @return packet length, 0 if none was pending, -1 on error or when the
+     *         peer closed (errno set; EMSGSIZE for a packet that did not fit,
+     *         which is dropped)
+     */
+    int receive(size_t offset) {
+        if (offset >= receive_.capacity) {
+            stats_.invalid.fetch_add(1, std::memory_order_relaxed);
+            errno = EINVAL;
+            return -1;
+        }
+        const size_t room = receive_.capacity - offset;
+        ssize_t n;
+        do {
+            n = recv(fd_, receive_.data + offset, room, MSG_TRUNC | MSG_DONTWAIT);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;
+            return -1;
+        }
+        if (static_cast<size_t>(n) > room) {
+            stats_.truncated.fetch_add(1, std::memory_order_relaxed);
+            errno = EMSGSIZE;
+            return -1;
+        }
+        stats_.packets_received.fetch_add(1, std::memory_order_relaxed);
+        stats_.receive_calls.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<int>(n);
+    }
+
+    /**
+     * Receives up to max_count packets and writes their descriptors to the
+     * start of the receive buffer. Truncated packets are dropped.
+     *
+     * @return packets described, 0 if none were pending, -1 on error or when
+     *         the peer closed (errno set)
+     */
+    int receive_batch(size_t max_count) {
+        mmsghdr msgs[MAX_BATCH];
+        iovec iovs[MAX_BATCH];
+        const size_t slots = (receive_.capacity - DATA_OFFSET) / SLOT_SIZE;
+        size_t count = max_count < MAX_BATCH ? max_count : MAX_BATCH;
+        if (count > slots) {
+            count = slots;
+        }
+        if (count == 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            iovs[i].iov_base = receive_.data + DATA_OFFSET + i * SLOT_SIZE;
+            iovs[i].iov_len = SLOT_SIZE;
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int n;
+        do {
+            n = recvmmsg(fd_, msgs, static_cast<unsigned int>(count), MSG_DONTWAIT, nullptr);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        // A closed peer reads as zero-length messages; no IP packet is empty
+        if (n == 0 || msgs[0].msg_len == 0) {
+            errno = ECONNRESET;
+            return -1;
+        }
+
+        size_t described = 0;
+        for (int i = 0; i < n; ++i) {
+            if (msgs[i].msg_len == 0) {
+                break;
+            }
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                stats_.truncated.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            write_descriptor(receive_, described++, DATA_OFFSET + static_cast<size_t>(i) * SLOT_SIZE,
+                             msgs[i].msg_len);
+        }
+        if (described > 0) {
+            stats_.packets_received.fetch_add(described, std::memory_order_relaxed);
+            stats_.receive_calls.fetch_add(1, std::memory_order_relaxed);
+        }
+        return static_cast<int>(described);
+    }
+
+    int fd() const {
+        return fd_;
+    }
+
+    const DirectPacketStats& stats() const {
+        return stats_;
+    }
+
+private:
+    static bool in_bounds(const DirectPacketBuffer& buffer, size_t offset, size_t length) {
+        return length > 0 && offset <= buffer.capacity && length <= buffer.capacity - offset;
+    }
+
+    static void read_descriptor(const DirectPacketBuffer& buffer, size_t index, size_t& offset, size_t& length) {
+        int32_t fields[2];
+        std::memcpy(fields, buffer.data + index * DESCRIPTOR_SIZE, sizeof(fields));
+        // Negative values become huge and fail in_bounds()
+        offset = static_cast<size_t>(static_cast<uint32_t>(fields[0]));
+        length = static_cast<size_t>(static_cast<uint32_t>(fields[1]));
+    }
+
+    static void write_descriptor(DirectPacketBuffer& buffer, size_t index, size_t offset, size_t length) {
+        const int32_t fields[2] = {static_cast<int32_t>(offset), static_cast<int32_t>(length)};
+        std::memcpy(buffer.data + index * DESCRIPTOR_SIZE, fields, sizeof(fields));
+    }
+
+    int fd_;   // Owned by Kotlin, which unregisters the channel before closing it
+    DirectPacketBuffer send_;
+    DirectPacketBuffer receive_;
+    DirectPacketStats stats_;
+};
+
+} // namespace openvpn
+
+#endif // DIRECT_PACKET_CHANNEL_H
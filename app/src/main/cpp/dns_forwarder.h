@@ -0,0 +1,603 @@
+#ifndef DNS_FORWARDER_H
+#define DNS_FORWARDER_H
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "packet_classifier.h"
+
+// DNS responses cached per tunnel.
+// Override at build time with -DTUN_DNS_CACHE_ENTRIES=<n> (see CMakeLists.txt).
+#ifndef TUN_DNS_CACHE_ENTRIES
+#define TUN_DNS_CACHE_ENTRIES 512
+#endif
+
+// Upper bound on how long a cached response is served, whatever its TTL
+#ifndef TUN_DNS_MAX_TTL_SEC
+#define TUN_DNS_MAX_TTL_SEC 3600
+#endif
+
+namespace openvpn {
+
+/**
+ * Counters for a tunnel's DnsForwarder, readable from any thread
+ */
+struct DnsStats {
+    std::atomic<uint64_t> queries{0};           // UDP/53 queries from the app
+    std::atomic<uint64_t> cache_hits{0};        // Answered from the cache without leaving the device
+    std::atomic<uint64_t> forwarded{0};         // Sent on to the tunnel's resolver
+    std::atomic<uint64_t> responses{0};         // Resolver responses matched to a forwarded query
+    std::atomic<uint64_t> latency_us_total{0};  // Sum of forward → response times over responses
+    std::atomic<uint64_t> cache_entries{0};     // Current cache size
+};
+
+namespace dns_detail {
+
+using classifier_detail::read_be16;
+
+constexpr size_t HEADER_SIZE = 12;
+constexpr uint16_t TYPE_SOA = 6;
+constexpr uint16_t TYPE_OPT = 41;
+constexpr uint16_t PORT = 53;
+
+inline uint32_t read_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+inline void write_be16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+inline void write_be32(uint8_t* p, uint32_t value) {
+    write_be16(p, static_cast<uint16_t>(value >> 16));
+    write_be16(p + 2, static_cast<uint16_t>(value));
+}
+
+// Offset just past the (possibly compressed) name at off, or 0 if malformed
+inline size_t skip_name(const uint8_t* msg, size_t len, size_t off) {
+    for (int labels = 0; labels < 128 && off < len; ++labels) {
+        const uint8_t label = msg[off];
+        if (label == 0) {
+            return off + 1;
+        }
+        if ((label & 0xC0) == 0xC0) {
+            return off + 2 <= len ? off + 2 : 0;
+        }
+        if (label & 0xC0) {
+            return 0;
+        }
+        off += 1 + static_cast<size_t>(label);
+    }
+    return 0;
+}
+
+/**
+ * Builds the cache key of a message's single question: lowercased name,
+ * type, class and the CD bit. Returns the offset past the question, or 0 if
+ * the message is not a standard single-question query or response.
+ */
+inline size_t question_key(const uint8_t* msg, size_t len, std::string& key) {
+    if (len < HEADER_SIZE || read_be16(msg + 4) != 1 || (msg[2] & 0x78) != 0) {
+        return 0;
+    }
+    key.clear();
+    size_t off = HEADER_SIZE;
+    while (off < len && msg[off] != 0) {
+        const size_t label = msg[off];
+        // Questions are never compressed
+        if (label > 63 || off + 1 + label > len) {
+            return 0;
+        }
+        key.push_back(static_cast<char>(label));
+        for (size_t i = 1; i <= label; ++i) {
+            const char c = static_cast<char>(msg[off + i]);
+            key.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c);
+        }
+        off += 1 + label;
+    }
+    if (off + 5 > len) {
+        return 0;
+    }
+    key.push_back('\0');
+    key.append(reinterpret_cast<const char*>(msg + off + 1), 4);
+    key.push_back(static_cast<char>(msg[3] & 0x10));
+    return off + 5;
+}
+
+/**
+ * Calls visit(type_offset, in_answer_or_authority) for each resource record
+ * after the question. Returns false if the records run past len.
+ */
+template <typename Visit>
+inline bool for_each_record(const uint8_t* msg, size_t len, size_t off, Visit&& visit) {
+    const size_t answer_authority = static_cast<size_t>(read_be16(msg + 6)) + read_be16(msg + 8);
+    const size_t total = answer_authority + read_be16(msg + 10);
+    for (size_t i = 0; i < total; ++i) {
+        off = skip_name(msg, len, off);
+        if (off == 0 || off + 10 > len) {
+            return false;
+        }
+        const size_t rdlength = read_be16(msg + off + 8);
+        if (off + 10 + rdlength > len) {
+            return false;
+        }
+        visit(off, i < answer_authority);
+        off += 10 + rdlength;
+    }
+    return true;
+}
+
+/**
+ * Seconds a response may be cached: the smallest answer/authority TTL, or
+ * for a negative answer min(SOA TTL, SOA MINIMUM) per RFC 2308. 0 means the
+ * response is not cacheable (truncated, an error, or no SOA to bound it).
+ */
+inline uint32_t cache_ttl(const uint8_t* msg, size_t len, size_t question_end) {
+    const uint8_t rcode = msg[3] & 0x0F;
+    if ((msg[2] & 0x02) || (rcode != 0 && rcode != 3)) {
+        return 0;
+    }
+    const bool negative = rcode == 3 || read_be16(msg + 6) == 0;
+    uint32_t ttl = UINT32_MAX;
+    bool soa = false;
+    const bool intact = for_each_record(msg, len, question_end, [&](size_t rr, bool counted) {
+        if (!counted) {
+            return;
+        }
+        uint32_t rr_ttl = read_be32(msg + rr + 4);
+        if (negative) {
+            const size_t rdlength = read_be16(msg + rr + 8);
+            // MINIMUM closes the SOA RDATA, after two names and four 32-bit fields
+            if (read_be16(msg + rr) != TYPE_SOA || rdlength < 22) {
+                return;
+            }
+            rr_ttl = std::min(rr_ttl, read_be32(msg + rr + 10 + rdlength - 4));
+            soa = true;
+        }
+        ttl = std::min(ttl, rr_ttl);
+    });
+    if (!intact || ttl == UINT32_MAX || (negative && !soa)) {
+        return 0;
+    }
+    return std::min<uint32_t>(ttl, TUN_DNS_MAX_TTL_SEC);
+}
+
+/**
+ * Lowers every record TTL except OPT's by elapsed seconds
+ */
+inline void age_ttls(uint8_t* msg, size_t len, size_t question_end, uint32_t elapsed) {
+    for_each_record(msg, len, question_end, [&](size_t rr, bool) {
+        if (read_be16(msg + rr) == TYPE_OPT) {
+            return;
+        }
+        const uint32_t ttl = read_be32(msg + rr + 4);
+        write_be32(msg + rr + 4, ttl > elapsed ? ttl - elapsed : 0);
+    });
+}
+
+/**
+ * Where the UDP header and DNS message sit in an IP packet
+ */
+struct UdpView {
+    bool ipv6 = false;
+    size_t udp = 0;           // Offset of the UDP header
+    size_t payload_len = 0;   // DNS message bytes after the UDP header
+
+    size_t payload() const { return udp + 8; }
+    size_t src_addr() const { return ipv6 ? 8 : 12; }
+    size_t dst_addr() const { return ipv6 ? 24 : 16; }
+    size_t addr_len() const { return ipv6 ? 16 : 4; }
+};
+
+/**
+ * Finds the UDP datagram in an unfragmented IPv4 packet or an IPv6 packet
+ * without extension headers
+ */
+inline bool parse_udp(const uint8_t* packet, size_t len, UdpView& view) {
+    if (len < 28) {
+        return false;
+    }
+    const uint8_t version = packet[0] >> 4;
+    if (version == 4) {
+        const size_t ihl = static_cast<size_t>(packet[0] & 0x0F) * 4;
+        if (ihl < 20 || packet[9] != 17 || (read_be16(packet + 6) & 0x3FFF) != 0) {
+            return false;
+        }
+        len = std::min<size_t>(len, read_be16(packet + 2));
+        view.ipv6 = false;
+        view.udp = ihl;
+    } else if (version == 6) {
+        if (len < 48 || packet[6] != 17) {
+            return false;
+        }
+        len = std::min<size_t>(len, 40 + static_cast<size_t>(read_be16(packet + 4)));
+        view.ipv6 = true;
+        view.udp = 40;
+    } else {
+        return false;
+    }
+    const size_t udp_len = read_be16(packet + view.udp + 4);
+    if (udp_len < 8 || view.udp + udp_len > len) {
+        return false;
+    }
+    view.payload_len = udp_len - 8;
+    return true;
+}
+
+inline uint32_t sum_words(const uint8_t* data, size_t len, uint32_t sum) {
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += read_be16(data + i);
+    }
+    if (len & 1) {
+        sum += static_cast<uint32_t>(data[len - 1]) << 8;
+    }
+    return sum;
+}
+
+inline uint16_t fold(uint32_t sum) {
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+/**
+ * Recomputes the IPv4 header checksum (if any) and the UDP checksum
+ */
+inline void update_checksums(uint8_t* packet, const UdpView& view) {
+    const size_t udp_len = view.payload_len + 8;
+    if (!view.ipv6) {
+        write_be16(packet + 10, 0);
+        write_be16(packet + 10, fold(sum_words(packet, view.udp, 0)));
+    }
+    uint32_t sum = sum_words(packet + view.src_addr(), view.addr_len() * 2, 0);
+    sum += 17 + static_cast<uint32_t>(udp_len);
+    write_be16(packet + view.udp + 6, 0);
+    sum = sum_words(packet + view.udp, udp_len, sum);
+    const uint16_t checksum = fold(sum);
+    write_be16(packet + view.udp + 6, checksum == 0 ? 0xFFFF : checksum);
+}
+
+} // namespace dns_detail
+
+/**
+ * LRU map from question key to the last response, with expiry from the
+ * response's own TTLs. Single-threaded; owned by one DnsForwarder.
+ */
+class DnsCache {
+public:
+    explicit DnsCache(size_t max_entries = TUN_DNS_CACHE_ENTRIES)
+        : max_entries_(max_entries < 1 ? 1 : max_entries) {}
+
+    /**
+     * Copies the response cached for key into out with its TTLs lowered by
+     * its age. Returns the length, or 0 on a miss, an expired entry, or an
+     * entry larger than capacity.
+     */
+    size_t lookup(const std::string& key, uint64_t now_ms, uint8_t* out, size_t capacity) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return 0;
+        }
+        Entry& entry = *it->second;
+        if (now_ms >= entry.expires_ms) {
+            lru_.erase(it->second);
+            index_.erase(it);
+            return 0;
+        }
+        if (entry.response.size() > capacity) {
+            return 0;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);
+
+        std::memcpy(out, entry.response.data(), entry.response.size());
+        // Round up so a served TTL never outlives the original
+        const uint32_t elapsed = static_cast<uint32_t>((now_ms - entry.stored_ms + 999) / 1000);
+        dns_detail::age_ttls(out, entry.response.size(), entry.question_end, elapsed);
+        return entry.response.size();
+    }
+
+    /**
+     * Stores a response for ttl_sec, evicting the least recently used entry
+     * when full
+     */
+    void insert(const std::string& key, const uint8_t* msg, size_t len, size_t question_end,
+                uint32_t ttl_sec, uint64_t now_ms) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+        } else {
+            if (lru_.size() >= max_entries_) {
+                index_.erase(lru_.back().key);
+                lru_.pop_back();
+            }
+            lru_.emplace_front();
+            lru_.front().key = key;
+            index_.emplace(key, lru_.begin());
+        }
+        Entry& entry = lru_.front();
+        entry.response.assign(msg, msg + len);
+        entry.question_end = question_end;
+        entry.stored_ms = now_ms;
+        entry.expires_ms = now_ms + static_cast<uint64_t>(ttl_sec) * 1000;
+    }
+
+    size_t size() const { return lru_.size(); }
+
+    void clear() {
+        lru_.clear();
+        index_.clear();
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::vector<uint8_t> response;
+        size_t question_end = 0;
+        uint64_t stored_ms = 0;
+        uint64_t expires_ms = 0;
+    };
+
+    size_t max_entries_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+/**
+ * Per-tunnel DNS forwarder on CustomTunClient's packet path.
+ *
+ * Outbound UDP/53 queries are answered from the tunnel's DnsCache when
+ * possible; the rest are readdressed to the resolvers OpenVPN pushed for
+ * this tunnel (on_dns_configured), so a query never leaves through one
+ * region's tunnel towards another region's resolver. Responses are matched
+ * back by DNS ID and client port, cached, and given back the source address
+ * the app queried. Each tunnel owns its own forwarder and cache.
+ *
+ * Used from a single io_context thread.
+ */
+class DnsForwarder {
+public:
+    // Largest response served from the cache; keeps answers inside one TUN packet
+    static constexpr size_t MAX_CACHED_RESPONSE = 1400;
+    static constexpr size_t PENDING_SLOTS = 1024;
+    static constexpr uint64_t PENDING_TIMEOUT_US = 5000000;
+
+    enum class Action {
+        PASS,       // Not a DNS query; send unchanged
+        ANSWERED,   // Packet now holds the cached response for the app
+        FORWARD     // Query for the resolver; send to the server
+    };
+
+    explicit DnsForwarder(size_t cache_entries = TUN_DNS_CACHE_ENTRIES)
+        : cache_(cache_entries), pending_(PENDING_SLOTS) {}
+
+    DnsForwarder(const DnsForwarder&) = delete;
+    DnsForwarder& operator=(const DnsForwarder&) = delete;
+
+    /**
+     * Counts into an external stats block (a tunnel's TunnelStats) instead of
+     * the forwarder's own
+     */
+    void attach_stats(DnsStats& stats) {
+        stats_ = &stats;
+    }
+
+    /**
+     * Sets the tunnel's resolvers from pushed dhcp-option DNS values; the
+     * first address of each family is used
+     */
+    void set_resolvers(const std::vector<std::string>& servers) {
+        has_v4_ = has_v6_ = false;
+        for (const std::string& server : servers) {
+            if (!has_v4_ && inet_pton(AF_INET, server.c_str(), resolver_v4_) == 1) {
+                has_v4_ = true;
+            } else if (!has_v6_ && inet_pton(AF_INET6, server.c_str(), resolver_v6_) == 1) {
+                has_v6_ = true;
+            }
+        }
+    }
+
+    /**
+     * Handles a packet from the app. A query with a cached answer is
+     * rewritten in place into the response (len is updated; capacity is the
+     * writable room from packet) and ANSWERED is returned.
+     */
+    Action on_outbound(uint8_t* packet, size_t& len, size_t capacity, uint64_t now_us) {
+        dns_detail::UdpView view;
+        if (!dns_detail::parse_udp(packet, len, view) ||
+            dns_detail::read_be16(packet + view.udp + 2) != dns_detail::PORT ||
+            view.payload_len < dns_detail::HEADER_SIZE) {
+            return Action::PASS;
+        }
+        uint8_t* msg = packet + view.payload();
+        if (msg[2] & 0x80) {
+            return Action::PASS;   // A response travelling outbound is not ours to touch
+        }
+        stats_->queries.fetch_add(1, std::memory_order_relaxed);
+
+        if (dns_detail::question_key(msg, view.payload_len, key_) != 0) {
+            if (answer_from_cache(packet, len, capacity, view, now_us)) {
+                stats_->cache_hits.fetch_add(1, std::memory_order_relaxed);
+                return Action::ANSWERED;
+            }
+        } else {
+            key_.clear();
+        }
+
+        track(packet, view, now_us);
+        stats_->forwarded.fetch_add(1, std::memory_order_relaxed);
+        return Action::FORWARD;
+    }
+
+    /**
+     * Handles a packet from the server. A response to a tracked query is
+     * cached and its source restored to the address the app queried.
+     *
+     * @return true if packet was such a response
+     */
+    bool on_inbound(uint8_t* packet, size_t len, uint64_t now_us) {
+        dns_detail::UdpView view;
+        if (!dns_detail::parse_udp(packet, len, view) ||
+            dns_detail::read_be16(packet + view.udp) != dns_detail::PORT ||
+            view.payload_len < dns_detail::HEADER_SIZE) {
+            return false;
+        }
+        const uint8_t* msg = packet + view.payload();
+        const uint16_t id = dns_detail::read_be16(msg);
+        const uint16_t port = dns_detail::read_be16(packet + view.udp + 2);
+        Pending& slot = pending_[slot_index(id, port)];
+        const uint8_t* expected_src = slot.rewritten ? slot.resolver : slot.app_dst;
+        if (!slot.used || slot.id != id || slot.port != port || slot.ipv6 != view.ipv6 ||
+            !(msg[2] & 0x80) ||
+            std::memcmp(packet + view.src_addr(), expected_src, view.addr_len()) != 0) {
+            return false;
+        }
+        slot.used = false;
+
+        stats_->responses.fetch_add(1, std::memory_order_relaxed);
+        stats_->latency_us_total.fetch_add(now_us - slot.sent_us, std::memory_order_relaxed);
+
+        std::string& key = response_key_;
+        const size_t question_end = dns_detail::question_key(msg, view.payload_len, key);
+        if (question_end != 0 && !slot.key.empty() && key == slot.key &&
+            view.payload_len <= MAX_CACHED_RESPONSE) {
+            const uint32_t ttl = dns_detail::cache_ttl(msg, view.payload_len, question_end);
+            if (ttl > 0) {
+                cache_.insert(key, msg, view.payload_len, question_end, ttl, now_us / 1000);
+                stats_->cache_entries.store(cache_.size(), std::memory_order_relaxed);
+            }
+        }
+
+        if (slot.rewritten) {
+            std::memcpy(packet + view.src_addr(), slot.app_dst, view.addr_len());
+            dns_detail::update_checksums(packet, view);
+        }
+        return true;
+    }
+
+    void clear_cache() {
+        cache_.clear();
+        stats_->cache_entries.store(0, std::memory_order_relaxed);
+    }
+
+    size_t cache_size() const { return cache_.size(); }
+
+    const DnsStats& stats() const { return *stats_; }
+
+private:
+    struct Pending {
+        bool used = false;
+        bool ipv6 = false;
+        bool rewritten = false;        // Destination was changed to resolver
+        uint16_t id = 0;
+        uint16_t port = 0;             // App's source port
+        uint8_t app_dst[16] = {};      // Address the app sent the query to
+        uint8_t resolver[16] = {};
+        uint64_t sent_us = 0;
+        std::string key;               // Question key; empty if uncacheable
+    };
+
+    static size_t slot_index(uint16_t id, uint16_t port) {
+        return (static_cast<size_t>(id) * 31 + port) % PENDING_SLOTS;
+    }
+
+    bool answer_from_cache(uint8_t* packet, size_t& len, size_t capacity, const dns_detail::UdpView& view,
+                           uint64_t now_us) {
+        using namespace dns_detail;
+        const size_t headers = view.ipv6 ? 48 : 28;
+        if (capacity <= headers) {
+            return false;
+        }
+        // Everything needed from the query before the buffer is overwritten
+        uint8_t app_addr[16];
+        uint8_t server_addr[16];
+        std::memcpy(app_addr, packet + view.src_addr(), view.addr_len());
+        std::memcpy(server_addr, packet + view.dst_addr(), view.addr_len());
+        const uint16_t app_port = read_be16(packet + view.udp);
+        const uint16_t id = read_be16(packet + view.payload());
+
+        const size_t response_len = cache_.lookup(key_, now_us / 1000, scratch_, sizeof(scratch_));
+        if (response_len == 0 || headers + response_len > capacity) {
+            return false;
+        }
+
+        UdpView reply;
+        reply.ipv6 = view.ipv6;
+        reply.udp = headers - 8;
+        reply.payload_len = response_len;
+        std::memset(packet, 0, headers);
+        if (view.ipv6) {
+            packet[0] = 0x60;
+            write_be16(packet + 4, static_cast<uint16_t>(8 + response_len));
+            packet[6] = 17;
+            packet[7] = 64;
+        } else {
+            packet[0] = 0x45;
+            write_be16(packet + 2, static_cast<uint16_t>(headers + response_len));
+            write_be16(packet + 6, 0x4000);   // DF
+            packet[8] = 64;
+            packet[9] = 17;
+        }
+        std::memcpy(packet + reply.src_addr(), server_addr, reply.addr_len());
+        std::memcpy(packet + reply.dst_addr(), app_addr, reply.addr_len());
+        write_be16(packet + reply.udp, PORT);
+        write_be16(packet + reply.udp + 2, app_port);
+        write_be16(packet + reply.udp + 4, static_cast<uint16_t>(8 + response_len));
+        std::memcpy(packet + headers, scratch_, response_len);
+        write_be16(packet + headers, id);
+        update_checksums(packet, reply);
+        len = headers + response_len;
+        return true;
+    }
+
+    void track(uint8_t* packet, const dns_detail::UdpView& view, uint64_t now_us) {
+        const uint16_t id = dns_detail::read_be16(packet + view.payload());
+        const uint16_t port = dns_detail::read_be16(packet + view.udp);
+        Pending& slot = pending_[slot_index(id, port)];
+        if (slot.used && now_us - slot.sent_us < PENDING_TIMEOUT_US && (slot.id != id || slot.port != port)) {
+            return;   // Slot busy: forward unchanged and leave the response untouched
+        }
+        slot.used = true;
+        slot.ipv6 = view.ipv6;
+        slot.id = id;
+        slot.port = port;
+        slot.sent_us = now_us;
+        slot.key = key_;
+        std::memcpy(slot.app_dst, packet + view.dst_addr(), view.addr_len());
+
+        const bool has_resolver = view.ipv6 ? has_v6_ : has_v4_;
+        const uint8_t* resolver = view.ipv6 ? resolver_v6_ : resolver_v4_;
+        slot.rewritten = has_resolver && std::memcmp(slot.app_dst, resolver, view.addr_len()) != 0;
+        if (slot.rewritten) {
+            std::memcpy(slot.resolver, resolver, view.addr_len());
+            std::memcpy(packet + view.dst_addr(), resolver, view.addr_len());
+            dns_detail::update_checksums(packet, view);
+        }
+    }
+
+    DnsCache cache_;
+    std::vector<Pending> pending_;
+    std::string key_;            // Question key of the query being handled
+    std::string response_key_;
+    uint8_t scratch_[MAX_CACHED_RESPONSE];
+    bool has_v4_ = false;
+    bool has_v6_ = false;
+    uint8_t resolver_v4_[4] = {};
+    uint8_t resolver_v6_[16] = {};
+    DnsStats own_stats_;
+    DnsStats* stats_ = &own_stats_;
+};
+
+} // namespace openvpn
+
+#endif // DNS_FORWARDER_H
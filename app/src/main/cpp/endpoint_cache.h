@@ -0,0 +1,514 @@
+#ifndef ENDPOINT_CACHE_H
+#define ENDPOINT_CACHE_H
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "config_normalizer.h"
+
+#ifndef TUN_ENDPOINT_CACHE_ENTRIES
+#define TUN_ENDPOINT_CACHE_ENTRIES 64
+#endif
+#ifndef TUN_ENDPOINT_CACHE_MAX_AGE_SEC
+#define TUN_ENDPOINT_CACHE_MAX_AGE_SEC 604800
+#endif
+
+namespace openvpn {
+
+/**
+ * Resolved VPN server addresses keyed by hostname, persisted to one file.
+ *
+ * An address is recorded when a connect to it succeeds or a background refresh
+ * resolves the host, and dropped when a connect to it fails. Entries older than
+ * the maximum age are not served. Resolution and the refresh thread are
+ * injectable for tests.
+ */
+class EndpointCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = TUN_ENDPOINT_CACHE_ENTRIES;
+    static constexpr int64_t DEFAULT_MAX_AGE_SEC = TUN_ENDPOINT_CACHE_MAX_AGE_SEC;
+
+    // Returns host's first address as text, or empty if it does not resolve
+    using Resolver = std::function<std::string(const std::string& host)>;
+    // Runs a refresh; the default starts a detached thread
+    using Executor = std::function<void(std::function<void()>)>;
+    // Wall clock in seconds, so ages stay meaningful across restarts
+    using Clock = std::function<int64_t()>;
+
+    static EndpointCache& instance() {
+        static EndpointCache cache(DEFAULT_CAPACITY, DEFAULT_MAX_AGE_SEC);
+        return cache;
+    }
+
+    EndpointCache(size_t capacity, int64_t max_age_sec,
+                  Resolver resolver = resolve_first, Executor executor = detached_thread,
+                  Clock clock = wall_clock_sec)
+        : capacity_(capacity > 0 ? capacity : 1), max_age_sec_(max_age_sec),
+          resolver_(std::move(resolver)), executor_(std::move(executor)), clock_(std::move(clock)) {}
+
+    EndpointCache(const EndpointCache&) = delete;
+    EndpointCache& operator=(const EndpointCache&) = delete;
+
+    /**
+     * File holding the cache; loaded now and rewritten on every change.
+     * Empty disables persistence.
+     */
+    void set_storage_path(const std::string& path) {
+        std::string content;
+        const bool loaded = !path.empty() && read_file(path, content);
+        std::lock_guard<std::mutex> lock(mutex_);
+        storage_path_ = path;
+        if (loaded) {
+            load_locked(content);
+        }
+    }
+
+    /**
+     * Sets ip to host's cached address if one younger than the maximum age exists
+     */
+    bool lookup(const std::string& host, std::string& ip) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(host);
+        if (it == entries_.end() || clock_() - it->second.resolved_sec > max_age_sec_) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        it->second.last_used = ++use_clock_;
+        ip = it->second.ip;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Records that host answered at ip
+     */
+    void record_success(const std::string& host, const std::string& ip) {
+        if (host.empty() || ip.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            store_locked(host, ip);
+        }
+        persist();
+    }
+
+    /**
+     * Drops host's entry if it still holds ip, so the next connect resolves it
+     */
+    void record_failure(const std::string& host, const std::string& ip) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(host);
+            if (it == entries_.end() || it->second.ip != ip) {
+                return;
+            }
+            entries_.erase(it);
+            failures_.fetch_add(1, std::memory_order_relaxed);
+        }
+        persist();
+    }
+
+    /**
+     * Resolves host on the executor and stores the result; at most one refresh
+     * per host is in flight
+     */
+    void refresh_async(const std::string& host) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!refreshing_.insert(host).second) {
+                return;
+            }
+        }
+        executor_([this, host] {
+            const std::string ip = resolver_(host);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                refreshing_.erase(host);
+                if (ip.empty()) {
+                    return;
+                }
+                store_locked(host, ip);
+                refreshes_.fetch_add(1, std::memory_order_relaxed);
+            }
+            persist();
+        });
+    }
+
+    /**
+     * Drops every entry in memory and on disk
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        if (!storage_path_.empty()) {
+            unlink(storage_path_.c_str());
+        }
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+    uint64_t failures() const { return failures_.load(std::memory_order_relaxed); }
+    uint64_t refreshes() const { return refreshes_.load(std::memory_order_relaxed); }
+
+    static bool is_ip_literal(const std::string& host) {
+        unsigned char addr[16];
+        return inet_pton(AF_INET, host.c_str(), addr) == 1 || inet_pton(AF_INET6, host.c_str(), addr) == 1;
+    }
+
+    static std::string resolve_first(const std::string& host) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+            return {};
+        }
+        char text[INET6_ADDRSTRLEN] = {0};
+        const void* addr = result->ai_family == AF_INET6
+            ? static_cast<const void*>(&reinterpret_cast<sockaddr_in6*>(result->ai_addr)->sin6_addr)
+            : static_cast<const void*>(&reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr);
+        const bool ok = inet_ntop(result->ai_family, addr, text, sizeof(text)) != nullptr;
+        freeaddrinfo(result);
+        return ok ? std::string(text) : std::string();
+    }
+
+    static void detached_thread(std::function<void()> task) {
+        std::thread(std::move(task)).detach();
+    }
+
+    static int64_t wall_clock_sec() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct Entry {
+        std::string ip;
+        int64_t resolved_sec = 0;
+        uint64_t last_used = 0;
+    };
+
+    void store_locked(const std::string& host, const std::string& ip, int64_t resolved_sec = -1) {
+        Entry& entry = entries_[host];
+        entry.ip = ip;
+        entry.resolved_sec = resolved_sec >= 0 ? resolved_sec : clock_();
+        entry.last_used = ++use_clock_;
+        while (entries_.size() > capacity_) {
+            auto oldest = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            entries_.erase(oldest);
+        }
+    }
+
+    // One "host ip resolved_sec" line per entry; malformed lines are skipped
+    void load_locked(const std::string& content) {
+        size_t begin = 0;
+        while (begin < content.size()) {
+            size_t end = content.find('\n', begin);
+            if (end == std::string::npos) {
+                end = content.size();
+            }
+            const std::string line = content.substr(begin, end - begin);
+            begin = end + 1;
+
+            const size_t first = line.find(' ');
+            const size_t second = first == std::string::npos ? first : line.find(' ', first + 1);
+            if (second == std::string::npos) {
+                continue;
+            }
+            const std::string host = line.substr(0, first);
+            const std::string ip = line.substr(first + 1, second - first - 1);
+            char* stop = nullptr;
+            const long long resolved = strtoll(line.c_str() + second + 1, &stop, 10);
+            if (host.empty() || !is_ip_literal(ip) || stop == line.c_str() + second + 1 || resolved < 0) {
+                continue;
+            }
+            store_locked(host, ip, resolved);
+        }
+    }
+
+    void persist() {
+        // Serializes writers so an older snapshot never replaces a newer one
+        std::lock_guard<std::mutex> io_lock(io_mutex_);
+        std::string path;
+        std::string content;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (storage_path_.empty()) {
+                return;
+            }
+            path = storage_path_;
+            for (const auto& entry : entries_) {
+                content += entry.first + " " + entry.second.ip + " " +
+                           std::to_string(entry.second.resolved_sec) + "\n";
+            }
+        }
+        write_file_atomic(path, content);
+    }
+
+    static bool read_file(const std::string& path, std::string& out) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        out.clear();
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) > 0) {
+            out.append(buf, static_cast<size_t>(n));
+        }
+        close(fd);
+        return n == 0;
+    }
+
+    // Write to a temporary file and rename, so a crash never leaves a partial cache
+    static bool write_file_atomic(const std::string& path, const std::string& content) {
+        const std::string tmp = path + ".tmp";
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        size_t written = 0;
+        while (written < content.size()) {
+            ssize_t n = write(fd, content.data() + written, content.size() - written);
+            if (n <= 0) {
+                close(fd);
+                unlink(tmp.c_str());
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        close(fd);
+        if (rename(tmp.c_str(), path.c_str()) != 0) {
+            unlink(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    const size_t capacity_;
+    const int64_t max_age_sec_;
+    const Resolver resolver_;
+    const Executor executor_;
+    const Clock clock_;
+
+    mutable std::mutex mutex_;
+    std::mutex io_mutex_;
+    std::string storage_path_;
+    std::map<std::string, Entry> entries_;
+    std::set<std::string> refreshing_;
+    uint64_t use_clock_ = 0;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> failures_{0};
+    std::atomic<uint64_t> refreshes_{0};
+};
+
+/**
+ * One connect attempt: ip is the cached address to connect to directly, or
+ * empty to let OpenVPN resolve host
+ */
+struct EndpointAttempt {
+    std::string host;
+    std::string ip;
+    std::string port;
+    std::string proto;
+    bool cached = false;
+};
+
+/**
+ * Order of connect attempts over a profile's top-level remote directives.
+ *
+ * Each remote is tried at its cached address first, which also starts a
+ * background refresh of the host; if that attempt does not connect, the cached
+ * address is dropped and the same remote is retried with live DNS before moving
+ * to the next remote. After a successful connect the address OpenVPN used is
+ * recorded and a reconnect starts again at the same remote.
+ *
+ * Not thread-safe: a session drives it from its connection thread.
+ */
+class EndpointPlan {
+public:
+    struct Remote {
+        std::string host;
+        std::string port;
+        std::string proto;
+    };
+
+    /**
+     * Reads "remote host [port] [proto]" lines, defaulting port and proto from
+     * the "port" and "proto" directives (1194/udp if absent). Remotes inside
+     * <connection> blocks are not read, so such profiles get an empty plan.
+     */
+    static EndpointPlan from_profile(std::string_view profile) {
+        EndpointPlan plan;
+        std::string default_port = "1194";
+        std::string default_proto = "udp";
+        std::vector<std::vector<std::string>> remote_lines;
+
+        size_t begin = 0;
+        while (begin < profile.size()) {
+            size_t end = profile.find('\n', begin);
+            if (end == std::string_view::npos) {
+                end = profile.size();
+            }
+            const std::string_view line = profile.substr(begin, end - begin);
+            begin = end + 1;
+
+            const std::string_view directive = detail::directive_of(line);
+            if (detail::is_inline_open(directive)) {
+                const std::string close_tag = "</" + std::string(directive.substr(1));
+                const size_t close_at = profile.find(close_tag, begin);
+                if (close_at == std::string_view::npos) {
+                    break;
+                }
+                const size_t close_end = profile.find('\n', close_at);
+                begin = close_end == std::string_view::npos ? profile.size() : close_end + 1;
+                continue;
+            }
+            if (directive != "remote" && directive != "port" && directive != "proto") {
+                continue;
+            }
+            const std::vector<std::string> args = arguments(line);
+            if (directive == "remote" && !args.empty()) {
+                remote_lines.push_back(args);
+            } else if (directive == "port" && !args.empty()) {
+                default_port = args[0];
+            } else if (directive == "proto" && !args.empty()) {
+                default_proto = args[0];
+            }
+        }
+
+        for (const std::vector<std::string>& args : remote_lines) {
+            plan.remotes_.push_back(Remote{
+                args[0],
+                args.size() > 1 ? args[1] : default_port,
+                args.size() > 2 ? args[2] : default_proto});
+        }
+        return plan;
+    }
+
+    bool empty() const { return remotes_.empty(); }
+    const std::vector<Remote>& remotes() const { return remotes_; }
+
+    /**
+     * Fills out with the next attempt; false if the profile has no remotes.
+     * A cached attempt that next() is called again after counts as failed.
+     */
+    bool next(EndpointCache& cache, EndpointAttempt& out) {
+        if (remotes_.empty()) {
+            return false;
+        }
+        if (started_) {
+            if (last_.cached) {
+                cache.record_failure(last_.host, last_.ip);
+                out = attempt(remotes_[index_], std::string());
+                last_ = out;
+                return true;
+            }
+            index_ = (index_ + 1) % remotes_.size();
+        }
+        started_ = true;
+
+        const Remote& remote = remotes_[index_];
+        std::string ip;
+        if (!EndpointCache::is_ip_literal(remote.host) && cache.lookup(remote.host, ip)) {
+            out = attempt(remote, ip);
+            cache.refresh_async(remote.host);
+        } else {
+            out = attempt(remote, std::string());
+        }
+        last_ = out;
+        return true;
+    }
+
+    /**
+     * Records the address the last attempt connected to
+     */
+    void on_connected(EndpointCache& cache, const std::string& server_ip) {
+        if (!started_) {
+            return;
+        }
+        if (!EndpointCache::is_ip_literal(last_.host) && EndpointCache::is_ip_literal(server_ip)) {
+            cache.record_success(last_.host, server_ip);
+        }
+        started_ = false;
+        last_ = EndpointAttempt();
+    }
+
+private:
+    static std::vector<std::string> arguments(std::string_view line) {
+        std::vector<std::string> args;
+        line = detail::trimmed(line);
+        size_t i = 0;
+        bool directive = true;
+        while (i < line.size()) {
+            while (i < line.size() && detail::is_space(line[i])) {
+                ++i;
+            }
+            const size_t start = i;
+            while (i < line.size() && !detail::is_space(line[i])) {
+                ++i;
+            }
+            if (start == i) {
+                break;
+            }
+            if (line[start] == '#' || line[start] == ';') {
+                break;
+            }
+            if (!directive) {
+                args.emplace_back(line.substr(start, i - start));
+            }
+            directive = false;
+        }
+        return args;
+    }
+
+    static EndpointAttempt attempt(const Remote& remote, const std::string& ip) {
+        EndpointAttempt out;
+        out.host = remote.host;
+        out.ip = ip;
+        out.port = remote.port;
+        out.proto = remote.proto;
+        out.cached = !ip.empty();
+        return out;
+    }
+
+    std::vector<Remote> remotes_;
+    size_t index_ = 0;
+    bool started_ = false;
+    EndpointAttempt last_;
+};
+
+} // namespace openvpn
+
+#endif // ENDPOINT_CACHE_H
@@ -0,0 +1,382 @@
+#ifndef FLOW_TABLE_H
+#define FLOW_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "packet_classifier.h"
+
+namespace openvpn {
+
+/**
+ * Flow → (tunnel index, UID) map for the packet path.
+ *
+ * Open addressing with linear probing over a power-of-two slot array, keyed
+ * on the packed FlowKey. Readers never lock: each slot carries a sequence
+ * counter that writers make odd while they rewrite it, and a reader retries
+ * the slot if the counter moved. Writers (the control plane learning and
+ * clearing flows) serialize on a mutex.
+ *
+ * Probes are bounded to MAX_PROBE slots. Aging is incremental: every insert
+ * advances a clock hand over SWEEP_STEP slots, expiring entries idle for
+ * longer than ttl_ms. An insert whose probe window is full of live flows
+ * evicts the least recently seen one, so the table never rejects a flow.
+ */
+class FlowTable {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16384;       // Slots; ~10000 live flows at 60% load
+    static constexpr uint64_t DEFAULT_TTL_MS = 300000;      // Matches ConnectionTracker.ENTRY_TIMEOUT_MS
+    static constexpr size_t MAX_PROBE = 32;
+    static constexpr size_t SWEEP_STEP = 8;
+
+    struct Match {
+        int32_t tunnel_index = -1;
+        int32_t uid = -1;
+    };
+
+    explicit FlowTable(size_t capacity = DEFAULT_CAPACITY, uint64_t ttl_ms = DEFAULT_TTL_MS)
+        : capacity_(round_up_pow2(capacity)),
+          mask_(capacity_ - 1),
+          probe_limit_(capacity_ < MAX_PROBE ? capacity_ : MAX_PROBE),
+          ttl_ms_(ttl_ms),
+          slots_(new Slot[capacity_]) {}
+
+    FlowTable(const FlowTable&) = delete;
+    FlowTable& operator=(const FlowTable&) = delete;
+
+    /**
+     * Lock-free lookup. A hit refreshes the entry's idle timer.
+     */
+    bool lookup(const FlowKey& key, uint64_t now_ms, Match& out) const {
+        const PackedKey wanted = pack(key);
+        size_t index = home(wanted);
+        for (size_t probe = 0; probe < probe_limit_; ++probe, index = (index + 1) & mask_) {
+            const Slot& slot = slots_[index];
+            Snapshot snap;
+            read_slot(slot, snap);
+            if (snap.state == EMPTY) {
+                return false;
+            }
+            if (snap.state != FULL || !(snap.key == wanted)) {
+                continue;
+            }
+            if (now_ms > snap.last_seen_ms && now_ms - snap.last_seen_ms > ttl_ms_) {
+                return false;
+            }
+            slot.last_seen_ms.store(now_ms, std::memory_order_relaxed);
+            out.tunnel_index = snap.tunnel_index;
+            out.uid = snap.uid;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Adds or replaces a flow. Reuses an empty, deleted or expired slot in the
+     * probe window, or evicts the window's least recently seen flow.
+     */
+    bool insert(const FlowKey& key, int32_t tunnel_index, int32_t uid, uint64_t now_ms) {
+        const PackedKey packed = pack(key);
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        sweep_locked(now_ms, SWEEP_STEP);
+
+        size_t index = home(packed);
+        Slot* reuse = nullptr;       // First empty, tombstone or expired slot
+        Slot* oldest = nullptr;      // Eviction victim if the window is all live
+        for (size_t probe = 0; probe < probe_limit_; ++probe, index = (index + 1) & mask_) {
+            Slot& slot = slots_[index];
+            const uint8_t state = slot.state.load(std::memory_order_relaxed);
+            if (state == FULL && slot.load_key() == packed) {
+                write_slot(slot, packed, tunnel_index, uid, now_ms, FULL);
+                return true;
+            }
+            if (state == EMPTY) {
+                if (!reuse) {
+                    reuse = &slot;
+                }
+                break;   // Key cannot be further along the chain
+            }
+            if (!reuse && (state == TOMBSTONE || expired(slot, now_ms))) {
+                reuse = &slot;
+            }
+            if (state == FULL && (!oldest || slot.last_seen_ms.load(std::memory_order_relaxed) <
+                                                 oldest->last_seen_ms.load(std::memory_order_relaxed))) {
+                oldest = &slot;
+            }
+        }
+
+        Slot* target = reuse ? reuse : oldest;
+        if (!target) {
+            return false;
+        }
+        if (target->state.load(std::memory_order_relaxed) == FULL) {
+            if (!reuse) {
+                stats_evictions_.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        write_slot(*target, packed, tunnel_index, uid, now_ms, FULL);
+        return true;
+    }
+
+    bool erase(const FlowKey& key) {
+        const PackedKey packed = pack(key);
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        size_t index = home(packed);
+        for (size_t probe = 0; probe < probe_limit_; ++probe, index = (index + 1) & mask_) {
+            Slot& slot = slots_[index];
+            const uint8_t state = slot.state.load(std::memory_order_relaxed);
+            if (state == EMPTY) {
+                return false;
+            }
+            if (state == FULL && slot.load_key() == packed) {
+                remove_locked(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Removes every flow owned by uid (app rule removed or changed)
+     */
+    size_t erase_uid(int32_t uid) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return erase_if_locked([uid](const Slot& s) {
+            return s.uid.load(std::memory_order_relaxed) == uid;
+        });
+    }
+
+    /**
+     * Removes every flow routed to tunnel_index (tunnel closed)
+     */
+    size_t erase_tunnel(int32_t tunnel_index) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return erase_if_locked([tunnel_index](const Slot& s) {
+            return s.tunnel_index.load(std::memory_order_relaxed) == tunnel_index;
+        });
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (slots_[i].state.load(std::memory_order_relaxed) != EMPTY) {
+                set_state(slots_[i], EMPTY);
+            }
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Advances the clock hand over budget slots, expiring idle flows.
+     * Inserts already do this; callers with idle periods may drive it too.
+     */
+    void sweep(uint64_t now_ms, size_t budget) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        sweep_locked(now_ms, budget);
+    }
+
+    /**
+     * Counts live flows routed to tunnel_index. Lock-free like lookup(), so
+     * the result may be off by flows inserted or removed during the scan.
+     */
+    size_t count_tunnel(int32_t tunnel_index, uint64_t now_ms) const {
+        size_t count = 0;
+        for (size_t i = 0; i < capacity_; ++i) {
+            const Slot& slot = slots_[i];
+            if (slot.state.load(std::memory_order_relaxed) != FULL) {
+                continue;
+            }
+            Snapshot snap;
+            read_slot(slot, snap);
+            if (snap.state == FULL && snap.tunnel_index == tunnel_index &&
+                !(now_ms > snap.last_seen_ms && now_ms - snap.last_seen_ms > ttl_ms_)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return capacity_; }
+    uint64_t evictions() const { return stats_evictions_.load(std::memory_order_relaxed); }
+
+private:
+    enum : uint8_t { EMPTY = 0, FULL = 1, TOMBSTONE = 2 };
+
+    static constexpr size_t KEY_WORDS = sizeof(FlowKey) / sizeof(uint64_t);
+    static_assert(sizeof(FlowKey) % sizeof(uint64_t) == 0, "FlowKey must pack into whole words");
+
+    struct PackedKey {
+        uint64_t words[KEY_WORDS];
+
+        bool operator==(const PackedKey& other) const {
+            return std::memcmp(words, other.words, sizeof(words)) == 0;
+        }
+    };
+
+    // Every field is atomic so concurrent reads are well defined; the sequence
+    // counter makes a multi-field read consistent
+    struct Slot {
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint8_t> state{EMPTY};
+        std::atomic<uint64_t> key[KEY_WORDS] = {};
+        std::atomic<int32_t> tunnel_index{-1};
+        std::atomic<int32_t> uid{-1};
+        mutable std::atomic<uint64_t> last_seen_ms{0};
+
+        PackedKey load_key() const {
+            PackedKey out;
+            for (size_t i = 0; i < KEY_WORDS; ++i) {
+                out.words[i] = key[i].load(std::memory_order_relaxed);
+            }
+            return out;
+        }
+    };
+
+    struct Snapshot {
+        uint8_t state;
+        PackedKey key;
+        int32_t tunnel_index;
+        int32_t uid;
+        uint64_t last_seen_ms;
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t capacity = 1;
+        while (capacity < n) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    static PackedKey pack(const FlowKey& key) {
+        PackedKey packed;
+        std::memcpy(packed.words, &key, sizeof(FlowKey));
+        return packed;
+    }
+
+    size_t home(const PackedKey& key) const {
+        // FNV-1a over the words, then a final mix so low bits spread
+        uint64_t hash = 1469598103934665603ULL;
+        for (uint64_t word : key.words) {
+            hash ^= word;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= hash >> 29;
+        return static_cast<size_t>(hash) & mask_;
+    }
+
+    static void read_slot(const Slot& slot, Snapshot& out) {
+        for (;;) {
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;   // Writer mid-update
+            }
+            out.state = slot.state.load(std::memory_order_relaxed);
+            out.key = slot.load_key();
+            out.tunnel_index = slot.tunnel_index.load(std::memory_order_relaxed);
+            out.uid = slot.uid.load(std::memory_order_relaxed);
+            out.last_seen_ms = slot.last_seen_ms.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+    }
+
+    static void begin_write(Slot& slot) {
+        slot.seq.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static void end_write(Slot& slot) {
+        slot.seq.fetch_add(1, std::memory_order_release);
+    }
+
+    static void write_slot(Slot& slot, const PackedKey& key, int32_t tunnel_index, int32_t uid,
+                           uint64_t now_ms, uint8_t state) {
+        begin_write(slot);
+        for (size_t i = 0; i < KEY_WORDS; ++i) {
+            slot.key[i].store(key.words[i], std::memory_order_relaxed);
+        }
+        slot.tunnel_index.store(tunnel_index, std::memory_order_relaxed);
+        slot.uid.store(uid, std::memory_order_relaxed);
+        slot.last_seen_ms.store(now_ms, std::memory_order_relaxed);
+        slot.state.store(state, std::memory_order_relaxed);
+        end_write(slot);
+    }
+
+    static void set_state(Slot& slot, uint8_t state) {
+        begin_write(slot);
+        slot.state.store(state, std::memory_order_relaxed);
+        end_write(slot);
+    }
+
+    bool expired(const Slot& slot, uint64_t now_ms) const {
+        const uint64_t last = slot.last_seen_ms.load(std::memory_order_relaxed);
+        return now_ms > last && now_ms - last > ttl_ms_;
+    }
+
+    // Tombstones the slot, then turns trailing tombstones back into EMPTY so
+    // probe chains stay short: a tombstone followed by EMPTY ends no chain
+    void remove_locked(size_t index) {
+        set_state(slots_[index], TOMBSTONE);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (slots_[(index + 1) & mask_].state.load(std::memory_order_relaxed) != EMPTY) {
+            return;
+        }
+        for (size_t i = 0; i < capacity_; ++i) {
+            Slot& slot = slots_[index];
+            if (slot.state.load(std::memory_order_relaxed) != TOMBSTONE) {
+                break;
+            }
+            set_state(slot, EMPTY);
+            index = (index - 1) & mask_;
+        }
+    }
+
+    template <typename Pred>
+    size_t erase_if_locked(Pred pred) {
+        size_t removed = 0;
+        for (size_t i = 0; i < capacity_; ++i) {
+            const Slot& slot = slots_[i];
+            if (slot.state.load(std::memory_order_relaxed) == FULL && pred(slot)) {
+                remove_locked(i);
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    void sweep_locked(uint64_t now_ms, size_t budget) {
+        for (size_t i = 0; i < budget; ++i) {
+            const size_t index = hand_;
+            hand_ = (hand_ + 1) & mask_;
+            if (slots_[index].state.load(std::memory_order_relaxed) == FULL && expired(slots_[index], now_ms)) {
+                remove_locked(index);
+            }
+        }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    const size_t probe_limit_;
+    const uint64_t ttl_ms_;
+    std::unique_ptr<Slot[]> slots_;
+
+    std::mutex write_mutex_;
+    size_t hand_ = 0;                               // Clock hand; writers only
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> stats_evictions_{0};
+};
+
+} // namespace openvpn
+
+#endif // FLOW_TABLE_H
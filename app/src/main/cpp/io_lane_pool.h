@@ -0,0 +1,331 @@
+#ifndef IO_LANE_POOL_H
+#define IO_LANE_POOL_H
+
+#include <sched.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openvpn {
+
+/**
+ * Snapshot of one lane for stats reporting
+ */
+struct IoLaneStats {
+    int cpu = -1;                       // Core the lane's threads are pinned to
+    uint32_t tunnels = 0;               // Tunnel event-loop threads on this lane
+    uint32_t utilization_permille = 0;  // CPU used by those threads over the last sample
+};
+
+/**
+ * Places tunnel event-loop threads on a fixed set of lanes, one per core.
+ *
+ * OpenVPN 3 ClientAPI::connect() runs its own io_context and blocks for the
+ * life of the session, so tunnels cannot share an event loop from outside.
+ * Instead each session's connection thread joins a lane and is pinned to
+ * that lane's core: new tunnels go to the least-loaded lane, sample() measures
+ * per-thread CPU time, and a tunnel on a hot lane is migrated (re-pinned) to
+ * the coolest lane when that narrows the gap.
+ */
+class IoLanePool {
+public:
+    static constexpr size_t MAX_LANES = 16;
+    // Lanes closer than this are considered balanced
+    static constexpr uint32_t REBALANCE_GAP_PERMILLE = 250;
+
+    using CpuClock = std::function<uint64_t(pthread_t thread)>;
+    using PinThread = std::function<bool(pid_t tid, int cpu)>;
+
+    static IoLanePool& instance() {
+        static IoLanePool pool(online_cpus());
+        return pool;
+    }
+
+    /**
+     * @param cpus One lane per entry, pinned to that core (capped at MAX_LANES)
+     */
+    explicit IoLanePool(std::vector<int> cpus,
+                        CpuClock cpu_clock = thread_cpu_ns,
+                        PinThread pin = pin_thread)
+        : cpu_clock_(std::move(cpu_clock)), pin_(std::move(pin)) {
+        if (cpus.empty()) {
+            cpus.push_back(0);
+        }
+        if (cpus.size() > MAX_LANES) {
+            cpus.resize(MAX_LANES);
+        }
+        for (int cpu : cpus) {
+            lanes_.push_back(Lane{cpu, 0, 0});
+        }
+    }
+
+    IoLanePool(const IoLanePool&) = delete;
+    IoLanePool& operator=(const IoLanePool&) = delete;
+
+    /**
+     * Off by default: threads keep the scheduler's placement until enabled
+     */
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    size_t lane_count() const { return lanes_.size(); }
+
+    /**
+     * Places the calling thread on the least-loaded lane as tunnel_id's event
+     * loop. Returns the lane index, or -1 if the pool is disabled.
+     */
+    int join_current_thread(const std::string& tunnel_id, uint64_t now_ns = monotonic_ns()) {
+        if (!enabled()) {
+            return -1;
+        }
+        return join(tunnel_id, pthread_self(), current_tid(), now_ns);
+    }
+
+    int join(const std::string& tunnel_id, pthread_t thread, pid_t tid, uint64_t now_ns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        leave_locked(tunnel_id);
+
+        size_t best = 0;
+        for (size_t i = 1; i < lanes_.size(); ++i) {
+            if (lane_less(lanes_[i], lanes_[best])) {
+                best = i;
+            }
+        }
+        Member member;
+        member.thread = thread;
+        member.tid = tid;
+        member.lane = static_cast<int>(best);
+        member.last_cpu_ns = cpu_clock_(thread);
+        member.last_sample_ns = now_ns;
+        members_[tunnel_id] = member;
+        lanes_[best].tunnels++;
+        pin_(tid, lanes_[best].cpu);
+        return member.lane;
+    }
+
+    /**
+     * Removes tunnel_id's thread; must be called before that thread exits
+     */
+    void leave(const std::string& tunnel_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        leave_locked(tunnel_id);
+    }
+
+    /**
+     * Lane tunnel_id runs on, or -1
+     */
+    int lane_of(const std::string& tunnel_id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = members_.find(tunnel_id);
+        return it == members_.end() ? -1 : it->second.lane;
+    }
+
+    /**
+     * Re-pins tunnel_id's thread onto lane
+     */
+    bool migrate(const std::string& tunnel_id, int lane) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = members_.find(tunnel_id);
+        if (it == members_.end() || lane < 0 || static_cast<size_t>(lane) >= lanes_.size()) {
+            return false;
+        }
+        move_locked(it->second, lane);
+        return true;
+    }
+
+    /**
+     * Measures each thread's CPU use since the previous sample and, if the
+     * hottest lane leads the coolest by more than REBALANCE_GAP_PERMILLE,
+     * migrates the tunnel that best evens them out. Returns the number of
+     * migrations (0 or 1).
+     */
+    int sample(uint64_t now_ns = monotonic_ns()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Lane& lane : lanes_) {
+            lane.utilization_permille = 0;
+        }
+        for (auto& entry : members_) {
+            Member& member = entry.second;
+            const uint64_t cpu = cpu_clock_(member.thread);
+            const uint64_t wall = now_ns > member.last_sample_ns ? now_ns - member.last_sample_ns : 0;
+            const uint64_t used = cpu > member.last_cpu_ns ? cpu - member.last_cpu_ns : 0;
+            if (wall > 0) {
+                member.utilization_permille = static_cast<uint32_t>(
+                    std::min<uint64_t>(used * 1000 / wall, 1000));
+            }
+            member.last_cpu_ns = cpu;
+            member.last_sample_ns = now_ns;
+            lanes_[member.lane].utilization_permille += member.utilization_permille;
+        }
+        return rebalance_locked();
+    }
+
+    std::vector<IoLaneStats> stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<IoLaneStats> out;
+        out.reserve(lanes_.size());
+        for (const Lane& lane : lanes_) {
+            out.push_back(IoLaneStats{lane.cpu, lane.tunnels, lane.utilization_permille});
+        }
+        return out;
+    }
+
+    uint64_t migrations() const { return migrations_.load(std::memory_order_relaxed); }
+
+    /**
+     * Cores this process may run on, in order
+     */
+    static std::vector<int> online_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE && cpus.size() < MAX_LANES; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        return cpus;
+    }
+
+    static uint64_t monotonic_ns() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    static uint64_t thread_cpu_ns(pthread_t thread) {
+        clockid_t clock;
+        timespec ts{};
+        if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    static bool pin_thread(pid_t tid, int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(tid, sizeof(set), &set) == 0;
+    }
+
+    static pid_t current_tid() {
+        return static_cast<pid_t>(syscall(SYS_gettid));
+    }
+
+private:
+    struct Lane {
+        int cpu;
+        uint32_t tunnels;
+        uint32_t utilization_permille;
+    };
+
+    struct Member {
+        pthread_t thread{};
+        pid_t tid = 0;
+        int lane = 0;
+        uint64_t last_cpu_ns = 0;
+        uint64_t last_sample_ns = 0;
+        uint32_t utilization_permille = 0;
+    };
+
+    static bool lane_less(const Lane& a, const Lane& b) {
+        if (a.utilization_permille != b.utilization_permille) {
+            return a.utilization_permille < b.utilization_permille;
+        }
+        return a.tunnels < b.tunnels;
+    }
+
+    void leave_locked(const std::string& tunnel_id) {
+        auto it = members_.find(tunnel_id);
+        if (it == members_.end()) {
+            return;
+        }
+        Lane& lane = lanes_[it->second.lane];
+        lane.tunnels--;
+        lane.utilization_permille -= std::min(lane.utilization_permille, it->second.utilization_permille);
+        members_.erase(it);
+    }
+
+    void move_locked(Member& member, int lane) {
+        if (member.lane == lane) {
+            return;
+        }
+        Lane& from = lanes_[member.lane];
+        Lane& to = lanes_[lane];
+        from.tunnels--;
+        from.utilization_permille -= std::min(from.utilization_permille, member.utilization_permille);
+        to.tunnels++;
+        to.utilization_permille += member.utilization_permille;
+        member.lane = lane;
+        pin_(member.tid, to.cpu);
+        migrations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int rebalance_locked() {
+        if (lanes_.size() < 2) {
+            return 0;
+        }
+        size_t hot = 0;
+        size_t cool = 0;
+        for (size_t i = 1; i < lanes_.size(); ++i) {
+            if (lanes_[i].utilization_permille > lanes_[hot].utilization_permille) {
+                hot = i;
+            }
+            if (lane_less(lanes_[i], lanes_[cool])) {
+                cool = i;
+            }
+        }
+        const uint32_t hot_load = lanes_[hot].utilization_permille;
+        const uint32_t cool_load = lanes_[cool].utilization_permille;
+        if (hot == cool || hot_load - cool_load <= REBALANCE_GAP_PERMILLE) {
+            return 0;
+        }
+
+        // Move the tunnel that leaves the pair's busier side least loaded
+        Member* best = nullptr;
+        uint32_t best_peak = hot_load;
+        for (auto& entry : members_) {
+            Member& member = entry.second;
+            if (member.lane != static_cast<int>(hot)) {
+                continue;
+            }
+            const uint32_t peak = std::max(hot_load - member.utilization_permille,
+                                           cool_load + member.utilization_permille);
+            if (peak < best_peak) {
+                best_peak = peak;
+                best = &member;
+            }
+        }
+        if (!best) {
+            return 0;
+        }
+        move_locked(*best, static_cast<int>(cool));
+        return 1;
+    }
+
+    CpuClock cpu_clock_;
+    PinThread pin_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> migrations_{0};
+
+    mutable std::mutex mutex_;
+    std::vector<Lane> lanes_;
+    std::map<std::string, Member> members_;
+};
+
+} // namespace openvpn
+
+#endif // IO_LANE_POOL_H
@@ -0,0 +1,105 @@
+#include <jni.h>
+#include <string>
+#include <vector>
+#include <android/log.h>
+#include "logging_config.h"
+#include "io_lane_pool.h"
+
+#define LOG_TAG "IoLanes-JNI"
+
+// JNI entry points for com.multiregionvpn.core.NativeIoLanes (object @JvmStatic methods).
+// Control plane only: sampling and pinning run on the caller's thread.
+
+using openvpn::IoLanePool;
+
+extern "C" {
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_NativeIoLanes_nativeSetEnabled(
+            JNIEnv *env, jclass clazz, jboolean enabled);
+
+    JNIEXPORT jlongArray JNICALL
+    Java_com_multiregionvpn_core_NativeIoLanes_nativeSample(
+            JNIEnv *env, jclass clazz);
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_multiregionvpn_core_NativeIoLanes_nativeMigrate(
+            JNIEnv *env, jclass clazz, jstring tunnelId, jint lane);
+
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_NativeIoLanes_nativeLaneOf(
+            JNIEnv *env, jclass clazz, jstring tunnelId);
+}
+
+static bool tunnel_id_string(JNIEnv* env, jstring tunnelId, std::string& out) {
+    if (!tunnelId) {
+        return false;
+    }
+    const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
+    if (!tunnelIdStr) {
+        return false;
+    }
+    out = tunnelIdStr;
+    env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+    return true;
+}
+
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_NativeIoLanes_nativeSetEnabled(
+        JNIEnv *env, jclass clazz, jboolean enabled) {
+    IoLanePool& pool = IoLanePool::instance();
+    pool.set_enabled(enabled == JNI_TRUE);
+    LOG_INFO(LOG_TAG, "IO lanes %s (%zu lanes)", enabled ? "enabled" : "disabled", pool.lane_count());
+}
+
+/**
+ * Samples per-thread CPU use, rebalances if needed, and returns
+ * [laneCount, migrations, then cpu, tunnels, utilizationPermille per lane].
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_multiregionvpn_core_NativeIoLanes_nativeSample(
+        JNIEnv *env, jclass clazz) {
+    IoLanePool& pool = IoLanePool::instance();
+    if (pool.sample() > 0) {
+        LOG_INFO(LOG_TAG, "Rebalanced IO lanes (%llu migrations total)",
+                 (unsigned long long)pool.migrations());
+    }
+    const std::vector<openvpn::IoLaneStats> lanes = pool.stats();
+
+    std::vector<jlong> packed;
+    packed.reserve(2 + lanes.size() * 3);
+    packed.push_back(static_cast<jlong>(lanes.size()));
+    packed.push_back(static_cast<jlong>(pool.migrations()));
+    for (const openvpn::IoLaneStats& lane : lanes) {
+        packed.push_back(lane.cpu);
+        packed.push_back(lane.tunnels);
+        packed.push_back(lane.utilization_permille);
+    }
+
+    jlongArray result = env->NewLongArray(static_cast<jsize>(packed.size()));
+    if (result) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(packed.size()), packed.data());
+    }
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_multiregionvpn_core_NativeIoLanes_nativeMigrate(
+        JNIEnv *env, jclass clazz, jstring tunnelId, jint lane) {
+    std::string id;
+    if (!tunnel_id_string(env, tunnelId, id)) {
+        return JNI_FALSE;
+    }
+    const bool moved = IoLanePool::instance().migrate(id, lane);
+    LOG_INFO(LOG_TAG, "Migrate tunnel %s to lane %d: %s", id.c_str(), lane, moved ? "ok" : "failed");
+    return moved ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_NativeIoLanes_nativeLaneOf(
+        JNIEnv *env, jclass clazz, jstring tunnelId) {
+    std::string id;
+    if (!tunnel_id_string(env, tunnelId, id)) {
+        return -1;
+    }
+    return IoLanePool::instance().lane_of(id);
+}
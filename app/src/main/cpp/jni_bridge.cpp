@@ -0,0 +1,248 @@
+#include <jni.h>
+#include <string>
+#include <vector>
+#include <android/log.h>
+#include "logging_config.h"
+#include "jni_bridge.h"
+
+#define LOG_TAG "JNI-Bridge"
+
+using openvpn::JniBridge;
+using openvpn::ThreadPlacement;
+using openvpn::ThreadRole;
+
+extern "C" {
+    JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved);
+    JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved);
+}
+
+namespace {
+
+// Global ref to a class, or nullptr (exception cleared) if it cannot be loaded
+jclass global_class(JNIEnv* env, const char* name) {
+    jclass local = env->FindClass(name);
+    if (!local) {
+        env->ExceptionClear();
+        LOG_ERROR(LOG_TAG, "Cannot find class %s", name);
+        return nullptr;
+    }
+    jclass global = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+jmethodID method(JNIEnv* env, jclass clazz, const char* name, const char* signature) {
+    if (!clazz) {
+        return nullptr;
+    }
+    jmethodID id = env->GetMethodID(clazz, name, signature);
+    if (!id) {
+        env->ExceptionClear();
+        LOG_ERROR(LOG_TAG, "Cannot find method %s%s", name, signature);
+    }
+    return id;
+}
+
+void clear_exception(JNIEnv* env, const char* what) {
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        LOG_ERROR(LOG_TAG, "%s threw", what);
+    }
+}
+
+} // namespace
+
+namespace openvpn {
+
+bool JniBridge::on_load(JavaVM* vm, JNIEnv* env) {
+    vm_ = vm;
+
+    ids_.array_list = global_class(env, "java/util/ArrayList");
+    ids_.array_list_init = method(env, ids_.array_list, "<init>", "(I)V");
+    ids_.array_list_add = method(env, ids_.array_list, "add", "(Ljava/lang/Object;)Z");
+
+    ids_.ip_callback = global_class(env, "com/multiregionvpn/core/vpnclient/TunnelIpCallback");
+    ids_.on_tunnel_ip_received = method(env, ids_.ip_callback, "onTunnelIpReceived",
+                                        "(Ljava/lang/String;Ljava/lang/String;I)V");
+    ids_.dns_callback = global_class(env, "com/multiregionvpn/core/vpnclient/TunnelDnsCallback");
+    ids_.on_tunnel_dns_received = method(env, ids_.dns_callback, "onTunnelDnsReceived",
+                                         "(Ljava/lang/String;Ljava/util/List;)V");
+    ids_.state_callback = global_class(env, "com/multiregionvpn/core/vpnclient/TunnelStateCallback");
+    ids_.on_tunnel_state_changed = method(env, ids_.state_callback, "onTunnelStateChanged",
+                                          "(Ljava/lang/String;IJ)V");
+
+    ids_.vpn_service = global_class(env, "android/net/VpnService");
+    ids_.vpn_service_protect = method(env, ids_.vpn_service, "protect", "(I)Z");
+
+    const bool started = dispatcher_.start(
+        [this] {
+            dispatcher_tid_ = ThreadPlacement::instance().join_current_thread("ovpn-callbacks",
+                                                                              ThreadRole::CONTROL);
+            JavaVMAttachArgs args{JNI_VERSION_1_6, "ovpn-callbacks", nullptr};
+            if (vm_->AttachCurrentThreadAsDaemon(&dispatcher_env_, &args) != JNI_OK) {
+                dispatcher_env_ = nullptr;
+                LOG_ERROR(LOG_TAG, "Cannot attach callback dispatcher to the JVM");
+            }
+        },
+        [this] {
+            if (dispatcher_env_) {
+                vm_->DetachCurrentThread();
+                dispatcher_env_ = nullptr;
+            }
+            ThreadPlacement::instance().leave(dispatcher_tid_);
+        });
+    if (!started) {
+        LOG_ERROR(LOG_TAG, "Cannot start callback dispatcher");
+    }
+    return started;
+}
+
+void JniBridge::on_unload(JNIEnv* env) {
+    dispatcher_.stop();
+    for (jclass* clazz : {&ids_.array_list, &ids_.ip_callback, &ids_.dns_callback,
+                          &ids_.state_callback, &ids_.vpn_service}) {
+        if (*clazz && env) {
+            env->DeleteGlobalRef(*clazz);
+        }
+        *clazz = nullptr;
+    }
+}
+
+JNIEnv* JniBridge::env_for_current_thread() {
+    if (!vm_) {
+        return nullptr;
+    }
+    JNIEnv* env = nullptr;
+    jint result = vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+    if (result == JNI_EDETACHED) {
+        result = vm_->AttachCurrentThread(&env, nullptr);
+    }
+    return result == JNI_OK ? env : nullptr;
+}
+
+bool JniBridge::post(JniTask task) {
+    return dispatcher_.post([this, task = std::move(task)] {
+        if (dispatcher_env_) {
+            task(dispatcher_env_);
+        }
+    });
+}
+
+bool JniBridge::post_ip_received(jobject callback, const std::string& tunnel_id,
+                                 const std::string& ip, int prefix_length) {
+    if (!callback || !ids_.on_tunnel_ip_received) {
+        return false;
+    }
+    const jmethodID method_id = ids_.on_tunnel_ip_received;
+    return post([callback, method_id, tunnel_id, ip, prefix_length](JNIEnv* env) {
+        jstring tunnel_id_str = env->NewStringUTF(tunnel_id.c_str());
+        jstring ip_str = env->NewStringUTF(ip.c_str());
+        env->CallVoidMethod(callback, method_id, tunnel_id_str, ip_str, static_cast<jint>(prefix_length));
+        clear_exception(env, "onTunnelIpReceived");
+        env->DeleteLocalRef(tunnel_id_str);
+        env->DeleteLocalRef(ip_str);
+    });
+}
+
+bool JniBridge::post_dns_received(jobject callback, const std::string& tunnel_id,
+                                  const std::vector<std::string>& dns_servers) {
+    if (!callback || !ids_.on_tunnel_dns_received || !ids_.array_list_init || !ids_.array_list_add) {
+        return false;
+    }
+    const JniIds ids = ids_;
+    return post([callback, ids, tunnel_id, dns_servers](JNIEnv* env) {
+        jobject list = env->NewObject(ids.array_list, ids.array_list_init,
+                                      static_cast<jint>(dns_servers.size()));
+        if (!list) {
+            clear_exception(env, "ArrayList()");
+            return;
+        }
+        for (const auto& server : dns_servers) {
+            jstring server_str = env->NewStringUTF(server.c_str());
+            env->CallBooleanMethod(list, ids.array_list_add, server_str);
+            env->DeleteLocalRef(server_str);
+        }
+        jstring tunnel_id_str = env->NewStringUTF(tunnel_id.c_str());
+        env->CallVoidMethod(callback, ids.on_tunnel_dns_received, tunnel_id_str, list);
+        clear_exception(env, "onTunnelDnsReceived");
+        env->DeleteLocalRef(tunnel_id_str);
+        env->DeleteLocalRef(list);
+    });
+}
+
+bool JniBridge::post_state_changed(jobject callback, const std::string& tunnel_id,
+                                   int state, int64_t connect_latency_ms) {
+    if (!callback || !ids_.on_tunnel_state_changed) {
+        return false;
+    }
+    const jmethodID method_id = ids_.on_tunnel_state_changed;
+    return post([callback, method_id, tunnel_id, state, connect_latency_ms](JNIEnv* env) {
+        jstring tunnel_id_str = env->NewStringUTF(tunnel_id.c_str());
+        env->CallVoidMethod(callback, method_id, tunnel_id_str,
+                            static_cast<jint>(state), static_cast<jlong>(connect_latency_ms));
+        clear_exception(env, "onTunnelStateChanged");
+        env->DeleteLocalRef(tunnel_id_str);
+    });
+}
+
+void JniBridge::release_global_ref(jobject ref) {
+    if (!ref) {
+        return;
+    }
+    // Uncapped: a dropped release would leave ref to be deleted inline while
+    // queued callbacks still use it
+    if (dispatcher_.post_uncapped([this, ref] {
+            if (dispatcher_env_) {
+                dispatcher_env_->DeleteGlobalRef(ref);
+            }
+        })) {
+        return;
+    }
+    // Dispatcher not running, so nothing queued can still use ref
+    if (dispatcher_.running() || !vm_) {
+        return;
+    }
+    JNIEnv* env = nullptr;
+    if (vm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_OK) {
+        env->DeleteGlobalRef(ref);
+    } else if (vm_->AttachCurrentThread(&env, nullptr) == JNI_OK) {
+        env->DeleteGlobalRef(ref);
+        vm_->DetachCurrentThread();
+    }
+}
+
+bool JniBridge::protect_socket(jobject vpn_service, int fd) {
+    if (!vpn_service || !ids_.vpn_service_protect) {
+        return false;
+    }
+    JNIEnv* env = env_for_current_thread();
+    if (!env) {
+        LOG_ERROR(LOG_TAG, "Cannot get JNIEnv to protect socket %d", fd);
+        return false;
+    }
+    const jboolean protected_fd = env->CallBooleanMethod(vpn_service, ids_.vpn_service_protect, fd);
+    if (env->ExceptionCheck()) {
+        clear_exception(env, "VpnService.protect()");
+        return false;
+    }
+    return protected_fd == JNI_TRUE;
+}
+
+} // namespace openvpn
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+    JniBridge::instance().on_load(vm, env);
+    LOG_INFO(LOG_TAG, "JNI bridge loaded");
+    return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+    JniBridge::instance().on_unload(env);
+}
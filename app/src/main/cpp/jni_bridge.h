@@ -0,0 +1,107 @@
+#ifndef JNI_BRIDGE_H
+#define JNI_BRIDGE_H
+
+#include <jni.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "callback_dispatcher.h"
+#include "thread_placement.h"
+
+namespace openvpn {
+
+/**
+ * Class and method IDs resolved once in JNI_OnLoad. Classes are global refs.
+ */
+struct JniIds {
+    jclass array_list = nullptr;
+    jmethodID array_list_init = nullptr;   // ArrayList(int)
+    jmethodID array_list_add = nullptr;    // ArrayList.add(Object)
+    jclass ip_callback = nullptr;          // TunnelIpCallback
+    jmethodID on_tunnel_ip_received = nullptr;
+    jclass dns_callback = nullptr;         // TunnelDnsCallback
+    jmethodID on_tunnel_dns_received = nullptr;
+    jclass state_callback = nullptr;       // TunnelStateCallback
+    jmethodID on_tunnel_state_changed = nullptr;
+    jclass vpn_service = nullptr;          // android.net.VpnService
+    jmethodID vpn_service_protect = nullptr;
+};
+
+/**
+ * Single entry point for calls from native code into Kotlin.
+ *
+ * Tunnel callbacks (IP, DNS, state) are posted to a CallbackDispatcher whose
+ * thread is attached to the JVM once and stays attached, so OpenVPN's event
+ * loops never attach, look up IDs or wait on Kotlin. Callbacks run in post
+ * order. Global refs that queued callbacks may still use are released through
+ * the same queue, after those callbacks.
+ */
+class JniBridge {
+public:
+    static JniBridge& instance() {
+        static JniBridge bridge;
+        return bridge;
+    }
+
+    JniBridge(const JniBridge&) = delete;
+    JniBridge& operator=(const JniBridge&) = delete;
+
+    /**
+     * Resolves JniIds and starts the dispatcher; called from JNI_OnLoad
+     */
+    bool on_load(JavaVM* vm, JNIEnv* env);
+
+    /**
+     * Stops the dispatcher after it runs queued callbacks, and drops the class refs
+     */
+    void on_unload(JNIEnv* env);
+
+    JavaVM* vm() const { return vm_; }
+    const JniIds& ids() const { return ids_; }
+
+    /**
+     * JNIEnv for the calling thread, attaching it if needed. Threads attached
+     * here stay attached, matching OpenVPN's long-lived connection threads.
+     */
+    JNIEnv* env_for_current_thread();
+
+    bool post_ip_received(jobject callback, const std::string& tunnel_id,
+                          const std::string& ip, int prefix_length);
+    bool post_dns_received(jobject callback, const std::string& tunnel_id,
+                           const std::vector<std::string>& dns_servers);
+    bool post_state_changed(jobject callback, const std::string& tunnel_id,
+                            int state, int64_t connect_latency_ms);
+
+    /**
+     * Deletes a global ref after every callback queued so far. Runs inline when
+     * the dispatcher is not running.
+     */
+    void release_global_ref(jobject ref);
+
+    /**
+     * VpnService.protect(fd), called synchronously since the socket must be
+     * protected before OpenVPN connects it
+     */
+    bool protect_socket(jobject vpn_service, int fd);
+
+    const CallbackDispatcher& dispatcher() const { return dispatcher_; }
+
+private:
+    using JniTask = std::function<void(JNIEnv* env)>;
+
+    JniBridge() = default;
+
+    bool post(JniTask task);
+
+    JavaVM* vm_ = nullptr;
+    JniIds ids_;
+    JNIEnv* dispatcher_env_ = nullptr;  // Only used on the dispatcher thread
+    pid_t dispatcher_tid_ = 0;          // ThreadPlacement entry of the dispatcher thread
+    CallbackDispatcher dispatcher_;
+};
+
+} // namespace openvpn
+
+#endif // JNI_BRIDGE_H
@@ -48,11 +48,13 @@
 
 // Info logging (enabled in DEBUG and VERBOSE)
 #if defined(LOGGING_LEVEL_DEBUG) || defined(LOGGING_LEVEL_VERBOSE)
+    #define LOGGING_INFO_ENABLED 1
     #define LOG_INFO(tag, ...) \
         __android_log_print(ANDROID_LOG_INFO, tag, __VA_ARGS__)
     #define LOG_DEBUG(tag, ...) \
         __android_log_print(ANDROID_LOG_DEBUG, tag, __VA_ARGS__)
 #else
+    #define LOGGING_INFO_ENABLED 0
     #define LOG_INFO(tag, ...) ((void)0)
     #define LOG_DEBUG(tag, ...) ((void)0)
 #endif
@@ -97,13 +99,26 @@
 
 // For hot paths (packet processing, encryption, etc.)
 // Only enabled in VERBOSE mode to minimize performance impact
+//
+// Per-packet code in the TUN data path must log through LOG_HOT_PATH (or
+// LOG_ERROR for genuine failures). check_hot_path_logging.cmake rejects direct
+// __android_log_print calls in those files; throughput is reported by the
+// periodic rate summary in CustomTunClient instead.
 #ifdef LOGGING_LEVEL_VERBOSE
+    #define LOGGING_HOT_PATH_ENABLED 1
     #define LOG_HOT_PATH(tag, ...) \
         __android_log_print(ANDROID_LOG_VERBOSE, tag, __VA_ARGS__)
 #else
+    #define LOGGING_HOT_PATH_ENABLED 0
     #define LOG_HOT_PATH(tag, ...) ((void)0)
 #endif
 
+// Two levels at once would enable the union of their macros (e.g. RELEASE + VERBOSE
+// would ship per-packet logging), so the build must pick exactly one
+#if defined(LOGGING_LEVEL_RELEASE) + defined(LOGGING_LEVEL_DEBUG) + defined(LOGGING_LEVEL_VERBOSE) != 1
+#error "Define exactly one of LOGGING_LEVEL_RELEASE, LOGGING_LEVEL_DEBUG, LOGGING_LEVEL_VERBOSE"
+#endif
+
 // ============================================================================
 // Logging Level Info
 // ============================================================================
@@ -0,0 +1,68 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace openvpn {
+
+/**
+ * Unbounded lock-free multi-producer single-consumer queue (Vyukov's intrusive
+ * MPSC design with a stub node).
+ *
+ * push() is one atomic exchange plus one store and never waits on other
+ * producers or the consumer. pop() may only be called from one thread at a time;
+ * it can report empty while a producer is between its exchange and its store,
+ * so producers must signal the consumer after push() returns.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        T discarded;
+        while (pop(discarded)) {
+        }
+        delete tail_;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Moves the oldest element into out; returns false if none is linked yet
+     */
+    bool pop(T& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        out = std::move(next->value);
+        next->value = T();
+        tail_ = next;  // next becomes the new stub
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node*> head_;  // Last pushed node; producers swap themselves in
+    Node* tail_;               // Stub node, owned by the consumer
+};
+
+} // namespace openvpn
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,127 @@
+#ifndef NATIVE_PACKET_ROUTER_H
+#define NATIVE_PACKET_ROUTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "flow_table.h"
+#include "packet_classifier.h"
+
+namespace openvpn {
+
+/**
+ * Native classification for PacketRouter: parses the 5-tuple in place and
+ * returns the tunnel index learned for that flow.
+ *
+ * Tunnel IDs are interned to small integers once so the per-packet call
+ * never crosses JNI with a string. Indices are stable for the process.
+ */
+class NativePacketRouter {
+public:
+    static constexpr int ROUTE_MISS = -1;         // Parsed, but no live flow entry
+    static constexpr int ROUTE_PARSE_ERROR = -2;  // Not a parseable IPv4/IPv6 packet
+
+    /**
+     * Process-wide router shared by the JNI entry points
+     */
+    static NativePacketRouter& instance() {
+        static NativePacketRouter router;
+        return router;
+    }
+
+    /**
+     * Returns the index for tunnel_id, assigning the next free one on first use
+     */
+    int register_tunnel(const std::string& tunnel_id) {
+        std::lock_guard<std::mutex> lock(tunnels_mutex_);
+        auto it = tunnel_indices_.find(tunnel_id);
+        if (it != tunnel_indices_.end()) {
+            return it->second;
+        }
+        const int index = static_cast<int>(tunnel_ids_.size());
+        tunnel_ids_.push_back(tunnel_id);
+        tunnel_indices_.emplace(tunnel_id, index);
+        return index;
+    }
+
+    /**
+     * Returns the ID registered for index, or an empty string
+     */
+    std::string tunnel_id(int index) const {
+        std::lock_guard<std::mutex> lock(tunnels_mutex_);
+        if (index < 0 || static_cast<size_t>(index) >= tunnel_ids_.size()) {
+            return std::string();
+        }
+        return tunnel_ids_[index];
+    }
+
+    /**
+     * Returns the tunnel index for packet's flow, ROUTE_MISS or ROUTE_PARSE_ERROR
+     */
+    int route(const uint8_t* packet, size_t len, uint64_t now_ms) const {
+        FlowKey key;
+        if (classify_packet(packet, len, key) != ClassifyResult::OK) {
+            return ROUTE_PARSE_ERROR;
+        }
+        FlowTable::Match match;
+        if (!flows_.lookup(key, now_ms, match)) {
+            return ROUTE_MISS;
+        }
+        return match.tunnel_index;
+    }
+
+    /**
+     * Looks up packet's flow without interpreting the result as a route
+     */
+    bool lookup(const uint8_t* packet, size_t len, uint64_t now_ms, FlowTable::Match& out) const {
+        FlowKey key;
+        if (classify_packet(packet, len, key) != ClassifyResult::OK) {
+            return false;
+        }
+        return flows_.lookup(key, now_ms, out);
+    }
+
+    /**
+     * Records packet's flow so later packets route to tunnel_index
+     */
+    bool learn(const uint8_t* packet, size_t len, int tunnel_index, int uid, uint64_t now_ms) {
+        FlowKey key;
+        if (tunnel_index < 0 || classify_packet(packet, len, key) != ClassifyResult::OK) {
+            return false;
+        }
+        return flows_.insert(key, tunnel_index, uid, now_ms);
+    }
+
+    /**
+     * Live flows routed to tunnel_id; 0 if the tunnel was never registered
+     */
+    size_t active_flows(const std::string& tunnel_id, uint64_t now_ms) const {
+        int index;
+        {
+            std::lock_guard<std::mutex> lock(tunnels_mutex_);
+            auto it = tunnel_indices_.find(tunnel_id);
+            if (it == tunnel_indices_.end()) {
+                return 0;
+            }
+            index = it->second;
+        }
+        return flows_.count_tunnel(index, now_ms);
+    }
+
+    FlowTable& flows() { return flows_; }
+    const FlowTable& flows() const { return flows_; }
+
+private:
+    FlowTable flows_;
+    mutable std::mutex tunnels_mutex_;
+    std::vector<std::string> tunnel_ids_;
+    std::map<std::string, int> tunnel_indices_;
+};
+
+} // namespace openvpn
+
+#endif // NATIVE_PACKET_ROUTER_H
@@ -0,0 +1,342 @@
+#ifndef NETWORK_HANDOFF_H
+#define NETWORK_HANDOFF_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace openvpn {
+
+/**
+ * Underlying network type reported by VpnEngineService. Values are shared
+ * with Kotlin (NetworkHandoffStats.kt).
+ */
+enum NetworkKind : int {
+    NETWORK_UNKNOWN = 0,
+    NETWORK_WIFI = 1,
+    NETWORK_CELLULAR = 2,
+    NETWORK_OTHER = 3,
+};
+
+/**
+ * How a tunnel moved to the new network
+ */
+enum HandoffPath : int {
+    HANDOFF_REBIND = 0,     // Transport socket re-connected in place, data-channel keys kept
+    HANDOFF_RECONNECT = 1,  // ClientAPI reconnect(): new transport, TLS handshake and auth
+    HANDOFF_PATH_COUNT
+};
+
+enum HandoffDirection : int {
+    HANDOFF_WIFI_TO_CELLULAR = 0,
+    HANDOFF_CELLULAR_TO_WIFI = 1,
+    HANDOFF_OTHER = 2,  // Any other pair, or the first change seen
+    HANDOFF_DIRECTION_COUNT
+};
+
+inline HandoffDirection handoff_direction(NetworkKind from, NetworkKind to) {
+    if (from == NETWORK_WIFI && to == NETWORK_CELLULAR) return HANDOFF_WIFI_TO_CELLULAR;
+    if (from == NETWORK_CELLULAR && to == NETWORK_WIFI) return HANDOFF_CELLULAR_TO_WIFI;
+    return HANDOFF_OTHER;
+}
+
+/**
+ * Transport facts learned when the tunnel comes up (CustomTunClient::tun_start)
+ */
+struct TransportTraits {
+    bool udp = false;
+    bool peer_id = false;        // Server pushed peer-id, so it floats peers to a new address
+    std::string local_ip4;       // Tunnel address (ifconfig)
+    std::string gateway_ip4;     // Server's tunnel address (route-gateway or ifconfig remote)
+};
+
+/**
+ * A UDP session whose server floats peers survives a source address change:
+ * only the socket has to move, the data channel keeps its keys.
+ */
+inline bool rebind_eligible(const TransportTraits& traits) {
+    return traits.udp && traits.peer_id;
+}
+
+/**
+ * Re-connects a connected UDP socket to the same server so the kernel picks
+ * a new source address and port on the current default network. The fd stays
+ * the same, so OpenVPN's transport keeps using it without noticing.
+ */
+inline bool rebind_udp_socket(int fd) {
+    int type = 0;
+    socklen_t type_len = sizeof(type);
+    if (fd < 0 || getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &type_len) != 0 || type != SOCK_DGRAM) {
+        return false;
+    }
+    sockaddr_storage peer{};
+    socklen_t peer_len = sizeof(peer);
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&peer), &peer_len) != 0) {
+        return false;
+    }
+    // Dissolving the association resets the auto-bound source address and port
+    sockaddr unspec{};
+    unspec.sa_family = AF_UNSPEC;
+    connect(fd, &unspec, sizeof(unspec));
+    return connect(fd, reinterpret_cast<sockaddr*>(&peer), peer_len) == 0;
+}
+
+namespace detail {
+
+inline uint16_t inet_checksum(const uint8_t* data, size_t len) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += static_cast<uint32_t>(data[i] << 8 | data[i + 1]);
+    }
+    if (len & 1) {
+        sum += static_cast<uint32_t>(data[len - 1] << 8);
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+} // namespace detail
+
+/**
+ * IPv4 ICMP echo request from src to dst. Written into the tunnel after a
+ * rebind, it makes OpenVPN send a data packet (which floats the peer on the
+ * server) and draws a reply that confirms data flows back. Empty if either
+ * address is not IPv4.
+ */
+inline std::vector<uint8_t> build_icmp_echo(const std::string& src, const std::string& dst,
+                                            uint16_t id, uint16_t seq) {
+    in_addr src_addr{};
+    in_addr dst_addr{};
+    if (inet_pton(AF_INET, src.c_str(), &src_addr) != 1 || inet_pton(AF_INET, dst.c_str(), &dst_addr) != 1) {
+        return {};
+    }
+    constexpr size_t IP_HEADER = 20;
+    constexpr size_t ICMP_HEADER = 8;
+    std::vector<uint8_t> packet(IP_HEADER + ICMP_HEADER, 0);
+
+    uint8_t* ip = packet.data();
+    ip[0] = 0x45;  // IPv4, 5-word header
+    ip[2] = static_cast<uint8_t>(packet.size() >> 8);
+    ip[3] = static_cast<uint8_t>(packet.size());
+    ip[8] = 64;    // TTL
+    ip[9] = 1;     // ICMP
+    memcpy(ip + 12, &src_addr, 4);
+    memcpy(ip + 16, &dst_addr, 4);
+    const uint16_t ip_sum = detail::inet_checksum(ip, IP_HEADER);
+    ip[10] = static_cast<uint8_t>(ip_sum >> 8);
+    ip[11] = static_cast<uint8_t>(ip_sum);
+
+    uint8_t* icmp = ip + IP_HEADER;
+    icmp[0] = 8;   // Echo request
+    icmp[4] = static_cast<uint8_t>(id >> 8);
+    icmp[5] = static_cast<uint8_t>(id);
+    icmp[6] = static_cast<uint8_t>(seq >> 8);
+    icmp[7] = static_cast<uint8_t>(seq);
+    const uint16_t icmp_sum = detail::inet_checksum(icmp, ICMP_HEADER);
+    icmp[2] = static_cast<uint8_t>(icmp_sum >> 8);
+    icmp[3] = static_cast<uint8_t>(icmp_sum);
+    return packet;
+}
+
+/**
+ * Index of each value in one packed handoff row.
+ *
+ * nativeGetNetworkHandoffStats() returns [HANDOFF_LAYOUT_VERSION, row count,
+ * HANDOFF_FIELD_COUNT, rows...], one row per direction and path that has
+ * samples. Append new fields before HANDOFF_FIELD_COUNT and bump the version.
+ */
+enum HandoffStatsField : size_t {
+    HANDOFF_FIELD_DIRECTION = 0,
+    HANDOFF_FIELD_PATH,
+    HANDOFF_FIELD_COUNT_DONE,   // Handoffs that saw data flow back
+    HANDOFF_FIELD_LAST_MS,      // Gap: network change to first inbound packet
+    HANDOFF_FIELD_MIN_MS,
+    HANDOFF_FIELD_MAX_MS,
+    HANDOFF_FIELD_TOTAL_MS,
+    HANDOFF_FIELD_ESCALATED,    // Rebinds that hit the deadline and fell back to reconnect
+    HANDOFF_FIELD_ABANDONED,    // Handoffs with no data back before ABANDON_MS
+    HANDOFF_FIELD_COUNT
+};
+
+/**
+ * Tracks each tunnel's move to a new network until data flows back.
+ *
+ * begin() records the tunnel's inbound packet count at the network change.
+ * poll() completes the handoff once that count grows, recording the gap per
+ * direction and path. A rebind that sees nothing back within the deadline is
+ * escalated: the caller runs a full reconnect and the same handoff continues
+ * as HANDOFF_RECONNECT, so its gap includes the failed rebind.
+ */
+class NetworkHandoffTracker {
+public:
+    static constexpr int64_t HANDOFF_LAYOUT_VERSION = 1;
+    static constexpr int64_t DEFAULT_REBIND_DEADLINE_MS = 3000;
+    static constexpr int64_t ABANDON_MS = 60000;
+
+    enum class Poll {
+        IDLE,       // No handoff in progress for the tunnel
+        PENDING,
+        DONE,       // Data flowed back; gap recorded
+        ESCALATE,   // Rebind deadline passed; caller must reconnect
+        ABANDONED,  // Nothing back after ABANDON_MS; given up
+    };
+
+    static NetworkHandoffTracker& instance() {
+        static NetworkHandoffTracker tracker;
+        return tracker;
+    }
+
+    explicit NetworkHandoffTracker(int64_t rebind_deadline_ms = DEFAULT_REBIND_DEADLINE_MS)
+        : rebind_deadline_ms_(rebind_deadline_ms) {}
+
+    NetworkHandoffTracker(const NetworkHandoffTracker&) = delete;
+    NetworkHandoffTracker& operator=(const NetworkHandoffTracker&) = delete;
+
+    /**
+     * Records the network the device moved to; later begin() calls use the
+     * direction from the previous one
+     */
+    HandoffDirection network_changed(NetworkKind kind) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        direction_ = handoff_direction(network_, kind);
+        network_ = kind;
+        return direction_;
+    }
+
+    void begin(const std::string& tunnel_id, HandoffPath path, uint64_t packets_in, int64_t now_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Pending& pending = pending_[tunnel_id];
+        pending.path = path;
+        pending.direction = direction_;
+        pending.packets_in = packets_in;
+        pending.started_ms = now_ms;
+        pending.path_started_ms = now_ms;
+    }
+
+    Poll poll(const std::string& tunnel_id, uint64_t packets_in, int64_t now_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(tunnel_id);
+        if (it == pending_.end()) {
+            return Poll::IDLE;
+        }
+        Pending& pending = it->second;
+        const int64_t elapsed = std::max<int64_t>(now_ms - pending.started_ms, 0);
+        Row& row = rows_[pending.direction][pending.path];
+        if (packets_in > pending.packets_in) {
+            row.count++;
+            row.last_ms = elapsed;
+            row.min_ms = row.count == 1 ? elapsed : std::min(row.min_ms, elapsed);
+            row.max_ms = std::max(row.max_ms, elapsed);
+            row.total_ms += elapsed;
+            pending_.erase(it);
+            return Poll::DONE;
+        }
+        if (pending.path == HANDOFF_REBIND && now_ms - pending.path_started_ms >= rebind_deadline_ms_) {
+            row.escalated++;
+            pending.path = HANDOFF_RECONNECT;
+            pending.path_started_ms = now_ms;
+            return Poll::ESCALATE;
+        }
+        if (elapsed >= ABANDON_MS) {
+            row.abandoned++;
+            pending_.erase(it);
+            return Poll::ABANDONED;
+        }
+        return Poll::PENDING;
+    }
+
+    /**
+     * Drops handoffs of tunnels that are no longer running
+     */
+    void retain(const std::set<std::string>& live_tunnel_ids) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            it = live_tunnel_ids.count(it->first) ? std::next(it) : pending_.erase(it);
+        }
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.size();
+    }
+
+    bool pending_path(const std::string& tunnel_id, HandoffPath& path) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(tunnel_id);
+        if (it == pending_.end()) {
+            return false;
+        }
+        path = it->second.path;
+        return true;
+    }
+
+    /**
+     * Rows in the layout documented on HandoffStatsField
+     */
+    std::vector<int64_t> pack() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<int64_t> out = {HANDOFF_LAYOUT_VERSION, 0, HANDOFF_FIELD_COUNT};
+        for (int direction = 0; direction < HANDOFF_DIRECTION_COUNT; ++direction) {
+            for (int path = 0; path < HANDOFF_PATH_COUNT; ++path) {
+                const Row& row = rows_[direction][path];
+                if (row.count == 0 && row.escalated == 0 && row.abandoned == 0) {
+                    continue;
+                }
+                const size_t base = out.size();
+                out.resize(base + HANDOFF_FIELD_COUNT);
+                out[base + HANDOFF_FIELD_DIRECTION] = direction;
+                out[base + HANDOFF_FIELD_PATH] = path;
+                out[base + HANDOFF_FIELD_COUNT_DONE] = row.count;
+                out[base + HANDOFF_FIELD_LAST_MS] = row.last_ms;
+                out[base + HANDOFF_FIELD_MIN_MS] = row.min_ms;
+                out[base + HANDOFF_FIELD_MAX_MS] = row.max_ms;
+                out[base + HANDOFF_FIELD_TOTAL_MS] = row.total_ms;
+                out[base + HANDOFF_FIELD_ESCALATED] = row.escalated;
+                out[base + HANDOFF_FIELD_ABANDONED] = row.abandoned;
+                out[1]++;
+            }
+        }
+        return out;
+    }
+
+private:
+    struct Pending {
+        HandoffPath path = HANDOFF_REBIND;
+        HandoffDirection direction = HANDOFF_OTHER;
+        uint64_t packets_in = 0;     // Inbound packet count at begin()
+        int64_t started_ms = 0;      // Network change
+        int64_t path_started_ms = 0; // Current path (moves on escalation)
+    };
+
+    struct Row {
+        int64_t count = 0;
+        int64_t last_ms = 0;
+        int64_t min_ms = 0;
+        int64_t max_ms = 0;
+        int64_t total_ms = 0;
+        int64_t escalated = 0;
+        int64_t abandoned = 0;
+    };
+
+    const int64_t rebind_deadline_ms_;
+    mutable std::mutex mutex_;
+    NetworkKind network_ = NETWORK_UNKNOWN;
+    HandoffDirection direction_ = HANDOFF_OTHER;
+    std::map<std::string, Pending> pending_;
+    Row rows_[HANDOFF_DIRECTION_COUNT][HANDOFF_PATH_COUNT];
+};
+
+} // namespace openvpn
+
+#endif // NETWORK_HANDOFF_H
@@ -4,25 +4,38 @@
 #include <unistd.h>    // For close()
 #include <sys/socket.h>  // For socketpair()
 #include <fcntl.h>     // For fcntl(), O_NONBLOCK
+#include <poll.h>      // For poll()
 #include <errno.h>     // For errno
 #include <cstring>     // For strerror()
-#include <map>         // For std::map
-#include <mutex>       // For std::mutex
+#include <set>
+#include <vector>
+#include <sys/ioctl.h>   // For ioctl()
+#include <linux/sockios.h>  // For SIOCINQ, SIOCOUTQ
 #include "openvpn_wrapper.h"
+#include "logging_config.h"
+#include "tunnel_stats.h"
+#include "connect_timeline.h"
+#include "endpoint_cache.h"
+#include "network_handoff.h"
+#include "native_packet_router.h"
+#include "reconnect_scheduler.h"
+#include "tunnel_slots.h"
 
 // Forward declare OpenVpnSession to avoid incomplete type issues
 // The actual definition is in openvpn_wrapper.cpp
 struct OpenVpnSession;
 
-// Global JavaVM reference (set once at library load)
-static JavaVM* g_javaVM = nullptr;
-
-// Global map of sessions keyed by tunnel ID
-// Used to retrieve session objects for app FD access
-static std::map<std::string, OpenVpnSession*> sessions;
-static std::mutex sessions_mutex;
+// Sessions and createPipe() socketpairs live in openvpn::TunnelSlotTable.
+// Kotlin gets a tunnel handle from createPipe()/nativeSetTunnelIdAndCallback()
+// and passes it back instead of the tunnel ID string.
+static openvpn::TunnelSlotTable& tunnel_slots() {
+    return openvpn::TunnelSlotTable::instance();
+}
 
 #define LOG_TAG "OpenVPN-JNI"
+// Tag this file's LOGI/LOGE with LOG_TAG rather than logging_config.h's generic tag
+#undef LOGI
+#undef LOGE
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
@@ -40,13 +53,14 @@ extern "C" {
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeDisconnect(
             JNIEnv *env, jobject thiz, jlong sessionHandle);
     
+    // Packets are passed in direct ByteBuffers by offset and length
     JNIEXPORT jint JNICALL
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSendPacket(
-            JNIEnv *env, jobject thiz, jlong sessionHandle, jbyteArray packet);
+            JNIEnv *env, jobject thiz, jlong sessionHandle, jobject buffer, jint offset, jint length);
     
-    JNIEXPORT jbyteArray JNICALL
+    JNIEXPORT jint JNICALL
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeReceivePacket(
-            JNIEnv *env, jobject thiz, jlong sessionHandle);
+            JNIEnv *env, jobject thiz, jlong sessionHandle, jobject buffer, jint offset);
     
     JNIEXPORT jboolean JNICALL
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeIsConnected(
@@ -56,32 +70,93 @@ extern "C" {
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeGetLastError(
             JNIEnv *env, jobject thiz, jlong sessionHandle);
     
-    JNIEXPORT void JNICALL
+    // Returns the tunnel handle used by getAppFd() and nativeGetTunnelStats()
+    JNIEXPORT jlong JNICALL
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetTunnelIdAndCallback(
             JNIEnv *env, jobject thiz,
             jlong sessionHandle, jstring tunnelId, jobject ipCallback, jobject dnsCallback);
     
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetStateCallback(
+            JNIEnv *env, jobject thiz, jlong sessionHandle, jobject stateCallback);
+    
     JNIEXPORT jint JNICALL
     Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_getAppFd(
-            JNIEnv *env, jobject thiz, jstring tunnelId);
+            JNIEnv *env, jobject thiz, jlong tunnelHandle);
     
-    // JNI functions for VpnConnectionManager to create pipes
-    JNIEXPORT jint JNICALL
+    // JNI functions for VpnConnectionManager to create pipes; createPipe()
+    // returns the tunnel handle the getters take
+    JNIEXPORT jlong JNICALL
     Java_com_multiregionvpn_core_VpnConnectionManager_createPipe(
             JNIEnv *env, jobject thiz, jstring tunnelId);
     
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_VpnConnectionManager_getOpenVpnPipeFd(
+            JNIEnv *env, jobject thiz, jlong tunnelHandle);
+    
     JNIEXPORT jint JNICALL
     Java_com_multiregionvpn_core_VpnConnectionManager_getPipeWriteFd(
-            JNIEnv *env, jobject thiz, jstring tunnelId);
+            JNIEnv *env, jobject thiz, jlong tunnelHandle);
     
     JNIEXPORT jint JNICALL
     Java_com_multiregionvpn_core_VpnConnectionManager_getPipeReadFd(
-            JNIEnv *env, jobject thiz, jstring tunnelId);
+            JNIEnv *env, jobject thiz, jlong tunnelHandle);
+    
+    // Pre-connect packet queue (see pre_connect_queue.h); returns a PreConnectResult
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_VpnConnectionManager_nativeQueuePacket(
+            JNIEnv *env, jobject thiz, jlong tunnelHandle, jbyteArray packet);
+    
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_VpnConnectionManager_nativeClearQueuedPackets(
+            JNIEnv *env, jobject thiz, jlong tunnelHandle);
+    
+    // Direct ByteBuffer packet channel over the tunnel's Kotlin-side socket (see direct_packet_channel.h)
+    JNIEXPORT jboolean JNICALL
+    Java_com_multiregionvpn_core_DirectPacketChannel_nativeRegister(
+            JNIEnv *env, jclass clazz, jlong tunnelHandle, jint fd, jobject sendBuffer, jobject receiveBuffer);
+    
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_DirectPacketChannel_nativeSend(
+            JNIEnv *env, jclass clazz, jlong tunnelHandle, jint offset, jint length, jint timeoutMs);
+    
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_DirectPacketChannel_nativeSendBatch(
+            JNIEnv *env, jclass clazz, jlong tunnelHandle, jint count, jint timeoutMs);
+    
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_DirectPacketChannel_nativeReceiveBatch(
+            JNIEnv *env, jclass clazz, jlong tunnelHandle, jint maxCount, jint timeoutMs);
     
     // JNI function for VpnEngineService network change notification
     JNIEXPORT void JNICALL
     Java_com_multiregionvpn_core_VpnEngineService_nativeOnNetworkChanged(
+            JNIEnv *env, jobject thiz, jint networkKind, jlong networkHandle);
+    
+    // Advances in-progress network handoffs; returns how many are still pending
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_VpnEngineService_nativePollNetworkHandoffs(
+            JNIEnv *env, jobject thiz);
+    
+    // Handoff gap per direction and path (see network_handoff.h)
+    JNIEXPORT jlongArray JNICALL
+    Java_com_multiregionvpn_core_VpnEngineService_nativeGetNetworkHandoffStats(
             JNIEnv *env, jobject thiz);
+    
+    // Per-tunnel data path counters (static method on NativeOpenVpnClient.Companion)
+    JNIEXPORT jlongArray JNICALL
+    Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeGetTunnelStats(
+            JNIEnv *env, jclass clazz, jlong tunnelHandle);
+    
+    // Recent connect timelines (static method on NativeOpenVpnClient.Companion)
+    JNIEXPORT jlongArray JNICALL
+    Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeGetConnectTimelines(
+            JNIEnv *env, jclass clazz, jstring tunnelId);
+    
+    // Persisted server addresses (static method on NativeOpenVpnClient.Companion)
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetEndpointCacheFile(
+            JNIEnv *env, jclass clazz, jstring path);
 }
 
 // Implementation using OpenVPN 3 wrapper
@@ -131,7 +206,9 @@ Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeConnect(
     }
     
     // Create OpenVPN session using wrapper
-    OpenVpnSession* session = openvpn_wrapper_create_session();
+    // Snapshot the current placement policy for this session's event loop
+    const openvpn::ThreadPlacementConfig placement = openvpn::ThreadPlacement::instance().config();
+    OpenVpnSession* session = openvpn_wrapper_create_session(&placement);
     if (!session) {
         LOGE("Failed to create OpenVPN session");
         env->ReleaseStringUTFChars(config, configStr);
@@ -184,69 +261,76 @@ Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeDisconnect(
     }
     
     OpenVpnSession* session = reinterpret_cast<OpenVpnSession*>(sessionHandle);
+    
+    // Close the tunnel's slot, which waits out any reconnect task still using
+    // the session, then drop queued reconnect work for it. The session reads
+    // the slot's socketpair until it is destroyed, so the pair closes after it.
+    openvpn::SlotPipe pipe;
+    const int64_t tunnelHandle = tunnel_slots().find_session(session);
+    if (tunnelHandle != openvpn::TunnelSlotTable::INVALID_HANDLE) {
+        const std::string tunnelId = tunnel_slots().tunnel_id(tunnelHandle);
+        tunnel_slots().release(tunnelHandle, &pipe);
+        openvpn::ReconnectScheduler::instance().cancel(tunnelId);
+    }
+    
     openvpn_wrapper_disconnect(session);
     openvpn_wrapper_destroy_session(session);
 }
 
+// Address of buffer[offset, offset + length) in a direct ByteBuffer, or nullptr
+// if the buffer is not direct or the range does not fit
+static uint8_t* direct_range(JNIEnv* env, jobject buffer, jint offset, jint length) {
+    if (!buffer || offset < 0 || length <= 0) {
+        return nullptr;
+    }
+    void* address = env->GetDirectBufferAddress(buffer);
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!address || static_cast<jlong>(offset) + length > capacity) {
+        return nullptr;
+    }
+    return static_cast<uint8_t*>(address) + offset;
+}
+
 JNIEXPORT jint JNICALL
 Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSendPacket(
-        JNIEnv *env, jobject thiz, jlong sessionHandle, jbyteArray packet) {
+        JNIEnv *env, jobject thiz, jlong sessionHandle, jobject buffer, jint offset, jint length) {
     
-    if (!packet) {
-        LOGE("Packet is null");
+    const uint8_t* packet = direct_range(env, buffer, offset, length);
+    if (!packet || sessionHandle == 0) {
+        LOGE("nativeSendPacket: invalid session handle or buffer range");
         return -1;
     }
     
-    jsize len = env->GetArrayLength(packet);
-    jbyte *bytes = env->GetByteArrayElements(packet, nullptr);
-    
-    if (!bytes) {
-        LOGE("Failed to get packet bytes");
-        return -1;
-    }
-    
-    LOGI("nativeSendPacket: handle=%lld, size=%d", (long long)sessionHandle, len);
-    
-    if (sessionHandle == 0) {
-        LOGE("Invalid session handle");
-        env->ReleaseByteArrayElements(packet, bytes, JNI_ABORT);
-        return -1;
-    }
+    LOG_HOT_PATH(LOG_TAG, "nativeSendPacket: handle=%lld, size=%d", (long long)sessionHandle, length);
     
     OpenVpnSession* session = reinterpret_cast<OpenVpnSession*>(sessionHandle);
-    int result = openvpn_wrapper_send_packet(session, (const uint8_t*)bytes, len);
-    
-    env->ReleaseByteArrayElements(packet, bytes, JNI_ABORT);
-    
-    return result;
+    return openvpn_wrapper_send_packet(session, packet, static_cast<size_t>(length));
 }
 
-JNIEXPORT jbyteArray JNICALL
+/**
+ * Copies the next packet into buffer at offset. Returns its length, 0 if
+ * none is pending, or -1 on error.
+ */
+JNIEXPORT jint JNICALL
 Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeReceivePacket(
-        JNIEnv *env, jobject thiz, jlong sessionHandle) {
+        JNIEnv *env, jobject thiz, jlong sessionHandle, jobject buffer, jint offset) {
     
-    if (sessionHandle == 0) {
-        return nullptr;
+    if (sessionHandle == 0 || !buffer) {
+        return -1;
+    }
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    uint8_t* out = capacity > offset ? direct_range(env, buffer, offset, static_cast<jint>(capacity - offset)) : nullptr;
+    if (!out) {
+        return -1;
     }
     
     OpenVpnSession* session = reinterpret_cast<OpenVpnSession*>(sessionHandle);
-    uint8_t* packet = nullptr;
     size_t len = 0;
-    
-    int result = openvpn_wrapper_receive_packet(session, &packet, &len);
-    
-    if (result != 0 || packet == nullptr || len == 0) {
-        return nullptr; // No packet available
-    }
-    
-    jbyteArray jpacket = env->NewByteArray(len);
-    if (jpacket != nullptr && packet != nullptr) {
-        env->SetByteArrayRegion(jpacket, 0, len, (jbyte*)packet);
-        // Free the packet buffer allocated by wrapper
-        free(packet);
+    const int result = openvpn_wrapper_receive_packet(session, out, static_cast<size_t>(capacity - offset), &len);
+    if (result < 0) {
+        return -1;
     }
-    
-    return jpacket;
+    return result == 1 ? static_cast<jint>(len) : 0;
 }
 
 JNIEXPORT jboolean JNICALL
@@ -274,14 +358,14 @@ Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeGetLastError(
     return env->NewStringUTF(errorMsg ? errorMsg : "No error");
 }
 
-JNIEXPORT void JNICALL
+JNIEXPORT jlong JNICALL
 Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetTunnelIdAndCallback(
         JNIEnv *env, jobject thiz,
         jlong sessionHandle, jstring tunnelId, jobject ipCallback, jobject dnsCallback) {
     
     if (sessionHandle == 0) {
         LOGE("Invalid session handle for setTunnelIdAndCallback");
-        return;
+        return openvpn::TunnelSlotTable::INVALID_HANDLE;
     }
     
     OpenVpnSession* session = reinterpret_cast<OpenVpnSession*>(sessionHandle);
@@ -295,17 +379,42 @@ Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetTunnelIdAndC
     // Set tunnel ID and callbacks
     openvpn_wrapper_set_tunnel_id_and_callback(session, env, tunnelIdStr, ipCallback, dnsCallback);
     
-    // Register session in global map for app FD retrieval
+    // Attach the session to the tunnel's slot for handle-based lookups. A
+    // session it replaces is no longer in use by any reader afterwards.
+    int64_t tunnelHandle = openvpn::TunnelSlotTable::INVALID_HANDLE;
     if (tunnelIdStr) {
-        std::lock_guard<std::mutex> lock(sessions_mutex);
-        sessions[std::string(tunnelIdStr)] = session;
-        LOGI("Registered session for tunnel: %s", tunnelIdStr);
+        tunnelHandle = tunnel_slots().open(tunnelIdStr);
+        if (tunnelHandle == openvpn::TunnelSlotTable::INVALID_HANDLE) {
+            LOGE("No free tunnel slot for %s (all %zu in use)", tunnelIdStr,
+                 openvpn::TunnelSlotTable::CAPACITY);
+        } else if (tunnel_slots().attach_session(tunnelHandle, session)) {
+            LOGI("Registered session for tunnel: %s (handle 0x%llx)", tunnelIdStr,
+                 (unsigned long long)tunnelHandle);
+        } else {
+            // open() succeeded, so the slot was released before the session got in
+            LOGE("Tunnel slot for %s closed while registering its session", tunnelIdStr);
+            tunnelHandle = openvpn::TunnelSlotTable::INVALID_HANDLE;
+        }
     }
     
     // Release string
     if (tunnelIdStr && tunnelId) {
         env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
     }
+    return static_cast<jlong>(tunnelHandle);
+}
+
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetStateCallback(
+        JNIEnv *env, jobject thiz, jlong sessionHandle, jobject stateCallback) {
+    
+    if (sessionHandle == 0) {
+        LOGE("Invalid session handle for setStateCallback");
+        return;
+    }
+    
+    OpenVpnSession* session = reinterpret_cast<OpenVpnSession*>(sessionHandle);
+    openvpn_wrapper_set_state_callback(session, env, stateCallback);
 }
 
 // CRITICAL: Get the app FD from External TUN Factory
@@ -314,84 +423,60 @@ Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetTunnelIdAndC
 // OpenVPN writes decrypted packets to this FD, our app reads them
 JNIEXPORT jint JNICALL
 Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_getAppFd(
-        JNIEnv *env, jobject thiz, jstring tunnelId) {
-    
-    if (!tunnelId) {
-        LOGE("getAppFd: tunnelId is null");
-        return -1;
-    }
-    
-    const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
-    if (!tunnelIdStr) {
-        LOGE("getAppFd: failed to get tunnelId string");
-        return -1;
-    }
-    
-    // Get session for this tunnel
-    OpenVpnSession* session = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(sessions_mutex);
-        auto it = sessions.find(tunnelIdStr);
-        if (it == sessions.end()) {
-            LOGE("getAppFd: No session found for tunnel: %s", tunnelIdStr);
-            env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
-            return -1;
-        }
-        session = it->second;
-    }
+        JNIEnv *env, jobject thiz, jlong tunnelHandle) {
     
-    if (!session) {
-        LOGE("getAppFd: Session pointer is null for tunnel: %s", tunnelIdStr);
-        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    if (!pin || !pin.session()) {
+        LOGE("getAppFd: No session for tunnel handle 0x%llx", (unsigned long long)tunnelHandle);
         return -1;
     }
     
     // Use wrapper function to get app FD (avoids incomplete type issues)
-    int appFd = openvpn_wrapper_get_app_fd(session);
+    int appFd = openvpn_wrapper_get_app_fd(pin.session());
     
     if (appFd < 0) {
-        LOGE("getAppFd: Failed to get app FD for tunnel: %s", tunnelIdStr);
-        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+        LOGE("getAppFd: Failed to get app FD for tunnel handle 0x%llx", (unsigned long long)tunnelHandle);
         return -1;
     }
     
-    LOGI("getAppFd: Retrieved app FD %d for tunnel: %s", appFd, tunnelIdStr);
-    env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+    LOGI("getAppFd: Retrieved app FD %d for tunnel handle 0x%llx", appFd, (unsigned long long)tunnelHandle);
     return appFd;
 }
 
-// Structure to hold socket pair FDs for a tunnel
-struct TunnelSockets {
-    int openvpnFd;      // OpenVPN 3 uses this (bidirectional - reads packets, writes responses)
-    int kotlinFd;       // Kotlin uses this (bidirectional - writes packets, reads responses)
-};
-
-// Global map to store socket pair FDs per tunnel
-static std::map<std::string, TunnelSockets> tunnel_sockets;
-static std::mutex sockets_mutex;
-
-JNIEXPORT jint JNICALL
+// Creates the tunnel's socketpair and returns its tunnel handle, or
+// TunnelSlotTable::INVALID_HANDLE (0). The slot keeps both ends:
+// openvpn_fd for OpenVPN 3, kotlin_fd for PacketRouter (both bidirectional).
+JNIEXPORT jlong JNICALL
 Java_com_multiregionvpn_core_VpnConnectionManager_createPipe(
         JNIEnv *env, jobject thiz, jstring tunnelId) {
     
     if (!tunnelId) {
         LOGE("createPipe: tunnelId is null");
-        return -1;
+        return openvpn::TunnelSlotTable::INVALID_HANDLE;
     }
     
     const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
     if (!tunnelIdStr) {
         LOGE("createPipe: failed to get tunnelId string");
-        return -1;
+        return openvpn::TunnelSlotTable::INVALID_HANDLE;
     }
     
-    std::lock_guard<std::mutex> lock(sockets_mutex);
+    const int64_t tunnelHandle = tunnel_slots().open(tunnelIdStr);
+    if (tunnelHandle == openvpn::TunnelSlotTable::INVALID_HANDLE) {
+        LOGE("createPipe: No free tunnel slot for %s (all %zu in use)", tunnelIdStr,
+             openvpn::TunnelSlotTable::CAPACITY);
+        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+        return openvpn::TunnelSlotTable::INVALID_HANDLE;
+    }
     
     // Check if socket pair already exists for this tunnel
-    if (tunnel_sockets.find(tunnelIdStr) != tunnel_sockets.end()) {
-        LOGI("createPipe: Socket pair already exists for tunnel %s, reusing", tunnelIdStr);
-        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
-        return tunnel_sockets[tunnelIdStr].openvpnFd;
+    {
+        openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+        if (pin && pin.openvpn_fd() >= 0) {
+            LOGI("createPipe: Socket pair already exists for tunnel %s, reusing", tunnelIdStr);
+            env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+            return static_cast<jlong>(tunnelHandle);
+        }
     }
     
     // Create socket pair with SOCK_SEQPACKET - bidirectional communication with packet boundaries
@@ -405,7 +490,7 @@ Java_com_multiregionvpn_core_VpnConnectionManager_createPipe(
     if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) == -1) {
         LOGE("createPipe: failed to create SEQPACKET socket pair: %s", strerror(errno));
         env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
-        return -1;
+        return openvpn::TunnelSlotTable::INVALID_HANDLE;
     }
     LOGI("createPipe: Created SEQPACKET socket pair (packet-oriented, emulates TUN behavior)");
     
@@ -427,57 +512,219 @@ Java_com_multiregionvpn_core_VpnConnectionManager_createPipe(
     // We want to block until data is available or EOF occurs
     LOGI("createPipe: Kotlin FD (%d) remains in BLOCKING mode for FileInputStream", sockets[1]);
     
-    // Store socket FDs
-    TunnelSockets sockPair;
-    sockPair.openvpnFd = sockets[0];  // OpenVPN 3 uses this (bidirectional)
-    sockPair.kotlinFd = sockets[1];  // Kotlin uses this (bidirectional)
-    
-    tunnel_sockets[tunnelIdStr] = sockPair;
+    // Store socket FDs: sockets[0] for OpenVPN 3, sockets[1] for Kotlin; the slot owns them
+    if (!tunnel_slots().set_pipe(tunnelHandle, sockets[0], sockets[1])) {
+        LOGE("createPipe: tunnel slot for %s closed while creating its socket pair", tunnelIdStr);
+        close(sockets[0]);
+        close(sockets[1]);
+        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+        return openvpn::TunnelSlotTable::INVALID_HANDLE;
+    }
     
     LOGI("createPipe: Created SEQPACKET socket pair for tunnel %s", tunnelIdStr);
-    LOGI("   OpenVPN 3 FD: %d (packet-oriented, non-blocking, emulates TUN read/write)", sockPair.openvpnFd);
-    LOGI("   Kotlin FD: %d (packet-oriented, blocking, for PacketRouter)", sockPair.kotlinFd);
+    LOGI("   OpenVPN 3 FD: %d (packet-oriented, non-blocking, emulates TUN read/write)", sockets[0]);
+    LOGI("   Kotlin FD: %d (packet-oriented, blocking, for PacketRouter)", sockets[1]);
     LOGI("   Each write() = one packet, each read() = one packet (preserves boundaries)");
     
-    // Return OpenVPN 3 FD (it will read packets from and write responses to this)
     env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
-    return sockPair.openvpnFd;
+    return static_cast<jlong>(tunnelHandle);
+}
+
+// JNI function to get the OpenVPN 3 FD (it reads packets from and writes responses to this)
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_VpnConnectionManager_getOpenVpnPipeFd(
+        JNIEnv *env, jobject thiz, jlong tunnelHandle) {
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    return pin ? pin.openvpn_fd() : -1;
 }
 
 // JNI function to get the Kotlin FD (bidirectional - for writing packets and reading responses)
 JNIEXPORT jint JNICALL
 Java_com_multiregionvpn_core_VpnConnectionManager_getPipeWriteFd(
-        JNIEnv *env, jobject thiz, jstring tunnelId) {
-    
-    if (!tunnelId) {
-        LOGE("getPipeWriteFd: tunnelId is null");
-        return -1;
-    }
-    
-    const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
-    if (!tunnelIdStr) {
-        return -1;
-    }
-    
-    std::lock_guard<std::mutex> lock(sockets_mutex);
-    auto it = tunnel_sockets.find(tunnelIdStr);
-    if (it == tunnel_sockets.end()) {
-        LOGE("getPipeWriteFd: No socket pair found for tunnel %s", tunnelIdStr);
-        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+        JNIEnv *env, jobject thiz, jlong tunnelHandle) {
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    if (!pin || pin.kotlin_fd() < 0) {
+        LOGE("getPipeWriteFd: No socket pair for tunnel handle 0x%llx", (unsigned long long)tunnelHandle);
         return -1;
     }
-    
-    int kotlinFd = it->second.kotlinFd;
-    env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
-    return kotlinFd;
+    return pin.kotlin_fd();
 }
 
 // JNI function to get the Kotlin FD (same as write FD - socket pair is bidirectional)
 JNIEXPORT jint JNICALL
 Java_com_multiregionvpn_core_VpnConnectionManager_getPipeReadFd(
-        JNIEnv *env, jobject thiz, jstring tunnelId) {
+        JNIEnv *env, jobject thiz, jlong tunnelHandle) {
     // Socket pair is bidirectional - same FD for reading and writing
-    return Java_com_multiregionvpn_core_VpnConnectionManager_getPipeWriteFd(env, thiz, tunnelId);
+    return Java_com_multiregionvpn_core_VpnConnectionManager_getPipeWriteFd(env, thiz, tunnelHandle);
+}
+
+static uint64_t tunnel_packets_in(int64_t tunnelHandle) {
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    openvpn::TunnelStats* stats = pin ? pin.stats() : nullptr;
+    return stats ? stats->traffic.packets_in.load(std::memory_order_relaxed) : 0;
+}
+
+static int64_t monotonic_ms() {
+    return openvpn::ConnectTimelineRing::now_us() / 1000;
+}
+
+/**
+ * Holds a packet for a tunnel that is still connecting. CustomTunClient writes
+ * the queue into app_fd from tun_start(); once that happened, packets go
+ * straight to app_fd until Kotlin switches to its own writer.
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_VpnConnectionManager_nativeQueuePacket(
+        JNIEnv *env, jobject thiz, jlong tunnelHandle, jbyteArray packet) {
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    openvpn::PreConnectQueue* queue = pin ? pin.pre_connect() : nullptr;
+    if (!queue || !packet) {
+        return static_cast<jint>(openvpn::PreConnectResult::DROPPED);
+    }
+    
+    // Copy out of the Java heap before taking the queue lock
+    uint8_t buf[openvpn::PreConnectQueue::MAX_PACKET_SIZE];
+    const jsize len = env->GetArrayLength(packet);
+    if (len <= 0 || static_cast<size_t>(len) > sizeof(buf)) {
+        // push() rejects and counts the size before touching the data
+        return static_cast<jint>(queue->push(nullptr, static_cast<size_t>(len > 0 ? len : 0), 0));
+    }
+    env->GetByteArrayRegion(packet, 0, len, reinterpret_cast<jbyte*>(buf));
+    return static_cast<jint>(queue->push(buf, static_cast<size_t>(len), static_cast<uint64_t>(monotonic_ms())));
+}
+
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_VpnConnectionManager_nativeClearQueuedPackets(
+        JNIEnv *env, jobject thiz, jlong tunnelHandle) {
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    if (openvpn::PreConnectQueue* queue = pin ? pin.pre_connect() : nullptr) {
+        queue->clear();
+    }
+}
+
+/**
+ * Registers the Kotlin end of the tunnel's socket (the createPipe() fd, or
+ * app_fd once connected) with its send and receive direct ByteBuffers, replacing any previous
+ * registration; a negative fd or null buffers unregister. Kotlin keeps the
+ * buffers alive and the fd open while registered.
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_multiregionvpn_core_DirectPacketChannel_nativeRegister(
+        JNIEnv *env, jclass clazz, jlong tunnelHandle, jint fd, jobject sendBuffer, jobject receiveBuffer) {
+    if (fd < 0 || !sendBuffer || !receiveBuffer) {
+        return tunnel_slots().set_direct(tunnelHandle, nullptr) ? JNI_TRUE : JNI_FALSE;
+    }
+    const openvpn::DirectPacketBuffer send{static_cast<uint8_t*>(env->GetDirectBufferAddress(sendBuffer)),
+                                           static_cast<size_t>(env->GetDirectBufferCapacity(sendBuffer))};
+    const openvpn::DirectPacketBuffer receive{static_cast<uint8_t*>(env->GetDirectBufferAddress(receiveBuffer)),
+                                              static_cast<size_t>(env->GetDirectBufferCapacity(receiveBuffer))};
+    auto channel = std::make_unique<openvpn::DirectPacketChannel>(fd, send, receive);
+    if (!channel->valid()) {
+        LOGE("DirectPacketChannel: buffers must be direct and hold at least %zu bytes",
+             openvpn::DirectPacketChannel::DATA_OFFSET + openvpn::DirectPacketChannel::SLOT_SIZE);
+        return JNI_FALSE;
+    }
+    return tunnel_slots().set_direct(tunnelHandle, std::move(channel)) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Waits up to timeout_ms for fd to become ready. Called with the slot
+ * unpinned, so a tunnel being released is never held up by a blocked caller.
+ */
+static bool wait_direct_socket(int fd, short events, int timeout_ms) {
+    pollfd pfd{fd, events, 0};
+    int ready;
+    do {
+        ready = poll(&pfd, 1, timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0;
+}
+
+/**
+ * Runs op(channel) on the tunnel's registered channel. If it reports
+ * EAGAIN and timeout_ms > 0, waits for events once and retries. Returns -1
+ * when the tunnel or channel is gone.
+ */
+template <typename Op>
+static jint with_direct_channel(int64_t tunnelHandle, short events, int timeout_ms, Op op) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        int fd;
+        {
+            openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+            openvpn::DirectPacketChannel* channel = pin ? pin.direct() : nullptr;
+            if (!channel) {
+                return -1;
+            }
+            const int result = op(*channel);
+            const bool would_block = (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ||
+                                     (result == 0 && events == POLLIN);
+            if (!would_block) {
+                return result;
+            }
+            fd = channel->fd();
+        }
+        if (attempt > 0 || timeout_ms <= 0 || !wait_direct_socket(fd, events, timeout_ms)) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Sends send buffer [offset, offset + length) to OpenVPN. Returns length, 0
+ * if the socket stayed full for timeoutMs, or -1 on error.
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_DirectPacketChannel_nativeSend(
+        JNIEnv *env, jclass clazz, jlong tunnelHandle, jint offset, jint length, jint timeoutMs) {
+    if (offset < 0 || length <= 0) {
+        return -1;
+    }
+    return with_direct_channel(tunnelHandle, POLLOUT, timeoutMs,
+        [offset, length](openvpn::DirectPacketChannel& channel) {
+            return channel.send(static_cast<size_t>(offset), static_cast<size_t>(length));
+        });
+}
+
+/**
+ * Sends the first count packets described in the send buffer with one
+ * sendmmsg(). Returns how many were sent; fewer than count if the socket
+ * stayed full for timeoutMs.
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_DirectPacketChannel_nativeSendBatch(
+        JNIEnv *env, jclass clazz, jlong tunnelHandle, jint count, jint timeoutMs) {
+    if (count <= 0) {
+        return 0;
+    }
+    return with_direct_channel(tunnelHandle, POLLOUT, timeoutMs,
+        [count](openvpn::DirectPacketChannel& channel) {
+            return channel.send_batch(static_cast<size_t>(count));
+        });
+}
+
+/**
+ * Receives up to maxCount packets with one recvmmsg(), waiting up to
+ * timeoutMs for the first, and describes them at the start of the receive
+ * buffer. Returns the count, 0 on timeout, or -1 on error or when the
+ * tunnel closed.
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_DirectPacketChannel_nativeReceiveBatch(
+        JNIEnv *env, jclass clazz, jlong tunnelHandle, jint maxCount, jint timeoutMs) {
+    if (maxCount <= 0) {
+        return 0;
+    }
+    return with_direct_channel(tunnelHandle, POLLIN, timeoutMs,
+        [maxCount](openvpn::DirectPacketChannel& channel) {
+            return channel.receive_batch(static_cast<size_t>(maxCount));
+        });
+}
+
+// Reconnect priority: tunnels carrying more live flows move first
+static int64_t tunnel_priority(const std::string& tunnelId) {
+    return static_cast<int64_t>(openvpn::NativePacketRouter::instance().active_flows(
+        tunnelId, static_cast<uint64_t>(openvpn::ReconnectScheduler::now_ms())));
 }
 
 /**
@@ -485,47 +732,210 @@ Java_com_multiregionvpn_core_VpnConnectionManager_getPipeReadFd(
  * 
  * THE ZOMBIE TUNNEL BUG FIX:
  * This function is called from VpnEngineService.networkCallback.onAvailable().
- * It propagates the network change event to all active OpenVPN/WireGuard sessions,
- * forcing them to reconnect and establish new sockets on the new underlying network.
+ * Without it, tunnels become "zombies" - the OS keeps sending packets to the VPN,
+ * but they go nowhere because the OpenVPN socket is still bound to the old (dead)
+ * network.
  * 
- * Without this, tunnels become "zombies" - the OS keeps sending packets to the VPN,
- * but they go nowhere because the OpenVPN/WireGuard socket is still bound to the
- * old (dead) network.
+ * UDP tunnels whose server floats peers rebind their socket in place; the rest
+ * reconnect. The work runs on ReconnectScheduler: a few tunnels at a time,
+ * tunnels with live flows first, idle ones staggered, and repeat reports of the
+ * same network dropped. The tunnel slots are only locked to snapshot them.
+ * Each tunnel's handoff is then tracked until data flows back, and
+ * nativePollNetworkHandoffs() escalates rebinds that stay silent.
  */
 JNIEXPORT void JNICALL
 Java_com_multiregionvpn_core_VpnEngineService_nativeOnNetworkChanged(
-        JNIEnv *env, jobject thiz) {
-    LOGI("═══════════════════════════════════════════════════════");
-    LOGI("🌐 JNI: nativeOnNetworkChanged() called");
-    LOGI("═══════════════════════════════════════════════════════");
+        JNIEnv *env, jobject thiz, jint networkKind, jlong networkHandle) {
+    openvpn::ReconnectScheduler& scheduler = openvpn::ReconnectScheduler::instance();
+    if (!scheduler.note_network_event(networkHandle)) {
+        LOGI("🌐 JNI: nativeOnNetworkChanged(kind=%d) repeats the current network, ignoring", networkKind);
+        return;
+    }
     
-    std::lock_guard<std::mutex> lock(sessions_mutex);
+    openvpn::NetworkHandoffTracker& tracker = openvpn::NetworkHandoffTracker::instance();
+    const openvpn::HandoffDirection direction =
+        tracker.network_changed(static_cast<openvpn::NetworkKind>(networkKind));
+    LOGI("🌐 JNI: nativeOnNetworkChanged(kind=%d, direction=%d)", networkKind, direction);
     
-    if (sessions.empty()) {
-        LOGI("   No active sessions to reconnect");
+    const std::vector<std::pair<int64_t, std::string>> tunnels = tunnel_slots().sessions();
+    if (tunnels.empty()) {
+        LOGI("   No active sessions to move");
         return;
     }
     
-    LOGI("   Reconnecting %zu active tunnel(s)...", sessions.size());
-    
-    // Iterate through all active sessions and trigger reconnect
-    for (auto& pair : sessions) {
-        const std::string& tunnelId = pair.first;
-        OpenVpnSession* session = pair.second;
-        
-        if (session) {
-            LOGI("   🔄 Reconnecting tunnel: %s", tunnelId.c_str());
-            try {
-                // Call the reconnect method on the OpenVPN client
-                // This will be implemented in openvpn_wrapper.cpp
-                reconnectSession(session);
-                LOGI("   ✅ Reconnect initiated for tunnel: %s", tunnelId.c_str());
-            } catch (const std::exception& e) {
-                LOGE("   ❌ Failed to reconnect tunnel %s: %s", tunnelId.c_str(), e.what());
-            }
+    const int64_t changedAt = monotonic_ms();
+    for (const auto& tunnel : tunnels) {
+        const int64_t tunnelHandle = tunnel.first;
+        const std::string& tunnelId = tunnel.second;
+        const uint64_t packetsIn = tunnel_packets_in(tunnelHandle);
+        const int64_t flows = tunnel_priority(tunnelId);
+        const int64_t delay = scheduler.schedule(tunnelId, flows,
+            [tunnelHandle, tunnelId, packetsIn, changedAt] {
+                // A stale handle means the tunnel disconnected while this was queued
+                openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+                if (!pin || !pin.session()) {
+                    return;
+                }
+                const int path = handleNetworkChange(pin.session());
+                if (path >= 0) {
+                    openvpn::NetworkHandoffTracker::instance().begin(
+                        tunnelId, static_cast<openvpn::HandoffPath>(path), packetsIn, changedAt);
+                    LOGI("   Tunnel %s: %s", tunnelId.c_str(),
+                         path == openvpn::HANDOFF_REBIND ? "transport rebound" : "reconnecting");
+                }
+            });
+        LOGI("   Tunnel %s: %lld active flows, moving in %lld ms", tunnelId.c_str(),
+             (long long)flows, (long long)delay);
+    }
+}
+
+/**
+ * Advances tracked handoffs and hands escalations to ReconnectScheduler.
+ * The returned count includes tunnels whose move has not run yet, so the
+ * caller keeps polling until every tunnel has moved and seen data.
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_VpnEngineService_nativePollNetworkHandoffs(
+        JNIEnv *env, jobject thiz) {
+    openvpn::NetworkHandoffTracker& tracker = openvpn::NetworkHandoffTracker::instance();
+    openvpn::ReconnectScheduler& scheduler = openvpn::ReconnectScheduler::instance();
+    const int64_t now = monotonic_ms();
+    
+    std::set<std::string> live;
+    for (const auto& tunnel : tunnel_slots().sessions()) {
+        const int64_t tunnelHandle = tunnel.first;
+        const std::string& tunnelId = tunnel.second;
+        live.insert(tunnelId);
+        switch (tracker.poll(tunnelId, tunnel_packets_in(tunnelHandle), now)) {
+            case openvpn::NetworkHandoffTracker::Poll::ESCALATE:
+                LOGW("Tunnel %s: no data %lld ms after rebind, reconnecting", tunnelId.c_str(),
+                     (long long)openvpn::NetworkHandoffTracker::DEFAULT_REBIND_DEADLINE_MS);
+                // A repeat attempt for the tunnel, so it waits out a jittered backoff
+                scheduler.schedule(tunnelId, tunnel_priority(tunnelId), [tunnelHandle] {
+                    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+                    if (pin && pin.session()) {
+                        reconnectSession(pin.session());
+                    }
+                });
+                break;
+            case openvpn::NetworkHandoffTracker::Poll::ABANDONED:
+                LOGW("Tunnel %s: no data after network change, giving up tracking", tunnelId.c_str());
+                break;
+            default:
+                break;
         }
     }
+    tracker.retain(live);
+    return static_cast<jint>(tracker.pending() + scheduler.pending());
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_com_multiregionvpn_core_VpnEngineService_nativeGetNetworkHandoffStats(
+        JNIEnv *env, jobject thiz) {
+    std::vector<int64_t> values = openvpn::NetworkHandoffTracker::instance().pack();
+    std::vector<jlong> packed(values.begin(), values.end());
     
-    LOGI("✅ JNI: Network change handling complete");
+    jlongArray result = env->NewLongArray(static_cast<jsize>(packed.size()));
+    if (result) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(packed.size()), packed.data());
+    }
+    return result;
 }
 
+// Bytes queued on a socket: SIOCINQ = unread by this end, SIOCOUTQ = unread by the peer
+static int64_t socket_queue_bytes(int fd, unsigned long request) {
+    int bytes = 0;
+    if (fd < 0 || ioctl(fd, request, &bytes) != 0) {
+        return 0;
+    }
+    return bytes;
+}
+
+/**
+ * Returns the packed per-tunnel counters described by openvpn::TunnelStatsField,
+ * or null if the tunnel handle is stale. Cheap enough to poll: an indexed slot
+ * pin, relaxed loads, and up to four ioctl() calls; no string marshalling.
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeGetTunnelStats(
+        JNIEnv *env, jclass clazz, jlong tunnelHandle) {
+    
+    openvpn::TunnelSlotTable::Pin pin = tunnel_slots().pin(tunnelHandle);
+    openvpn::TunnelStats* stats = pin ? pin.stats() : nullptr;
+    if (!stats) {
+        return nullptr;
+    }
+    
+    jlong packed[openvpn::STAT_FIELD_COUNT];
+    int64_t values[openvpn::STAT_FIELD_COUNT];
+    stats->pack(values);
+    
+    // CustomTunClient socketpair: lib_fd is OpenVPN's end
+    int lib_fd = stats->lib_fd.load(std::memory_order_relaxed);
+    values[openvpn::STAT_LIB_FD_INQ_BYTES] = socket_queue_bytes(lib_fd, SIOCINQ);
+    values[openvpn::STAT_LIB_FD_OUTQ_BYTES] = socket_queue_bytes(lib_fd, SIOCOUTQ);
+    
+    // createPipe() socketpair: Kotlin end
+    const int kotlin_fd = pin.kotlin_fd();
+    values[openvpn::STAT_BRIDGE_INQ_BYTES] = socket_queue_bytes(kotlin_fd, SIOCINQ);
+    values[openvpn::STAT_BRIDGE_OUTQ_BYTES] = socket_queue_bytes(kotlin_fd, SIOCOUTQ);
+    
+    for (size_t i = 0; i < openvpn::STAT_FIELD_COUNT; ++i) {
+        packed[i] = static_cast<jlong>(values[i]);
+    }
+    
+    jlongArray result = env->NewLongArray(openvpn::STAT_FIELD_COUNT);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, openvpn::STAT_FIELD_COUNT, packed);
+    }
+    return result;
+}
+
+/**
+ * Returns the recent connect timelines for tunnelId (every tunnel if null) in the
+ * layout described by openvpn::ConnectTimelineField.
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeGetConnectTimelines(
+        JNIEnv *env, jclass clazz, jstring tunnelId) {
+    
+    std::string id;
+    if (tunnelId) {
+        const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
+        if (!tunnelIdStr) {
+            return nullptr;
+        }
+        id = tunnelIdStr;
+        env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+    }
+    
+    std::vector<int64_t> values = openvpn::ConnectTimelineRing::instance().pack(id);
+    std::vector<jlong> packed(values.begin(), values.end());
+    
+    jlongArray result = env->NewLongArray(static_cast<jsize>(packed.size()));
+    if (result) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(packed.size()), packed.data());
+    }
+    return result;
+}
+
+/**
+ * Persists resolved server addresses in path so cold starts connect without DNS
+ */
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_vpnclient_NativeOpenVpnClient_nativeSetEndpointCacheFile(
+        JNIEnv *env, jclass clazz, jstring path) {
+    
+    std::string file;
+    if (path) {
+        const char* pathStr = env->GetStringUTFChars(path, nullptr);
+        if (!pathStr) {
+            return;
+        }
+        file = pathStr;
+        env->ReleaseStringUTFChars(path, pathStr);
+    }
+    openvpn::EndpointCache& cache = openvpn::EndpointCache::instance();
+    cache.set_storage_path(file);
+    LOGI("Endpoint cache file: %s (%zu hosts)", file.empty() ? "(memory only)" : file.c_str(), cache.size());
+}
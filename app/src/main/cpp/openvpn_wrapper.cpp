@@ -12,11 +12,27 @@
 #include <unistd.h>  // For write()
 #include <errno.h>   // For errno
 
+#include "logging_config.h"
+#include "connection_lifecycle.h"
+#include "connect_timeline.h"
+#include "io_lane_pool.h"
+#include "thread_placement.h"
+#include "profile_cache.h"
+#include "endpoint_cache.h"
+#include "jni_bridge.h"
+#include "network_handoff.h"
+
 #define LOG_TAG "OpenVPN-Wrapper"
+// Tag this file's LOGI/LOGE with LOG_TAG rather than logging_config.h's generic tag
+#undef LOGI
+#undef LOGE
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 #define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
 
+// How long disconnect waits for the connection thread to leave connect() before detaching it
+static constexpr int DISCONNECT_TIMEOUT_MS = 5000;
+
 // OpenVPN 3 API includes
 #ifdef OPENVPN3_AVAILABLE
 // CRITICAL: Include system headers that OpenVPN 3 expects to be available
@@ -224,46 +240,10 @@ public:
     virtual void on_ip_assigned(const std::string& tunnel_id, const std::string& ip, int prefix_len) override {
         LOGI("✅ on_ip_assigned callback: tunnel=%s, ip=%s/%d", tunnel_id.c_str(), ip.c_str(), prefix_len);
         
-        // Forward to Android callbacks if available
-        if (!destroying_ && ipAddressCallback_ && sessionJavaVM_ && !tunnel_id.empty()) {
-            JNIEnv* env = nullptr;
-            jint result = sessionJavaVM_->GetEnv((void**)&env, JNI_VERSION_1_6);
-            if (result == JNI_EDETACHED) {
-                result = sessionJavaVM_->AttachCurrentThread(&env, nullptr);
-                if (result != JNI_OK || env == nullptr) {
-                    LOGW("Cannot attach thread to JNI for IP callback");
-                    return;
-                }
-            } else if (result != JNI_OK || env == nullptr) {
-                LOGW("Cannot get JNIEnv for IP callback");
-                return;
-            }
-            
-            jclass callbackClass = env->GetObjectClass(ipAddressCallback_);
-            if (callbackClass) {
-                jmethodID methodId = env->GetMethodID(callbackClass, "onTunnelIpReceived", 
-                    "(Ljava/lang/String;Ljava/lang/String;I)V");
-                if (methodId) {
-                    jstring tunnelIdStr = env->NewStringUTF(tunnel_id.c_str());
-                    jstring ipStr = env->NewStringUTF(ip.c_str());
-                    
-                    env->CallVoidMethod(ipAddressCallback_, methodId, tunnelIdStr, ipStr, prefix_len);
-                    
-                    if (env->ExceptionCheck()) {
-                        env->ExceptionDescribe();
-                        env->ExceptionClear();
-                    }
-                    
-                    env->DeleteLocalRef(tunnelIdStr);
-                    env->DeleteLocalRef(ipStr);
-                    env->DeleteLocalRef(callbackClass);
-                    
-                    LOGI("✅ Notified Kotlin about tunnel IP: tunnel=%s, ip=%s/%d", 
-                         tunnel_id.c_str(), ip.c_str(), prefix_len);
-                } else {
-                    LOGW("Cannot find onTunnelIpReceived method in callback");
-                    env->DeleteLocalRef(callbackClass);
-                }
+        // Forward to Kotlin on the callback dispatcher thread
+        if (!destroying_ && ipAddressCallback_ && !tunnel_id.empty()) {
+            if (!openvpn::JniBridge::instance().post_ip_received(ipAddressCallback_, tunnel_id, ip, prefix_len)) {
+                LOGW("Cannot queue IP callback for tunnel %s", tunnel_id.c_str());
             }
         }
     }
@@ -272,60 +252,10 @@ public:
     virtual void on_dns_configured(const std::string& tunnel_id, const std::vector<std::string>& dns_servers) override {
         LOGI("✅ on_dns_configured callback: tunnel=%s, dns_count=%zu", tunnel_id.c_str(), dns_servers.size());
         
-        // Forward to Android callbacks if available
-        if (!destroying_ && dnsCallback_ && sessionJavaVM_ && !tunnel_id.empty() && !dns_servers.empty()) {
-            JNIEnv* env = nullptr;
-            jint result = sessionJavaVM_->GetEnv((void**)&env, JNI_VERSION_1_6);
-            if (result == JNI_EDETACHED) {
-                result = sessionJavaVM_->AttachCurrentThread(&env, nullptr);
-                if (result != JNI_OK || env == nullptr) {
-                    LOGW("Cannot attach thread to JNI for DNS callback");
-                    return;
-                }
-            } else if (result != JNI_OK || env == nullptr) {
-                LOGW("Cannot get JNIEnv for DNS callback");
-                return;
-            }
-            
-            jclass callbackClass = env->GetObjectClass(dnsCallback_);
-            if (callbackClass) {
-                // Create ArrayList for DNS servers
-                jclass arrayListClass = env->FindClass("java/util/ArrayList");
-                jmethodID arrayListInit = env->GetMethodID(arrayListClass, "<init>", "(I)V");
-                jmethodID arrayListAdd = env->GetMethodID(arrayListClass, "add", "(Ljava/lang/Object;)Z");
-                
-                jobject dnsList = env->NewObject(arrayListClass, arrayListInit, (jint)dns_servers.size());
-                
-                for (const auto& dns : dns_servers) {
-                    jstring dnsStr = env->NewStringUTF(dns.c_str());
-                    env->CallBooleanMethod(dnsList, arrayListAdd, dnsStr);
-                    env->DeleteLocalRef(dnsStr);
-                }
-                
-                jmethodID methodId = env->GetMethodID(callbackClass, "onTunnelDnsReceived", 
-                    "(Ljava/lang/String;Ljava/util/List;)V");
-                if (methodId) {
-                    jstring tunnelIdStr = env->NewStringUTF(tunnel_id.c_str());
-                    
-                    env->CallVoidMethod(dnsCallback_, methodId, tunnelIdStr, dnsList);
-                    
-                    if (env->ExceptionCheck()) {
-                        env->ExceptionDescribe();
-                        env->ExceptionClear();
-                    }
-                    
-                    env->DeleteLocalRef(tunnelIdStr);
-                    env->DeleteLocalRef(dnsList);
-                    env->DeleteLocalRef(arrayListClass);
-                    env->DeleteLocalRef(callbackClass);
-                    
-                    LOGI("✅ Notified Kotlin about tunnel DNS: tunnel=%s", tunnel_id.c_str());
-                } else {
-                    LOGW("Cannot find onTunnelDnsReceived method in callback");
-                    env->DeleteLocalRef(dnsList);
-                    env->DeleteLocalRef(arrayListClass);
-                    env->DeleteLocalRef(callbackClass);
-                }
+        // Forward to Kotlin on the callback dispatcher thread
+        if (!destroying_ && dnsCallback_ && !tunnel_id.empty() && !dns_servers.empty()) {
+            if (!openvpn::JniBridge::instance().post_dns_received(dnsCallback_, tunnel_id, dns_servers)) {
+                LOGW("Cannot queue DNS callback for tunnel %s", tunnel_id.c_str());
             }
         }
     }
@@ -352,8 +282,40 @@ public:
         customTunClientFactory_ = nullptr;
         factoryCreated_ = false;
     }
+    
+    // Implement CustomTunCallback::on_transport_started
+    virtual void on_transport_started(const std::string& tunnel_id, const openvpn::TransportTraits& traits) override {
+        LOGI("Transport started: tunnel=%s, udp=%d, peer-id=%d", tunnel_id.c_str(), traits.udp, traits.peer_id);
+        std::lock_guard<std::mutex> lock(transportMutex_);
+        transportTraits_ = traits;
+    }
+    
+    // Implement CustomTunCallback::on_transport_stopped
+    virtual void on_transport_stopped(const std::string& tunnel_id) override {
+        LOGI("Transport stopped: tunnel=%s", tunnel_id.c_str());
+        clearTransport();
+    }
 #endif
     
+    // Traits of the current transport (empty until the tunnel starts and after it stops)
+    openvpn::TransportTraits transportTraits() const {
+        std::lock_guard<std::mutex> lock(transportMutex_);
+        return transportTraits_;
+    }
+    
+    // Most recently protected transport socket, or -1 once that transport is torn down
+    int transportFd() const {
+        return transportFd_.load(std::memory_order_acquire);
+    }
+    
+    // OpenVPN closes the transport socket on teardown and the fd number can be
+    // reused by an unrelated socket, so a handoff must not rebind it afterwards
+    void clearTransport() {
+        transportFd_.store(-1, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(transportMutex_);
+        transportTraits_ = openvpn::TransportTraits();
+    }
+    
 private:
     JavaVM* javaVM_;  // JavaVM for getting JNIEnv in any thread
     jobject vpnBuilder_;  // Android VpnService.Builder instance (global ref)
@@ -368,6 +330,11 @@ private:
     std::string tunnelId_;  // Tunnel ID from session
     std::atomic<bool> destroying_;  // Flag to prevent callback access during destruction
     
+    // Transport socket and traits for rebinding after a network change
+    std::atomic<int> transportFd_{-1};
+    mutable std::mutex transportMutex_;
+    openvpn::TransportTraits transportTraits_;
+    
 #ifdef OPENVPN_EXTERNAL_TUN_FACTORY
     // Store the custom TUN client factory for app FD retrieval
     // NOTE: This is a NON-OWNING pointer - OpenVPN 3 owns the factory and will delete it
@@ -378,6 +345,12 @@ private:
     // Helper to set connected flag - implemented after OpenVpnSession definition
     void setConnectedFromEvent();
     
+    // Feeds event() into the session's lifecycle state machine - implemented after OpenVpnSession definition
+    void updateLifecycleFromEvent(const Event &evt);
+    
+    // Stores the server address of a successful connect in EndpointCache - implemented after OpenVpnSession definition
+    void recordConnectedEndpoint();
+    
     // Implement LogReceiver::log
     virtual void log(const LogInfo &log_info) override {
         // Log everything with appropriate level
@@ -409,6 +382,8 @@ private:
             "Event details: name=%s, error=%d, fatal=%d, info=%s",
             evt.name.c_str(), evt.error, evt.fatal, evt.info.c_str());
         
+        updateLifecycleFromEvent(evt);
+        
         // Handle specific events to track PUSH_REPLY flow
         if (evt.name == "CONNECTED") {
             LOGI("✅ OpenVPN connection established");
@@ -416,8 +391,13 @@ private:
             // Using atomic<bool> so we can set it from event handler without mutex
             // This allows isConnected() to return true as soon as connection is established
             setConnectedFromEvent();
+            recordConnectedEndpoint();
         } else if (evt.name == "DISCONNECTED") {
             LOGI("OpenVPN disconnected: %s", evt.info.c_str());
+            clearTransport();
+        } else if (evt.name == "RECONNECTING") {
+            // The next attempt protects a new socket; the current one is about to close
+            clearTransport();
         } else if (evt.name == "PUSH_REQUEST") {
             LOGI("📤 Client sent PUSH_REQUEST to server (requesting configuration)");
         } else if (evt.name == "PUSH_REPLY") {
@@ -514,59 +494,16 @@ private:
         LOGI("tun_builder_add_address: %s/%d (ipv6=%s, gateway=%s)", 
              address.c_str(), prefix_length, ipv6 ? "true" : "false", gateway.c_str());
         
-        // Notify Kotlin about the IP address via callback
-        // Use stored callback info from session (set via setSession/updateSessionCallbackInfo)
+        // Notify Kotlin about the IP address via the callback dispatcher
         // Check destroying_ flag to prevent accessing deleted callbacks during cleanup
-        if (!destroying_ && ipAddressCallback_ && sessionJavaVM_ && !tunnelId_.empty()) {
-            JNIEnv* env = nullptr;
-            jint result = sessionJavaVM_->GetEnv((void**)&env, JNI_VERSION_1_6);
-            if (result == JNI_EDETACHED) {
-                // Thread not attached - attach it
-                result = sessionJavaVM_->AttachCurrentThread(&env, nullptr);
-                if (result != JNI_OK || env == nullptr) {
-                    LOGW("Cannot attach thread to JNI for IP callback");
-                    return true;
-                }
-            } else if (result != JNI_OK || env == nullptr) {
-                LOGW("Cannot get JNIEnv for IP callback");
-                return true;
-            }
-            
-            // Call callback method: onTunnelIpReceived(tunnelId: String, ip: String, prefixLength: Int)
-            // The callback object should implement an interface with this method
-            jclass callbackClass = env->GetObjectClass(ipAddressCallback_);
-            if (callbackClass) {
-                jmethodID methodId = env->GetMethodID(callbackClass, "onTunnelIpReceived", 
-                    "(Ljava/lang/String;Ljava/lang/String;I)V");
-                if (methodId) {
-                    jstring tunnelIdStr = env->NewStringUTF(tunnelId_.c_str());
-                    jstring ipStr = env->NewStringUTF(address.c_str());
-                    
-                    env->CallVoidMethod(ipAddressCallback_, methodId, 
-                        tunnelIdStr, ipStr, prefix_length);
-                    
-                    // Check for exceptions
-                    if (env->ExceptionCheck()) {
-                        env->ExceptionDescribe();
-                        env->ExceptionClear();
-                    }
-                    
-                    env->DeleteLocalRef(tunnelIdStr);
-                    env->DeleteLocalRef(ipStr);
-                    env->DeleteLocalRef(callbackClass);
-                    
-                    LOGI("✅ Notified Kotlin about tunnel IP: tunnelId=%s, ip=%s/%d", 
-                         tunnelId_.c_str(), address.c_str(), prefix_length);
-                } else {
-                    LOGW("Cannot find onTunnelIpReceived method in callback");
-                    env->DeleteLocalRef(callbackClass);
-                }
-            } else {
-                LOGW("Cannot get callback class");
+        if (!destroying_ && ipAddressCallback_ && !tunnelId_.empty()) {
+            if (!openvpn::JniBridge::instance().post_ip_received(ipAddressCallback_, tunnelId_,
+                                                                 address, prefix_length)) {
+                LOGW("Cannot queue IP callback for tunnel %s", tunnelId_.c_str());
             }
         } else {
-            LOGW("⚠️  IP address callback not set - cannot notify Kotlin (callback=%p, javaVM=%p, tunnelId=%s)", 
-                 ipAddressCallback_, sessionJavaVM_, tunnelId_.c_str());
+            LOGW("⚠️  IP address callback not set - cannot notify Kotlin (callback=%p, tunnelId=%s)", 
+                 ipAddressCallback_, tunnelId_.c_str());
         }
         
         // For Android, we use the already-established VpnService interface
@@ -608,72 +545,15 @@ private:
                 }
             }
             
-            // Notify Kotlin about DNS servers via callback
+            // Notify Kotlin about DNS servers via the callback dispatcher
             // Check destroying_ flag to prevent accessing deleted callbacks during cleanup
-            if (!destroying_ && dnsCallback_ && sessionJavaVM_ && !tunnelId_.empty() && !dnsAddresses.empty()) {
-                JNIEnv* env = nullptr;
-                jint result = sessionJavaVM_->GetEnv((void**)&env, JNI_VERSION_1_6);
-                if (result == JNI_EDETACHED) {
-                    // Thread not attached - attach it
-                    result = sessionJavaVM_->AttachCurrentThread(&env, nullptr);
-                    if (result != JNI_OK || env == nullptr) {
-                        LOGW("Cannot attach thread to JNI for DNS callback");
-                        return true;
-                    }
-                } else if (result != JNI_OK || env == nullptr) {
-                    LOGW("Cannot get JNIEnv for DNS callback");
-                    return true;
-                }
-                
-                // Call callback method: onTunnelDnsReceived(tunnelId: String, dnsServers: List<String>)
-                jclass callbackClass = env->GetObjectClass(dnsCallback_);
-                if (callbackClass) {
-                    // Create ArrayList for DNS servers
-                    jclass arrayListClass = env->FindClass("java/util/ArrayList");
-                    jmethodID arrayListInit = env->GetMethodID(arrayListClass, "<init>", "(I)V");
-                    jmethodID arrayListAdd = env->GetMethodID(arrayListClass, "add", "(Ljava/lang/Object;)Z");
-                    
-                    jobject dnsList = env->NewObject(arrayListClass, arrayListInit, (jint)dnsAddresses.size());
-                    
-                    // Add each DNS server to the list
-                    for (const auto &dnsAddr : dnsAddresses) {
-                        jstring dnsStr = env->NewStringUTF(dnsAddr.c_str());
-                        env->CallBooleanMethod(dnsList, arrayListAdd, dnsStr);
-                        env->DeleteLocalRef(dnsStr);
-                    }
-                    
-                    // Call the callback method
-                    jmethodID methodId = env->GetMethodID(callbackClass, "onTunnelDnsReceived", 
-                        "(Ljava/lang/String;Ljava/util/List;)V");
-                    if (methodId) {
-                        jstring tunnelIdStr = env->NewStringUTF(tunnelId_.c_str());
-                        
-                        env->CallVoidMethod(dnsCallback_, methodId, tunnelIdStr, dnsList);
-                        
-                        // Check for exceptions
-                        if (env->ExceptionCheck()) {
-                            env->ExceptionDescribe();
-                            env->ExceptionClear();
-                        }
-                        
-                        env->DeleteLocalRef(tunnelIdStr);
-                        env->DeleteLocalRef(dnsList);
-                        env->DeleteLocalRef(callbackClass);
-                        env->DeleteLocalRef(arrayListClass);
-                        
-                        LOGI("✅ Notified Kotlin about DNS servers: tunnelId=%s, count=%zu", 
-                             tunnelId_.c_str(), dnsAddresses.size());
-                    } else {
-                        LOGW("Cannot find onTunnelDnsReceived method in callback");
-                        env->DeleteLocalRef(dnsList);
-                        env->DeleteLocalRef(callbackClass);
-                    }
-                } else {
-                    LOGW("Cannot get callback class");
+            if (!destroying_ && dnsCallback_ && !tunnelId_.empty() && !dnsAddresses.empty()) {
+                if (!openvpn::JniBridge::instance().post_dns_received(dnsCallback_, tunnelId_, dnsAddresses)) {
+                    LOGW("Cannot queue DNS callback for tunnel %s", tunnelId_.c_str());
                 }
             } else {
-                LOGW("⚠️  DNS callback not set - cannot notify Kotlin (callback=%p, javaVM=%p, tunnelId=%s)", 
-                     dnsCallback_, sessionJavaVM_, tunnelId_.c_str());
+                LOGW("⚠️  DNS callback not set - cannot notify Kotlin (callback=%p, tunnelId=%s)", 
+                     dnsCallback_, tunnelId_.c_str());
             }
             
             if (!dnsAddresses.empty()) {
@@ -722,84 +602,19 @@ private:
     
     // Helper function to protect a socket file descriptor
     bool protectSocket(int socket_fd) {
-        // We need to call VpnService.protect(socket_fd) from Java
-        // Since we have JavaVM, we can get JNIEnv and call the method
-        if (javaVM_ == nullptr) {
-            LOGW("JavaVM is null, cannot protect socket");
-            return false;
-        }
-        
-        JNIEnv* env = nullptr;
-        jint result = javaVM_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
-        if (result == JNI_EDETACHED) {
-            // Thread not attached - attach it
-            result = javaVM_->AttachCurrentThread(&env, nullptr);
-            if (result != JNI_OK || env == nullptr) {
-                LOGW("Cannot attach thread to JNI to protect socket");
-                return false;
-            }
-        } else if (result != JNI_OK || env == nullptr) {
-            LOGW("Cannot get JNIEnv to protect socket");
-            return false;
-        }
-        
-        // Get VpnService class
-        jclass vpnServiceClass = env->FindClass("android/net/VpnService");
-        if (vpnServiceClass == nullptr) {
-            LOGW("Cannot find VpnService class");
-            return false;
-        }
-        
-        // CRITICAL: VpnService.protect() is an INSTANCE method, not static!
-        // We need a VpnService instance to call it on
+        // VpnService.protect() is an instance method; the class and method IDs
+        // are resolved once by JniBridge
         if (vpnService_ == nullptr) {
             LOGW("VpnService instance is null, cannot protect socket");
-            env->DeleteLocalRef(vpnServiceClass);
-            return false;
-        }
-        
-        // Get protect() method: public boolean protect(int socket) - instance method
-        jmethodID protectMethod = env->GetMethodID(
-            vpnServiceClass,
-            "protect",
-            "(I)Z"
-        );
-        
-        if (protectMethod == nullptr) {
-            // Try to get error message
-            jthrowable exc = env->ExceptionOccurred();
-            if (exc) {
-                env->ExceptionClear();
-                LOGW("Cannot find VpnService.protect() instance method");
-            } else {
-                LOGW("Cannot find VpnService.protect() instance method - no exception");
-            }
-            if (exc) env->DeleteLocalRef(exc);
-            env->DeleteLocalRef(vpnServiceClass);
-            return false;
-        }
-        
-        // Call vpnService_.protect(socket_fd) - instance method call
-        jboolean protectResult = env->CallBooleanMethod(vpnService_, protectMethod, socket_fd);
-        
-        // Check for exceptions
-        if (env->ExceptionCheck()) {
-            jthrowable exc = env->ExceptionOccurred();
-            env->ExceptionClear();
-            LOGW("Exception calling VpnService.protect(): %p", exc);
-            env->DeleteLocalRef(exc);
-            env->DeleteLocalRef(vpnServiceClass);
             return false;
         }
-        env->DeleteLocalRef(vpnServiceClass);
         
-        if (protectResult) {
+        if (openvpn::JniBridge::instance().protect_socket(vpnService_, socket_fd)) {
             LOGI("✅ Successfully protected socket FD %d from VPN interface", socket_fd);
             return true;
-        } else {
-            LOGW("Failed to protect socket FD %d", socket_fd);
-            return false;
         }
+        LOGW("Failed to protect socket FD %d", socket_fd);
+        return false;
     }
     
     // CRITICAL: Implement socket_protect() from OpenVPNClient interface
@@ -813,9 +628,19 @@ private:
         LOGI("socket_protect() converting socket to FD: %d", socket_fd);
         
         // Protect the socket from being routed through VPN interface
-        return protectSocket(socket_fd);
+        if (!protectSocket(socket_fd)) {
+            return false;
+        }
+        // OpenVPN opens a new transport socket per connect attempt; the latest is live
+        transportFd_.store(socket_fd, std::memory_order_release);
+        return true;
     }
     
+    // Connect attempts come from the session's EndpointPlan, so a cached server
+    // address skips DNS - implemented after OpenVpnSession definition
+    virtual bool remote_override_enabled() override;
+    virtual void remote_override(RemoteOverride &ro) override;
+    
     virtual int tun_builder_establish() override {
         LOGI("═══════════════════════════════════════════════════════");
         LOGI("🔧 tun_builder_establish() called by OpenVPN 3");
@@ -850,6 +675,8 @@ struct OpenVpnSession {
     bool connecting;  // True when connect() is running but not yet complete
     std::string last_error;
     std::string tunnelId;  // Tunnel ID for identifying which tunnel this session belongs to
+    openvpn::ThreadPlacementConfig placement;  // Applied to connection_thread
+    openvpn::EndpointPlan endpoints;  // Remotes from the profile, tried at cached addresses first
     
 #ifdef OPENVPN3_AVAILABLE
     AndroidOpenVPNClient* androidClient;  // For accessing Android-specific methods
@@ -858,6 +685,8 @@ struct OpenVpnSession {
     ProvideCreds creds;
     std::thread connection_thread;
     std::mutex state_mutex;
+    openvpn::ConnectionLifecycle lifecycle;  // Event-driven state; connect/disconnect wait on it
+    jobject stateCallback;  // Global reference to Kotlin TunnelStateCallback
     std::atomic<bool> should_stop;
     ConnectionInfo connection_info;
     
@@ -874,7 +703,7 @@ struct OpenVpnSession {
     
     // Note: No separate tunFactory needed - AndroidOpenVPNClient implements ExternalTun::Factory
     
-    OpenVpnSession() : connected(false), connecting(false), androidClient(nullptr), client(nullptr), should_stop(false), ipAddressCallback(nullptr), dnsCallback(nullptr), javaVM(nullptr) {
+    OpenVpnSession() : connected(false), connecting(false), androidClient(nullptr), client(nullptr), should_stop(false), stateCallback(nullptr), ipAddressCallback(nullptr), dnsCallback(nullptr), javaVM(nullptr) {
         // atomic<bool> is initialized with false above
         // Initialize Android-specific OpenVPN 3 Client - This implements all required virtual methods
         androidClient = new AndroidOpenVPNClient();
@@ -906,6 +735,7 @@ struct OpenVpnSession {
         if (connection_thread.joinable()) {
             connection_thread.join();
         }
+        lifecycle.clear_listener();
         
         // Delete client FIRST - this sets destroying_ flag preventing callback access
         // and ensures OpenVPN 3 stops processing events
@@ -915,31 +745,15 @@ struct OpenVpnSession {
             client = nullptr;
         }
         
-        // Brief delay to ensure any in-flight JNI calls complete
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        // Now safe to clean up JNI callback references
-        if (ipAddressCallback && javaVM) {
-            JNIEnv* env = nullptr;
-            if (javaVM->GetEnv((void**)&env, JNI_VERSION_1_6) == JNI_OK) {
-                env->DeleteGlobalRef(ipAddressCallback);
-            } else if (javaVM->AttachCurrentThread(&env, nullptr) == JNI_OK) {
-                env->DeleteGlobalRef(ipAddressCallback);
-                javaVM->DetachCurrentThread();
-            }
-            ipAddressCallback = nullptr;
-        }
-        
-        if (dnsCallback && javaVM) {
-            JNIEnv* env = nullptr;
-            if (javaVM->GetEnv((void**)&env, JNI_VERSION_1_6) == JNI_OK) {
-                env->DeleteGlobalRef(dnsCallback);
-            } else if (javaVM->AttachCurrentThread(&env, nullptr) == JNI_OK) {
-                env->DeleteGlobalRef(dnsCallback);
-                javaVM->DetachCurrentThread();
-            }
-            dnsCallback = nullptr;
-        }
+        // Callbacks already queued on the dispatcher may still use these refs;
+        // release_global_ref() deletes them after those callbacks have run
+        openvpn::JniBridge& bridge = openvpn::JniBridge::instance();
+        bridge.release_global_ref(ipAddressCallback);
+        bridge.release_global_ref(dnsCallback);
+        bridge.release_global_ref(stateCallback);
+        ipAddressCallback = nullptr;
+        dnsCallback = nullptr;
+        stateCallback = nullptr;
     }
 #else
     void* client; // Placeholder until OpenVPN 3 is integrated
@@ -969,6 +783,56 @@ void AndroidOpenVPNClient::setConnectedFromEvent() {
     }
 }
 
+void AndroidOpenVPNClient::updateLifecycleFromEvent(const Event &evt) {
+    if (!session_ || destroying_) {
+        return;
+    }
+    if (!session_->tunnelId.empty()) {
+        openvpn::ConnectTimelineRing::instance().on_event(session_->tunnelId, evt.name, evt.fatal);
+    }
+    if (session_->lifecycle.on_event(evt.name, evt.fatal)) {
+        const openvpn::LifecycleState state = session_->lifecycle.state();
+        if (state == openvpn::LifecycleState::CONNECTED) {
+            LOGI("Lifecycle -> CONNECTED (connect latency %lld ms)",
+                 (long long)session_->lifecycle.connect_latency_ms());
+        } else {
+            LOGI("Lifecycle -> %s", openvpn::lifecycle_state_name(state));
+        }
+    }
+}
+
+void AndroidOpenVPNClient::recordConnectedEndpoint() {
+    if (!session_ || destroying_ || session_->endpoints.empty()) {
+        return;
+    }
+    const std::string serverIp = connection_info().serverIp;
+    session_->endpoints.on_connected(openvpn::EndpointCache::instance(), serverIp);
+    LOGI("Connected to %s; endpoint cache holds %zu hosts", serverIp.c_str(),
+         openvpn::EndpointCache::instance().size());
+}
+
+bool AndroidOpenVPNClient::remote_override_enabled() {
+    return session_ && !session_->endpoints.empty();
+}
+
+void AndroidOpenVPNClient::remote_override(RemoteOverride &ro) {
+    openvpn::EndpointAttempt attempt;
+    if (!session_ || !session_->endpoints.next(openvpn::EndpointCache::instance(), attempt)) {
+        ro.error = "no remote to connect to";
+        return;
+    }
+    ro.host = attempt.host;
+    ro.ip = attempt.ip;
+    ro.port = attempt.port;
+    ro.proto = attempt.proto;
+    if (attempt.cached) {
+        LOGI("Connecting to %s at cached address %s (%s/%s)", attempt.host.c_str(), attempt.ip.c_str(),
+             attempt.port.c_str(), attempt.proto.c_str());
+    } else {
+        LOGI("Connecting to %s via DNS (%s/%s)", attempt.host.c_str(), attempt.port.c_str(), attempt.proto.c_str());
+    }
+}
+
 // Implement AndroidOpenVPNClient::setSession() after OpenVpnSession definition
 void AndroidOpenVPNClient::setSession(OpenVpnSession* session) {
     session_ = session;
@@ -1032,13 +896,8 @@ void openvpn_wrapper_set_tunnel_id_and_callback(OpenVpnSession* session,
     
     // Set IP callback (global reference so it persists)
     if (ipCallback) {
-        if (session->ipAddressCallback) {
-            // Delete old callback if exists
-            JNIEnv* currentEnv = nullptr;
-            if (session->javaVM->GetEnv((void**)&currentEnv, JNI_VERSION_1_6) == JNI_OK) {
-                currentEnv->DeleteGlobalRef(session->ipAddressCallback);
-            }
-        }
+        // Release the old callback after any notification already queued for it
+        openvpn::JniBridge::instance().release_global_ref(session->ipAddressCallback);
         session->ipAddressCallback = env->NewGlobalRef(ipCallback);
         LOGI("IP address callback set for tunnel: %s", tunnelId ? tunnelId : "unknown");
     } else {
@@ -1047,13 +906,7 @@ void openvpn_wrapper_set_tunnel_id_and_callback(OpenVpnSession* session,
     
     // Set DNS callback (global reference so it persists)
     if (dnsCallback) {
-        if (session->dnsCallback) {
-            // Delete old callback if exists
-            JNIEnv* currentEnv = nullptr;
-            if (session->javaVM->GetEnv((void**)&currentEnv, JNI_VERSION_1_6) == JNI_OK) {
-                currentEnv->DeleteGlobalRef(session->dnsCallback);
-            }
-        }
+        openvpn::JniBridge::instance().release_global_ref(session->dnsCallback);
         session->dnsCallback = env->NewGlobalRef(dnsCallback);
         LOGI("DNS callback set for tunnel: %s", tunnelId ? tunnelId : "unknown");
     } else {
@@ -1070,6 +923,39 @@ void openvpn_wrapper_set_tunnel_id_and_callback(OpenVpnSession* session,
 #endif
 }
 
+void openvpn_wrapper_set_state_callback(OpenVpnSession* session,
+                                        JNIEnv* env,
+                                        jobject stateCallback) {
+#ifdef OPENVPN3_AVAILABLE
+    if (!session || !stateCallback) {
+        LOGE("Invalid session or callback for set_state_callback");
+        return;
+    }
+    if (!session->javaVM) {
+        env->GetJavaVM(&session->javaVM);
+    }
+    
+    session->lifecycle.clear_listener();
+    openvpn::JniBridge::instance().release_global_ref(session->stateCallback);
+    session->stateCallback = env->NewGlobalRef(stateCallback);
+    
+    // Transitions are queued to the callback dispatcher in order, so the event
+    // thread that caused one never waits on Kotlin
+    jobject callback = session->stateCallback;
+    std::string tunnelId = session->tunnelId;
+    session->lifecycle.set_listener([callback, tunnelId](openvpn::LifecycleState state,
+                                                         int64_t connectLatencyMs) {
+        if (!openvpn::JniBridge::instance().post_state_changed(callback, tunnelId,
+                                                               static_cast<int>(state), connectLatencyMs)) {
+            LOGW("Cannot queue state callback for tunnel %s", tunnelId.c_str());
+        }
+    });
+    LOGI("State callback set for tunnel: %s", tunnelId.c_str());
+#else
+    LOGE("OpenVPN 3 not available - cannot set state callback");
+#endif
+}
+
 // Helper function to set Android-specific parameters
 void openvpn_wrapper_set_android_params(OpenVpnSession* session,
                                         JNIEnv* env,
@@ -1122,10 +1008,11 @@ void openvpn_wrapper_set_android_params(OpenVpnSession* session,
 #endif
 }
 
-OpenVpnSession* openvpn_wrapper_create_session() {
+OpenVpnSession* openvpn_wrapper_create_session(const openvpn::ThreadPlacementConfig* placement) {
     LOGI("Creating OpenVPN session");
     try {
         OpenVpnSession* session = new OpenVpnSession();
+        session->placement = placement ? *placement : openvpn::ThreadPlacement::instance().config();
         return session;
     } catch (const std::exception& e) {
         LOGE("Failed to create session: %s", e.what());
@@ -1157,130 +1044,18 @@ int openvpn_wrapper_connect(OpenVpnSession* session,
         }
         
         // Using OpenVPN 3 ClientAPI - Real service integration
-        // 1. Parse and set OpenVPN config
-        // NordVPN configs use username/password auth, not client certificates
-        // Add client-cert-not-required if not present to prevent "Missing External PKI alias" error
-        // Also remove OpenVPN 3 unsupported options
-        std::string config_content = std::string(config_str);
-        
-        // Remove OpenVPN 3 unsupported options (these are OpenVPN 2.x only)
-        // NOTE: comp-lzo is supported by OpenVPN 3, but we need to handle it properly
-        std::vector<std::string> unsupported_options = {
-            "ping-timer-rem",
-            "remote-random",
-            "fast-io"
-            // "comp-lzo" - REMOVED: OpenVPN 3 supports LZO compression
-        };
-        
-        for (const auto& option : unsupported_options) {
-            // Remove lines containing the unsupported option
-            std::string search_pattern = option;
-            size_t pos = 0;
-            while ((pos = config_content.find(search_pattern, pos)) != std::string::npos) {
-                // Find the start of the line
-                size_t line_start = config_content.rfind('\n', pos);
-                if (line_start == std::string::npos) {
-                    line_start = 0;
-                } else {
-                    line_start++; // Skip the newline
-                }
-                // Find the end of the line
-                size_t line_end = config_content.find('\n', pos);
-                if (line_end == std::string::npos) {
-                    line_end = config_content.length();
-                } else {
-                    line_end++; // Include the newline
-                }
-                // Remove the entire line
-                config_content.erase(line_start, line_end - line_start);
-                pos = line_start; // Continue searching from where we removed
-            }
-        }
-        
-        // CRITICAL: Keep 'auth-user-pass' in config (without file path) to prevent autologin detection
-        // OpenVPN 3 detects autologin when 'auth-user-pass' is missing, which causes:
-        //   - eval.autologin = true
-        //   - xmit_creds = false
-        //   - client_auth() never called
-        //   - Credentials never sent
-        //   - Connection times out
-        // 
-        // By keeping 'auth-user-pass' (without a file path), OpenVPN 3 knows credentials are needed,
-        // but will use provide_creds() for the actual credentials instead of reading from a file.
-        if (config_content.find("auth-user-pass") == std::string::npos) {
-            // Add auth-user-pass without file path - this tells OpenVPN 3 credentials are needed
-            // but we'll provide them via provide_creds() instead of a file
-            config_content += "\nauth-user-pass\n";
-            LOGI("Added 'auth-user-pass' directive (without file path) to prevent autologin detection");
-        } else {
-            // Replace any auth-user-pass with file path to just 'auth-user-pass' (no file)
-            size_t pos = 0;
-            while ((pos = config_content.find("auth-user-pass", pos)) != std::string::npos) {
-                // Find the start of the line
-                size_t line_start = config_content.rfind('\n', pos);
-                if (line_start == std::string::npos) {
-                    line_start = 0;
-                } else {
-                    line_start++; // Skip the newline
-                }
-                // Find the end of the line
-                size_t line_end = config_content.find('\n', pos);
-                if (line_end == std::string::npos) {
-                    line_end = config_content.length();
-                } else {
-                    line_end++; // Include the newline
-                }
-                // Replace with just 'auth-user-pass' (no file path)
-                config_content.replace(line_start, line_end - line_start, "auth-user-pass\n");
-                LOGI("Replaced 'auth-user-pass' with file path to 'auth-user-pass' (using provide_creds() instead)");
-                break;
-            }
-        }
-        
-        if (config_content.find("client-cert-not-required") == std::string::npos) {
-            // Add it before other auth directives or at the end
-            if (config_content.find("auth ") != std::string::npos) {
-                // Insert before auth directive
-                size_t pos = config_content.find("auth ");
-                config_content.insert(pos, "client-cert-not-required\n");
-            } else {
-                // Append at the end
-                config_content += "\nclient-cert-not-required\n";
-            }
-            LOGI("Added 'client-cert-not-required' directive to config");
-        }
-        
-        // Increase verbosity for debugging (verb 5 = very verbose)
-        // Check if verb is already set, and if so, replace it with verb 5
-        // Otherwise, add verb 5
-        std::string verb_pattern = "verb ";
-        size_t verb_pos = config_content.find(verb_pattern);
-        if (verb_pos != std::string::npos) {
-            // Find the line with verb and replace it
-            size_t line_start = config_content.rfind('\n', verb_pos);
-            if (line_start == std::string::npos) {
-                line_start = 0;
-            } else {
-                line_start++; // Skip the newline
-            }
-            size_t line_end = config_content.find('\n', verb_pos);
-            if (line_end == std::string::npos) {
-                line_end = config_content.length();
-            } else {
-                line_end++; // Include the newline
-            }
-            // Replace the verb line with verb 5
-            config_content.replace(line_start, line_end - line_start, "verb 5\n");
-            LOGI("Updated verbosity to verb 5 (very verbose)");
-        } else {
-            // Add verb 5 if not present
-            config_content += "\nverb 5\n";
-            LOGI("Added 'verb 5' directive to config (very verbose logging)");
-        }
-        
-        LOGI("OpenVPN config processed (%zu bytes, removed unsupported options)", config_content.length());
-        
-        session->config.content = config_content;
+        // 1. Normalize the profile for OpenVPN 3 (see config_normalizer.h): drop 2.x-only
+        // options, keep a bare 'auth-user-pass' so credentials come from provide_creds()
+        // rather than autologin, add client-cert-not-required (NordVPN uses
+        // username/password auth) and set verb 5. Known profiles come from ProfileCache.
+        openvpn::ProfileCache& profileCache = openvpn::ProfileCache::instance();
+        openvpn::ProfileCache::Lookup profile = profileCache.normalized(config_str);
+        LOGI("OpenVPN config %s (%zu bytes, key %016llx)",
+             profile.memory_hit ? "from memory cache" : "normalized",
+             profile.content->length(), (unsigned long long)profile.key);
+        
+        session->config.content = *profile.content;
+        session->endpoints = openvpn::EndpointPlan::from_profile(*profile.content);
         session->config.connTimeout = 30;  // Connection timeout in seconds
         session->config.tunPersist = false; // Don't persist TUN interface
         
@@ -1320,8 +1095,23 @@ int openvpn_wrapper_connect(OpenVpnSession* session,
             LOGI("Config preview (first 500 chars): %s", preview.c_str());
         }
         
-        // 2. Evaluate the config using OpenVPN 3 service
+        // 2. Evaluate the config using OpenVPN 3 service. This also loads the profile
+        // into this client instance, so it runs on every connect; only a profile
+        // already known to be invalid is rejected up front.
+        openvpn::ProfileEvalSummary knownEval;
+        if (profileCache.find_eval(profile.key, knownEval) && knownEval.error) {
+            session->last_error = knownEval.message;
+            LOGE("OpenVPN config previously failed evaluation: %s", knownEval.message.c_str());
+            return OPENVPN_ERROR_CONFIG_FAILED;
+        }
+        
         EvalConfig eval = session->client->eval_config(session->config);
+        openvpn::ProfileEvalSummary evalSummary;
+        evalSummary.error = eval.error;
+        evalSummary.autologin = eval.autologin;
+        evalSummary.message = eval.message;
+        evalSummary.profile_name = eval.profileName;
+        profileCache.store_eval(profile.key, evalSummary);
         if (eval.error) {
             session->last_error = eval.message;
             LOGE("OpenVPN config evaluation failed: %s", eval.message.c_str());
@@ -1465,8 +1255,21 @@ int openvpn_wrapper_connect(OpenVpnSession* session,
             session->connecting = true;
             session->connected = false;
         }
+        session->lifecycle.begin_connect();
+        if (!session->tunnelId.empty()) {
+            openvpn::ConnectTimelineRing::instance().begin(session->tunnelId, false);
+        }
         
         session->connection_thread = std::thread([session]() {
+            // This thread runs the session's event loop. A cluster policy owns its
+            // affinity; otherwise it joins a core lane and only its scheduling changes.
+            const bool cluster_policy = session->placement.data_path.cluster != openvpn::CpuCluster::ANY;
+            const int lane = cluster_policy ? -1 : openvpn::IoLanePool::instance().join_current_thread(session->tunnelId);
+            if (lane >= 0) {
+                LOGI("Tunnel %s event loop on IO lane %d", session->tunnelId.c_str(), lane);
+            }
+            const pid_t placement_tid = openvpn::ThreadPlacement::instance().join_current_thread(
+                "ovpn-" + session->tunnelId, openvpn::ThreadRole::DATA_PATH, session->placement, lane < 0);
             try {
                 // CRITICAL: Verify credentials are still valid before connect()
                 // Log credential status to verify they weren't cleared
@@ -1551,30 +1354,14 @@ int openvpn_wrapper_connect(OpenVpnSession* session,
                 session->connected = false;
                 LOGE("Exception in connection thread: %s", e.what());
             }
+            openvpn::IoLanePool::instance().leave(session->tunnelId);
+            openvpn::ThreadPlacement::instance().leave(placement_tid);
+            // The event loop has exited: wake disconnect() and tell Kotlin
+            session->lifecycle.transition(openvpn::LifecycleState::DISCONNECTED);
         });
         
-        // Wait a bit for connection to start, then check status
-        // OpenVPN 3 connect() will call tun_builder_establish() which needs the TUN FD
-        LOGI("Waiting for OpenVPN 3 connection to start...");
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        
-        {
-            std::lock_guard<std::mutex> lock(session->state_mutex);
-            if (session->connected) {
-                LOGI("✅ Connection established immediately!");
-                return OPENVPN_ERROR_SUCCESS;
-            }
-            
-            // Check if there's an error message
-            if (!session->last_error.empty()) {
-                LOGE("Connection error detected: %s", session->last_error.c_str());
-                // Don't return error yet - connection might still be in progress
-            }
-        }
-        
-        // Connection is in progress, return success (connection will complete asynchronously)
+        // Connection completes asynchronously; CONNECTED is pushed through the lifecycle listener
         LOGI("Connection initiated, will complete asynchronously...");
-        LOGI("Note: Connection status will be updated in background thread");
         return OPENVPN_ERROR_SUCCESS;
         
     } catch (const std::exception& e) {
@@ -1601,26 +1388,32 @@ void openvpn_wrapper_disconnect(OpenVpnSession* session) {
     
 #ifdef OPENVPN3_AVAILABLE
     try {
-        std::lock_guard<std::mutex> lock(session->state_mutex);
-        
-        if (session->client && session->connected) {
-            LOGI("Stopping OpenVPN 3 service connection...");
-            session->should_stop = true;
+        {
+            std::lock_guard<std::mutex> lock(session->state_mutex);
             
-            // Stop the OpenVPN 3 service (this will cause connect() to return)
-            session->client->stop();
+            if (session->client && (session->connected || session->connecting)) {
+                LOGI("Stopping OpenVPN 3 service connection...");
+                session->should_stop = true;
+                
+                // Stop the OpenVPN 3 service (this will cause connect() to return)
+                session->client->stop();
+                
+                LOGI("OpenVPN 3 service disconnected");
+            }
             
-            LOGI("OpenVPN 3 service disconnected");
+            session->connected = false;
         }
         
-        session->connected = false;
-        
-        // Wait for connection thread to finish
+        // The connection thread reports DISCONNECTED as soon as connect() returns.
+        // state_mutex is released first because that thread takes it on the way out.
         if (session->connection_thread.joinable()) {
-            // Give it a moment to finish
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            if (session->connection_thread.joinable()) {
-                session->connection_thread.detach(); // Detach if still running
+            const openvpn::LifecycleState state = session->lifecycle.wait_for(
+                openvpn::LifecycleState::DISCONNECTED, std::chrono::milliseconds(DISCONNECT_TIMEOUT_MS));
+            if (state == openvpn::LifecycleState::DISCONNECTED) {
+                session->connection_thread.join();
+            } else {
+                LOGW("Connection thread still running after %d ms - detaching", DISCONNECT_TIMEOUT_MS);
+                session->connection_thread.detach();
             }
         }
     } catch (const std::exception& e) {
@@ -1682,7 +1475,7 @@ int openvpn_wrapper_send_packet(OpenVpnSession* session,
         // writes directly to FIFO. But if we do, just return success (packet will be
         // written to FIFO from Kotlin side).
         
-        LOGI("send_packet() called for tunnel - packet should be written to FIFO from Kotlin");
+        LOG_HOT_PATH(LOG_TAG, "send_packet() called for tunnel - packet should be written to FIFO from Kotlin");
         return 0; // Success (packet will be written to FIFO)
     } catch (const std::exception& e) {
         LOGE("Exception during send_packet: %s", e.what());
@@ -1690,26 +1483,26 @@ int openvpn_wrapper_send_packet(OpenVpnSession* session,
     }
 #else
     // Placeholder: log that we would send the packet
-    LOGI("Would send %zu bytes (placeholder)", len);
+    LOG_HOT_PATH(LOG_TAG, "Would send %zu bytes (placeholder)", len);
     return 0;
 #endif
 }
 
 int openvpn_wrapper_receive_packet(OpenVpnSession* session,
-                                   uint8_t** packet,
+                                   uint8_t* packet,
+                                   size_t capacity,
                                    size_t* len) {
     if (!session || !packet || !len) {
         LOGE("Invalid parameters for receive_packet");
         return -1;
     }
     
+    *len = 0;
+    
     if (!session->connected) {
         return 0; // No packet available
     }
     
-    *packet = nullptr;
-    *len = 0;
-    
 #ifdef OPENVPN3_AVAILABLE
     try {
         std::lock_guard<std::mutex> lock(session->packet_mutex);
@@ -1727,13 +1520,17 @@ int openvpn_wrapper_receive_packet(OpenVpnSession* session,
         // TunBuilderBase callbacks and stored in the receive buffer.
         
         if (!session->receive_buffer.empty()) {
-            *len = session->receive_buffer.size();
-            *packet = (uint8_t*)malloc(*len);
-            if (*packet) {
-                memcpy(*packet, session->receive_buffer.data(), *len);
+            // Copied straight into the caller's (direct ByteBuffer) memory
+            if (session->receive_buffer.size() > capacity) {
+                LOGE("receive_packet: %zu byte packet does not fit in %zu bytes",
+                     session->receive_buffer.size(), capacity);
                 session->receive_buffer.clear();
-                return 1; // Packet available
+                return -1;
             }
+            *len = session->receive_buffer.size();
+            memcpy(packet, session->receive_buffer.data(), *len);
+            session->receive_buffer.clear();
+            return 1; // Packet available
         }
         
         return 0; // No packet available
@@ -1902,4 +1699,48 @@ void reconnectSession(OpenVpnSession* session) {
 #endif
 }
 
+/**
+ * Moves a session onto the network the device just switched to.
+ *
+ * A UDP session whose server pushed peer-id keeps its data channel: the
+ * transport socket is re-connected in place so it picks up a source address
+ * on the new network, and an ICMP echo to the server's tunnel address makes
+ * the next data packet (which floats the peer) go out immediately. Everything
+ * else, or a rebind that fails, gets a full reconnectSession(). The caller
+ * tracks the handoff with NetworkHandoffTracker and escalates a rebind that
+ * sees no data back.
+ */
+int handleNetworkChange(OpenVpnSession* session) {
+    if (!session) {
+        return -1;
+    }
+#ifdef OPENVPN3_AVAILABLE
+    if (session->androidClient &&
+        session->lifecycle.state() == openvpn::LifecycleState::CONNECTED) {
+        const openvpn::TransportTraits traits = session->androidClient->transportTraits();
+        const int fd = session->androidClient->transportFd();
+        if (openvpn::rebind_eligible(traits) && openvpn::rebind_udp_socket(fd)) {
+            LOGI("handleNetworkChange: rebound UDP transport fd %d for tunnel %s",
+                 fd, session->tunnelId.c_str());
+#ifdef OPENVPN_EXTERNAL_TUN_FACTORY
+            const std::vector<uint8_t> probe = openvpn::build_icmp_echo(
+                traits.local_ip4, traits.gateway_ip4, static_cast<uint16_t>(getpid()), 1);
+            const int appFd = session->androidClient->getAppFd();
+            if (!probe.empty() && appFd >= 0 && write(appFd, probe.data(), probe.size()) < 0) {
+                LOGW("handleNetworkChange: probe write failed: %s", strerror(errno));
+            }
+#endif
+            return openvpn::HANDOFF_REBIND;
+        }
+        LOGI("handleNetworkChange: tunnel %s cannot rebind (udp=%d, peer-id=%d, fd=%d)",
+             session->tunnelId.c_str(), traits.udp, traits.peer_id, fd);
+    }
+#endif
+    if (!session->connected && !session->connecting) {
+        return -1;
+    }
+    reconnectSession(session);
+    return openvpn::HANDOFF_RECONNECT;
+}
+
 } // extern "C"
\ No newline at end of file
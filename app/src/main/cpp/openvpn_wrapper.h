@@ -5,6 +5,8 @@
 #include <stddef.h>
 
 #ifdef __cplusplus
+#include "thread_placement.h"
+
 extern "C" {
 #endif
 
@@ -19,12 +21,20 @@ class AndroidOpenVPNClient;
 #endif
 
 // Session management
-OpenVpnSession* openvpn_wrapper_create_session();
+#ifdef __cplusplus
+// placement is copied into the session and applied to its event-loop thread;
+// nullptr uses the process default (ThreadPlacement::config())
+OpenVpnSession* openvpn_wrapper_create_session(const openvpn::ThreadPlacementConfig* placement);
+#endif
 void openvpn_wrapper_destroy_session(OpenVpnSession* session);
 
 // Network change handling (for zombie tunnel bug fix)
 void reconnectSession(OpenVpnSession* session);
 
+// Rebinds the transport in place when the session allows it, else reconnects.
+// Returns the openvpn::HandoffPath taken, or -1 if the session is not running.
+int handleNetworkChange(OpenVpnSession* session);
+
 // Error codes
 #define OPENVPN_ERROR_SUCCESS 0
 #define OPENVPN_ERROR_INVALID_PARAMS -1
@@ -52,6 +62,15 @@ void openvpn_wrapper_set_tunnel_id_and_callback(OpenVpnSession* session,
                                                  jobject dnsCallback);
 #endif
 
+// Set the Kotlin TunnelStateCallback notified on every lifecycle transition
+// (DISCONNECTED/CONNECTING/CONNECTED/RECONNECTING). The current state is reported immediately.
+#ifdef __cplusplus
+#include <jni.h>
+void openvpn_wrapper_set_state_callback(OpenVpnSession* session,
+                                        JNIEnv* env,
+                                        jobject stateCallback);
+#endif
+
 // Set Android-specific parameters (VpnService.Builder and TUN file descriptor)
 // This must be called before connect() if using Android VpnService
 #ifdef __cplusplus
@@ -73,8 +92,11 @@ int openvpn_wrapper_send_packet(OpenVpnSession* session,
                                 const uint8_t* packet,
                                 size_t len);
 
+// Copies the next packet into packet[0, capacity); returns 1 with *len set,
+// 0 if none is pending, -1 on error
 int openvpn_wrapper_receive_packet(OpenVpnSession* session,
-                                   uint8_t** packet,
+                                   uint8_t* packet,
+                                   size_t capacity,
                                    size_t* len);
 
 // Status
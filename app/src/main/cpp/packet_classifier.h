@@ -0,0 +1,171 @@
+#ifndef PACKET_CLASSIFIER_H
+#define PACKET_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace openvpn {
+
+/**
+ * 5-tuple identifying an outbound flow read from the TUN interface.
+ *
+ * IPv4 addresses occupy the first 4 bytes of src/dst with the rest zeroed, so
+ * keys compare and hash as plain bytes. Ports are host order and 0 for
+ * protocols without ports (ICMP) or non-first fragments.
+ */
+struct FlowKey {
+    uint8_t src[16];
+    uint8_t dst[16];
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t protocol;   // IPPROTO_* of the transport header
+    uint8_t family;     // 4 or 6
+    uint8_t pad[2];     // Always zero; keeps memcmp/hash well defined
+
+    bool operator==(const FlowKey& other) const {
+        return std::memcmp(this, &other, sizeof(FlowKey)) == 0;
+    }
+};
+
+static_assert(sizeof(FlowKey) == 40, "FlowKey must stay padding-free for byte-wise hashing");
+
+/**
+ * FNV-1a over the key bytes
+ */
+struct FlowKeyHash {
+    size_t operator()(const FlowKey& key) const {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&key);
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t i = 0; i < sizeof(FlowKey); ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+enum class ClassifyResult {
+    OK,
+    TOO_SHORT,        // Truncated IP or transport header
+    BAD_VERSION,      // Neither IPv4 nor IPv6
+    BAD_HEADER        // Malformed header length or extension chain
+};
+
+namespace classifier_detail {
+
+inline uint16_t read_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// IPv6 extension headers walked before the transport header
+inline bool is_ipv6_extension(uint8_t next_header) {
+    return next_header == 0      // Hop-by-hop options
+        || next_header == 43     // Routing
+        || next_header == 44     // Fragment
+        || next_header == 60;    // Destination options
+}
+
+constexpr int MAX_IPV6_EXTENSIONS = 8;
+
+inline ClassifyResult read_ports(const uint8_t* l4, size_t remaining, uint8_t protocol, FlowKey& key) {
+    // TCP (6), UDP (17) and UDP-Lite (136) start with source and destination port
+    if (protocol == 6 || protocol == 17 || protocol == 136) {
+        if (remaining < 4) {
+            return ClassifyResult::TOO_SHORT;
+        }
+        key.src_port = read_be16(l4);
+        key.dst_port = read_be16(l4 + 2);
+    }
+    return ClassifyResult::OK;
+}
+
+} // namespace classifier_detail
+
+/**
+ * Parses the IP and TCP/UDP headers of packet in place and fills key.
+ *
+ * Reads only header bytes and allocates nothing, so it is safe to call per
+ * packet on the TUN read path.
+ */
+inline ClassifyResult classify_packet(const uint8_t* packet, size_t len, FlowKey& key) {
+    using namespace classifier_detail;
+
+    std::memset(&key, 0, sizeof(key));
+    if (len < 1) {
+        return ClassifyResult::TOO_SHORT;
+    }
+
+    const uint8_t version = packet[0] >> 4;
+    if (version == 4) {
+        if (len < 20) {
+            return ClassifyResult::TOO_SHORT;
+        }
+        const size_t ihl = static_cast<size_t>(packet[0] & 0x0F) * 4;
+        if (ihl < 20) {
+            return ClassifyResult::BAD_HEADER;
+        }
+        if (len < ihl) {
+            return ClassifyResult::TOO_SHORT;
+        }
+
+        key.family = 4;
+        key.protocol = packet[9];
+        std::memcpy(key.src, packet + 12, 4);
+        std::memcpy(key.dst, packet + 16, 4);
+
+        // Only the first fragment carries the transport header
+        const uint16_t fragment_offset = read_be16(packet + 6) & 0x1FFF;
+        if (fragment_offset != 0) {
+            return ClassifyResult::OK;
+        }
+        return read_ports(packet + ihl, len - ihl, key.protocol, key);
+    }
+
+    if (version == 6) {
+        if (len < 40) {
+            return ClassifyResult::TOO_SHORT;
+        }
+
+        key.family = 6;
+        std::memcpy(key.src, packet + 8, 16);
+        std::memcpy(key.dst, packet + 24, 16);
+
+        uint8_t next_header = packet[6];
+        size_t offset = 40;
+        for (int i = 0; i < MAX_IPV6_EXTENSIONS && is_ipv6_extension(next_header); ++i) {
+            if (len < offset + 8) {
+                return ClassifyResult::TOO_SHORT;
+            }
+            const uint8_t* ext = packet + offset;
+            if (next_header == 44) {
+                // Fragment header is fixed size; later fragments have no transport header
+                const uint16_t fragment_offset = read_be16(ext + 2) >> 3;
+                next_header = ext[0];
+                offset += 8;
+                if (fragment_offset != 0) {
+                    key.protocol = next_header;
+                    return ClassifyResult::OK;
+                }
+            } else {
+                next_header = ext[0];
+                offset += (static_cast<size_t>(ext[1]) + 1) * 8;
+            }
+        }
+        if (is_ipv6_extension(next_header)) {
+            return ClassifyResult::BAD_HEADER;
+        }
+        if (len < offset) {
+            return ClassifyResult::TOO_SHORT;
+        }
+
+        key.protocol = next_header;
+        return read_ports(packet + offset, len - offset, key.protocol, key);
+    }
+
+    return ClassifyResult::BAD_VERSION;
+}
+
+} // namespace openvpn
+
+#endif // PACKET_CLASSIFIER_H
@@ -0,0 +1,440 @@
+#ifndef PACKET_RING_H
+#define PACKET_RING_H
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+
+// CustomTunClient offers shared-memory rings to the TUN pump (socketpair otherwise)
+#ifndef TUN_SHM_RING
+#define TUN_SHM_RING 0
+#endif
+
+// Data bytes per direction of a PacketRingPair (power of two)
+#ifndef TUN_SHM_RING_BYTES
+#define TUN_SHM_RING_BYTES (512 * 1024)
+#endif
+
+namespace openvpn {
+
+/**
+ * Shared header of one PacketRing. Producer and consumer fields sit on
+ * separate cache lines so the two threads do not bounce a line per packet.
+ */
+struct PacketRingHeader {
+    alignas(64) std::atomic<uint64_t> head{0};           // Bytes published by the producer
+    std::atomic<uint32_t> producer_parked{0};           // Producer is waiting on space_fd
+    alignas(64) std::atomic<uint64_t> tail{0};           // Bytes released by the consumer
+    std::atomic<uint32_t> consumer_parked{0};           // Consumer is waiting on data_fd
+
+    // Counters, written by one side each
+    alignas(64) std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> full{0};                      // push() calls rejected for lack of space
+    std::atomic<uint64_t> doorbells{0};                 // data_fd writes
+    std::atomic<uint64_t> doorbells_suppressed{0};      // publish() calls that found the consumer awake
+    std::atomic<uint64_t> popped{0};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "PacketRing needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "PacketRing needs lock-free 32-bit atomics");
+
+/**
+ * Single-producer/single-consumer ring of length-prefixed packets in shared
+ * memory, with eventfd doorbells in both directions.
+ *
+ * Each record is a 4-byte length followed by the payload, padded to 8 bytes.
+ * A record that would straddle the end of the data area is preceded by a pad
+ * marker and written at offset 0 instead, so payloads are always contiguous
+ * and the consumer can hand out pointers into the ring.
+ *
+ * Wakeups are batched: the producer push()es any number of packets and then
+ * calls publish() once, which writes data_fd only if the consumer parked
+ * itself. A consumer that keeps up therefore costs no syscalls at all.
+ * Parking uses a seq_cst flag/re-check handshake on each side, so a packet
+ * published while the consumer is deciding to sleep is never missed.
+ *
+ * The ring does not own its memory or fds; PacketRingPair does.
+ */
+class PacketRing {
+public:
+    static constexpr uint32_t PAD_MARKER = 0xFFFFFFFFu;
+    static constexpr size_t RECORD_HEADER = sizeof(uint32_t);
+    static constexpr size_t RECORD_ALIGN = 8;
+
+    PacketRing() = default;
+
+    PacketRing(PacketRingHeader* header, uint8_t* data, size_t capacity, int data_fd, int space_fd)
+        : header_(header), data_(data), capacity_(capacity), mask_(capacity - 1),
+          data_fd_(data_fd), space_fd_(space_fd) {}
+
+    explicit operator bool() const { return header_ != nullptr; }
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * Largest payload push() accepts. Half the ring, so a record plus the pad
+     * in front of it always fits in an empty ring.
+     */
+    size_t max_packet() const { return capacity_ / 2 - RECORD_HEADER; }
+
+    // eventfd the consumer waits on for new packets
+    int data_fd() const { return data_fd_; }
+
+    // eventfd the producer waits on for free space
+    int space_fd() const { return space_fd_; }
+
+    const PacketRingHeader& header() const { return *header_; }
+
+    // ---- Producer side ----
+
+    /**
+     * Copies one packet into the ring without making it visible to the
+     * consumer; publish() does that for the whole batch.
+     *
+     * @return false if the packet is empty, larger than max_packet(), or the ring is full
+     */
+    bool push(const void* packet, size_t len) {
+        if (len == 0 || len > max_packet()) {
+            return false;
+        }
+        const uint64_t tail = header_->tail.load(std::memory_order_acquire);
+        const size_t needed = reserve_bytes(pending_head_, len);
+        if (capacity_ - (pending_head_ - tail) < needed) {
+            header_->full.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        size_t offset = pending_head_ & mask_;
+        if (capacity_ - offset < record_size(len)) {
+            write_length(offset, PAD_MARKER);
+            pending_head_ += capacity_ - offset;
+            offset = 0;
+        }
+        write_length(offset, static_cast<uint32_t>(len));
+        std::memcpy(data_ + offset + RECORD_HEADER, packet, len);
+        pending_head_ += record_size(len);
+        header_->pushed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Makes pushed packets visible and rings data_fd if the consumer is parked
+     *
+     * @return true if the doorbell was rung
+     */
+    bool publish() {
+        if (pending_head_ == header_->head.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        header_->head.store(pending_head_, std::memory_order_seq_cst);
+        if (header_->consumer_parked.load(std::memory_order_seq_cst) &&
+            header_->consumer_parked.exchange(0, std::memory_order_seq_cst)) {
+            ring(data_fd_);
+            header_->doorbells.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        header_->doorbells_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * Asks to be woken through space_fd once the consumer frees space.
+     *
+     * @return false if a len byte packet already fits, in which case the
+     *         producer should push instead of waiting
+     */
+    bool park_producer(size_t len) {
+        header_->producer_parked.store(1, std::memory_order_seq_cst);
+        const uint64_t tail = header_->tail.load(std::memory_order_seq_cst);
+        if (capacity_ - (pending_head_ - tail) >= reserve_bytes(pending_head_, len)) {
+            header_->producer_parked.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // ---- Consumer side ----
+
+    /**
+     * Next published packet, or nullptr if the ring is empty. The pointer
+     * stays valid until pop().
+     */
+    const uint8_t* front(size_t& len) {
+        const uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (read_pos_ == head) {
+            return nullptr;
+        }
+        size_t offset = read_pos_ & mask_;
+        uint32_t length = read_length(offset);
+        if (length == PAD_MARKER) {
+            read_pos_ += capacity_ - offset;
+            offset = 0;
+            length = read_length(offset);
+        }
+        len = length;
+        return data_ + offset + RECORD_HEADER;
+    }
+
+    /**
+     * Drops the packet returned by front(). Space is handed back to the
+     * producer in release().
+     */
+    void pop() {
+        const size_t offset = read_pos_ & mask_;
+        read_pos_ += record_size(read_length(offset));
+        header_->popped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns popped space to the producer and rings space_fd if it is parked
+     */
+    void release() {
+        if (read_pos_ == header_->tail.load(std::memory_order_relaxed)) {
+            return;
+        }
+        header_->tail.store(read_pos_, std::memory_order_seq_cst);
+        if (header_->producer_parked.load(std::memory_order_seq_cst) &&
+            header_->producer_parked.exchange(0, std::memory_order_seq_cst)) {
+            ring(space_fd_);
+        }
+    }
+
+    /**
+     * Asks to be woken through data_fd when the producer publishes.
+     *
+     * @return false if packets are already waiting, in which case the
+     *         consumer should drain them instead of sleeping
+     */
+    bool park_consumer() {
+        header_->consumer_parked.store(1, std::memory_order_seq_cst);
+        if (header_->head.load(std::memory_order_seq_cst) != read_pos_) {
+            header_->consumer_parked.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    bool empty() const {
+        return header_->head.load(std::memory_order_acquire) == read_pos_;
+    }
+
+    /**
+     * Clears a doorbell eventfd after it fired
+     */
+    static void drain_doorbell(int fd) {
+        uint64_t count;
+        ssize_t ignored = read(fd, &count, sizeof(count));
+        (void)ignored;
+    }
+
+    /**
+     * Rings a doorbell eventfd
+     */
+    static void ring(int fd) {
+        const uint64_t one = 1;
+        ssize_t ignored = write(fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+private:
+    static size_t record_size(size_t len) {
+        return (RECORD_HEADER + len + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+    }
+
+    // Record size plus the pad needed to move it to offset 0
+    size_t reserve_bytes(uint64_t head, size_t len) const {
+        const size_t offset = head & mask_;
+        const size_t record = record_size(len);
+        return capacity_ - offset < record ? capacity_ - offset + record : record;
+    }
+
+    void write_length(size_t offset, uint32_t len) {
+        std::memcpy(data_ + offset, &len, sizeof(len));
+    }
+
+    uint32_t read_length(size_t offset) const {
+        uint32_t len;
+        std::memcpy(&len, data_ + offset, sizeof(len));
+        return len;
+    }
+
+    PacketRingHeader* header_ = nullptr;
+    uint8_t* data_ = nullptr;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    int data_fd_ = -1;
+    int space_fd_ = -1;
+
+    uint64_t pending_head_ = 0;   // Producer's private head, ahead of header_->head until publish()
+    uint64_t read_pos_ = 0;       // Consumer's private tail, ahead of header_->tail until release()
+};
+
+/**
+ * Two PacketRings in one memfd mapping: app → OpenVPN (outbound) and
+ * OpenVPN → app (inbound). Each ring has its own producer and consumer and
+ * must only be driven from one thread on each side.
+ *
+ * The app side (TunPump) attaches once it is ready to use the rings; until
+ * then CustomTunClient keeps delivering inbound packets over its socketpair.
+ */
+class PacketRingPair {
+public:
+    /**
+     * Maps a new pair with ring_bytes of data per direction (rounded up to a
+     * power of two). Returns nullptr if memfd, mmap or eventfd are unavailable
+     * so the caller can stay on the socketpair.
+     */
+    static std::shared_ptr<PacketRingPair> create(size_t ring_bytes = TUN_SHM_RING_BYTES) {
+        size_t capacity = 4096;
+        while (capacity < ring_bytes) {
+            capacity <<= 1;
+        }
+        std::shared_ptr<PacketRingPair> pair(new PacketRingPair());
+        if (!pair->map(capacity)) {
+            return nullptr;
+        }
+        return pair;
+    }
+
+    ~PacketRingPair() {
+        if (base_ && base_ != MAP_FAILED) {
+            munmap(base_, mapped_);
+        }
+        for (int fd : {memfd_, fds_[0], fds_[1], fds_[2], fds_[3]}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    PacketRingPair(const PacketRingPair&) = delete;
+    PacketRingPair& operator=(const PacketRingPair&) = delete;
+
+    // App pushes, CustomTunClient pops
+    PacketRing& outbound() { return outbound_; }
+
+    // CustomTunClient pushes, app pops
+    PacketRing& inbound() { return inbound_; }
+
+    int memfd() const { return memfd_; }
+
+    /**
+     * Set by the app side once it consumes inbound() and produces outbound()
+     */
+    void set_app_attached(bool attached) {
+        app_attached_.store(attached, std::memory_order_release);
+        if (!attached) {
+            // A producer parked on a full inbound ring falls back to the socketpair
+            PacketRing::ring(inbound_.space_fd());
+        }
+    }
+
+    bool app_attached() const {
+        return app_attached_.load(std::memory_order_acquire);
+    }
+
+private:
+    PacketRingPair() = default;
+
+    static int create_memfd(const char* name) {
+#ifdef SYS_memfd_create
+        return static_cast<int>(syscall(SYS_memfd_create, name, 1u /* MFD_CLOEXEC */));
+#else
+        (void)name;
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    bool map(size_t capacity) {
+        const size_t header_bytes = 4096;   // Keeps each data area page aligned
+        const size_t ring_bytes = header_bytes + capacity;
+        mapped_ = 2 * ring_bytes;
+
+        memfd_ = create_memfd("ovpn-packet-ring");
+        if (memfd_ < 0 || ftruncate(memfd_, static_cast<off_t>(mapped_)) != 0) {
+            return false;
+        }
+        base_ = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+        if (base_ == MAP_FAILED) {
+            return false;
+        }
+        for (int& fd : fds_) {
+            fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fd < 0) {
+                return false;
+            }
+        }
+
+        auto* bytes = static_cast<uint8_t*>(base_);
+        outbound_ = PacketRing(new (bytes) PacketRingHeader(), bytes + header_bytes,
+                               capacity, fds_[0], fds_[1]);
+        inbound_ = PacketRing(new (bytes + ring_bytes) PacketRingHeader(),
+                              bytes + ring_bytes + header_bytes, capacity, fds_[2], fds_[3]);
+        return true;
+    }
+
+    int memfd_ = -1;
+    int fds_[4] = {-1, -1, -1, -1};   // outbound data/space, inbound data/space
+    void* base_ = nullptr;
+    size_t mapped_ = 0;
+    PacketRing outbound_;
+    PacketRing inbound_;
+    std::atomic<bool> app_attached_{false};
+};
+
+/**
+ * Ring pairs published by CustomTunClient per tunnel ID, for the TUN pump to
+ * pick up when the tunnel is attached
+ */
+class PacketRingRegistry {
+public:
+    static PacketRingRegistry& instance() {
+        static PacketRingRegistry registry;
+        return registry;
+    }
+
+    void publish(const std::string& tunnel_id, std::shared_ptr<PacketRingPair> pair) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pairs_[tunnel_id] = std::move(pair);
+    }
+
+    std::shared_ptr<PacketRingPair> find(const std::string& tunnel_id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pairs_.find(tunnel_id);
+        return it == pairs_.end() ? nullptr : it->second;
+    }
+
+    /**
+     * Removes tunnel_id's entry if it is still pair
+     */
+    void erase(const std::string& tunnel_id, const PacketRingPair* pair) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pairs_.find(tunnel_id);
+        if (it != pairs_.end() && it->second.get() == pair) {
+            pairs_.erase(it);
+        }
+    }
+
+private:
+    PacketRingRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<PacketRingPair>> pairs_;
+};
+
+} // namespace openvpn
+
+#endif // PACKET_RING_H
@@ -0,0 +1,129 @@
+#include <jni.h>
+#include <string>
+#include <chrono>
+#include <android/log.h>
+#include "logging_config.h"
+#include "native_packet_router.h"
+
+#define LOG_TAG "PacketRouter-JNI"
+
+// JNI entry points for com.multiregionvpn.core.NativePacketRouter (companion @JvmStatic methods).
+// Packets are passed as direct ByteBuffers so classification reads the bytes
+// in place: no array copies, no Java object allocation per packet.
+
+using openvpn::NativePacketRouter;
+
+extern "C" {
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_NativePacketRouter_nativeRegisterTunnel(
+            JNIEnv *env, jclass clazz, jstring tunnelId);
+
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_NativePacketRouter_nativeClassify(
+            JNIEnv *env, jclass clazz, jobject buffer, jint length);
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_multiregionvpn_core_NativePacketRouter_nativeLearnFlow(
+            JNIEnv *env, jclass clazz, jobject buffer, jint length, jint tunnelIndex, jint uid);
+
+    JNIEXPORT jlong JNICALL
+    Java_com_multiregionvpn_core_NativePacketRouter_nativeLookupFlow(
+            JNIEnv *env, jclass clazz, jobject buffer, jint length);
+
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_NativePacketRouter_nativeForgetUid(
+            JNIEnv *env, jclass clazz, jint uid);
+
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_NativePacketRouter_nativeClearFlows(
+            JNIEnv *env, jclass clazz);
+}
+
+static uint64_t now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Address of the first length bytes of a direct ByteBuffer, or nullptr if it is
+// not direct or shorter than length
+static const uint8_t* direct_packet(JNIEnv* env, jobject buffer, jint length) {
+    if (!buffer || length <= 0) {
+        return nullptr;
+    }
+    void* address = env->GetDirectBufferAddress(buffer);
+    if (!address || env->GetDirectBufferCapacity(buffer) < length) {
+        return nullptr;
+    }
+    return static_cast<const uint8_t*>(address);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_NativePacketRouter_nativeRegisterTunnel(
+        JNIEnv *env, jclass clazz, jstring tunnelId) {
+    if (!tunnelId) {
+        return -1;
+    }
+    const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
+    if (!tunnelIdStr) {
+        return -1;
+    }
+    std::string id(tunnelIdStr);
+    env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+
+    const int index = NativePacketRouter::instance().register_tunnel(id);
+    LOG_INFO(LOG_TAG, "Tunnel %s registered as index %d", id.c_str(), index);
+    return index;
+}
+
+/**
+ * Called once per outbound packet. Returns a tunnel index, ROUTE_MISS (-1)
+ * or ROUTE_PARSE_ERROR (-2).
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_NativePacketRouter_nativeClassify(
+        JNIEnv *env, jclass clazz, jobject buffer, jint length) {
+    const uint8_t* packet = direct_packet(env, buffer, length);
+    if (!packet) {
+        return NativePacketRouter::ROUTE_PARSE_ERROR;
+    }
+    return NativePacketRouter::instance().route(packet, static_cast<size_t>(length), now_ms());
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_multiregionvpn_core_NativePacketRouter_nativeLearnFlow(
+        JNIEnv *env, jclass clazz, jobject buffer, jint length, jint tunnelIndex, jint uid) {
+    const uint8_t* packet = direct_packet(env, buffer, length);
+    if (!packet) {
+        return JNI_FALSE;
+    }
+    const bool learned = NativePacketRouter::instance().learn(
+        packet, static_cast<size_t>(length), tunnelIndex, uid, now_ms());
+    return learned ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Returns (tunnelIndex << 32) | uid for packet's flow, or -1 if it has no live entry
+ */
+JNIEXPORT jlong JNICALL
+Java_com_multiregionvpn_core_NativePacketRouter_nativeLookupFlow(
+        JNIEnv *env, jclass clazz, jobject buffer, jint length) {
+    const uint8_t* packet = direct_packet(env, buffer, length);
+    openvpn::FlowTable::Match match;
+    if (!packet || !NativePacketRouter::instance().lookup(packet, static_cast<size_t>(length), now_ms(), match)) {
+        return -1;
+    }
+    return (static_cast<jlong>(match.tunnel_index) << 32) | static_cast<uint32_t>(match.uid);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_NativePacketRouter_nativeForgetUid(
+        JNIEnv *env, jclass clazz, jint uid) {
+    return static_cast<jint>(NativePacketRouter::instance().flows().erase_uid(uid));
+}
+
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_NativePacketRouter_nativeClearFlows(
+        JNIEnv *env, jclass clazz) {
+    NativePacketRouter::instance().flows().clear();
+    LOG_INFO(LOG_TAG, "Native flow table cleared");
+}
@@ -0,0 +1,295 @@
+#ifndef PRE_CONNECT_QUEUE_H
+#define PRE_CONNECT_QUEUE_H
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tun_buffer_pool.h"
+#include "tun_egress_queue.h"
+
+// Packets held per tunnel while it is still connecting.
+// Override at build time with -DTUN_PRECONNECT_QUEUE_SIZE=<n> (see CMakeLists.txt).
+#ifndef TUN_PRECONNECT_QUEUE_SIZE
+#define TUN_PRECONNECT_QUEUE_SIZE 1024
+#endif
+
+// Age at which a queued pre-connect packet is dropped instead of sent
+#ifndef TUN_PRECONNECT_MAX_AGE_MS
+#define TUN_PRECONNECT_MAX_AGE_MS 10000
+#endif
+
+namespace openvpn {
+
+/**
+ * Pooled copy of one app packet, sized for the largest TUN packet.
+ * Satisfies TunBufferPool's Buffer(capacity, flags) / capacity() contract.
+ */
+struct PreConnectPacket {
+    PreConnectPacket() = default;
+    PreConnectPacket(size_t capacity, unsigned int) : data(capacity) {}
+
+    size_t capacity() const { return data.size(); }
+
+    std::vector<uint8_t> data;
+    size_t size = 0;
+};
+
+/**
+ * Counters for PreConnectQueue on top of the queue's own TunEgressStats
+ */
+struct PreConnectStats {
+    TunEgressStats queue;                       // enqueued / flushed / tail_drops / age_drops
+    std::atomic<uint64_t> sent_direct{0};       // Written straight to app_fd after open()
+    std::atomic<uint64_t> oversized{0};         // Larger than MAX_PACKET_SIZE or empty
+    std::atomic<uint64_t> write_errors{0};      // app_fd write failed (not EAGAIN)
+};
+
+/**
+ * What PreConnectQueue::push() did with a packet; values are returned to Kotlin
+ */
+enum class PreConnectResult : int {
+    QUEUED = 0,    // Held until the tunnel's TUN is up
+    SENT = 1,      // Written to app_fd
+    DROPPED = -1   // Queue full, oversized, or app_fd write error
+};
+
+/**
+ * Per-tunnel bounded FIFO for packets the app routes to a tunnel before
+ * OpenVPN has brought its TUN up.
+ *
+ * Kotlin threads push(); CustomTunClient calls open() from tun_start() to
+ * write the backlog straight into app_fd, where OpenVPN picks it up from
+ * lib_fd with the first read batch. Entries are time-ordered, so expiry
+ * only ever looks at the head and push() stays O(1) amortized however long
+ * the queue gets. Packet copies come from a TunBufferPool and return to it
+ * when sent or dropped.
+ *
+ * If app_fd fills up during the flush the remainder stays queued, and pushes
+ * queue behind it to keep order; flush() resumes from CustomTunClient's
+ * lib_fd read loop while backlog() is true. After open() with nothing left
+ * queued, push() writes directly to app_fd until close().
+ */
+class PreConnectQueue {
+public:
+    // VpnEngineService sets a 1500-byte TUN MTU
+    static constexpr size_t MAX_PACKET_SIZE = 2048;
+    static constexpr size_t DEFAULT_CAPACITY = TUN_PRECONNECT_QUEUE_SIZE;
+    static constexpr uint64_t DEFAULT_MAX_AGE_MS = TUN_PRECONNECT_MAX_AGE_MS;
+
+    explicit PreConnectQueue(size_t capacity = DEFAULT_CAPACITY,
+                             uint64_t max_age_ms = DEFAULT_MAX_AGE_MS)
+        : queue_(capacity, TunDropPolicy::DROP_BY_AGE, max_age_ms) {
+        queue_.attach_stats(stats_.queue);
+        pool_.configure(MAX_PACKET_SIZE, TunBufferPool<PreConnectPacket>::DEFAULT_POOL_SIZE);
+    }
+
+    PreConnectQueue(const PreConnectQueue&) = delete;
+    PreConnectQueue& operator=(const PreConnectQueue&) = delete;
+
+    /**
+     * Queues a copy of packet, or writes it to app_fd once the queue is open
+     * and has no backlog
+     */
+    PreConnectResult push(const uint8_t* packet, size_t len, uint64_t now_ms) {
+        if (len == 0 || len > MAX_PACKET_SIZE) {
+            stats_.oversized.fetch_add(1, std::memory_order_relaxed);
+            return PreConnectResult::DROPPED;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ >= 0 && queue_.empty()) {
+            const int written = write_packet(packet, len);
+            if (written > 0) {
+                stats_.sent_direct.fetch_add(1, std::memory_order_relaxed);
+                return PreConnectResult::SENT;
+            }
+            if (written < 0) {
+                return PreConnectResult::DROPPED;
+            }
+            // app_fd is full: OpenVPN has unread packets, so its read loop will flush()
+        }
+
+        queue_.expire(now_ms, release_fn());
+        PreConnectPacket buf = pool_.acquire();
+        std::memcpy(buf.data.data(), packet, len);
+        buf.size = len;
+        const bool queued = queue_.push(std::move(buf), now_ms, release_fn());
+        depth_.store(queue_.size(), std::memory_order_relaxed);
+        return queued ? PreConnectResult::QUEUED : PreConnectResult::DROPPED;
+    }
+
+    /**
+     * Starts sending to app_fd: writes the unexpired backlog until the socket
+     * fills and returns how many packets are still queued
+     */
+    size_t open(int app_fd, uint64_t now_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fd_ = app_fd;
+        return flush_locked(now_ms);
+    }
+
+    /**
+     * Continues an open() that stopped on a full app_fd
+     */
+    size_t flush(uint64_t now_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return flush_locked(now_ms);
+    }
+
+    /**
+     * Stops writing to app_fd before its owner closes it. Queued packets stay
+     * for the next open() unless they expire first.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fd_ = -1;
+        is_open_.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Drops every queued packet, e.g. when the tunnel is closed
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!queue_.empty()) {
+            pool_.release(queue_.pop());
+        }
+        depth_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * True while open() left packets queued; lock-free for the read loop
+     */
+    bool backlog() const {
+        return depth_.load(std::memory_order_relaxed) != 0 && is_open_.load(std::memory_order_relaxed);
+    }
+
+    size_t size() const {
+        return depth_.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity() const {
+        return queue_.capacity();
+    }
+
+    const PreConnectStats& stats() const {
+        return stats_;
+    }
+
+private:
+    // Drop callback for queue_: evicted packets go back to pool_
+    struct Release {
+        TunBufferPool<PreConnectPacket>& pool;
+        void operator()(PreConnectPacket&& buf) const { pool.release(std::move(buf)); }
+    };
+
+    Release release_fn() {
+        return Release{pool_};
+    }
+
+    // 1 if written, 0 if app_fd is full, -1 on any other error
+    int write_packet(const uint8_t* packet, size_t len) {
+        const ssize_t n = send(fd_, packet, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n == static_cast<ssize_t>(len)) {
+            return 1;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        stats_.write_errors.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    size_t flush_locked(uint64_t now_ms) {
+        is_open_.store(fd_ >= 0, std::memory_order_relaxed);
+        if (fd_ >= 0) {
+            queue_.expire(now_ms, release_fn());
+            while (!queue_.empty()) {
+                const PreConnectPacket& buf = queue_.front();
+                const int written = write_packet(buf.data.data(), buf.size);
+                if (written == 0) {
+                    break;
+                }
+                // A packet that failed outright is dropped rather than retried
+                pool_.release(queue_.pop());
+            }
+            if (queue_.empty()) {
+                // Later packets go straight to app_fd; free the storm's buffers
+                pool_.configure(MAX_PACKET_SIZE, TunBufferPool<PreConnectPacket>::DEFAULT_POOL_SIZE);
+            }
+        }
+        depth_.store(queue_.size(), std::memory_order_relaxed);
+        return queue_.size();
+    }
+
+    mutable std::mutex mutex_;
+    TunEgressQueue<PreConnectPacket> queue_;
+    TunBufferPool<PreConnectPacket> pool_;
+    PreConnectStats stats_;
+    int fd_ = -1;                           // app_fd between open() and close()
+    std::atomic<size_t> depth_{0};
+    std::atomic<bool> is_open_{false};
+};
+
+/**
+ * Process-wide pre-connect queues keyed by tunnel ID, so packets queued
+ * before a tunnel's CustomTunClient exists are found by its tun_start()
+ */
+class PreConnectQueueRegistry {
+public:
+    static PreConnectQueueRegistry& instance() {
+        static PreConnectQueueRegistry registry;
+        return registry;
+    }
+
+    /**
+     * Returns the queue for tunnel_id, creating it on first use
+     */
+    std::shared_ptr<PreConnectQueue> acquire(const std::string& tunnel_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<PreConnectQueue>& queue = queues_[tunnel_id];
+        if (!queue) {
+            queue = std::make_shared<PreConnectQueue>();
+        }
+        return queue;
+    }
+
+    /**
+     * Returns the queue for tunnel_id, or nullptr if none was created
+     */
+    std::shared_ptr<PreConnectQueue> find(const std::string& tunnel_id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = queues_.find(tunnel_id);
+        return it == queues_.end() ? nullptr : it->second;
+    }
+
+    /**
+     * Removes tunnel_id's entry if it is still queue
+     */
+    void erase(const std::string& tunnel_id, const PreConnectQueue* queue) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = queues_.find(tunnel_id);
+        if (it != queues_.end() && it->second.get() == queue) {
+            queues_.erase(it);
+        }
+    }
+
+private:
+    PreConnectQueueRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<PreConnectQueue>> queues_;
+};
+
+} // namespace openvpn
+
+#endif // PRE_CONNECT_QUEUE_H
@@ -0,0 +1,194 @@
+#ifndef PROFILE_CACHE_H
+#define PROFILE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "config_normalizer.h"
+
+namespace openvpn {
+
+/**
+ * Outcome of OpenVPN 3 eval_config() for a normalized profile
+ */
+struct ProfileEvalSummary {
+    bool error = false;
+    bool autologin = false;
+    std::string message;       // eval_config() error text
+    std::string profile_name;
+};
+
+/**
+ * Normalized .ovpn profiles keyed by a hash of the raw profile text.
+ *
+ * A profile is normalized once per content: later connects of the same raw text,
+ * including reconnects, reuse the stored result, and a profile that failed
+ * eval_config() is rejected without evaluating it again. Entries live in memory
+ * only: profiles carry inline key material, and normalizing one costs less
+ * than reading it back from storage would.
+ */
+class ProfileCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16;
+
+    struct Lookup {
+        uint64_t key = 0;
+        std::shared_ptr<const std::string> content;  // Normalized profile
+        bool memory_hit = false;
+    };
+
+    static ProfileCache& instance() {
+        static ProfileCache cache(DEFAULT_CAPACITY);
+        return cache;
+    }
+
+    explicit ProfileCache(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    ProfileCache(const ProfileCache&) = delete;
+    ProfileCache& operator=(const ProfileCache&) = delete;
+
+    /**
+     * Returns raw's normalized profile from memory, normalizing and storing it
+     * on a miss
+     */
+    Lookup normalized(std::string_view raw) {
+        Lookup result;
+        result.key = key_for(raw);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // The key is a 64-bit non-cryptographic hash: a hit must also match the raw text
+            auto it = entries_.find(result.key);
+            if (it != entries_.end() && it->second.content && it->second.raw == raw) {
+                it->second.last_used = ++clock_;
+                result.content = it->second.content;
+                result.memory_hit = true;
+                memory_hits_.fetch_add(1, std::memory_order_relaxed);
+                return result;
+            }
+        }
+
+        result.content = std::make_shared<const std::string>(normalize_profile(raw).content);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = touch_locked(result.key);
+        if (entry.raw != raw) {
+            // New profile, or a different one that hashed to the same key
+            entry.raw.assign(raw.data(), raw.size());
+            entry.has_eval = false;
+        }
+        entry.content = result.content;
+        return result;
+    }
+
+    void store_eval(uint64_t key, const ProfileEvalSummary& eval) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = touch_locked(key);
+        entry.eval = eval;
+        entry.has_eval = true;
+    }
+
+    bool find_eval(uint64_t key, ProfileEvalSummary& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || !it->second.has_eval) {
+            return false;
+        }
+        out = it->second.eval;
+        return true;
+    }
+
+    /**
+     * Drops every cached entry
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    uint64_t memory_hits() const { return memory_hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+    /**
+     * 64-bit hash of the raw profile over four independent 8-byte lanes, seeded
+     * with the normalizer version so a normalizer change never serves output
+     * from the previous one
+     */
+    static uint64_t key_for(std::string_view raw) {
+        constexpr uint64_t PRIME = 0x9E3779B97F4A7C15ull;
+        const uint64_t seed = (0xCBF29CE484222325ull ^ PROFILE_NORMALIZER_VERSION) + raw.size() * PRIME;
+        uint64_t lanes[4] = {seed, seed + PRIME, seed + 2 * PRIME, seed + 3 * PRIME};
+        size_t i = 0;
+        for (; i + 32 <= raw.size(); i += 32) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                uint64_t word;
+                memcpy(&word, raw.data() + i + lane * 8, sizeof(word));
+                lanes[lane] = (lanes[lane] ^ word) * PRIME;
+                lanes[lane] ^= lanes[lane] >> 29;
+            }
+        }
+        uint64_t hash = mix(lanes[0]) ^ mix(lanes[1] + 1) ^ mix(lanes[2] + 2) ^ mix(lanes[3] + 3);
+        for (; i < raw.size(); i += 8) {
+            uint64_t word = 0;
+            memcpy(&word, raw.data() + i, raw.size() - i < 8 ? raw.size() - i : 8);
+            hash = mix(hash ^ word);
+        }
+        return hash;
+    }
+
+private:
+    struct Entry {
+        std::string raw;
+        std::shared_ptr<const std::string> content;
+        ProfileEvalSummary eval;
+        bool has_eval = false;
+        uint64_t last_used = 0;
+    };
+
+    Entry& touch_locked(uint64_t key) {
+        Entry& entry = entries_[key];
+        entry.last_used = ++clock_;
+        while (entries_.size() > capacity_) {
+            auto oldest = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            entries_.erase(oldest);
+        }
+        return entries_[key];
+    }
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::map<uint64_t, Entry> entries_;
+    uint64_t clock_ = 0;
+
+    std::atomic<uint64_t> memory_hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace openvpn
+
+#endif // PROFILE_CACHE_H
@@ -0,0 +1,319 @@
+#ifndef RECONNECT_SCHEDULER_H
+#define RECONNECT_SCHEDULER_H
+
+#include <pthread.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_placement.h"
+
+namespace openvpn {
+
+/**
+ * Timing for ReconnectScheduler. The defaults suit a handful of tunnels
+ * reacting to one network change.
+ */
+struct ReconnectPolicy {
+    size_t max_parallel = 2;            // Tunnels moved at the same time
+    int64_t stagger_ms = 400;           // First attempts of idle tunnels spread over [0, stagger_ms)
+    int64_t base_backoff_ms = 1000;     // Repeat attempts wait [cap/2, cap], cap doubling from here
+    int64_t max_backoff_ms = 30000;
+    int64_t backoff_reset_ms = 60000;   // A tunnel quiet this long starts over at attempt 0
+    int64_t coalesce_window_ms = 1500;  // Repeat events for the same network inside this are dropped
+};
+
+/**
+ * Runs per-tunnel reconnect work off the JNI thread, a few tunnels at a time.
+ *
+ * Each key (tunnel ID) has at most one queued task; scheduling it again while
+ * queued replaces the task and keeps the original due time, so a burst of
+ * network callbacks moves each tunnel once. Tunnels that carry flows
+ * (priority > 0) go first and skip the initial stagger; idle ones are spread
+ * out so the servers do not see every tunnel at the same instant. A tunnel
+ * scheduled again soon after its last run backs off with jitter.
+ *
+ * Tasks run on up to max_parallel worker threads started on first use; two
+ * tasks for the same key never run concurrently.
+ */
+class ReconnectScheduler {
+public:
+    using Task = std::function<void()>;
+
+    static ReconnectScheduler& instance() {
+        static ReconnectScheduler scheduler;
+        return scheduler;
+    }
+
+    explicit ReconnectScheduler(ReconnectPolicy policy = ReconnectPolicy(),
+                                uint64_t seed = std::random_device{}())
+        : policy_(policy), rng_(seed) {
+        if (policy_.max_parallel == 0) {
+            policy_.max_parallel = 1;
+        }
+    }
+
+    ~ReconnectScheduler() {
+        stop();
+    }
+
+    ReconnectScheduler(const ReconnectScheduler&) = delete;
+    ReconnectScheduler& operator=(const ReconnectScheduler&) = delete;
+
+    static int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Upper bound of the wait before repeat attempt number `attempt` (>= 1)
+     */
+    static int64_t backoff_cap_ms(const ReconnectPolicy& policy, uint32_t attempt) {
+        int64_t cap = policy.base_backoff_ms;
+        for (uint32_t i = 1; i < attempt && cap < policy.max_backoff_ms; ++i) {
+            cap *= 2;
+        }
+        return cap < policy.max_backoff_ms ? cap : policy.max_backoff_ms;
+    }
+
+    /**
+     * Records a network-change event; returns false if the same network was
+     * already reported within coalesce_window_ms and the event should be dropped
+     */
+    bool note_network_event(int64_t network, int64_t now = now_ms()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (has_last_network_ && network == last_network_ &&
+            now - last_network_ms_ < policy_.coalesce_window_ms) {
+            events_coalesced_++;
+            return false;
+        }
+        has_last_network_ = true;
+        last_network_ = network;
+        last_network_ms_ = now;
+        return true;
+    }
+
+    /**
+     * Queues task for key. Returns the delay in ms before it becomes due, or
+     * -1 while the scheduler is stopping.
+     */
+    int64_t schedule(const std::string& key, int64_t priority, Task task) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return -1;
+        }
+        const int64_t now = now_ms();
+
+        auto queued = jobs_.find(key);
+        if (queued != jobs_.end()) {
+            queued->second.task = std::move(task);
+            if (priority > queued->second.priority) {
+                queued->second.priority = priority;
+            }
+            tasks_merged_++;
+            return queued->second.due_ms > now ? queued->second.due_ms - now : 0;
+        }
+
+        KeyState& state = states_[key];
+        if (state.attempts > 0 && now - state.last_run_ms >= policy_.backoff_reset_ms) {
+            state.attempts = 0;
+        }
+        const int64_t delay = delay_locked(state.attempts, priority);
+
+        Job job;
+        job.task = std::move(task);
+        job.priority = priority;
+        job.due_ms = now + delay;
+        job.seq = next_seq_++;
+        jobs_.emplace(key, std::move(job));
+
+        if (workers_.size() < policy_.max_parallel) {
+            workers_.emplace_back([this] { run(); });
+        }
+        lock.unlock();
+        cv_.notify_all();
+        return delay;
+    }
+
+    /**
+     * Drops key's queued task and backoff state, then waits for a running
+     * task for key to finish. Must not be called from a task.
+     */
+    void cancel(const std::string& key) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        jobs_.erase(key);
+        cv_.wait(lock, [this, &key] { return running_.count(key) == 0; });
+        states_.erase(key);
+    }
+
+    /**
+     * Drops every queued task and joins the workers once running tasks return.
+     * Must not be called from a task. The scheduler can be used again afterwards.
+     */
+    void stop() {
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            jobs_.clear();
+            workers.swap(workers_);
+        }
+        cv_.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+
+    /**
+     * Tasks queued or running
+     */
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return jobs_.size() + running_.size();
+    }
+
+    uint32_t attempts(const std::string& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = states_.find(key);
+        return it == states_.end() ? 0 : it->second.attempts;
+    }
+
+    uint64_t executed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_executed_;
+    }
+
+    uint64_t merged() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tasks_merged_;
+    }
+
+    uint64_t events_coalesced() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return events_coalesced_;
+    }
+
+private:
+    struct Job {
+        Task task;
+        int64_t priority = 0;
+        int64_t due_ms = 0;
+        uint64_t seq = 0;
+    };
+
+    struct KeyState {
+        uint32_t attempts = 0;
+        int64_t last_run_ms = 0;
+    };
+
+    int64_t delay_locked(uint32_t attempts, int64_t priority) {
+        if (attempts == 0) {
+            if (priority > 0 || policy_.stagger_ms <= 0) {
+                return 0;
+            }
+            return std::uniform_int_distribution<int64_t>(0, policy_.stagger_ms - 1)(rng_);
+        }
+        const int64_t cap = backoff_cap_ms(policy_, attempts);
+        return std::uniform_int_distribution<int64_t>(cap / 2, cap)(rng_);
+    }
+
+    // Highest priority first, then earliest due, then scheduling order. Sets
+    // wake_ms to the earliest due time among jobs not ready yet.
+    std::map<std::string, Job>::iterator pick_ready_locked(int64_t now, int64_t& wake_ms) {
+        auto best = jobs_.end();
+        wake_ms = std::numeric_limits<int64_t>::max();
+        for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+            if (running_.count(it->first)) {
+                continue;
+            }
+            const Job& job = it->second;
+            if (job.due_ms > now) {
+                if (job.due_ms < wake_ms) {
+                    wake_ms = job.due_ms;
+                }
+                continue;
+            }
+            if (best == jobs_.end() ||
+                job.priority > best->second.priority ||
+                (job.priority == best->second.priority &&
+                 (job.due_ms < best->second.due_ms ||
+                  (job.due_ms == best->second.due_ms && job.seq < best->second.seq)))) {
+                best = it;
+            }
+        }
+        return best;
+    }
+
+    void run() {
+        pthread_setname_np(pthread_self(), "ovpn-reconnect");
+        ScopedThreadPlacement placement("ovpn-reconnect", ThreadRole::CONTROL);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            const int64_t now = now_ms();
+            int64_t wake_ms;
+            auto next = pick_ready_locked(now, wake_ms);
+            if (next == jobs_.end()) {
+                if (wake_ms == std::numeric_limits<int64_t>::max()) {
+                    cv_.wait(lock);
+                } else {
+                    cv_.wait_for(lock, std::chrono::milliseconds(wake_ms - now));
+                }
+                continue;
+            }
+
+            const std::string key = next->first;
+            Task task = std::move(next->second.task);
+            jobs_.erase(next);
+            running_.insert(key);
+            lock.unlock();
+            try {
+                task();
+            } catch (...) {
+                // A failed attempt still counts towards the key's backoff
+            }
+            lock.lock();
+            running_.erase(key);
+            KeyState& state = states_[key];
+            state.attempts++;
+            state.last_run_ms = now_ms();
+            tasks_executed_++;
+            cv_.notify_all();
+        }
+    }
+
+    ReconnectPolicy policy_;
+    std::mt19937_64 rng_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    std::map<std::string, Job> jobs_;
+    std::set<std::string> running_;
+    std::map<std::string, KeyState> states_;
+    uint64_t next_seq_ = 0;
+
+    bool has_last_network_ = false;
+    int64_t last_network_ = 0;
+    int64_t last_network_ms_ = 0;
+
+    uint64_t tasks_executed_ = 0;
+    uint64_t tasks_merged_ = 0;
+    uint64_t events_coalesced_ = 0;
+};
+
+} // namespace openvpn
+
+#endif // RECONNECT_SCHEDULER_H
@@ -0,0 +1,225 @@
+#ifndef TCP_MSS_CLAMP_H
+#define TCP_MSS_CLAMP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "packet_classifier.h"
+
+// MTU assumed for the path between the device and the VPN server
+#ifndef TUN_PATH_MTU
+#define TUN_PATH_MTU 1500
+#endif
+
+namespace openvpn {
+
+/**
+ * What OpenVPN wraps around each TUN packet on the wire
+ */
+struct TunnelOverhead {
+    bool udp = true;
+    bool ipv6_transport = false;
+    bool aead = true;            // GCM / ChaCha20-Poly1305; otherwise CBC + HMAC
+    size_t hmac_bytes = 0;       // Digest size for CBC ciphers
+};
+
+/**
+ * Bytes added outside the inner IP packet: outer IP and UDP/TCP headers,
+ * the P_DATA_V2 opcode and peer-id, packet ID, cipher framing and one
+ * compression framing byte. CBC assumes a full block of padding.
+ */
+inline size_t tunnel_overhead_bytes(const TunnelOverhead& overhead) {
+    size_t bytes = overhead.ipv6_transport ? 40 : 20;
+    bytes += overhead.udp ? 8 : 20 + 2;    // TCP adds a 2-byte packet length
+    bytes += 4;                            // Opcode and peer-id
+    bytes += 4;                            // Packet ID
+    if (overhead.aead) {
+        bytes += 16;                       // Authentication tag
+    } else {
+        bytes += overhead.hmac_bytes + 16 + 16;   // HMAC, IV, padding
+    }
+    return bytes + 1;
+}
+
+/**
+ * AEAD if the OpenVPN cipher name is a GCM or ChaCha20-Poly1305 cipher
+ */
+inline bool cipher_is_aead(const std::string& cipher) {
+    return cipher.find("GCM") != std::string::npos || cipher.find("POLY1305") != std::string::npos;
+}
+
+/**
+ * Digest size of an OpenVPN auth name; unknown names count as SHA512 so the
+ * clamp errs small
+ */
+inline size_t hmac_size(const std::string& digest) {
+    static const struct {
+        const char* name;
+        size_t bytes;
+    } digests[] = {
+        {"NONE", 0}, {"MD5", 16}, {"SHA1", 20}, {"RIPEMD160", 20},
+        {"SHA224", 28}, {"SHA256", 32}, {"SHA384", 48}, {"SHA512", 64},
+    };
+    for (const auto& known : digests) {
+        if (digest == known.name) {
+            return known.bytes;
+        }
+    }
+    return 64;
+}
+
+/**
+ * Largest TCP MSS for a tunnel, per inner IP version
+ */
+struct MssLimit {
+    uint16_t ipv4 = 0;   // 0 disables clamping
+    uint16_t ipv6 = 0;
+
+    explicit operator bool() const { return ipv4 != 0; }
+};
+
+/**
+ * MSS that keeps a full segment plus tunnel overhead within path_mtu, and
+ * the inner packet within tun_mtu
+ */
+inline MssLimit mss_limit(int tun_mtu, const TunnelOverhead& overhead, int path_mtu = TUN_PATH_MTU) {
+    const int overhead_bytes = static_cast<int>(tunnel_overhead_bytes(overhead));
+    int inner_mtu = path_mtu - overhead_bytes;
+    if (tun_mtu > 0 && tun_mtu < inner_mtu) {
+        inner_mtu = tun_mtu;
+    }
+    MssLimit limit;
+    // Below the IPv4 minimum MTU the limit would be meaningless; leave MSS alone
+    if (inner_mtu >= 576) {
+        limit.ipv4 = static_cast<uint16_t>(inner_mtu - 40);
+        limit.ipv6 = static_cast<uint16_t>(inner_mtu - 60);
+    }
+    return limit;
+}
+
+namespace mss_detail {
+
+// RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m')
+inline uint16_t checksum_adjust(uint16_t checksum, uint16_t old_word, uint16_t new_word) {
+    uint32_t sum = static_cast<uint16_t>(~checksum);
+    sum += static_cast<uint16_t>(~old_word);
+    sum += new_word;
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+inline void write_be16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+// Offset of the TCP header in packet, or 0 if this is not the first
+// fragment of a TCP segment. limit is the MSS for the packet's IP version.
+inline size_t tcp_offset(const uint8_t* packet, size_t len, const MssLimit& mss, uint16_t& limit) {
+    using classifier_detail::read_be16;
+    using classifier_detail::is_ipv6_extension;
+
+    if (len < 20) {
+        return 0;
+    }
+    const uint8_t version = packet[0] >> 4;
+    if (version == 4) {
+        const size_t ihl = static_cast<size_t>(packet[0] & 0x0F) * 4;
+        if (ihl < 20 || packet[9] != 6 || (read_be16(packet + 6) & 0x1FFF) != 0) {
+            return 0;
+        }
+        limit = mss.ipv4;
+        return ihl;
+    }
+    if (version == 6 && len >= 40) {
+        uint8_t next_header = packet[6];
+        size_t offset = 40;
+        for (int i = 0; i < classifier_detail::MAX_IPV6_EXTENSIONS && is_ipv6_extension(next_header); ++i) {
+            if (len < offset + 8) {
+                return 0;
+            }
+            const uint8_t* ext = packet + offset;
+            if (next_header == 44 && (read_be16(ext + 2) >> 3) != 0) {
+                return 0;
+            }
+            offset += next_header == 44 ? 8 : (static_cast<size_t>(ext[1]) + 1) * 8;
+            next_header = ext[0];
+        }
+        if (next_header != 6) {
+            return 0;
+        }
+        limit = mss.ipv6;
+        return offset;
+    }
+    return 0;
+}
+
+} // namespace mss_detail
+
+/**
+ * Lowers the MSS option of a TCP SYN or SYN-ACK to the tunnel's limit, in
+ * place, and patches the TCP checksum incrementally. Any other packet is
+ * left untouched after a few header byte reads.
+ *
+ * @return true if the MSS option was rewritten
+ */
+inline bool clamp_tcp_mss(uint8_t* packet, size_t len, const MssLimit& mss) {
+    using classifier_detail::read_be16;
+
+    if (!mss) {
+        return false;
+    }
+    uint16_t limit = 0;
+    const size_t tcp = mss_detail::tcp_offset(packet, len, mss, limit);
+    if (tcp == 0 || len < tcp + 20 || !(packet[tcp + 13] & 0x02)) {
+        return false;   // Not TCP, truncated, or no SYN flag
+    }
+    const size_t header_len = static_cast<size_t>(packet[tcp + 12] >> 4) * 4;
+    if (header_len < 20 || len < tcp + header_len) {
+        return false;
+    }
+
+    size_t option = tcp + 20;
+    const size_t end = tcp + header_len;
+    while (option < end) {
+        const uint8_t kind = packet[option];
+        if (kind == 0) {
+            break;                              // End of options
+        }
+        if (kind == 1) {
+            ++option;                           // NOP
+            continue;
+        }
+        if (option + 1 >= end || packet[option + 1] < 2 || option + packet[option + 1] > end) {
+            break;                              // Malformed option list
+        }
+        if (kind == 2 && packet[option + 1] == 4) {
+            const size_t value = option + 2;
+            if (read_be16(packet + value) <= limit) {
+                return false;
+            }
+            // The value may straddle two checksum words when options are not aligned
+            const size_t first = tcp + ((value - tcp) & ~static_cast<size_t>(1));
+            const size_t words = (value - tcp) % 2 ? 2 : 1;
+            uint16_t old_words[2] = {read_be16(packet + first), 0};
+            if (words == 2) {
+                old_words[1] = read_be16(packet + first + 2);
+            }
+            mss_detail::write_be16(packet + value, limit);
+            uint16_t checksum = read_be16(packet + tcp + 16);
+            for (size_t i = 0; i < words; ++i) {
+                checksum = mss_detail::checksum_adjust(checksum, old_words[i], read_be16(packet + first + 2 * i));
+            }
+            mss_detail::write_be16(packet + tcp + 16, checksum);
+            return true;
+        }
+        option += packet[option + 1];
+    }
+    return false;
+}
+
+} // namespace openvpn
+
+#endif // TCP_MSS_CLAMP_H
@@ -0,0 +1,462 @@
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <sched.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// AUTO threads move to the big cluster above this CPU use and back below the demote mark
+#ifndef TUN_PLACEMENT_PROMOTE_PERMILLE
+#define TUN_PLACEMENT_PROMOTE_PERMILLE 400
+#endif
+#ifndef TUN_PLACEMENT_DEMOTE_PERMILLE
+#define TUN_PLACEMENT_DEMOTE_PERMILLE 100
+#endif
+
+namespace openvpn {
+
+enum class ThreadRole : int {
+    DATA_PATH = 0,   // Tunnel event loops (encryption) and the TUN pump
+    CONTROL = 1,     // Callback dispatcher and reconnect workers
+};
+
+enum class CpuCluster : int {
+    ANY = 0,      // Affinity left to the scheduler
+    BIG = 1,      // Every core above the slowest frequency tier
+    LITTLE = 2,   // The slowest frequency tier
+    AUTO = 3,     // Starts on BIG; sample() moves the thread by its measured CPU use
+};
+
+/**
+ * Scheduling applied to every thread of one role
+ */
+struct RolePlacement {
+    CpuCluster cluster = CpuCluster::ANY;
+    int nice = 0;               // setpriority() value, -20..19
+    int policy = SCHED_OTHER;   // SCHED_OTHER/BATCH/IDLE; SCHED_FIFO/RR need CAP_SYS_NICE
+    int rt_priority = 0;        // sched_priority for SCHED_FIFO/RR
+
+    // True if applying this changes nothing about a default thread
+    bool is_default() const {
+        return nice == 0 && policy == SCHED_OTHER;
+    }
+};
+
+/**
+ * Thread placement for one session (snapshotted at session creation) or for
+ * the process-wide threads. The defaults change nothing.
+ */
+struct ThreadPlacementConfig {
+    RolePlacement data_path;
+    RolePlacement control;
+    uint32_t promote_permille = TUN_PLACEMENT_PROMOTE_PERMILLE;
+    uint32_t demote_permille = TUN_PLACEMENT_DEMOTE_PERMILLE;
+
+    const RolePlacement& role(ThreadRole r) const {
+        return r == ThreadRole::CONTROL ? control : data_path;
+    }
+};
+
+/**
+ * Cores split into clusters by maximum frequency. On a homogeneous device
+ * both clusters hold every core.
+ */
+struct CpuTopology {
+    std::vector<int> big;
+    std::vector<int> little;
+
+    bool heterogeneous() const { return big != little; }
+
+    const std::vector<int>& cluster(CpuCluster c) const {
+        return c == CpuCluster::LITTLE ? little : big;
+    }
+
+    std::vector<int> all() const {
+        std::vector<int> cpus = big;
+        cpus.insert(cpus.end(), little.begin(), little.end());
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    /**
+     * Splits (cpu, max frequency) pairs: the slowest tier is LITTLE and
+     * every faster core BIG. A missing frequency (0) makes the split
+     * unreliable, so every core lands in both.
+     */
+    static CpuTopology from_max_freq(const std::vector<std::pair<int, uint64_t>>& cpus) {
+        CpuTopology topology;
+        if (cpus.empty()) {
+            topology.big.push_back(0);
+            topology.little.push_back(0);
+            return topology;
+        }
+        uint64_t slowest = UINT64_MAX;
+        bool known = true;
+        for (const auto& cpu : cpus) {
+            known = known && cpu.second > 0;
+            slowest = std::min(slowest, cpu.second);
+        }
+        for (const auto& cpu : cpus) {
+            if (!known) {
+                topology.big.push_back(cpu.first);
+                topology.little.push_back(cpu.first);
+            } else if (cpu.second == slowest) {
+                topology.little.push_back(cpu.first);
+            } else {
+                topology.big.push_back(cpu.first);
+            }
+        }
+        if (topology.big.empty()) {
+            topology.big = topology.little;
+        }
+        return topology;
+    }
+
+    /**
+     * Reads cpufreq's cpuinfo_max_freq for every core this process may run on
+     */
+    static CpuTopology detect() {
+        std::vector<std::pair<int, uint64_t>> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.emplace_back(cpu, max_freq_khz(cpu));
+                }
+            }
+        }
+        return from_max_freq(cpus);
+    }
+
+    static uint64_t max_freq_khz(int cpu) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+        FILE* file = fopen(path, "re");
+        if (!file) {
+            return 0;
+        }
+        unsigned long long khz = 0;
+        if (fscanf(file, "%llu", &khz) != 1) {
+            khz = 0;
+        }
+        fclose(file);
+        return khz;
+    }
+};
+
+/**
+ * Snapshot of one placed thread for stats reporting
+ */
+struct PlacedThreadStats {
+    pid_t tid = 0;
+    std::string name;
+    ThreadRole role = ThreadRole::DATA_PATH;
+    CpuCluster cluster = CpuCluster::ANY;   // Cluster the thread is pinned to now (ANY if unpinned)
+    uint32_t utilization_permille = 0;      // CPU used over the last sample
+};
+
+/**
+ * Places native threads by role: cluster affinity, nice value and scheduling
+ * policy. Threads join from their own start-up code and leave before they
+ * exit. sample() measures each thread's CPU time and moves AUTO threads
+ * between clusters: busy ones up to BIG, idle ones down to LITTLE, with a gap
+ * between the two marks so a thread does not bounce.
+ *
+ * Threads joined without their own config follow the process default, and
+ * configure() re-applies it to them. Session event loops pass the config
+ * snapshotted at session creation.
+ */
+class ThreadPlacement {
+public:
+    using CpuClock = std::function<uint64_t(pthread_t thread)>;
+    using SetAffinity = std::function<bool(pid_t tid, const std::vector<int>& cpus)>;
+    using SetScheduling = std::function<bool(pid_t tid, const RolePlacement& placement)>;
+
+    static ThreadPlacement& instance() {
+        static ThreadPlacement placement(CpuTopology::detect());
+        return placement;
+    }
+
+    explicit ThreadPlacement(CpuTopology topology,
+                             CpuClock cpu_clock = thread_cpu_ns,
+                             SetAffinity set_affinity = set_thread_affinity,
+                             SetScheduling set_scheduling = set_thread_scheduling)
+        : topology_(std::move(topology)),
+          cpu_clock_(std::move(cpu_clock)),
+          set_affinity_(std::move(set_affinity)),
+          set_scheduling_(std::move(set_scheduling)) {}
+
+    ThreadPlacement(const ThreadPlacement&) = delete;
+    ThreadPlacement& operator=(const ThreadPlacement&) = delete;
+
+    const CpuTopology& topology() const { return topology_; }
+
+    /**
+     * Replaces the process default and re-applies it to the threads that use it
+     */
+    void configure(const ThreadPlacementConfig& config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        default_config_ = config;
+        for (auto& entry : members_) {
+            if (!entry.second.own_config) {
+                entry.second.config = config;
+                apply_locked(entry.second);
+            }
+        }
+    }
+
+    ThreadPlacementConfig config() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return default_config_;
+    }
+
+    /**
+     * Places the calling thread under the process default. With pin false
+     * the thread keeps its affinity (e.g. an IO lane owns it) and only its
+     * scheduling changes. Returns the tid to pass to leave().
+     */
+    pid_t join_current_thread(const std::string& name, ThreadRole role, bool pin = true) {
+        const pid_t tid = current_tid();
+        join(tid, pthread_self(), name, role, nullptr, pin, monotonic_ns());
+        return tid;
+    }
+
+    pid_t join_current_thread(const std::string& name, ThreadRole role,
+                              const ThreadPlacementConfig& config, bool pin = true) {
+        const pid_t tid = current_tid();
+        join(tid, pthread_self(), name, role, &config, pin, monotonic_ns());
+        return tid;
+    }
+
+    void join(pid_t tid, pthread_t thread, const std::string& name, ThreadRole role,
+              const ThreadPlacementConfig* config, bool pin, uint64_t now_ns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Member& member = members_[tid];
+        member = Member{};
+        member.thread = thread;
+        member.tid = tid;
+        member.name = name;
+        member.role = role;
+        member.own_config = config != nullptr;
+        member.config = config ? *config : default_config_;
+        member.pin = pin;
+        member.last_cpu_ns = cpu_clock_(thread);
+        member.last_sample_ns = now_ns;
+        apply_locked(member);
+    }
+
+    /**
+     * Forgets the thread; must be called before it exits
+     */
+    void leave(pid_t tid) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        members_.erase(tid);
+    }
+
+    /**
+     * Measures each thread's CPU use since the previous sample and moves AUTO
+     * threads across clusters. Returns the number of moves.
+     */
+    int sample(uint64_t now_ns = monotonic_ns()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int moves = 0;
+        for (auto& entry : members_) {
+            Member& member = entry.second;
+            const uint64_t cpu = cpu_clock_(member.thread);
+            const uint64_t wall = now_ns > member.last_sample_ns ? now_ns - member.last_sample_ns : 0;
+            const uint64_t used = cpu > member.last_cpu_ns ? cpu - member.last_cpu_ns : 0;
+            if (wall > 0) {
+                member.utilization_permille = static_cast<uint32_t>(std::min<uint64_t>(used * 1000 / wall, 1000));
+            }
+            member.last_cpu_ns = cpu;
+            member.last_sample_ns = now_ns;
+
+            if (!member.pin || member.config.role(member.role).cluster != CpuCluster::AUTO ||
+                !topology_.heterogeneous()) {
+                continue;
+            }
+            if (member.pinned == CpuCluster::LITTLE &&
+                member.utilization_permille >= member.config.promote_permille) {
+                pin_locked(member, CpuCluster::BIG);
+                promotions_.fetch_add(1, std::memory_order_relaxed);
+                moves++;
+            } else if (member.pinned == CpuCluster::BIG &&
+                       member.utilization_permille < member.config.demote_permille) {
+                pin_locked(member, CpuCluster::LITTLE);
+                demotions_.fetch_add(1, std::memory_order_relaxed);
+                moves++;
+            }
+        }
+        return moves;
+    }
+
+    std::vector<PlacedThreadStats> threads() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<PlacedThreadStats> out;
+        out.reserve(members_.size());
+        for (const auto& entry : members_) {
+            const Member& member = entry.second;
+            PlacedThreadStats stats;
+            stats.tid = member.tid;
+            stats.name = member.name;
+            stats.role = member.role;
+            stats.cluster = member.pinned;
+            stats.utilization_permille = member.utilization_permille;
+            out.push_back(std::move(stats));
+        }
+        return out;
+    }
+
+    uint64_t promotions() const { return promotions_.load(std::memory_order_relaxed); }
+    uint64_t demotions() const { return demotions_.load(std::memory_order_relaxed); }
+    // Affinity or scheduling calls the kernel refused (e.g. SCHED_FIFO without CAP_SYS_NICE)
+    uint64_t failures() const { return failures_.load(std::memory_order_relaxed); }
+
+    static uint64_t monotonic_ns() {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    static uint64_t thread_cpu_ns(pthread_t thread) {
+        clockid_t clock;
+        timespec ts{};
+        if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    static bool set_thread_affinity(pid_t tid, const std::vector<int>& cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+        return sched_setaffinity(tid, sizeof(set), &set) == 0;
+    }
+
+    /**
+     * Applies policy, then nice. A refused real-time policy still gets the nice value.
+     */
+    static bool set_thread_scheduling(pid_t tid, const RolePlacement& placement) {
+        const bool realtime = placement.policy == SCHED_FIFO || placement.policy == SCHED_RR;
+        sched_param param{};
+        param.sched_priority = realtime ? placement.rt_priority : 0;
+        bool ok = sched_setscheduler(tid, placement.policy, &param) == 0;
+        if (!realtime || !ok) {
+            ok = setpriority(PRIO_PROCESS, static_cast<id_t>(tid), placement.nice) == 0 && ok;
+        }
+        return ok;
+    }
+
+    static pid_t current_tid() {
+        return static_cast<pid_t>(syscall(SYS_gettid));
+    }
+
+private:
+    struct Member {
+        pthread_t thread{};
+        pid_t tid = 0;
+        std::string name;
+        ThreadRole role = ThreadRole::DATA_PATH;
+        ThreadPlacementConfig config;
+        bool own_config = false;
+        bool pin = true;
+        bool scheduled = false;                // Scheduling was changed from the default
+        CpuCluster pinned = CpuCluster::ANY;
+        uint64_t last_cpu_ns = 0;
+        uint64_t last_sample_ns = 0;
+        uint32_t utilization_permille = 0;
+    };
+
+    void apply_locked(Member& member) {
+        const RolePlacement& placement = member.config.role(member.role);
+        if (!placement.is_default() || member.scheduled) {
+            if (!set_scheduling_(member.tid, placement)) {
+                failures_.fetch_add(1, std::memory_order_relaxed);
+            }
+            member.scheduled = !placement.is_default();
+        }
+        if (!member.pin) {
+            return;
+        }
+        switch (placement.cluster) {
+            case CpuCluster::ANY:
+                if (member.pinned != CpuCluster::ANY) {
+                    // Undo an earlier pin
+                    if (!set_affinity_(member.tid, topology_.all())) {
+                        failures_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    member.pinned = CpuCluster::ANY;
+                }
+                break;
+            case CpuCluster::AUTO:
+                // Keep the cluster sample() chose when re-applying
+                pin_locked(member, member.pinned == CpuCluster::LITTLE ? CpuCluster::LITTLE : CpuCluster::BIG);
+                break;
+            default:
+                pin_locked(member, placement.cluster);
+                break;
+        }
+    }
+
+    void pin_locked(Member& member, CpuCluster cluster) {
+        if (!set_affinity_(member.tid, topology_.cluster(cluster))) {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+        }
+        member.pinned = cluster;
+    }
+
+    const CpuTopology topology_;
+    CpuClock cpu_clock_;
+    SetAffinity set_affinity_;
+    SetScheduling set_scheduling_;
+    std::atomic<uint64_t> promotions_{0};
+    std::atomic<uint64_t> demotions_{0};
+    std::atomic<uint64_t> failures_{0};
+
+    mutable std::mutex mutex_;
+    ThreadPlacementConfig default_config_;
+    std::map<pid_t, Member> members_;
+};
+
+/**
+ * Joins the calling thread to ThreadPlacement for its lifetime
+ */
+class ScopedThreadPlacement {
+public:
+    ScopedThreadPlacement(const std::string& name, ThreadRole role, bool pin = true)
+        : tid_(ThreadPlacement::instance().join_current_thread(name, role, pin)) {}
+
+    ScopedThreadPlacement(const std::string& name, ThreadRole role, const ThreadPlacementConfig& config,
+                          bool pin = true)
+        : tid_(ThreadPlacement::instance().join_current_thread(name, role, config, pin)) {}
+
+    ~ScopedThreadPlacement() { ThreadPlacement::instance().leave(tid_); }
+
+    ScopedThreadPlacement(const ScopedThreadPlacement&) = delete;
+    ScopedThreadPlacement& operator=(const ScopedThreadPlacement&) = delete;
+
+private:
+    pid_t tid_;
+};
+
+} // namespace openvpn
+
+#endif // THREAD_PLACEMENT_H
@@ -0,0 +1,122 @@
+#include <jni.h>
+#include <vector>
+#include <android/log.h>
+#include "logging_config.h"
+#include "thread_placement.h"
+
+#define LOG_TAG "ThreadPlacement-JNI"
+
+// JNI entry points for com.multiregionvpn.core.NativeThreadPlacement (object @JvmStatic methods).
+// Control plane only: sampling and re-pinning run on the caller's thread.
+
+using openvpn::CpuCluster;
+using openvpn::ThreadPlacement;
+using openvpn::ThreadPlacementConfig;
+
+extern "C" {
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_NativeThreadPlacement_nativeConfigure(
+            JNIEnv *env, jclass clazz, jintArray packed);
+
+    JNIEXPORT jintArray JNICALL
+    Java_com_multiregionvpn_core_NativeThreadPlacement_nativeTopology(
+            JNIEnv *env, jclass clazz);
+
+    JNIEXPORT jlongArray JNICALL
+    Java_com_multiregionvpn_core_NativeThreadPlacement_nativeSample(
+            JNIEnv *env, jclass clazz);
+}
+
+// Fields per role in the packed config: cluster, nice, policy, rtPriority
+static constexpr jsize ROLE_FIELDS = 4;
+static constexpr jsize CONFIG_FIELDS = 2 * ROLE_FIELDS + 2;
+
+static openvpn::RolePlacement unpack_role(const jint* fields) {
+    openvpn::RolePlacement role;
+    role.cluster = fields[0] >= 0 && fields[0] <= static_cast<jint>(CpuCluster::AUTO)
+                       ? static_cast<CpuCluster>(fields[0]) : CpuCluster::ANY;
+    role.nice = fields[1];
+    role.policy = fields[2];
+    role.rt_priority = fields[3];
+    return role;
+}
+
+/**
+ * Sets the process default from [data path role, control role, promotePermille,
+ * demotePermille]. Sessions created afterwards snapshot it.
+ */
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_NativeThreadPlacement_nativeConfigure(
+        JNIEnv *env, jclass clazz, jintArray packed) {
+    if (!packed || env->GetArrayLength(packed) != CONFIG_FIELDS) {
+        LOG_ERROR(LOG_TAG, "nativeConfigure: expected %d fields", (int)CONFIG_FIELDS);
+        return;
+    }
+    jint fields[CONFIG_FIELDS];
+    env->GetIntArrayRegion(packed, 0, CONFIG_FIELDS, fields);
+
+    ThreadPlacementConfig config;
+    config.data_path = unpack_role(fields);
+    config.control = unpack_role(fields + ROLE_FIELDS);
+    config.promote_permille = static_cast<uint32_t>(fields[2 * ROLE_FIELDS] > 0 ? fields[2 * ROLE_FIELDS] : 0);
+    config.demote_permille = static_cast<uint32_t>(fields[2 * ROLE_FIELDS + 1] > 0 ? fields[2 * ROLE_FIELDS + 1] : 0);
+    ThreadPlacement::instance().configure(config);
+    LOG_INFO(LOG_TAG, "Thread placement: data path cluster=%d nice=%d policy=%d, control cluster=%d nice=%d policy=%d",
+             static_cast<int>(config.data_path.cluster), config.data_path.nice, config.data_path.policy,
+             static_cast<int>(config.control.cluster), config.control.nice, config.control.policy);
+}
+
+/**
+ * Returns [bigCount, littleCount, big cpus..., little cpus...]
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_multiregionvpn_core_NativeThreadPlacement_nativeTopology(
+        JNIEnv *env, jclass clazz) {
+    const openvpn::CpuTopology& topology = ThreadPlacement::instance().topology();
+    std::vector<jint> packed;
+    packed.push_back(static_cast<jint>(topology.big.size()));
+    packed.push_back(static_cast<jint>(topology.little.size()));
+    packed.insert(packed.end(), topology.big.begin(), topology.big.end());
+    packed.insert(packed.end(), topology.little.begin(), topology.little.end());
+
+    jintArray result = env->NewIntArray(static_cast<jsize>(packed.size()));
+    if (result) {
+        env->SetIntArrayRegion(result, 0, static_cast<jsize>(packed.size()), packed.data());
+    }
+    return result;
+}
+
+/**
+ * Samples per-thread CPU use, moves AUTO threads, and returns
+ * [promotions, demotions, failures, threadCount, then tid, role, cluster,
+ * utilizationPermille per thread].
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_multiregionvpn_core_NativeThreadPlacement_nativeSample(
+        JNIEnv *env, jclass clazz) {
+    ThreadPlacement& placement = ThreadPlacement::instance();
+    if (placement.sample() > 0) {
+        LOG_INFO(LOG_TAG, "Moved threads between clusters (%llu promotions, %llu demotions total)",
+                 (unsigned long long)placement.promotions(), (unsigned long long)placement.demotions());
+    }
+    const std::vector<openvpn::PlacedThreadStats> threads = placement.threads();
+
+    std::vector<jlong> packed;
+    packed.reserve(4 + threads.size() * 4);
+    packed.push_back(static_cast<jlong>(placement.promotions()));
+    packed.push_back(static_cast<jlong>(placement.demotions()));
+    packed.push_back(static_cast<jlong>(placement.failures()));
+    packed.push_back(static_cast<jlong>(threads.size()));
+    for (const openvpn::PlacedThreadStats& thread : threads) {
+        packed.push_back(thread.tid);
+        packed.push_back(static_cast<jlong>(thread.role));
+        packed.push_back(static_cast<jlong>(thread.cluster));
+        packed.push_back(thread.utilization_permille);
+    }
+
+    jlongArray result = env->NewLongArray(static_cast<jsize>(packed.size()));
+    if (result) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(packed.size()), packed.data());
+    }
+    return result;
+}
@@ -0,0 +1,179 @@
+#ifndef TUN_BATCH_READER_H
+#define TUN_BATCH_READER_H
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Default number of SEQPACKET messages drained per readiness event.
+// Override at build time with -DTUN_READ_BATCH_SIZE=<n> (see CMakeLists.txt).
+#ifndef TUN_READ_BATCH_SIZE
+#define TUN_READ_BATCH_SIZE 32
+#endif
+
+namespace openvpn {
+
+/**
+ * Per-batch fill statistics for TunBatchReader.
+ *
+ * The fill histogram uses power-of-two buckets: bucket 0 counts batches of
+ * exactly 1 packet, bucket 1 counts 2-3, bucket 2 counts 4-7, and so on.
+ * Counters are relaxed atomics so they can be read from any thread.
+ */
+struct TunBatchStats {
+    static constexpr size_t FILL_BUCKETS = 8;
+
+    std::atomic<uint64_t> batches{0};        // recvmmsg() calls that returned packets
+    std::atomic<uint64_t> packets{0};        // Packets returned across all batches
+    std::atomic<uint64_t> full_batches{0};   // Batches that filled every slot
+    std::atomic<uint64_t> empty_reads{0};    // Readiness events that found nothing (EAGAIN)
+    std::atomic<uint64_t> truncated{0};      // Messages larger than their slot
+    std::atomic<uint64_t> fill_histogram[FILL_BUCKETS] = {};
+
+    static size_t bucket_for(size_t fill) {
+        size_t bucket = 0;
+        while (fill > 1 && bucket + 1 < FILL_BUCKETS) {
+            fill >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    void record(size_t fill, size_t capacity) {
+        batches.fetch_add(1, std::memory_order_relaxed);
+        packets.fetch_add(fill, std::memory_order_relaxed);
+        if (fill == capacity) {
+            full_batches.fetch_add(1, std::memory_order_relaxed);
+        }
+        fill_histogram[bucket_for(fill)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Average packets per non-empty batch, scaled by 100 to stay integral
+    uint64_t average_fill_x100() const {
+        uint64_t b = batches.load(std::memory_order_relaxed);
+        return b ? (packets.load(std::memory_order_relaxed) * 100) / b : 0;
+    }
+};
+
+/**
+ * Drains several SOCK_SEQPACKET messages from a non-blocking FD with a single
+ * recvmmsg() call.
+ *
+ * Each slot is backed by caller-owned storage registered with set_slot(), so
+ * the reader itself never allocates on the read path. After read_batch()
+ * returns n > 0, length(i) and truncated(i) describe slots [0, n).
+ */
+class TunBatchReader {
+public:
+    static constexpr size_t DEFAULT_BATCH_SIZE = TUN_READ_BATCH_SIZE;
+    static constexpr size_t MAX_BATCH_SIZE = 64;
+
+    explicit TunBatchReader(size_t batch_size = DEFAULT_BATCH_SIZE)
+        : msgs_(MAX_BATCH_SIZE),
+          iovs_(MAX_BATCH_SIZE) {
+        set_batch_size(batch_size);
+        for (size_t i = 0; i < MAX_BATCH_SIZE; ++i) {
+            iovs_[i].iov_base = nullptr;
+            iovs_[i].iov_len = 0;
+            msgs_[i] = {};
+            msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    /**
+     * Counts into an external stats block (e.g. a tunnel's TunnelStats) instead
+     * of the reader's own, so totals survive the reader's owner
+     */
+    void attach_stats(TunBatchStats& stats) {
+        stats_ = &stats;
+    }
+
+    /**
+     * Sets how many messages a single read_batch() may return (clamped to 1..MAX_BATCH_SIZE)
+     */
+    void set_batch_size(size_t batch_size) {
+        if (batch_size < 1) {
+            batch_size = 1;
+        } else if (batch_size > MAX_BATCH_SIZE) {
+            batch_size = MAX_BATCH_SIZE;
+        }
+        batch_size_ = batch_size;
+    }
+
+    size_t batch_size() const {
+        return batch_size_;
+    }
+
+    /**
+     * Points slot i at caller-owned storage of the given capacity
+     */
+    void set_slot(size_t i, void* data, size_t capacity) {
+        iovs_[i].iov_base = data;
+        iovs_[i].iov_len = capacity;
+    }
+
+    /**
+     * Reads up to batch_size() messages without blocking.
+     *
+     * @return number of messages read, 0 if nothing was pending, -1 on error (errno set)
+     */
+    int read_batch(int fd) {
+        for (size_t i = 0; i < batch_size_; ++i) {
+            msgs_[i].msg_hdr.msg_flags = 0;
+            msgs_[i].msg_len = 0;
+        }
+
+        int n;
+        do {
+            n = recvmmsg(fd, msgs_.data(), static_cast<unsigned int>(batch_size_), MSG_DONTWAIT, nullptr);
+        } while (n < 0 && errno == EINTR);
+
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                stats_->empty_reads.fetch_add(1, std::memory_order_relaxed);
+                return 0;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            stats_->empty_reads.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            if (truncated(static_cast<size_t>(i))) {
+                stats_->truncated.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        stats_->record(static_cast<size_t>(n), batch_size_);
+        return n;
+    }
+
+    size_t length(size_t i) const {
+        return msgs_[i].msg_len;
+    }
+
+    bool truncated(size_t i) const {
+        return (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+
+    const TunBatchStats& stats() const {
+        return *stats_;
+    }
+
+private:
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec> iovs_;
+    size_t batch_size_ = DEFAULT_BATCH_SIZE;
+    TunBatchStats own_stats_;
+    TunBatchStats* stats_ = &own_stats_;
+};
+
+} // namespace openvpn
+
+#endif // TUN_BATCH_READER_H
@@ -0,0 +1,141 @@
+#ifndef TUN_BUFFER_POOL_H
+#define TUN_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Maximum number of idle packet buffers kept per tunnel.
+// Override at build time with -DTUN_BUFFER_POOL_SIZE=<n> (see CMakeLists.txt).
+#ifndef TUN_BUFFER_POOL_SIZE
+#define TUN_BUFFER_POOL_SIZE 128
+#endif
+
+namespace openvpn {
+
+/**
+ * Counters for TunBufferPool.
+ *
+ * Written only from the owning io_context thread; relaxed atomics so stats
+ * can be read from JNI or logging threads.
+ */
+struct TunBufferPoolStats {
+    std::atomic<uint64_t> hits{0};        // acquire() served from the free list
+    std::atomic<uint64_t> misses{0};      // acquire() had to allocate
+    std::atomic<uint64_t> discards{0};    // release() dropped a buffer (pool full or undersized)
+    std::atomic<uint64_t> in_use{0};      // Buffers currently handed out
+    std::atomic<uint64_t> high_water{0};  // Peak value of in_use
+};
+
+/**
+ * Fixed-size per-tunnel pool of packet buffers.
+ *
+ * Every buffer has the same capacity (headroom + payload + tailroom), so any
+ * idle buffer can serve any packet. The pool is owned by one CustomTunClient
+ * and only touched from its io_context thread, which makes acquire/release a
+ * plain vector push/pop with no locking.
+ *
+ * Buffer must be constructible as Buffer(capacity, flags), movable, and
+ * expose capacity(); openvpn::BufferAllocated satisfies this.
+ */
+template <typename Buffer>
+class TunBufferPool {
+public:
+    static constexpr size_t DEFAULT_POOL_SIZE = TUN_BUFFER_POOL_SIZE;
+
+    TunBufferPool() = default;
+
+    TunBufferPool(size_t buffer_size, size_t max_idle) {
+        configure(buffer_size, max_idle);
+    }
+
+    /**
+     * Counts into an external stats block (e.g. a tunnel's TunnelStats) instead
+     * of the pool's own, so totals survive the pool's owner
+     */
+    void attach_stats(TunBufferPoolStats& stats) {
+        stats_ = &stats;
+    }
+
+    /**
+     * Sets the per-buffer capacity and idle limit, dropping any idle buffers
+     */
+    void configure(size_t buffer_size, size_t max_idle) {
+        buffer_size_ = buffer_size;
+        max_idle_ = max_idle;
+        free_.clear();
+        free_.reserve(max_idle_);
+    }
+
+    /**
+     * Allocates up to count idle buffers ahead of time
+     */
+    void prefill(size_t count) {
+        while (free_.size() < count && free_.size() < max_idle_) {
+            free_.emplace_back(buffer_size_, 0);
+        }
+    }
+
+    /**
+     * Returns an idle buffer, or a newly allocated one if none are idle.
+     * The buffer's contents and offsets are unspecified; callers reset them.
+     */
+    Buffer acquire() {
+        uint64_t in_use = stats_->in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (in_use > stats_->high_water.load(std::memory_order_relaxed)) {
+            stats_->high_water.store(in_use, std::memory_order_relaxed);
+        }
+
+        if (!free_.empty()) {
+            stats_->hits.fetch_add(1, std::memory_order_relaxed);
+            Buffer buf(std::move(free_.back()));
+            free_.pop_back();
+            return buf;
+        }
+
+        stats_->misses.fetch_add(1, std::memory_order_relaxed);
+        return Buffer(buffer_size_, 0);
+    }
+
+    /**
+     * Returns a buffer obtained from acquire() to the pool.
+     * Buffers smaller than buffer_size() (e.g. swapped in by OpenVPN during
+     * encryption) or beyond the idle limit are freed instead.
+     */
+    void release(Buffer&& buf) {
+        if (stats_->in_use.load(std::memory_order_relaxed) > 0) {
+            stats_->in_use.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (free_.size() < max_idle_ && buf.capacity() >= buffer_size_) {
+            free_.emplace_back(std::move(buf));
+        } else {
+            stats_->discards.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    size_t buffer_size() const {
+        return buffer_size_;
+    }
+
+    size_t idle() const {
+        return free_.size();
+    }
+
+    const TunBufferPoolStats& stats() const {
+        return *stats_;
+    }
+
+private:
+    size_t buffer_size_ = 0;
+    size_t max_idle_ = DEFAULT_POOL_SIZE;
+    std::vector<Buffer> free_;
+    TunBufferPoolStats own_stats_;
+    TunBufferPoolStats* stats_ = &own_stats_;
+};
+
+} // namespace openvpn
+
+#endif // TUN_BUFFER_POOL_H
@@ -0,0 +1,218 @@
+#ifndef TUN_EGRESS_QUEUE_H
+#define TUN_EGRESS_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Packets held per tunnel while lib_fd is not writable.
+// Override at build time with -DTUN_EGRESS_QUEUE_SIZE=<n> (see CMakeLists.txt).
+#ifndef TUN_EGRESS_QUEUE_SIZE
+#define TUN_EGRESS_QUEUE_SIZE 256
+#endif
+
+// What a full queue drops: 0 = tail-drop, 1 = head-drop, 2 = drop-by-age, and
+// the age (ms) at which drop-by-age expires queued packets.
+// Override at build time with -DTUN_EGRESS_DROP_POLICY=<n> / -DTUN_EGRESS_MAX_AGE_MS=<n>.
+#ifndef TUN_EGRESS_DROP_POLICY
+#define TUN_EGRESS_DROP_POLICY 0
+#endif
+#ifndef TUN_EGRESS_MAX_AGE_MS
+#define TUN_EGRESS_MAX_AGE_MS 100
+#endif
+
+namespace openvpn {
+
+/**
+ * What TunEgressQueue does with a packet that arrives while it is full
+ */
+enum class TunDropPolicy {
+    TAIL_DROP,    // Drop the arriving packet
+    HEAD_DROP,    // Drop the oldest queued packet to make room
+    DROP_BY_AGE   // Drop queued packets older than max_age_ms, then tail-drop if still full
+};
+
+inline const char* drop_policy_name(TunDropPolicy policy) {
+    switch (policy) {
+        case TunDropPolicy::TAIL_DROP: return "tail-drop";
+        case TunDropPolicy::HEAD_DROP: return "head-drop";
+        case TunDropPolicy::DROP_BY_AGE: return "drop-by-age";
+    }
+    return "unknown";
+}
+
+static_assert(TUN_EGRESS_DROP_POLICY >= 0 && TUN_EGRESS_DROP_POLICY <= 2,
+              "TUN_EGRESS_DROP_POLICY must be 0 (tail), 1 (head) or 2 (age)");
+
+/**
+ * Counters for TunEgressQueue, readable from any thread
+ */
+struct TunEgressStats {
+    std::atomic<uint64_t> enqueued{0};    // Packets accepted into the queue
+    std::atomic<uint64_t> flushed{0};     // Packets popped after a successful write
+    std::atomic<uint64_t> tail_drops{0};  // Arriving packets rejected while full
+    std::atomic<uint64_t> head_drops{0};  // Oldest packets evicted by HEAD_DROP
+    std::atomic<uint64_t> age_drops{0};   // Packets expired by DROP_BY_AGE
+    std::atomic<uint64_t> high_water{0};  // Peak queue depth
+
+    uint64_t total_drops() const {
+        return tail_drops.load(std::memory_order_relaxed) +
+               head_drops.load(std::memory_order_relaxed) +
+               age_drops.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Bounded FIFO ring of packets waiting for lib_fd to become writable.
+ *
+ * Used from a single io_context thread. Evicted packets are handed to a
+ * caller-supplied drop callback so their buffers can go back to the pool.
+ */
+template <typename Buffer>
+class TunEgressQueue {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = TUN_EGRESS_QUEUE_SIZE;
+    static constexpr TunDropPolicy DEFAULT_POLICY = static_cast<TunDropPolicy>(TUN_EGRESS_DROP_POLICY);
+    static constexpr uint64_t DEFAULT_MAX_AGE_MS = TUN_EGRESS_MAX_AGE_MS;
+
+    explicit TunEgressQueue(size_t capacity = DEFAULT_CAPACITY,
+                            TunDropPolicy policy = DEFAULT_POLICY,
+                            uint64_t max_age_ms = DEFAULT_MAX_AGE_MS) {
+        configure(capacity, policy, max_age_ms);
+    }
+
+    TunEgressQueue(const TunEgressQueue&) = delete;
+    TunEgressQueue& operator=(const TunEgressQueue&) = delete;
+
+    /**
+     * Counts into an external stats block (e.g. a tunnel's TunnelStats) instead
+     * of the queue's own, so totals survive the queue's owner
+     */
+    void attach_stats(TunEgressStats& stats) {
+        stats_ = &stats;
+    }
+
+    /**
+     * Resizes the ring and sets the drop policy. Must only be called while empty.
+     */
+    void configure(size_t capacity, TunDropPolicy policy, uint64_t max_age_ms) {
+        ring_.clear();
+        ring_.resize(capacity < 1 ? 1 : capacity);
+        head_ = 0;
+        count_ = 0;
+        policy_ = policy;
+        max_age_ms_ = max_age_ms;
+    }
+
+    /**
+     * Appends a packet, applying the drop policy if the ring is full.
+     *
+     * @return true if buf was queued, false if it was dropped
+     */
+    template <typename DropFn>
+    bool push(Buffer&& buf, uint64_t now_ms, DropFn&& drop) {
+        if (full() && policy_ == TunDropPolicy::DROP_BY_AGE) {
+            expire(now_ms, drop);
+        }
+
+        if (full()) {
+            if (policy_ == TunDropPolicy::HEAD_DROP) {
+                drop(std::move(ring_[head_].buf));
+                pop_front();
+                stats_->head_drops.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                drop(std::move(buf));
+                stats_->tail_drops.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        Entry& slot = ring_[(head_ + count_) % ring_.size()];
+        slot.buf = std::move(buf);
+        slot.enqueued_ms = now_ms;
+        ++count_;
+
+        stats_->enqueued.fetch_add(1, std::memory_order_relaxed);
+        if (count_ > stats_->high_water.load(std::memory_order_relaxed)) {
+            stats_->high_water.store(count_, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * Drops queued packets older than max_age_ms (DROP_BY_AGE only)
+     */
+    template <typename DropFn>
+    void expire(uint64_t now_ms, DropFn&& drop) {
+        if (policy_ != TunDropPolicy::DROP_BY_AGE) {
+            return;
+        }
+        while (count_ > 0 && now_ms - ring_[head_].enqueued_ms > max_age_ms_) {
+            drop(std::move(ring_[head_].buf));
+            pop_front();
+            stats_->age_drops.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Hands every queued packet to release without counting it as a drop;
+     * used when the queue's owner is torn down
+     */
+    template <typename ReleaseFn>
+    void drain(ReleaseFn&& release) {
+        while (count_ > 0) {
+            release(std::move(ring_[head_].buf));
+            pop_front();
+        }
+    }
+
+    Buffer& front() {
+        return ring_[head_].buf;
+    }
+
+    /**
+     * Removes the front packet after it was written, returning its buffer
+     */
+    Buffer pop() {
+        Buffer buf(std::move(ring_[head_].buf));
+        pop_front();
+        stats_->flushed.fetch_add(1, std::memory_order_relaxed);
+        return buf;
+    }
+
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == ring_.size(); }
+    size_t size() const { return count_; }
+    size_t capacity() const { return ring_.size(); }
+    TunDropPolicy policy() const { return policy_; }
+    uint64_t max_age_ms() const { return max_age_ms_; }
+
+    const TunEgressStats& stats() const {
+        return *stats_;
+    }
+
+private:
+    struct Entry {
+        Buffer buf;
+        uint64_t enqueued_ms = 0;
+    };
+
+    void pop_front() {
+        head_ = (head_ + 1) % ring_.size();
+        --count_;
+    }
+
+    std::vector<Entry> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    TunDropPolicy policy_ = TunDropPolicy::TAIL_DROP;
+    uint64_t max_age_ms_ = DEFAULT_MAX_AGE_MS;
+    TunEgressStats own_stats_;
+    TunEgressStats* stats_ = &own_stats_;
+};
+
+} // namespace openvpn
+
+#endif // TUN_EGRESS_QUEUE_H
@@ -0,0 +1,485 @@
+#ifndef TUN_PUMP_H
+#define TUN_PUMP_H
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "native_packet_router.h"
+#include "packet_ring.h"
+#include "thread_placement.h"
+#include "tun_egress_queue.h"
+
+// Packets moved per fd per readiness event before servicing other fds.
+// Shares the outbound batch size knob (see CMakeLists.txt).
+#ifndef TUN_READ_BATCH_SIZE
+#define TUN_READ_BATCH_SIZE 32
+#endif
+
+namespace openvpn {
+
+/**
+ * Counters for TunPump, readable from any thread
+ */
+struct TunPumpStats {
+    std::atomic<uint64_t> tun_packets{0};        // Packets read from the TUN fd
+    std::atomic<uint64_t> routed{0};             // Outbound packets forwarded to a tunnel natively
+    std::atomic<uint64_t> misses{0};             // Outbound packets handed to the Kotlin router
+    std::atomic<uint64_t> miss_drops{0};         // Misses dropped because the miss queue was full
+    std::atomic<uint64_t> app_send_drops{0};     // Outbound packets the tunnel socket refused
+    std::atomic<uint64_t> inbound_packets{0};    // Packets read from tunnel app fds
+    std::atomic<uint64_t> tun_write_drops{0};    // Inbound packets the TUN fd refused
+};
+
+/**
+ * Native data path between the VpnService TUN fd and each tunnel's socketpair.
+ *
+ * One thread runs an epoll loop over the TUN fd, every attached tunnel app_fd
+ * and a wakeup eventfd. Outbound packets are classified by NativePacketRouter
+ * and sent straight to the tunnel's app_fd; inbound packets are copied from
+ * app_fd to the TUN fd. Only flow misses (first packet of a flow, or a tunnel
+ * not yet attached) go up to Kotlin through take_miss(), where PacketRouter
+ * decides and teaches the router the flow.
+ *
+ * A tunnel attached with a PacketRingPair exchanges packets through the
+ * shared-memory rings instead: outbound packets are pushed into the ring and
+ * published once per batch, and inbound packets are drained from the ring when
+ * its doorbell fires. The app_fd stays watched so packets CustomTunClient sent
+ * over the socketpair before the attach are still delivered.
+ *
+ * The pump dup()s every fd it is given and closes its copies itself, so the
+ * Kotlin side keeps ownership of its own descriptors. The TUN dup shares its
+ * file status flags with the VpnService fd: the pump sets O_NONBLOCK while it
+ * owns the fd, so a readiness event is drained with plain reads until EAGAIN,
+ * and stop() restores the original flags before Kotlin reads the fd again.
+ * Kotlin's writes to the fd while the pump runs are unaffected, since a TUN
+ * write never waits for space.
+ */
+class TunPump {
+public:
+    static constexpr int MAX_TUNNELS = 64;
+    static constexpr size_t PACKET_SIZE = 32767;        // Matches the Kotlin TUN read buffer
+    static constexpr size_t MISS_QUEUE_SIZE = 256;
+    static constexpr size_t BATCH_SIZE = TUN_READ_BATCH_SIZE;
+
+    explicit TunPump(NativePacketRouter& router)
+        : router_(router), misses_(MISS_QUEUE_SIZE, TunDropPolicy::TAIL_DROP) {
+        app_fds_.fill(-1);
+    }
+
+    ~TunPump() {
+        stop();
+        for (int& fd : app_fds_) {
+            if (fd >= 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        for (auto& ring : rings_) {
+            if (ring) {
+                ring->set_app_attached(false);
+            }
+        }
+    }
+
+    TunPump(const TunPump&) = delete;
+    TunPump& operator=(const TunPump&) = delete;
+
+    /**
+     * Process-wide pump shared by the JNI entry points
+     */
+    static TunPump& instance() {
+        static TunPump pump(NativePacketRouter::instance());
+        return pump;
+    }
+
+    /**
+     * Starts pumping tun_fd, replacing any previous TUN fd. Attached tunnels
+     * carry over.
+     *
+     * @return false if the fd could not be duplicated or epoll set up
+     */
+    bool start(int tun_fd) {
+        stop();
+
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        tun_fd_ = dup(tun_fd);
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (tun_fd_ < 0 || epoll_fd_ < 0 || wake_fd_ < 0) {
+            close_loop_fds();
+            return false;
+        }
+        tun_flags_ = fcntl(tun_fd_, F_GETFL, 0);
+        if (tun_flags_ < 0 || fcntl(tun_fd_, F_SETFL, tun_flags_ | O_NONBLOCK) != 0) {
+            close_loop_fds();
+            return false;
+        }
+
+        bool ok = watch(tun_fd_, TUN_TAG) && watch(wake_fd_, WAKE_TAG);
+        for (int i = 0; ok && i < MAX_TUNNELS; ++i) {
+            if (app_fds_[i] >= 0) {
+                ok = watch(app_fds_[i], static_cast<uint32_t>(i));
+            }
+            if (ok && rings_[i]) {
+                ok = watch_ring(i);
+            }
+        }
+        if (!ok) {
+            close_loop_fds();
+            return false;
+        }
+
+        stopping_.store(false, std::memory_order_relaxed);
+        running_ = true;
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    /**
+     * Stops the loop thread, restores the TUN fd's flags and releases it. Safe
+     * to call when stopped.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(control_mutex_);
+            if (!running_) {
+                return;
+            }
+            stopping_.store(true, std::memory_order_relaxed);
+            wake();
+        }
+        thread_.join();
+
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        running_ = false;
+        apply_commands_locked();
+        close_loop_fds();
+        miss_cv_.notify_all();
+    }
+
+    bool running() const {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        return running_;
+    }
+
+    /**
+     * Routes packets for tunnel_index to app_fd, replacing any previous fd.
+     * With a ring pair, packets move through its rings and app_fd only
+     * carries what was already queued on the socketpair.
+     */
+    bool attach_tunnel(int tunnel_index, int app_fd,
+                       std::shared_ptr<PacketRingPair> ring = nullptr) {
+        if (tunnel_index < 0 || tunnel_index >= MAX_TUNNELS || app_fd < 0) {
+            return false;
+        }
+        const int fd = dup(app_fd);
+        if (fd < 0) {
+            return false;
+        }
+        submit({tunnel_index, fd, std::move(ring)});
+        return true;
+    }
+
+    void detach_tunnel(int tunnel_index) {
+        if (tunnel_index >= 0 && tunnel_index < MAX_TUNNELS) {
+            submit({tunnel_index, -1, nullptr});
+        }
+    }
+
+    /**
+     * Waits up to timeout_ms for an outbound packet the router could not place
+     * and copies it into out.
+     *
+     * @return packet length, 0 on timeout, or -1 once the pump is stopped and
+     *         no misses remain
+     */
+    ssize_t take_miss(uint8_t* out, size_t capacity, int timeout_ms) {
+        std::unique_lock<std::mutex> lock(miss_mutex_);
+        miss_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] {
+            return !misses_.empty() || stopping_.load(std::memory_order_relaxed);
+        });
+        if (misses_.empty()) {
+            return stopping_.load(std::memory_order_relaxed) ? -1 : 0;
+        }
+        std::vector<uint8_t> packet = misses_.pop();
+        if (packet.size() > capacity) {
+            return 0;
+        }
+        std::memcpy(out, packet.data(), packet.size());
+        return static_cast<ssize_t>(packet.size());
+    }
+
+    const TunPumpStats& stats() const { return stats_; }
+
+private:
+    static constexpr uint32_t TUN_TAG = 0xFFFFFFF0u;
+    static constexpr uint32_t WAKE_TAG = 0xFFFFFFF1u;
+    static constexpr uint32_t RING_TAG = 0x10000u;   // RING_TAG + index: inbound ring doorbell
+
+    struct Command {
+        int tunnel_index;
+        int fd;   // Pump-owned dup, or -1 to detach
+        std::shared_ptr<PacketRingPair> ring;
+    };
+
+    bool watch(int fd, uint32_t tag) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = tag;
+        return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    // Watches the inbound ring's doorbell and rings it once so the loop drains
+    // anything published before the pump was listening, then parks
+    bool watch_ring(int tunnel_index) {
+        const int data_fd = rings_[tunnel_index]->inbound().data_fd();
+        if (!watch(data_fd, RING_TAG + static_cast<uint32_t>(tunnel_index))) {
+            return false;
+        }
+        PacketRing::ring(data_fd);
+        return true;
+    }
+
+    void wake() {
+        const uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    // While running, the loop thread owns app_fds_; commands are queued for it
+    void submit(Command command) {
+        std::lock_guard<std::mutex> lock(control_mutex_);
+        pending_.push_back(command);
+        if (running_) {
+            wake();
+        } else {
+            apply_commands_locked();
+        }
+    }
+
+    void apply_commands_locked() {
+        for (const Command& command : pending_) {
+            int& slot = app_fds_[command.tunnel_index];
+            if (slot >= 0) {
+                if (running_) {
+                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, slot, nullptr);
+                }
+                close(slot);
+            }
+            slot = command.fd;
+            if (slot >= 0 && running_) {
+                watch(slot, static_cast<uint32_t>(command.tunnel_index));
+            }
+
+            std::shared_ptr<PacketRingPair>& ring = rings_[command.tunnel_index];
+            if (ring) {
+                if (running_) {
+                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, ring->inbound().data_fd(), nullptr);
+                }
+                ring->set_app_attached(false);
+            }
+            ring = command.ring;
+            if (ring) {
+                ring->set_app_attached(true);
+                if (running_) {
+                    watch_ring(command.tunnel_index);
+                }
+            }
+        }
+        pending_.clear();
+    }
+
+    void close_loop_fds() {
+        if (tun_fd_ >= 0 && tun_flags_ >= 0) {
+            fcntl(tun_fd_, F_SETFL, tun_flags_);
+        }
+        tun_flags_ = -1;
+        for (int* fd : {&tun_fd_, &epoll_fd_, &wake_fd_}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    void run() {
+        ScopedThreadPlacement placement("tun-pump", ThreadRole::DATA_PATH);
+        epoll_event events[16];
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            const int n = epoll_wait(epoll_fd_, events, 16, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            // Apply attach/detach before moving packets so a detach is never overtaken
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.u32 == WAKE_TAG) {
+                    uint64_t count;
+                    ssize_t ignored = read(wake_fd_, &count, sizeof(count));
+                    (void)ignored;
+                    std::lock_guard<std::mutex> lock(control_mutex_);
+                    apply_commands_locked();
+                }
+            }
+            for (int i = 0; i < n; ++i) {
+                const uint32_t tag = events[i].data.u32;
+                if (tag == TUN_TAG) {
+                    pump_outbound();
+                } else if (tag < static_cast<uint32_t>(MAX_TUNNELS)) {
+                    pump_inbound(static_cast<int>(tag));
+                } else if (tag >= RING_TAG && tag < RING_TAG + MAX_TUNNELS) {
+                    pump_inbound_ring(static_cast<int>(tag - RING_TAG));
+                }
+            }
+        }
+    }
+
+    void pump_outbound() {
+        const uint64_t now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+
+        static_assert(MAX_TUNNELS <= 64, "pushed_rings has one bit per tunnel");
+        uint64_t pushed_rings = 0;   // Bit per tunnel index with unpublished ring packets
+        // Reads until EAGAIN; past BATCH_SIZE the level-triggered epoll reports
+        // the fd again after the other fds had a turn
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            const ssize_t len = read(tun_fd_, buffer_, sizeof(buffer_));
+            if (len <= 0) {
+                break;
+            }
+            stats_.tun_packets.fetch_add(1, std::memory_order_relaxed);
+
+            const int index = router_.route(buffer_, static_cast<size_t>(len), now_ms);
+            const int app_fd = (index >= 0 && index < MAX_TUNNELS) ? app_fds_[index] : -1;
+            if (app_fd < 0) {
+                push_miss(static_cast<size_t>(len), now_ms);
+                continue;
+            }
+            bool sent;
+            if (rings_[index]) {
+                sent = rings_[index]->outbound().push(buffer_, static_cast<size_t>(len));
+                pushed_rings |= sent ? (1ULL << index) : 0;
+            } else {
+                sent = send(app_fd, buffer_, static_cast<size_t>(len), MSG_DONTWAIT | MSG_NOSIGNAL) >= 0;
+            }
+            if (sent) {
+                stats_.routed.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                stats_.app_send_drops.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // One publish (and at most one doorbell) per tunnel per batch
+        while (pushed_rings) {
+            const int index = __builtin_ctzll(pushed_rings);
+            pushed_rings &= pushed_rings - 1;
+            rings_[index]->outbound().publish();
+        }
+    }
+
+    void pump_inbound(int tunnel_index) {
+        const int app_fd = app_fds_[tunnel_index];
+        if (app_fd < 0) {
+            return;
+        }
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            const ssize_t len = recv(app_fd, buffer_, sizeof(buffer_), MSG_DONTWAIT);
+            if (len == 0) {
+                // Peer (CustomTunClient) closed: stop watching until re-attached
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, app_fd, nullptr);
+                break;
+            }
+            if (len < 0) {
+                break;
+            }
+            stats_.inbound_packets.fetch_add(1, std::memory_order_relaxed);
+            if (write(tun_fd_, buffer_, static_cast<size_t>(len)) < 0) {
+                stats_.tun_write_drops.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void pump_inbound_ring(int tunnel_index) {
+        if (!rings_[tunnel_index]) {
+            return;
+        }
+        PacketRing& ring = rings_[tunnel_index]->inbound();
+        PacketRing::drain_doorbell(ring.data_fd());
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            size_t len;
+            const uint8_t* packet = ring.front(len);
+            if (!packet) {
+                break;
+            }
+            stats_.inbound_packets.fetch_add(1, std::memory_order_relaxed);
+            if (write(tun_fd_, packet, len) < 0) {
+                stats_.tun_write_drops.fetch_add(1, std::memory_order_relaxed);
+            }
+            ring.pop();
+        }
+        ring.release();
+
+        // Packets left over: keep the doorbell readable so other fds get a turn first
+        if (!ring.park_consumer()) {
+            PacketRing::ring(ring.data_fd());
+        }
+    }
+
+    void push_miss(size_t len, uint64_t now_ms) {
+        std::vector<uint8_t> packet(buffer_, buffer_ + len);
+        bool queued;
+        {
+            std::lock_guard<std::mutex> lock(miss_mutex_);
+            queued = misses_.push(std::move(packet), now_ms, [](std::vector<uint8_t>&&) {});
+        }
+        if (queued) {
+            stats_.misses.fetch_add(1, std::memory_order_relaxed);
+            miss_cv_.notify_one();
+        } else {
+            stats_.miss_drops.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    NativePacketRouter& router_;
+
+    mutable std::mutex control_mutex_;
+    std::vector<Command> pending_;
+    bool running_ = false;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+
+    int tun_fd_ = -1;
+    int tun_flags_ = -1;   // tun_fd_'s file status flags before start() set O_NONBLOCK
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::array<int, MAX_TUNNELS> app_fds_;   // Pump-owned dups, indexed by router tunnel index
+    std::array<std::shared_ptr<PacketRingPair>, MAX_TUNNELS> rings_;
+    uint8_t buffer_[PACKET_SIZE];            // Loop thread only
+
+    std::mutex miss_mutex_;
+    std::condition_variable miss_cv_;
+    TunEgressQueue<std::vector<uint8_t>> misses_;
+
+    TunPumpStats stats_;
+};
+
+} // namespace openvpn
+
+#endif // TUN_PUMP_H
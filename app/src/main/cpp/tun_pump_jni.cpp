@@ -0,0 +1,142 @@
+#include <jni.h>
+#include <string>
+#include <android/log.h>
+#include "logging_config.h"
+#include "tun_pump.h"
+
+#define LOG_TAG "TunPump-JNI"
+
+// JNI entry points for com.multiregionvpn.core.NativeTunPump (object @JvmStatic methods).
+// Control plane only: per-packet work happens on the pump thread.
+
+using openvpn::NativePacketRouter;
+using openvpn::PacketRingPair;
+using openvpn::PacketRingRegistry;
+using openvpn::TunPump;
+
+extern "C" {
+    JNIEXPORT jboolean JNICALL
+    Java_com_multiregionvpn_core_NativeTunPump_nativeStart(
+            JNIEnv *env, jclass clazz, jint tunFd);
+
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_NativeTunPump_nativeStop(
+            JNIEnv *env, jclass clazz);
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_multiregionvpn_core_NativeTunPump_nativeIsRunning(
+            JNIEnv *env, jclass clazz);
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_multiregionvpn_core_NativeTunPump_nativeAttachTunnel(
+            JNIEnv *env, jclass clazz, jstring tunnelId, jint appFd);
+
+    JNIEXPORT void JNICALL
+    Java_com_multiregionvpn_core_NativeTunPump_nativeDetachTunnel(
+            JNIEnv *env, jclass clazz, jstring tunnelId);
+
+    JNIEXPORT jint JNICALL
+    Java_com_multiregionvpn_core_NativeTunPump_nativeTakeMiss(
+            JNIEnv *env, jclass clazz, jobject buffer, jint timeoutMs);
+}
+
+static bool tunnel_id_string(JNIEnv* env, jstring tunnelId, std::string& out) {
+    if (!tunnelId) {
+        return false;
+    }
+    const char* tunnelIdStr = env->GetStringUTFChars(tunnelId, nullptr);
+    if (!tunnelIdStr) {
+        return false;
+    }
+    out = tunnelIdStr;
+    env->ReleaseStringUTFChars(tunnelId, tunnelIdStr);
+    return true;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_multiregionvpn_core_NativeTunPump_nativeStart(
+        JNIEnv *env, jclass clazz, jint tunFd) {
+    if (tunFd < 0) {
+        return JNI_FALSE;
+    }
+    if (!TunPump::instance().start(tunFd)) {
+        LOG_ERROR(LOG_TAG, "Failed to start TUN pump on fd %d: %s", tunFd, strerror(errno));
+        return JNI_FALSE;
+    }
+    LOG_INFO(LOG_TAG, "TUN pump started on fd %d", tunFd);
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_NativeTunPump_nativeStop(
+        JNIEnv *env, jclass clazz) {
+    TunPump& pump = TunPump::instance();
+    pump.stop();
+
+#if LOGGING_INFO_ENABLED
+    const openvpn::TunPumpStats& stats = pump.stats();
+    LOG_INFO(LOG_TAG, "TUN pump stopped: tun=%llu routed=%llu misses=%llu inbound=%llu drops(miss=%llu send=%llu tun=%llu)",
+             (unsigned long long)stats.tun_packets.load(), (unsigned long long)stats.routed.load(),
+             (unsigned long long)stats.misses.load(), (unsigned long long)stats.inbound_packets.load(),
+             (unsigned long long)stats.miss_drops.load(), (unsigned long long)stats.app_send_drops.load(),
+             (unsigned long long)stats.tun_write_drops.load());
+#endif
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_multiregionvpn_core_NativeTunPump_nativeIsRunning(
+        JNIEnv *env, jclass clazz) {
+    return TunPump::instance().running() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_multiregionvpn_core_NativeTunPump_nativeAttachTunnel(
+        JNIEnv *env, jclass clazz, jstring tunnelId, jint appFd) {
+    std::string id;
+    if (!tunnel_id_string(env, tunnelId, id)) {
+        return JNI_FALSE;
+    }
+    const int index = NativePacketRouter::instance().register_tunnel(id);
+    // Set when CustomTunClient was built with TUN_SHM_RING and could map the rings
+    std::shared_ptr<PacketRingPair> ring = PacketRingRegistry::instance().find(id);
+    if (!TunPump::instance().attach_tunnel(index, appFd, ring)) {
+        LOG_ERROR(LOG_TAG, "Failed to attach tunnel %s (index %d, fd %d)", id.c_str(), index, appFd);
+        return JNI_FALSE;
+    }
+    LOG_INFO(LOG_TAG, "Tunnel %s attached to TUN pump (index %d, fd %d, %s)",
+             id.c_str(), index, appFd, ring ? "shared-memory rings" : "socketpair");
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_multiregionvpn_core_NativeTunPump_nativeDetachTunnel(
+        JNIEnv *env, jclass clazz, jstring tunnelId) {
+    std::string id;
+    if (!tunnel_id_string(env, tunnelId, id)) {
+        return;
+    }
+    const int index = NativePacketRouter::instance().register_tunnel(id);
+    TunPump::instance().detach_tunnel(index);
+    NativePacketRouter::instance().flows().erase_tunnel(index);
+}
+
+/**
+ * Blocks up to timeoutMs for an outbound packet the native router could not
+ * place and copies it into the direct buffer. Returns its length, 0 on
+ * timeout, or -1 once the pump has stopped.
+ */
+JNIEXPORT jint JNICALL
+Java_com_multiregionvpn_core_NativeTunPump_nativeTakeMiss(
+        JNIEnv *env, jclass clazz, jobject buffer, jint timeoutMs) {
+    if (!buffer) {
+        return 0;
+    }
+    void* address = env->GetDirectBufferAddress(buffer);
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!address || capacity <= 0) {
+        return 0;
+    }
+    const ssize_t len = TunPump::instance().take_miss(
+        static_cast<uint8_t*>(address), static_cast<size_t>(capacity), timeoutMs);
+    return static_cast<jint>(len);
+}
@@ -0,0 +1,113 @@
+#ifndef TUN_TRAFFIC_STATS_H
+#define TUN_TRAFFIC_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Seconds between per-tunnel rate summary log lines (0 disables).
+// Override at build time with -DTUN_STATS_LOG_INTERVAL_SEC=<n> (see CMakeLists.txt).
+#ifndef TUN_STATS_LOG_INTERVAL_SEC
+#define TUN_STATS_LOG_INTERVAL_SEC 10
+#endif
+
+namespace openvpn {
+
+/**
+ * Per-tunnel packet and byte counters for the TUN data path.
+ *
+ * "Out" is app → server (read from lib_fd, fed to tun_recv), "in" is
+ * server → app (tun_send, written to lib_fd). Relaxed atomics: written on
+ * the io_context thread, readable from anywhere.
+ */
+struct TunTrafficCounters {
+    std::atomic<uint64_t> packets_out{0};
+    std::atomic<uint64_t> bytes_out{0};
+    std::atomic<uint64_t> packets_in{0};
+    std::atomic<uint64_t> bytes_in{0};
+
+    void add_out(size_t bytes) {
+        packets_out.fetch_add(1, std::memory_order_relaxed);
+        bytes_out.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void add_in(size_t bytes) {
+        packets_in.fetch_add(1, std::memory_order_relaxed);
+        bytes_in.fetch_add(bytes, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Turns successive TunTrafficCounters snapshots into per-second rates
+ * for the periodic summary log line.
+ */
+class TunRateSummary {
+public:
+    struct Rates {
+        uint64_t interval_ms = 0;
+        uint64_t packets_out = 0;   // Packets in this interval
+        uint64_t packets_in = 0;
+        uint64_t pps_out = 0;       // Packets per second
+        uint64_t pps_in = 0;
+        uint64_t kbps_out = 0;      // Kilobits per second
+        uint64_t kbps_in = 0;
+
+        bool idle() const {
+            return packets_out == 0 && packets_in == 0;
+        }
+    };
+
+    /**
+     * Records the current counters and returns rates since the previous call.
+     * The first call only establishes the baseline.
+     */
+    Rates sample(const TunTrafficCounters& counters, uint64_t now_ms) {
+        const uint64_t packets_out = counters.packets_out.load(std::memory_order_relaxed);
+        const uint64_t bytes_out = counters.bytes_out.load(std::memory_order_relaxed);
+        const uint64_t packets_in = counters.packets_in.load(std::memory_order_relaxed);
+        const uint64_t bytes_in = counters.bytes_in.load(std::memory_order_relaxed);
+
+        Rates rates;
+        if (has_baseline_ && now_ms > last_ms_) {
+            rates.interval_ms = now_ms - last_ms_;
+            rates.packets_out = packets_out - last_packets_out_;
+            rates.packets_in = packets_in - last_packets_in_;
+            rates.pps_out = rates.packets_out * 1000 / rates.interval_ms;
+            rates.pps_in = rates.packets_in * 1000 / rates.interval_ms;
+            rates.kbps_out = (bytes_out - last_bytes_out_) * 8 / rates.interval_ms;
+            rates.kbps_in = (bytes_in - last_bytes_in_) * 8 / rates.interval_ms;
+        }
+
+        has_baseline_ = true;
+        last_ms_ = now_ms;
+        last_packets_out_ = packets_out;
+        last_bytes_out_ = bytes_out;
+        last_packets_in_ = packets_in;
+        last_bytes_in_ = bytes_in;
+        return rates;
+    }
+
+    /**
+     * Formats rates as a single log line body
+     */
+    static int format(char* out, size_t len, const Rates& rates) {
+        return snprintf(out, len,
+            "out %llu pps / %llu kbps, in %llu pps / %llu kbps over %llu ms",
+            (unsigned long long)rates.pps_out, (unsigned long long)rates.kbps_out,
+            (unsigned long long)rates.pps_in, (unsigned long long)rates.kbps_in,
+            (unsigned long long)rates.interval_ms);
+    }
+
+private:
+    bool has_baseline_ = false;
+    uint64_t last_ms_ = 0;
+    uint64_t last_packets_out_ = 0;
+    uint64_t last_bytes_out_ = 0;
+    uint64_t last_packets_in_ = 0;
+    uint64_t last_bytes_in_ = 0;
+};
+
+} // namespace openvpn
+
+#endif // TUN_TRAFFIC_STATS_H
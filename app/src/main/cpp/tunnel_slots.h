@@ -0,0 +1,383 @@
+#ifndef TUNNEL_SLOTS_H
+#define TUNNEL_SLOTS_H
+
+#include <unistd.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "direct_packet_channel.h"
+#include "pre_connect_queue.h"
+#include "tunnel_stats.h"
+
+// Defined in openvpn_wrapper.cpp; slots only carry the pointer
+struct OpenVpnSession;
+
+namespace openvpn {
+
+/**
+ * The createPipe() socketpair of a tunnel slot; closes both ends when destroyed.
+ * Kotlin only holds dups of kotlin_fd (ParcelFileDescriptor.fromFd), so this
+ * is the one owner of the pair.
+ */
+class SlotPipe {
+public:
+    SlotPipe() = default;
+    SlotPipe(int openvpn_fd, int kotlin_fd) : openvpn_fd_(openvpn_fd), kotlin_fd_(kotlin_fd) {}
+    SlotPipe(SlotPipe&& other) noexcept { *this = std::move(other); }
+
+    SlotPipe& operator=(SlotPipe&& other) noexcept {
+        if (this != &other) {
+            reset();
+            std::swap(openvpn_fd_, other.openvpn_fd_);
+            std::swap(kotlin_fd_, other.kotlin_fd_);
+        }
+        return *this;
+    }
+
+    SlotPipe(const SlotPipe&) = delete;
+    SlotPipe& operator=(const SlotPipe&) = delete;
+
+    ~SlotPipe() { reset(); }
+
+    void reset() {
+        for (int* fd : {&openvpn_fd_, &kotlin_fd_}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    int openvpn_fd() const { return openvpn_fd_; }
+    int kotlin_fd() const { return kotlin_fd_; }
+
+private:
+    int openvpn_fd_ = -1;
+    int kotlin_fd_ = -1;
+};
+
+/**
+ * Fixed array of per-tunnel slots addressed by generation-checked handles.
+ *
+ * A tunnel ID is resolved to a slot once, when the tunnel's pipe or session
+ * is registered; JNI entry points called afterwards pass the 64-bit handle
+ * (generation << 32 | index) and reach the slot by index with no string
+ * marshalling or map lookup. Releasing a slot bumps its generation, so
+ * handles held by a closed tunnel stop resolving instead of reaching the
+ * tunnel that reuses the slot.
+ *
+ * Readers never lock: pin() counts itself on the slot, then checks the
+ * generation. Writers take the table mutex, publish the change, and wait for
+ * pinned readers to drain before the old session may be destroyed.
+ */
+class TunnelSlotTable {
+public:
+    static constexpr size_t CAPACITY = 64;
+    static constexpr int64_t INVALID_HANDLE = 0;
+
+    /**
+     * Process-wide table shared by the JNI entry points
+     */
+    static TunnelSlotTable& instance() {
+        static TunnelSlotTable table;
+        return table;
+    }
+
+    TunnelSlotTable() = default;
+    TunnelSlotTable(const TunnelSlotTable&) = delete;
+    TunnelSlotTable& operator=(const TunnelSlotTable&) = delete;
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> generation{0};  // Odd while the slot is open
+        std::atomic<uint32_t> pins{0};
+        std::atomic<OpenVpnSession*> session{nullptr};
+        std::atomic<int> openvpn_fd{-1};
+        std::atomic<int> kotlin_fd{-1};
+        std::atomic<TunnelStats*> stats{nullptr};
+        std::atomic<PreConnectQueue*> pre_connect{nullptr};
+        std::atomic<DirectPacketChannel*> direct{nullptr};
+
+        // Written and read under the table mutex only
+        std::string tunnel_id;
+        std::shared_ptr<TunnelStats> stats_owner;
+        std::shared_ptr<PreConnectQueue> pre_connect_owner;
+        std::unique_ptr<DirectPacketChannel> direct_owner;
+        SlotPipe pipe_owner;
+    };
+
+public:
+    /**
+     * A reader's hold on an open slot. The session seen through a Pin stays
+     * valid until the Pin is destroyed. Writers wait for pins while holding the
+     * table mutex, so a pinned reader must not call the locking methods.
+     */
+    class Pin {
+    public:
+        Pin() = default;
+        Pin(Pin&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+        Pin& operator=(Pin&&) = delete;
+
+        ~Pin() {
+            if (slot_) {
+                slot_->pins.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        explicit operator bool() const { return slot_ != nullptr; }
+
+        OpenVpnSession* session() const { return slot_->session.load(std::memory_order_seq_cst); }
+        int openvpn_fd() const { return slot_->openvpn_fd.load(std::memory_order_acquire); }
+        int kotlin_fd() const { return slot_->kotlin_fd.load(std::memory_order_acquire); }
+        TunnelStats* stats() const { return slot_->stats.load(std::memory_order_acquire); }
+        PreConnectQueue* pre_connect() const { return slot_->pre_connect.load(std::memory_order_acquire); }
+        DirectPacketChannel* direct() const { return slot_->direct.load(std::memory_order_seq_cst); }
+
+    private:
+        friend class TunnelSlotTable;
+        explicit Pin(Slot* slot) : slot_(slot) {}
+
+        Slot* slot_ = nullptr;
+    };
+
+    /**
+     * Returns the handle of tunnel_id's open slot, opening one if needed, or
+     * INVALID_HANDLE if every slot is taken
+     */
+    int64_t open(const std::string& tunnel_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t free_index = CAPACITY;
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            const uint32_t generation = slots_[i].generation.load(std::memory_order_relaxed);
+            if (generation & 1) {
+                if (slots_[i].tunnel_id == tunnel_id) {
+                    return make_handle(generation, i);
+                }
+            } else if (free_index == CAPACITY) {
+                free_index = i;
+            }
+        }
+        if (free_index == CAPACITY) {
+            return INVALID_HANDLE;
+        }
+
+        Slot& slot = slots_[free_index];
+        slot.tunnel_id = tunnel_id;
+        slot.stats_owner = TunnelStatsRegistry::instance().acquire(tunnel_id);
+        slot.stats.store(slot.stats_owner.get(), std::memory_order_release);
+        slot.pre_connect_owner = PreConnectQueueRegistry::instance().acquire(tunnel_id);
+        slot.pre_connect.store(slot.pre_connect_owner.get(), std::memory_order_release);
+        const uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+        slot.generation.store(generation, std::memory_order_seq_cst);
+        return make_handle(generation, free_index);
+    }
+
+    /**
+     * Handle of tunnel_id's open slot, or INVALID_HANDLE. Control plane only.
+     */
+    int64_t find(const std::string& tunnel_id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            const uint32_t generation = slots_[i].generation.load(std::memory_order_relaxed);
+            if ((generation & 1) && slots_[i].tunnel_id == tunnel_id) {
+                return make_handle(generation, i);
+            }
+        }
+        return INVALID_HANDLE;
+    }
+
+    /**
+     * Handle of the open slot holding session, or INVALID_HANDLE
+     */
+    int64_t find_session(const OpenVpnSession* session) const {
+        if (!session) {
+            return INVALID_HANDLE;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            const uint32_t generation = slots_[i].generation.load(std::memory_order_relaxed);
+            if ((generation & 1) && slots_[i].session.load(std::memory_order_relaxed) == session) {
+                return make_handle(generation, i);
+            }
+        }
+        return INVALID_HANDLE;
+    }
+
+    /**
+     * Pins the slot for handle; an empty Pin if the handle is stale or invalid
+     */
+    Pin pin(int64_t handle) {
+        Slot* slot = resolve(handle);
+        if (!slot) {
+            return Pin();
+        }
+        slot->pins.fetch_add(1, std::memory_order_seq_cst);
+        if (slot->generation.load(std::memory_order_seq_cst) != handle_generation(handle)) {
+            slot->pins.fetch_sub(1, std::memory_order_release);
+            return Pin();
+        }
+        return Pin(slot);
+    }
+
+    /**
+     * Attaches session to the slot. A session it replaces is no longer held
+     * by any reader once this returns. False if the handle is stale.
+     */
+    bool attach_session(int64_t handle, OpenVpnSession* session) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = open_slot_locked(handle);
+        if (!slot) {
+            return false;
+        }
+        OpenVpnSession* previous = slot->session.exchange(session, std::memory_order_seq_cst);
+        if (previous && previous != session) {
+            wait_unpinned(*slot);
+        }
+        return true;
+    }
+
+    /**
+     * Hands the createPipe() socketpair to the slot, which closes it on
+     * release. False (and the fds are left open) if the handle is stale.
+     */
+    bool set_pipe(int64_t handle, int openvpn_fd, int kotlin_fd) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = open_slot_locked(handle);
+        if (!slot) {
+            return false;
+        }
+        slot->openvpn_fd.store(openvpn_fd, std::memory_order_seq_cst);
+        slot->kotlin_fd.store(kotlin_fd, std::memory_order_seq_cst);
+        if (slot->pipe_owner.openvpn_fd() >= 0 || slot->pipe_owner.kotlin_fd() >= 0) {
+            wait_unpinned(*slot);
+        }
+        slot->pipe_owner = SlotPipe(openvpn_fd, kotlin_fd);
+        return true;
+    }
+
+    /**
+     * Installs the slot's direct ByteBuffer channel, or removes it when
+     * channel is null. A channel it replaces is destroyed once no reader
+     * holds it. False if the handle is stale.
+     */
+    bool set_direct(int64_t handle, std::unique_ptr<DirectPacketChannel> channel) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = open_slot_locked(handle);
+        if (!slot) {
+            return false;
+        }
+        slot->direct.store(channel.get(), std::memory_order_seq_cst);
+        if (slot->direct_owner) {
+            wait_unpinned(*slot);
+        }
+        slot->direct_owner = std::move(channel);
+        return true;
+    }
+
+    /**
+     * Closes the slot: stale handles stop resolving, and once pinned readers
+     * drain the slot can be reused. The pipe is closed now, or moved to pipe
+     * for a caller whose session still uses it (closed when pipe is destroyed).
+     * Returns false if the handle was already stale.
+     */
+    bool release(int64_t handle, SlotPipe* pipe = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = open_slot_locked(handle);
+        if (!slot) {
+            return false;
+        }
+        slot->generation.fetch_add(1, std::memory_order_seq_cst);
+        wait_unpinned(*slot);
+        slot->session.store(nullptr, std::memory_order_relaxed);
+        slot->openvpn_fd.store(-1, std::memory_order_relaxed);
+        slot->kotlin_fd.store(-1, std::memory_order_relaxed);
+        slot->stats.store(nullptr, std::memory_order_relaxed);
+        // Counters span reconnects but not the tunnel: a reopened tunnel starts from zero
+        TunnelStatsRegistry::instance().erase(slot->tunnel_id, slot->stats_owner.get());
+        slot->stats_owner.reset();
+        slot->pre_connect.store(nullptr, std::memory_order_relaxed);
+        // Packets still queued belong to the closed tunnel; a reopen starts a fresh queue
+        PreConnectQueueRegistry::instance().erase(slot->tunnel_id, slot->pre_connect_owner.get());
+        slot->pre_connect_owner.reset();
+        slot->direct.store(nullptr, std::memory_order_relaxed);
+        slot->direct_owner.reset();
+        if (pipe) {
+            *pipe = std::move(slot->pipe_owner);
+        } else {
+            slot->pipe_owner.reset();
+        }
+        slot->tunnel_id.clear();
+        return true;
+    }
+
+    /**
+     * Tunnel ID of the slot, or an empty string if the handle is stale
+     */
+    std::string tunnel_id(int64_t handle) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Slot* slot = open_slot_locked(handle);
+        return slot ? slot->tunnel_id : std::string();
+    }
+
+    /**
+     * Handles and tunnel IDs of the open slots that have a session attached
+     */
+    std::vector<std::pair<int64_t, std::string>> sessions() const {
+        std::vector<std::pair<int64_t, std::string>> out;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            const uint32_t generation = slots_[i].generation.load(std::memory_order_relaxed);
+            if ((generation & 1) && slots_[i].session.load(std::memory_order_relaxed)) {
+                out.emplace_back(make_handle(generation, i), slots_[i].tunnel_id);
+            }
+        }
+        return out;
+    }
+
+private:
+    static int64_t make_handle(uint32_t generation, size_t index) {
+        return static_cast<int64_t>((static_cast<uint64_t>(generation) << 32) | index);
+    }
+
+    static uint32_t handle_generation(int64_t handle) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(handle) >> 32);
+    }
+
+    Slot* resolve(int64_t handle) const {
+        const uint64_t index = static_cast<uint64_t>(handle) & 0xffffffffULL;
+        if (index >= CAPACITY || !(handle_generation(handle) & 1)) {
+            return nullptr;
+        }
+        return &slots_[index];
+    }
+
+    Slot* open_slot_locked(int64_t handle) const {
+        Slot* slot = resolve(handle);
+        if (!slot || slot->generation.load(std::memory_order_relaxed) != handle_generation(handle)) {
+            return nullptr;
+        }
+        return slot;
+    }
+
+    static void wait_unpinned(const Slot& slot) {
+        while (slot.pins.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    mutable Slot slots_[CAPACITY];  // Readers pin through a const table too
+};
+
+} // namespace openvpn
+
+#endif // TUNNEL_SLOTS_H
@@ -0,0 +1,237 @@
+#ifndef TUNNEL_STATS_H
+#define TUNNEL_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "dns_forwarder.h"
+#include "tun_batch_reader.h"
+#include "tun_buffer_pool.h"
+#include "tun_egress_queue.h"
+#include "tun_traffic_stats.h"
+
+namespace openvpn {
+
+/**
+ * Index of each value in the packed array returned by nativeGetTunnelStats().
+ *
+ * Append new fields before FIELD_COUNT and bump STATS_LAYOUT_VERSION; never
+ * reorder, the Kotlin decoder (TunnelStats.kt) mirrors these indices.
+ */
+enum TunnelStatsField : size_t {
+    STAT_LAYOUT_VERSION = 0,
+
+    // Traffic (out = app → server, in = server → app)
+    STAT_PACKETS_OUT,
+    STAT_BYTES_OUT,
+    STAT_PACKETS_IN,
+    STAT_BYTES_IN,
+
+    // Drops by reason
+    STAT_DROP_OVERSIZED,       // Outbound packet larger than its read slot
+    STAT_DROP_ENCRYPT_ERROR,   // tun_recv() threw
+    STAT_DROP_QUEUE_TAIL,      // Egress queue full, arriving packet dropped
+    STAT_DROP_QUEUE_HEAD,      // Egress queue full, oldest packet evicted
+    STAT_DROP_QUEUE_AGE,       // Queued packet exceeded max age
+    STAT_DROP_WRITE_ERROR,     // write(lib_fd) failed with a hard error
+    STAT_DROP_HALTED,          // Packet arrived after the tunnel was stopped
+
+    // EAGAIN events
+    STAT_EAGAIN_WRITE,         // write(lib_fd) would block (packet queued)
+    STAT_EAGAIN_READ,          // Readable wakeup found nothing to read
+
+    // Queue depths (instantaneous)
+    STAT_EGRESS_QUEUE_DEPTH,
+    STAT_EGRESS_QUEUE_HIGH_WATER,
+    STAT_LIB_FD_INQ_BYTES,     // Outbound bytes waiting for OpenVPN to read
+    STAT_LIB_FD_OUTQ_BYTES,    // Inbound bytes waiting for the app to read
+    STAT_BRIDGE_INQ_BYTES,     // createPipe() socketpair, Kotlin side
+    STAT_BRIDGE_OUTQ_BYTES,
+
+    // Latency from TUN read to tun_recv() return, power-of-two microsecond buckets
+    STAT_LATENCY_US_BUCKET_0,
+
+    // TCP SYN / SYN-ACK packets whose MSS option was lowered (both directions)
+    STAT_MSS_CLAMPED = STAT_LATENCY_US_BUCKET_0 + 16,
+
+    // DNS forwarder (UDP/53 queries from the app)
+    STAT_DNS_QUERIES,
+    STAT_DNS_CACHE_HITS,         // Answered on-device from the tunnel's cache
+    STAT_DNS_FORWARDED,          // Sent to the tunnel's resolver
+    STAT_DNS_RESPONSES,          // Resolver responses matched to a forwarded query
+    STAT_DNS_LATENCY_US_TOTAL,   // Sum of forward → response times; divide by responses
+    STAT_DNS_CACHE_ENTRIES,      // Instantaneous
+
+    // Batched lib_fd reads (recvmmsg) on the outbound path
+    STAT_READ_BATCHES,           // Reads that returned at least one packet
+    STAT_READ_BATCH_PACKETS,     // Packets across those reads; divide by batches for average fill
+    STAT_READ_BATCHES_FULL,      // Reads that filled every slot
+    // Fill histogram: bucket 0 is 1 packet, bucket i is [2^i, 2^(i+1))
+    STAT_READ_BATCH_FILL_BUCKET_0,
+
+    // Per-tunnel packet buffer pool
+    STAT_POOL_HITS = STAT_READ_BATCH_FILL_BUCKET_0 + TunBatchStats::FILL_BUCKETS,
+    STAT_POOL_MISSES,            // Allocations because no idle buffer was free
+    STAT_POOL_DISCARDS,          // Buffers freed instead of returned (pool full or undersized)
+    STAT_POOL_HIGH_WATER,        // Peak buffers in use at once
+
+    STAT_FIELD_COUNT
+};
+
+/**
+ * Lock-free per-tunnel counters for the TUN data path.
+ *
+ * Writers are the tunnel's io_context thread; readers (JNI polling, logging)
+ * use relaxed loads. Values are cumulative across reconnects because the
+ * registry keeps one instance per tunnel ID.
+ */
+struct TunnelStats {
+    static constexpr int64_t STATS_LAYOUT_VERSION = 4;
+    static constexpr size_t LATENCY_BUCKETS = STAT_MSS_CLAMPED - STAT_LATENCY_US_BUCKET_0;
+
+    TunTrafficCounters traffic;
+    TunEgressStats egress;     // Attached to CustomTunClient's TunEgressQueue
+    DnsStats dns;              // Attached to CustomTunClient's DnsForwarder
+    TunBatchStats batch;       // Attached to CustomTunClient's TunBatchReader
+    TunBufferPoolStats pool;   // Attached to CustomTunClient's TunBufferPool
+
+    std::atomic<uint64_t> drop_oversized{0};
+    std::atomic<uint64_t> drop_encrypt_error{0};
+    std::atomic<uint64_t> drop_write_error{0};
+    std::atomic<uint64_t> drop_halted{0};
+    std::atomic<uint64_t> eagain_write{0};
+    std::atomic<uint64_t> egress_depth{0};
+    std::atomic<uint64_t> mss_clamped{0};
+    std::atomic<uint64_t> latency_us[LATENCY_BUCKETS] = {};
+
+    // lib_fd of the live CustomTunClient, -1 when stopped; used for socket queue depths
+    std::atomic<int> lib_fd{-1};
+
+    /**
+     * Bucket i counts latencies in [2^(i-1), 2^i) microseconds; bucket 0 is < 1us
+     * and the last bucket absorbs everything slower.
+     */
+    static size_t latency_bucket(uint64_t micros) {
+        size_t bucket = 0;
+        while (micros > 0 && bucket + 1 < LATENCY_BUCKETS) {
+            micros >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    void record_latency(uint64_t micros) {
+        latency_us[latency_bucket(micros)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Writes every field into out[0, STAT_FIELD_COUNT). Socket queue depths are
+     * left at 0; the JNI layer fills them from ioctl().
+     */
+    void pack(int64_t* out) const {
+        auto get = [](const std::atomic<uint64_t>& v) {
+            return static_cast<int64_t>(v.load(std::memory_order_relaxed));
+        };
+
+        for (size_t i = 0; i < STAT_FIELD_COUNT; ++i) {
+            out[i] = 0;
+        }
+        out[STAT_LAYOUT_VERSION] = STATS_LAYOUT_VERSION;
+        out[STAT_PACKETS_OUT] = get(traffic.packets_out);
+        out[STAT_BYTES_OUT] = get(traffic.bytes_out);
+        out[STAT_PACKETS_IN] = get(traffic.packets_in);
+        out[STAT_BYTES_IN] = get(traffic.bytes_in);
+        out[STAT_DROP_OVERSIZED] = get(drop_oversized);
+        out[STAT_DROP_ENCRYPT_ERROR] = get(drop_encrypt_error);
+        out[STAT_DROP_QUEUE_TAIL] = get(egress.tail_drops);
+        out[STAT_DROP_QUEUE_HEAD] = get(egress.head_drops);
+        out[STAT_DROP_QUEUE_AGE] = get(egress.age_drops);
+        out[STAT_DROP_WRITE_ERROR] = get(drop_write_error);
+        out[STAT_DROP_HALTED] = get(drop_halted);
+        out[STAT_EAGAIN_WRITE] = get(eagain_write);
+        out[STAT_EAGAIN_READ] = get(batch.empty_reads);
+        out[STAT_EGRESS_QUEUE_DEPTH] = get(egress_depth);
+        out[STAT_EGRESS_QUEUE_HIGH_WATER] = get(egress.high_water);
+        for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            out[STAT_LATENCY_US_BUCKET_0 + i] = get(latency_us[i]);
+        }
+        out[STAT_MSS_CLAMPED] = get(mss_clamped);
+        out[STAT_DNS_QUERIES] = get(dns.queries);
+        out[STAT_DNS_CACHE_HITS] = get(dns.cache_hits);
+        out[STAT_DNS_FORWARDED] = get(dns.forwarded);
+        out[STAT_DNS_RESPONSES] = get(dns.responses);
+        out[STAT_DNS_LATENCY_US_TOTAL] = get(dns.latency_us_total);
+        out[STAT_DNS_CACHE_ENTRIES] = get(dns.cache_entries);
+        out[STAT_READ_BATCHES] = get(batch.batches);
+        out[STAT_READ_BATCH_PACKETS] = get(batch.packets);
+        out[STAT_READ_BATCHES_FULL] = get(batch.full_batches);
+        for (size_t i = 0; i < TunBatchStats::FILL_BUCKETS; ++i) {
+            out[STAT_READ_BATCH_FILL_BUCKET_0 + i] = get(batch.fill_histogram[i]);
+        }
+        out[STAT_POOL_HITS] = get(pool.hits);
+        out[STAT_POOL_MISSES] = get(pool.misses);
+        out[STAT_POOL_DISCARDS] = get(pool.discards);
+        out[STAT_POOL_HIGH_WATER] = get(pool.high_water);
+    }
+};
+
+/**
+ * Process-wide map from tunnel ID to its TunnelStats.
+ *
+ * The mutex only guards the map itself; lookups happen when a CustomTunClient
+ * is created and when JNI polls, never per packet.
+ */
+class TunnelStatsRegistry {
+public:
+    static TunnelStatsRegistry& instance() {
+        static TunnelStatsRegistry registry;
+        return registry;
+    }
+
+    /**
+     * Returns the stats for tunnel_id, creating them on first use
+     */
+    std::shared_ptr<TunnelStats> acquire(const std::string& tunnel_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<TunnelStats>& stats = stats_[tunnel_id];
+        if (!stats) {
+            stats = std::make_shared<TunnelStats>();
+        }
+        return stats;
+    }
+
+    /**
+     * Returns the stats for tunnel_id, or nullptr if the tunnel never started
+     */
+    std::shared_ptr<TunnelStats> find(const std::string& tunnel_id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = stats_.find(tunnel_id);
+        return it == stats_.end() ? nullptr : it->second;
+    }
+
+    /**
+     * Removes tunnel_id's entry if it is still stats
+     */
+    void erase(const std::string& tunnel_id, const TunnelStats* stats) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = stats_.find(tunnel_id);
+        if (it != stats_.end() && it->second.get() == stats) {
+            stats_.erase(it);
+        }
+    }
+
+private:
+    TunnelStatsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<TunnelStats>> stats_;
+};
+
+} // namespace openvpn
+
+#endif // TUNNEL_STATS_H
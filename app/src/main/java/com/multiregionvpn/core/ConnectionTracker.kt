@@ -20,7 +20,8 @@ import java.util.concurrent.ConcurrentHashMap
  */
 class ConnectionTracker(
     private val context: Context,
-    private val packageManager: PackageManager
+    private val packageManager: PackageManager,
+    private val nativeRouter: NativePacketRouter? = null // Native flow table kept in step with UID clears
 ) {
     private val connectionTable = ConcurrentHashMap<String, ConnectionInfo>()
     private val packageNameToUid = ConcurrentHashMap<String, Int>()
@@ -87,6 +88,7 @@ class ConnectionTracker(
         if (uid != null) {
             uidToTunnelId.remove(uid)
             connectionTable.entries.removeIf { it.value.uid == uid }
+            nativeRouter?.forgetUid(uid)
             Log.d(TAG, "Cleared connection tracking for package $packageName (uid $uid)")
         }
     }
@@ -98,6 +100,7 @@ class ConnectionTracker(
         connectionTable.clear()
         packageNameToUid.clear()
         uidToTunnelId.clear()
+        nativeRouter?.clear()
         Log.d(TAG, "Cleared all connection tracker mappings")
     }
 
@@ -194,6 +197,7 @@ class ConnectionTracker(
         val toRemove = connectionTable.entries.filter { it.value.uid == uid }
         toRemove.forEach { connectionTable.remove(it.key) }
         uidToTunnelId.remove(uid)
+        nativeRouter?.forgetUid(uid)
         Log.d(TAG, "Cleared ${toRemove.size} connections for UID $uid")
     }
     
@@ -270,6 +274,7 @@ class ConnectionTracker(
         connectionTable.clear()
         packageNameToUid.clear()
         uidToTunnelId.clear()
+        nativeRouter?.clear()
         Log.d(TAG, "Cleared all connection tracking data")
     }
     
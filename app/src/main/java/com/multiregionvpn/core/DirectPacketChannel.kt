@@ -0,0 +1,161 @@
+package com.multiregionvpn.core
+
+import android.util.Log
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Direct ByteBuffer packet I/O for one tunnel's socket (direct_packet_channel.h).
+ *
+ * The send and receive buffers are registered with native code once per socket,
+ * so each JNI call passes only offsets, lengths and counts: no Java arrays cross
+ * JNI and the kernel copies straight into / out of the buffers. Batches move up
+ * to [MAX_BATCH] packets per sendmmsg() / recvmmsg().
+ *
+ * Received packets are handed out as views of the receive buffer, with no
+ * allocation or copy. Sends take the ByteArrays PacketRouter routes, so each
+ * packet is copied once into the send buffer.
+ *
+ * Buffer layout (both buffers): [MAX_BATCH] descriptors of {int32 offset,
+ * int32 length} in native byte order, then packet bytes from [DATA_OFFSET].
+ *
+ * Sends and receives are each serialized internally, so a reader being
+ * replaced may overlap its successor.
+ */
+class DirectPacketChannel private constructor(private val tunnelHandle: Long) {
+    private val sendBuffer: ByteBuffer = ByteBuffer.allocateDirect(BUFFER_SIZE).order(ByteOrder.nativeOrder())
+    private val receiveBuffer: ByteBuffer = ByteBuffer.allocateDirect(BUFFER_SIZE).order(ByteOrder.nativeOrder())
+    private val sendLock = Any()
+    private val receiveLock = Any()
+    // Reused view handed to receiveBatch() callbacks; receiveLock guards it
+    private val receiveView: ByteBuffer = receiveBuffer.duplicate()
+
+    /**
+     * Moves the channel to [fd] (the Kotlin end of the tunnel's socketpair).
+     * The caller keeps [fd] open until the next [bind] or [close].
+     */
+    fun bind(fd: Int): Boolean = nativeRegister(tunnelHandle, fd, sendBuffer, receiveBuffer)
+
+    /**
+     * Sends one packet, waiting up to [timeoutMs] for socket space.
+     * Returns its size, 0 if the socket stayed full and the packet was not
+     * sent, or -1 if the channel is unusable (unbound, tunnel released or a
+     * socket error). Callers that must not lose the packet retry it on 0.
+     */
+    fun send(packet: ByteArray, timeoutMs: Int = SEND_TIMEOUT_MS): Int {
+        if (packet.isEmpty() || packet.size > BUFFER_SIZE - DATA_OFFSET) {
+            return -1
+        }
+        synchronized(sendLock) {
+            sendBuffer.clear()
+            sendBuffer.position(DATA_OFFSET)
+            sendBuffer.put(packet)
+            return nativeSend(tunnelHandle, DATA_OFFSET, packet.size, timeoutMs)
+        }
+    }
+
+    /**
+     * Sends up to [MAX_BATCH] packets, in order, with one sendmmsg().
+     * Returns how many were sent, or -1 if the channel is unusable.
+     */
+    fun sendBatch(packets: List<ByteArray>, timeoutMs: Int = SEND_TIMEOUT_MS): Int {
+        synchronized(sendLock) {
+            var offset = DATA_OFFSET
+            var count = 0
+            for (packet in packets) {
+                if (count == MAX_BATCH || packet.isEmpty() || offset + packet.size > BUFFER_SIZE) {
+                    break
+                }
+                sendBuffer.putInt(count * DESCRIPTOR_SIZE, offset)
+                sendBuffer.putInt(count * DESCRIPTOR_SIZE + 4, packet.size)
+                sendBuffer.clear()
+                sendBuffer.position(offset)
+                sendBuffer.put(packet)
+                offset += packet.size
+                count++
+            }
+            return if (count > 0) nativeSendBatch(tunnelHandle, count, timeoutMs) else 0
+        }
+    }
+
+    /**
+     * Receives up to [maxCount] packets with one recvmmsg(), waiting up to
+     * [timeoutMs] for the first, and hands each to [onPacket] in order as a
+     * view of the receive buffer (position to limit). The view is reused and
+     * only valid during the call; copy the bytes out to keep them.
+     * Returns the count, 0 on timeout, or -1 once the tunnel's socket closed.
+     */
+    fun receiveBatch(
+        maxCount: Int = MAX_BATCH,
+        timeoutMs: Int = RECEIVE_TIMEOUT_MS,
+        onPacket: (ByteBuffer) -> Unit
+    ): Int {
+        synchronized(receiveLock) {
+            val count = nativeReceiveBatch(tunnelHandle, maxCount, timeoutMs)
+            for (i in 0 until count) {
+                val offset = receiveBuffer.getInt(i * DESCRIPTOR_SIZE)
+                val length = receiveBuffer.getInt(i * DESCRIPTOR_SIZE + 4)
+                receiveView.limit(offset + length)
+                receiveView.position(offset)
+                onPacket(receiveView)
+            }
+            return count
+        }
+    }
+
+    /**
+     * Unregisters the buffers. Call before closing the bound fd.
+     */
+    fun close() {
+        nativeRegister(tunnelHandle, -1, null, null)
+    }
+
+    companion object {
+        private const val TAG = "DirectPacketChannel"
+
+        /** Mirror DirectPacketChannel's constants in direct_packet_channel.h */
+        const val MAX_BATCH = 64
+        const val DESCRIPTOR_SIZE = 8
+        const val DATA_OFFSET = MAX_BATCH * DESCRIPTOR_SIZE
+        const val SLOT_SIZE = 2048
+        const val BUFFER_SIZE = DATA_OFFSET + MAX_BATCH * SLOT_SIZE
+
+        private const val SEND_TIMEOUT_MS = 50
+        private const val RECEIVE_TIMEOUT_MS = 500
+
+        /**
+         * Creates a channel bound to [fd] for the native tunnel [tunnelHandle],
+         * or null if the native library is unavailable or registration failed.
+         */
+        fun open(tunnelHandle: Long, fd: Int): DirectPacketChannel? {
+            if (tunnelHandle == 0L || fd < 0) {
+                return null
+            }
+            return try {
+                System.loadLibrary("openvpn-jni")
+                val channel = DirectPacketChannel(tunnelHandle)
+                if (channel.bind(fd)) channel else null
+            } catch (e: UnsatisfiedLinkError) {
+                Log.w(TAG, "Native library unavailable - tunnel packets use stream I/O", e)
+                null
+            }
+        }
+
+        @JvmStatic
+        private external fun nativeRegister(
+            tunnelHandle: Long,
+            fd: Int,
+            sendBuffer: ByteBuffer?,
+            receiveBuffer: ByteBuffer?
+        ): Boolean
+
+        @JvmStatic
+        private external fun nativeSend(tunnelHandle: Long, offset: Int, length: Int, timeoutMs: Int): Int
+
+        @JvmStatic
+        private external fun nativeSendBatch(tunnelHandle: Long, count: Int, timeoutMs: Int): Int
+
+        @JvmStatic
+        private external fun nativeReceiveBatch(tunnelHandle: Long, maxCount: Int, timeoutMs: Int): Int
+    }
+}
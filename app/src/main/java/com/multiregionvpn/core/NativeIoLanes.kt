@@ -0,0 +1,78 @@
+package com.multiregionvpn.core
+
+import android.util.Log
+
+/**
+ * Core placement for tunnel event loops (io_lane_pool.h).
+ *
+ * Each OpenVPN 3 session runs its event loop on its own thread. When enabled,
+ * those threads are pinned onto one lane per core: new tunnels go to the
+ * least-loaded lane, and [sample] migrates a tunnel off a lane that is running
+ * noticeably hotter than the coolest one.
+ *
+ * Enable before tunnels connect; threads started while disabled keep the
+ * scheduler's placement.
+ */
+object NativeIoLanes {
+    private const val TAG = "NativeIoLanes"
+
+    data class Lane(val cpu: Int, val tunnels: Int, val utilizationPermille: Int)
+
+    data class Sample(val lanes: List<Lane>, val migrations: Long)
+
+    /** False when the native library is unavailable (e.g. JVM unit tests) */
+    val isAvailable: Boolean by lazy {
+        try {
+            System.loadLibrary("openvpn-jni")
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library unavailable - tunnel threads keep default placement")
+            false
+        }
+    }
+
+    fun setEnabled(enabled: Boolean) {
+        if (isAvailable) {
+            nativeSetEnabled(enabled)
+        }
+    }
+
+    /**
+     * Measures per-lane CPU use since the previous call and rebalances if needed.
+     * Call periodically; utilization is averaged over the interval between calls.
+     */
+    fun sample(): Sample? {
+        if (!isAvailable) {
+            return null
+        }
+        val packed = nativeSample() ?: return null
+        if (packed.size < 2) {
+            return null
+        }
+        val laneCount = packed[0].toInt()
+        val lanes = (0 until laneCount).map { i ->
+            val base = 2 + i * 3
+            Lane(packed[base].toInt(), packed[base + 1].toInt(), packed[base + 2].toInt())
+        }
+        return Sample(lanes, packed[1])
+    }
+
+    /** Re-pins [tunnelId]'s event loop onto [lane] */
+    fun migrate(tunnelId: String, lane: Int): Boolean = isAvailable && nativeMigrate(tunnelId, lane)
+
+    /** Lane [tunnelId] runs on, or -1 */
+    fun laneOf(tunnelId: String): Int = if (isAvailable) nativeLaneOf(tunnelId) else -1
+
+    @JvmStatic
+    private external fun nativeSetEnabled(enabled: Boolean)
+
+    /** [laneCount, migrations, then cpu, tunnels, utilizationPermille per lane] */
+    @JvmStatic
+    private external fun nativeSample(): LongArray?
+
+    @JvmStatic
+    private external fun nativeMigrate(tunnelId: String, lane: Int): Boolean
+
+    @JvmStatic
+    private external fun nativeLaneOf(tunnelId: String): Int
+}
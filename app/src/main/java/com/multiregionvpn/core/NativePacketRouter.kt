@@ -0,0 +1,133 @@
+package com.multiregionvpn.core
+
+import android.util.Log
+import java.nio.ByteBuffer
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * Native flow classifier for [PacketRouter] (native_packet_router.h).
+ *
+ * Each packet is staged in a reusable direct buffer and classified in C++ from
+ * its IPv4/IPv6 + TCP/UDP headers, so a flow that has already been routed costs
+ * one JNI call and no allocations. Flows are learned from the Kotlin slow path
+ * via [learnStagedFlow].
+ *
+ * The staging buffer is per thread: [learnStagedFlow] and [lookupStagedFlow] act on
+ * the packet the calling thread last passed to [classify], so concurrent readers
+ * never see each other's packets. [forgetUid] and [clear] act on the process-wide
+ * flow table and are safe from any thread.
+ */
+class NativePacketRouter private constructor() {
+    private class Staging {
+        val buffer: ByteBuffer = ByteBuffer.allocateDirect(MAX_PACKET_SIZE)
+        var length = 0
+    }
+
+    private val staging = ThreadLocal.withInitial { Staging() }
+    private val tunnelIds = ConcurrentHashMap<Int, String>()
+    private val tunnelIndices = ConcurrentHashMap<String, Int>()
+
+    /**
+     * Returns the tunnel learned for [packet]'s flow, or null on a miss.
+     * The packet stays staged on this thread for a following [learnStagedFlow].
+     */
+    fun classify(packet: ByteArray): String? {
+        val staged = staging.get()
+        if (packet.size > staged.buffer.capacity()) {
+            staged.length = 0
+            return null
+        }
+        staged.buffer.clear()
+        staged.buffer.put(packet)
+        staged.length = packet.size
+
+        val index = nativeClassify(staged.buffer, staged.length)
+        return if (index >= 0) tunnelIds[index] else null
+    }
+
+    /**
+     * Routes future packets of this thread's last classified packet's flow to [tunnelId]
+     */
+    fun learnStagedFlow(tunnelId: String, uid: Int) {
+        val staged = staging.get()
+        if (staged.length == 0) {
+            return
+        }
+        val index = indexFor(tunnelId)
+        if (index >= 0) {
+            nativeLearnFlow(staged.buffer, staged.length, index, uid)
+        }
+    }
+
+    /**
+     * Returns the native flow entry for this thread's last classified packet, or null
+     */
+    fun lookupStagedFlow(): FlowMatch? {
+        val staged = staging.get()
+        if (staged.length == 0) {
+            return null
+        }
+        val packed = nativeLookupFlow(staged.buffer, staged.length)
+        if (packed < 0) {
+            return null
+        }
+        return FlowMatch(tunnelIds[(packed ushr 32).toInt()], packed.toInt())
+    }
+
+    fun forgetUid(uid: Int): Int = nativeForgetUid(uid)
+
+    fun clear() = nativeClearFlows()
+
+    private fun indexFor(tunnelId: String): Int {
+        tunnelIndices[tunnelId]?.let { return it }
+        val index = nativeRegisterTunnel(tunnelId)
+        if (index >= 0) {
+            tunnelIds[index] = tunnelId
+            tunnelIndices[tunnelId] = index
+        }
+        return index
+    }
+
+    data class FlowMatch(val tunnelId: String?, val uid: Int)
+
+    companion object {
+        private const val TAG = "NativePacketRouter"
+
+        /** Matches the TUN read buffer in VpnEngineService */
+        const val MAX_PACKET_SIZE = 32767
+
+        /**
+         * Returns a router, or null if the native library is unavailable
+         * (e.g. JVM unit tests), in which case PacketRouter stays on the Kotlin path.
+         */
+        fun createOrNull(): NativePacketRouter? {
+            return try {
+                System.loadLibrary("openvpn-jni")
+                NativePacketRouter()
+            } catch (e: UnsatisfiedLinkError) {
+                Log.w(TAG, "Native library unavailable - using Kotlin packet classification", e)
+                null
+            }
+        }
+
+        @JvmStatic
+        private external fun nativeRegisterTunnel(tunnelId: String): Int
+
+        /** Returns a tunnel index, -1 for an unknown flow or -2 for an unparseable packet */
+        @JvmStatic
+        private external fun nativeClassify(buffer: ByteBuffer, length: Int): Int
+
+        @JvmStatic
+        private external fun nativeLearnFlow(buffer: ByteBuffer, length: Int, tunnelIndex: Int, uid: Int): Boolean
+
+        /** Returns (tunnelIndex shl 32) or uid, or -1 for an unknown flow */
+        @JvmStatic
+        private external fun nativeLookupFlow(buffer: ByteBuffer, length: Int): Long
+
+        @JvmStatic
+        private external fun nativeForgetUid(uid: Int): Int
+
+        @JvmStatic
+        private external fun nativeClearFlows()
+    }
+}
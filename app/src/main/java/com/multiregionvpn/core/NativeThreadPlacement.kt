@@ -0,0 +1,129 @@
+package com.multiregionvpn.core
+
+import android.util.Log
+
+/**
+ * CPU cluster and scheduling policy for native tunnel threads (thread_placement.h).
+ *
+ * Data path threads (tunnel event loops that encrypt, and the TUN pump) and
+ * control threads (callbacks, reconnect workers) each get a cluster, nice value
+ * and scheduling policy. [Cluster.AUTO] threads start on the big cluster and
+ * [sample] moves them by measured CPU time: busy ones stay big, idle ones drop
+ * to little. A tunnel whose data path has a cluster policy is not placed on an
+ * IO lane ([NativeIoLanes]).
+ *
+ * Configure before tunnels connect: each session snapshots the policy when it
+ * is created. Process-wide threads pick up changes immediately.
+ */
+object NativeThreadPlacement {
+    private const val TAG = "NativeThreadPlacement"
+
+    /** Matches openvpn::CpuCluster */
+    enum class Cluster { ANY, BIG, LITTLE, AUTO }
+
+    /** Linux scheduling policies usable here (SCHED_FIFO/RR need CAP_SYS_NICE) */
+    const val SCHED_OTHER = 0
+    const val SCHED_FIFO = 1
+    const val SCHED_RR = 2
+    const val SCHED_BATCH = 3
+    const val SCHED_IDLE = 5
+
+    data class RolePlacement(
+        val cluster: Cluster = Cluster.ANY,
+        val nice: Int = 0,
+        val policy: Int = SCHED_OTHER,
+        val rtPriority: Int = 0
+    )
+
+    data class Config(
+        val dataPath: RolePlacement = RolePlacement(),
+        val control: RolePlacement = RolePlacement(),
+        val promotePermille: Int = 400,
+        val demotePermille: Int = 100
+    ) {
+        internal fun toPacked(): IntArray = intArrayOf(
+            dataPath.cluster.ordinal, dataPath.nice, dataPath.policy, dataPath.rtPriority,
+            control.cluster.ordinal, control.nice, control.policy, control.rtPriority,
+            promotePermille, demotePermille
+        )
+    }
+
+    data class Topology(val big: List<Int>, val little: List<Int>) {
+        val heterogeneous: Boolean get() = big != little
+    }
+
+    data class PlacedThread(val tid: Int, val dataPath: Boolean, val cluster: Cluster, val utilizationPermille: Int)
+
+    data class Sample(val threads: List<PlacedThread>, val promotions: Long, val demotions: Long, val failures: Long)
+
+    /** False when the native library is unavailable (e.g. JVM unit tests) */
+    val isAvailable: Boolean by lazy {
+        try {
+            System.loadLibrary("openvpn-jni")
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library unavailable - tunnel threads keep default placement")
+            false
+        }
+    }
+
+    fun configure(config: Config) {
+        if (isAvailable) {
+            nativeConfigure(config.toPacked())
+        }
+    }
+
+    /** Big and little cores by maximum frequency; equal on homogeneous devices */
+    fun topology(): Topology? {
+        if (!isAvailable) {
+            return null
+        }
+        val packed = nativeTopology() ?: return null
+        if (packed.size < 2) {
+            return null
+        }
+        val bigCount = packed[0]
+        val littleCount = packed[1]
+        return Topology(
+            packed.slice(2 until 2 + bigCount),
+            packed.slice(2 + bigCount until 2 + bigCount + littleCount)
+        )
+    }
+
+    /**
+     * Measures per-thread CPU use since the previous call and moves AUTO threads.
+     * Call periodically; utilization is averaged over the interval between calls.
+     */
+    fun sample(): Sample? {
+        if (!isAvailable) {
+            return null
+        }
+        val packed = nativeSample() ?: return null
+        if (packed.size < 4) {
+            return null
+        }
+        val count = packed[3].toInt()
+        val threads = (0 until count).map { i ->
+            val base = 4 + i * 4
+            PlacedThread(
+                packed[base].toInt(),
+                packed[base + 1] == 0L,
+                Cluster.values()[packed[base + 2].toInt()],
+                packed[base + 3].toInt()
+            )
+        }
+        return Sample(threads, packed[0], packed[1], packed[2])
+    }
+
+    /** [data path cluster, nice, policy, rtPriority, control (same), promotePermille, demotePermille] */
+    @JvmStatic
+    private external fun nativeConfigure(packed: IntArray)
+
+    /** [bigCount, littleCount, big cpus..., little cpus...] */
+    @JvmStatic
+    private external fun nativeTopology(): IntArray?
+
+    /** [promotions, demotions, failures, threadCount, then tid, role, cluster, utilizationPermille per thread] */
+    @JvmStatic
+    private external fun nativeSample(): LongArray?
+}
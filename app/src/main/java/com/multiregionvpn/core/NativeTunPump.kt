@@ -0,0 +1,85 @@
+package com.multiregionvpn.core
+
+import android.util.Log
+import java.nio.ByteBuffer
+
+/**
+ * Native TUN data path (tun_pump.h).
+ *
+ * A C++ thread owns the TUN fd and every tunnel's socketpair fd on one epoll
+ * loop: outbound packets for known flows go straight to their tunnel and
+ * inbound packets straight to TUN, with no JNI crossing or copy into the JVM.
+ * Only flow misses surface here via [takeMiss] so [PacketRouter] can decide
+ * and teach the native flow table.
+ *
+ * The pump dup()s the fds it is given; callers keep ownership of theirs.
+ */
+object NativeTunPump {
+    private const val TAG = "NativeTunPump"
+
+    /** Matches TunPump::PACKET_SIZE */
+    const val MAX_PACKET_SIZE = 32767
+
+    /** False when the native library is unavailable (e.g. JVM unit tests) */
+    val isAvailable: Boolean by lazy {
+        try {
+            System.loadLibrary("openvpn-jni")
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            Log.w(TAG, "Native library unavailable - TUN I/O stays in Kotlin")
+            false
+        }
+    }
+
+    /**
+     * Starts pumping [tunFd], replacing any previous TUN fd.
+     * Must be stopped before the VpnService interface is closed.
+     */
+    fun start(tunFd: Int): Boolean = isAvailable && nativeStart(tunFd)
+
+    fun stop() {
+        if (isAvailable) {
+            nativeStop()
+        }
+    }
+
+    fun isRunning(): Boolean = isAvailable && nativeIsRunning()
+
+    /**
+     * Forwards [tunnelId]'s traffic through [appFd] (the Kotlin end of its socketpair).
+     * Attachments survive pump restarts.
+     */
+    fun attachTunnel(tunnelId: String, appFd: Int): Boolean =
+        isAvailable && nativeAttachTunnel(tunnelId, appFd)
+
+    fun detachTunnel(tunnelId: String) {
+        if (isAvailable) {
+            nativeDetachTunnel(tunnelId)
+        }
+    }
+
+    /**
+     * Waits up to [timeoutMs] for a packet whose flow the native router does not
+     * know and copies it into [buffer] (direct). Returns its length, 0 on timeout,
+     * or -1 once the pump has stopped.
+     */
+    fun takeMiss(buffer: ByteBuffer, timeoutMs: Int): Int = nativeTakeMiss(buffer, timeoutMs)
+
+    @JvmStatic
+    private external fun nativeStart(tunFd: Int): Boolean
+
+    @JvmStatic
+    private external fun nativeStop()
+
+    @JvmStatic
+    private external fun nativeIsRunning(): Boolean
+
+    @JvmStatic
+    private external fun nativeAttachTunnel(tunnelId: String, appFd: Int): Boolean
+
+    @JvmStatic
+    private external fun nativeDetachTunnel(tunnelId: String)
+
+    @JvmStatic
+    private external fun nativeTakeMiss(buffer: ByteBuffer, timeoutMs: Int): Int
+}
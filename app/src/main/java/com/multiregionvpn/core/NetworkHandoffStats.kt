@@ -0,0 +1,84 @@
+package com.multiregionvpn.core
+
+/**
+ * Network handoff gaps decoded from VpnEngineService.nativeGetNetworkHandoffStats().
+ *
+ * One row per direction and path, mirroring openvpn::HandoffStatsField in
+ * network_handoff.h. The gap runs from the network change to the first packet
+ * the tunnel received afterwards.
+ */
+data class NetworkHandoffStats(
+    val direction: Direction,
+    val path: Path,
+    /** Handoffs that saw data flow back */
+    val count: Long,
+    val lastMs: Long,
+    val minMs: Long,
+    val maxMs: Long,
+    val totalMs: Long,
+    /** Rebinds that saw no data before the deadline and fell back to a reconnect */
+    val escalated: Long,
+    val abandoned: Long
+) {
+    enum class Direction { WIFI_TO_CELLULAR, CELLULAR_TO_WIFI, OTHER }
+
+    enum class Path { REBIND, RECONNECT }
+
+    val averageMs: Long
+        get() = if (count > 0) totalMs / count else -1
+
+    companion object {
+        const val LAYOUT_VERSION = 1L
+
+        /** Values of openvpn::NetworkKind passed to nativeOnNetworkChanged() */
+        const val NETWORK_UNKNOWN = 0
+        const val NETWORK_WIFI = 1
+        const val NETWORK_CELLULAR = 2
+        const val NETWORK_OTHER = 3
+
+        private const val IDX_DIRECTION = 0
+        private const val IDX_PATH = 1
+        private const val IDX_COUNT = 2
+        private const val IDX_LAST_MS = 3
+        private const val IDX_MIN_MS = 4
+        private const val IDX_MAX_MS = 5
+        private const val IDX_TOTAL_MS = 6
+        private const val IDX_ESCALATED = 7
+        private const val IDX_ABANDONED = 8
+        const val FIELD_COUNT = 9
+
+        /**
+         * Decodes [version, rowCount, fieldCount, rows...]. Returns an empty list if
+         * the array is missing or from a different layout version.
+         */
+        fun fromPacked(packed: LongArray?): List<NetworkHandoffStats> {
+            if (packed == null || packed.size < 3 || packed[0] != LAYOUT_VERSION) {
+                return emptyList()
+            }
+            val count = packed[1].toInt()
+            val fieldCount = packed[2].toInt()
+            if (fieldCount < FIELD_COUNT || packed.size < 3 + count * fieldCount) {
+                return emptyList()
+            }
+            return (0 until count).mapNotNull { i ->
+                val base = 3 + i * fieldCount
+                val direction = Direction.values().getOrNull(packed[base + IDX_DIRECTION].toInt())
+                val path = Path.values().getOrNull(packed[base + IDX_PATH].toInt())
+                if (direction == null || path == null) {
+                    return@mapNotNull null
+                }
+                NetworkHandoffStats(
+                    direction = direction,
+                    path = path,
+                    count = packed[base + IDX_COUNT],
+                    lastMs = packed[base + IDX_LAST_MS],
+                    minMs = packed[base + IDX_MIN_MS],
+                    maxMs = packed[base + IDX_MAX_MS],
+                    totalMs = packed[base + IDX_TOTAL_MS],
+                    escalated = packed[base + IDX_ESCALATED],
+                    abandoned = packed[base + IDX_ABANDONED]
+                )
+            }
+        }
+    }
+}
@@ -20,7 +20,9 @@ class PacketRouter(
     private val vpnService: VpnService,
     private val vpnConnectionManager: VpnConnectionManager,
     private val vpnOutput: java.io.FileOutputStream? = null, // For writing packets back to TUN interface
-    private val connectionTracker: ConnectionTracker? = null // Optional connection tracker for UID detection
+    private val connectionTracker: ConnectionTracker? = null, // Optional connection tracker for UID detection
+    private val nativeRouter: NativePacketRouter? = null, // Native flow classifier; null keeps classification in Kotlin
+    private val routingTable: RoutingTable? = null // Precompiled app rules; null falls back to Room lookups
 ) {
     private val connectivityManager = context.getSystemService(Context.CONNECTIVITY_SERVICE) as ConnectivityManager
     private val packageManager = context.packageManager
@@ -32,6 +34,13 @@ class PacketRouter(
             // (was logging 100+ times per second, flooding binder buffer)
             // Only log errors and important routing events
             
+            // Fast path: flows already routed once are classified natively without allocating
+            val learnedTunnelId = nativeRouter?.classify(packet)
+            if (learnedTunnelId != null) {
+                vpnConnectionManager.sendPacketToTunnel(learnedTunnelId, packet)
+                return
+            }
+            
             // Parse packet to get 5-tuple
             val packetInfo = parsePacket(packet)
             if (packetInfo == null) {
@@ -52,8 +61,17 @@ class PacketRouter(
             // The old "isFromTunnelIp" check was incorrectly matching the VPN interface IP (10.100.0.2),
             // causing outbound HTTP traffic to be misclassified as "inbound" and sent to direct internet!
             
-            val srcIpString = packetInfo.srcIp.hostAddress ?: ""
-            val isDnsQuery = packetInfo.protocol == 17 && packetInfo.destPort == 53
+            // DNS goes to the querying app's tunnel and is not tracked as a flow; the tunnel's
+            // native DnsForwarder answers repeats from its cache and sends misses to its resolver
+            if (packetInfo.protocol == 17 && packetInfo.destPort == 53) {
+                val dnsTunnel = dnsTunnelFor(packetInfo)
+                if (dnsTunnel != null) {
+                    vpnConnectionManager.sendPacketToTunnel(dnsTunnel, packet)
+                } else {
+                    sendToDirectInternet(packet)
+                }
+                return
+            }
             
             // CRITICAL: Use ConnectionTracker to get UID instead of /proc/net
             // This solves the permission denied issue with /proc/net files
@@ -63,47 +81,20 @@ class PacketRouter(
                 // Connection not in tracking table - try to infer from registered packages
                 // Since we're using VpnService.Builder.addAllowedApplication(), only registered
                 // apps' packets should reach us. Try to match by checking registered packages.
-                // CRITICAL: For DNS queries (UDP port 53) or any new connection from registered apps,
-                // we should register it immediately and route it to the appropriate tunnel
-                // Since only registered apps' packets reach us (via addAllowedApplication),
-                // any packet from a registered app should be routed to its tunnel
-                
-                // SPECIAL CASE: DNS queries (UDP port 53)
-                // DNS queries are special - they come from the system resolver on behalf of apps
-                // The source IP is the VPN interface IP (e.g., 10.100.0.2), not the app's IP
-                // We need to route DNS queries to any connected tunnel since DNS resolution is needed
-                // for all apps using the VPN, and the DNS servers are only reachable through the tunnel
-                if (packetInfo.protocol == 17 && packetInfo.destPort == 53) {
-                    // This is a DNS query - route it to the first connected tunnel
-                    // DNS queries should go through the VPN to use VPN DNS servers
-                    Log.d(TAG, "🔍 DNS query detected: ${packetInfo.srcIp}:${packetInfo.srcPort} → ${packetInfo.destIp}:53")
-                    val allTunnels = vpnConnectionManager.getAllTunnelIds()
-                    Log.d(TAG, "   Available tunnels: ${allTunnels.joinToString()}")
-                    val connectedTunnel = allTunnels.firstOrNull { tunnelId ->
-                        val isConnected = vpnConnectionManager.isTunnelConnected(tunnelId)
-                        Log.d(TAG, "   Tunnel $tunnelId: ${if (isConnected) "✅ connected" else "❌ not connected"}")
-                        isConnected
-                    }
-                    
-                    if (connectedTunnel != null) {
-                        Log.i(TAG, "🌐 Routing DNS query from ${packetInfo.srcIp}:${packetInfo.srcPort} to tunnel $connectedTunnel (packet size: ${packet.size})")
-                        vpnConnectionManager.sendPacketToTunnel(connectedTunnel, packet)
-                        Log.d(TAG, "   ✅ DNS query sent to tunnel $connectedTunnel")
-                        
-                        // Register this DNS connection so future packets are tracked
-                        // Use a dummy UID (-1) since we don't know the actual app UID for DNS queries
-                        tracker.registerConnection(packetInfo.srcIp, packetInfo.srcPort, -1, connectedTunnel)
-                        return
-                    } else {
-                        Log.e(TAG, "⚠️  DNS query received but no connected tunnels available - sending to direct internet")
-                        Log.e(TAG, "   Available tunnels: ${allTunnels.joinToString()}")
+                // Routing snapshot already resolved the first registered package and its tunnel
+                if (routingTable != null) {
+                    val route = routingTable.current.defaultRoute
+                    if (route == null) {
+                        Log.v(TAG, "No routed packages in snapshot - sending ${packetInfo.srcIp}:${packetInfo.srcPort} to direct internet")
                         sendToDirectInternet(packet)
                         return
                     }
+                    tracker.registerConnection(packetInfo.srcIp, packetInfo.srcPort, route.uid, route.tunnelId)
+                    nativeRouter?.learnStagedFlow(route.tunnelId, route.uid)
+                    vpnConnectionManager.sendPacketToTunnel(route.tunnelId, packet)
+                    return
                 }
                 
-                Log.e(TAG, "🔍 DEBUG: connectionInfo is null, about to get registered packages")
-                
                 // Get all registered packages directly from ConnectionTracker
                 // This is more reliable than getting UIDs first
                 val registeredPackages = try {
@@ -148,6 +139,7 @@ class PacketRouter(
                             
                             if (tunnelId != null) {
                                 // Route to tunnel
+                                nativeRouter?.learnStagedFlow(tunnelId, uid)
                                 vpnConnectionManager.sendPacketToTunnel(tunnelId, packet)
                                 Log.d(TAG, "✅ Registered and routed new connection from $packageName (UID $uid) to tunnel $tunnelId (dest: ${packetInfo.destIp}:${packetInfo.destPort}, protocol: ${packetInfo.protocol}, src: ${packetInfo.srcIp}:${packetInfo.srcPort})")
                                 return
@@ -174,11 +166,25 @@ class PacketRouter(
             
             // If we have a tunnel ID, route directly to it
             if (tunnelId != null) {
+                nativeRouter?.learnStagedFlow(tunnelId, uid)
                 vpnConnectionManager.sendPacketToTunnel(tunnelId, packet)
                 // PERFORMANCE: Removed per-packet verbose logging
                 return
             }
             
+            if (routingTable != null) {
+                val ruleTunnelId = routingTable.current.tunnelForUid(uid)
+                if (ruleTunnelId == null) {
+                    sendToDirectInternet(packet)
+                    return
+                }
+                tracker.setUidToTunnel(uid, ruleTunnelId)
+                tracker.registerConnection(packetInfo.srcIp, packetInfo.srcPort, uid, ruleTunnelId)
+                nativeRouter?.learnStagedFlow(ruleTunnelId, uid)
+                vpnConnectionManager.sendPacketToTunnel(ruleTunnelId, packet)
+                return
+            }
+            
             // Fallback: Get package name from UID and look up rule
             val packageNames = packageManager.getPackagesForUid(uid) ?: return
             
@@ -208,6 +214,7 @@ class PacketRouter(
                     tracker.setUidToTunnel(uid, ruleTunnelId)
                     // Re-register connection with tunnel ID
                     tracker.registerConnection(packetInfo.srcIp, packetInfo.srcPort, uid, ruleTunnelId)
+                    nativeRouter?.learnStagedFlow(ruleTunnelId, uid)
                     vpnConnectionManager.sendPacketToTunnel(ruleTunnelId, packet)
                     Log.v(TAG, "Routed packet from $packageName (UID $uid) to tunnel $ruleTunnelId")
                 } else {
@@ -273,6 +280,31 @@ class PacketRouter(
         }
     }
     
+    /**
+     * Tunnel for a DNS query: the tunnel of the app that owns the socket, else the
+     * default route's tunnel, else any connected tunnel. Null if none is connected.
+     */
+    private fun dnsTunnelFor(info: PacketInfo): String? {
+        val uid = try {
+            connectivityManager.getConnectionOwnerUid(
+                info.protocol,
+                InetSocketAddress(info.srcIp, info.srcPort),
+                InetSocketAddress(info.destIp, info.destPort)
+            )
+        } catch (e: Exception) {
+            -1
+        }
+        val snapshot = routingTable?.current
+        val candidates = sequence {
+            if (uid >= 0) {
+                (snapshot?.tunnelForUid(uid) ?: tracker.getTunnelIdForUid(uid))?.let { yield(it) }
+            }
+            snapshot?.defaultRoute?.tunnelId?.let { yield(it) }
+            yieldAll(vpnConnectionManager.getAllTunnelIds())
+        }
+        return candidates.firstOrNull { vpnConnectionManager.isTunnelConnected(it) }
+    }
+    
     private fun getConnectionOwnerUid(
         srcIp: InetAddress,
         srcPort: Int,
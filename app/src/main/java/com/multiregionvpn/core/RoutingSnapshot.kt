@@ -0,0 +1,87 @@
+package com.multiregionvpn.core
+
+import com.multiregionvpn.data.database.AppRule
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.atomic.AtomicReference
+
+/**
+ * Immutable app-rule routing table used by [PacketRouter].
+ *
+ * Built off the packet path whenever app rules change: each package is resolved to
+ * its UID and each VPN config to its tunnel ID up front, so routing a new flow is a
+ * map lookup instead of Room queries.
+ */
+class RoutingSnapshot private constructor(
+    val version: Long,
+    private val uidToTunnel: Map<Int, String>,
+    private val packageToTunnel: Map<String, String>,
+    /** First rule with a tunnel, used for flows the tracker has no UID for */
+    val defaultRoute: Route?
+) {
+    data class Route(val packageName: String, val uid: Int, val tunnelId: String)
+
+    /** Tunnel for [uid], or null if its app has no rule or routes direct */
+    fun tunnelForUid(uid: Int): String? = uidToTunnel[uid]
+
+    fun tunnelForPackage(packageName: String): String? = packageToTunnel[packageName]
+
+    val size: Int get() = packageToTunnel.size
+
+    companion object {
+        val EMPTY = RoutingSnapshot(0, emptyMap(), emptyMap(), null)
+
+        /**
+         * Builds a snapshot from [rules].
+         *
+         * @param tunnelIds vpnConfigId -> tunnelId for configs that exist
+         * @param uidForPackage Resolves an installed package's UID, or null
+         */
+        fun build(
+            version: Long,
+            rules: List<AppRule>,
+            tunnelIds: Map<String, String>,
+            uidForPackage: (String) -> Int?
+        ): RoutingSnapshot {
+            val uidToTunnel = HashMap<Int, String>()
+            val packageToTunnel = LinkedHashMap<String, String>()
+            var defaultRoute: Route? = null
+
+            for (rule in rules) {
+                val tunnelId = rule.vpnConfigId?.let { tunnelIds[it] } ?: continue
+                packageToTunnel[rule.packageName] = tunnelId
+                val uid = uidForPackage(rule.packageName) ?: continue
+                uidToTunnel[uid] = tunnelId
+                if (defaultRoute == null) {
+                    defaultRoute = Route(rule.packageName, uid, tunnelId)
+                }
+            }
+            return RoutingSnapshot(version, uidToTunnel, packageToTunnel, defaultRoute)
+        }
+    }
+}
+
+/**
+ * Holds the current [RoutingSnapshot]. Readers take the reference with a single
+ * volatile load; writers build a new snapshot and swap it in, so a reader always
+ * sees one complete rule set.
+ */
+class RoutingTable {
+    private val snapshot = AtomicReference(RoutingSnapshot.EMPTY)
+    private val versions = AtomicLong()
+
+    val current: RoutingSnapshot get() = snapshot.get()
+
+    fun publish(
+        rules: List<AppRule>,
+        tunnelIds: Map<String, String>,
+        uidForPackage: (String) -> Int?
+    ): RoutingSnapshot {
+        val next = RoutingSnapshot.build(versions.incrementAndGet(), rules, tunnelIds, uidForPackage)
+        snapshot.set(next)
+        return next
+    }
+
+    fun clear() {
+        snapshot.set(RoutingSnapshot.EMPTY)
+    }
+}
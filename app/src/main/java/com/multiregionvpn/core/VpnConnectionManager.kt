@@ -7,12 +7,15 @@ import com.multiregionvpn.core.vpnclient.OpenVpnClient
 import com.multiregionvpn.core.vpnclient.NativeOpenVpnClient
 import com.multiregionvpn.core.vpnclient.WireGuardVpnClient
 import com.multiregionvpn.core.vpnclient.AuthenticationException
+import com.multiregionvpn.core.vpnclient.ConnectionState
+import com.multiregionvpn.core.vpnclient.ConnectTimeline
 import kotlinx.coroutines.runBlocking
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.GlobalScope
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.isActive
 import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicBoolean
 
 /**
  * Manages multiple simultaneous OpenVPN connections.
@@ -34,6 +37,7 @@ class VpnConnectionManager(
     }
     private val connections = ConcurrentHashMap<String, OpenVpnClient>()
     private var packetReceiver: ((String, ByteArray) -> Unit)? = null
+    @Volatile private var packetBufferReceiver: ((String, java.nio.ByteBuffer) -> Unit)? = null
     private var baseTunFileDescriptor: Int = -1  // Base TUN file descriptor from VpnEngineService (will be duplicated per connection)
     private var vpnInterface: android.os.ParcelFileDescriptor? = null  // Original PFD for duplicating
     private var connectionStateListener: ((Boolean) -> Unit)? = null  // true = has connecting connections, false = all connected or none connecting
@@ -48,11 +52,13 @@ class VpnConnectionManager(
     private var tunnelIpCallback: ((String, String, Int) -> Unit)? = null  // Callback for tunnel IP addresses
     private var tunnelDnsCallback: ((String, List<String>) -> Unit)? = null  // Callback for DNS servers
     
-    // Packet queueing for tunnels that are connecting but not yet ready
-    private data class QueuedPacket(val packet: ByteArray, val timestamp: Long)
-    private val packetQueues = ConcurrentHashMap<String, java.util.concurrent.ConcurrentLinkedQueue<QueuedPacket>>()
-    private val QUEUE_TIMEOUT_MS = 10000L  // Drop packets after 10 seconds (increased for slower connections)
-    private val MAX_QUEUE_SIZE = 10000  // Max packets to queue per tunnel (~15MB for avg 1500-byte packets)
+    // Native tunnel handles from createPipe(). Packets for a tunnel that is still connecting
+    // go to its native pre-connect queue (pre_connect_queue.h), which CustomTunClient
+    // writes into the tunnel's app FD as soon as tun_start() brings the TUN up.
+    private val tunnelHandles = ConcurrentHashMap<String, Long>()
+    // Direct ByteBuffer I/O on each tunnel's current Kotlin FD (direct_packet_channel.h),
+    // used by sendPacketToTunnel() and the pipe reader when the native TUN pump is not.
+    private val directChannels = ConcurrentHashMap<String, DirectPacketChannel>()
     
     // Tunnel readiness tracking (for comprehensive routing readiness checks)
     private data class TunnelReadinessState(
@@ -179,11 +185,15 @@ class VpnConnectionManager(
                 // appropriate socketpair. OpenVPN 3 reads from its socketpair (packet-oriented, emulates TUN).
                 val connectionFd = try {
                     // Create socketpair using JNI (native code)
-                    // Returns the OpenVPN 3 side FD (packet-oriented, SOCK_SEQPACKET)
-                    val pipeReadFd = createPipe(tunnelId)
+                    // Returns the tunnel handle; its OpenVPN 3 side FD is packet-oriented (SOCK_SEQPACKET)
+                    val pipeHandle = createPipe(tunnelId)
+                    if (pipeHandle != 0L) {
+                        tunnelHandles[tunnelId] = pipeHandle
+                    }
+                    val pipeReadFd = if (pipeHandle != 0L) getOpenVpnPipeFd(pipeHandle) else -1
                     if (pipeReadFd >= 0) {
                             // Get the Kotlin FD (socket pair is bidirectional - same FD for read/write)
-                            val kotlinFd = getPipeWriteFd(tunnelId)
+                            val kotlinFd = getPipeWriteFd(pipeHandle)
                             
                             if (kotlinFd >= 0) {
                                 Log.d(TAG, "✅ Created socket pair for tunnel $tunnelId")
@@ -197,6 +207,7 @@ class VpnConnectionManager(
                                 pipeWritePfds[tunnelId] = pfd
                                 // Don't create a second PFD from same FD - reuse the same PFD for read/write
                                 // pipeReadPfds[tunnelId] = pfd  // REMOVED - was causing double-close
+                                bindDirectChannel(tunnelId, kotlinFd)
                                 
                                 // Start pipe reader coroutine to read response packets from OpenVPN 3
                                 // OpenVPN 3 writes responses to socket pair, we read them and forward to TUN
@@ -288,6 +299,29 @@ class VpnConnectionManager(
         packetReceiver = callback
     }
     
+    /**
+     * Sets a callback that receives tunnel packets as a buffer view (position to
+     * limit), valid only during the call. Direct channels and clients that lend
+     * their receive buffer deliver here without copying; other packets still go
+     * to [setPacketReceiver].
+     */
+    fun setPacketBufferReceiver(callback: (tunnelId: String, packet: java.nio.ByteBuffer) -> Unit) {
+        packetBufferReceiver = callback
+    }
+    
+    // Hands a borrowed buffer view to the buffer receiver, or a copy to the ByteArray receiver
+    private fun deliverPacket(tunnelId: String, packet: java.nio.ByteBuffer) {
+        val bufferReceiver = packetBufferReceiver
+        if (bufferReceiver != null) {
+            bufferReceiver(tunnelId, packet)
+            return
+        }
+        val receiver = packetReceiver ?: return
+        val copy = ByteArray(packet.remaining())
+        packet.get(copy)
+        receiver(tunnelId, copy)
+    }
+    
     /**
      * Sets a callback to be notified when connection state changes.
      * Called with true when connections start connecting, false when all are connected or none connecting.
@@ -317,6 +351,12 @@ class VpnConnectionManager(
             try {
                     // Write packet to socket pair instead of calling client.sendPacket()
                     // OpenVPN 3 reads from socket pair, so writing to socket pair = injecting packet into OpenVPN 3
+                    // Direct buffer first. A socket that stays full (0) or an unusable
+                    // channel (-1) falls back to the stream writer, which blocks for
+                    // space rather than dropping the packet
+                    if ((directChannels[tunnelId]?.send(packet) ?: -1) > 0) {
+                        return
+                    }
                     val pipeWriteFd = pipeWriteFds[tunnelId]
                     if (pipeWriteFd != null && pipeWriteFd >= 0) {
                         // Get or create socket pair writer for this tunnel
@@ -342,26 +382,10 @@ class VpnConnectionManager(
                 Log.e(TAG, "Error sending packet to tunnel $tunnelId", e)
             }
         } else if (client != null && !client.isConnected()) {
-            // Tunnel exists but not connected yet - queue packet
-            val queue = packetQueues.getOrPut(tunnelId) { java.util.concurrent.ConcurrentLinkedQueue() }
-            
-            // Clean old packets from queue (older than QUEUE_TIMEOUT_MS)
-            val now = System.currentTimeMillis()
-            val iterator = queue.iterator()
-            while (iterator.hasNext()) {
-                val queuedPacket = iterator.next()
-                if (now - queuedPacket.timestamp > QUEUE_TIMEOUT_MS) {
-                    iterator.remove()
-                    Log.v(TAG, "Dropped queued packet for tunnel $tunnelId (timed out after ${QUEUE_TIMEOUT_MS}ms)")
-                }
-            }
-            
-            // Add packet to queue if not full
-            if (queue.size < MAX_QUEUE_SIZE) {
-                queue.add(QueuedPacket(packet, now))
-                Log.i(TAG, "📦 Queued packet for tunnel $tunnelId (not connected yet, queue size: ${queue.size})")
-            } else {
-                Log.w(TAG, "⚠️  Packet queue full for tunnel $tunnelId (max $MAX_QUEUE_SIZE = ~${MAX_QUEUE_SIZE * 1500 / 1024 / 1024}MB), dropping packet")
+            // Tunnel exists but not connected yet - hold the packet natively (O(1), age-expired)
+            val handle = tunnelHandles[tunnelId] ?: 0L
+            if (nativeQueuePacket(handle, packet) == QUEUE_RESULT_DROPPED) {
+                Log.w(TAG, "⚠️  Pre-connect queue for tunnel $tunnelId rejected packet (full, oversized or no handle)")
             }
         } else {
             // Tunnel doesn't exist at all - drop packet
@@ -370,52 +394,38 @@ class VpnConnectionManager(
     }
     
     /**
-     * Flush queued packets for a tunnel when it connects.
-     * Called automatically when tunnel connection completes.
+     * Queues [packet] in the tunnel's native pre-connect queue, or writes it to the
+     * tunnel's app FD if tun_start() already drained the queue.
+     * Returns 0 = queued, 1 = sent, -1 = dropped.
      */
-    private fun flushQueuedPackets(tunnelId: String) {
-        val queue = packetQueues[tunnelId]
-        if (queue != null && queue.isNotEmpty()) {
-            Log.i(TAG, "📤 Flushing ${queue.size} queued packets for tunnel $tunnelId")
-            var sentCount = 0
-            var droppedCount = 0
-            
-            while (queue.isNotEmpty()) {
-                val queuedPacket = queue.poll()
-                if (queuedPacket != null) {
-                    val age = System.currentTimeMillis() - queuedPacket.timestamp
-                    if (age <= QUEUE_TIMEOUT_MS) {
-                        // Packet still valid - send it
-                        sendPacketToTunnel(tunnelId, queuedPacket.packet)
-                        sentCount++
-                    } else {
-                        // Packet too old - drop it
-                        droppedCount++
-                    }
-                }
-            }
-            
-            Log.i(TAG, "✅ Flushed queued packets for tunnel $tunnelId: sent=$sentCount, dropped=$droppedCount")
-            packetQueues.remove(tunnelId)
-        }
-    }
+    private external fun nativeQueuePacket(tunnelHandle: Long, packet: ByteArray): Int
+    
+    /**
+     * Drops every packet in the tunnel's native pre-connect queue.
+     */
+    private external fun nativeClearQueuedPackets(tunnelHandle: Long)
     
     /**
      * Create pipes (unnamed pipes) for packet filtering.
-     * Returns the read FD for OpenVPN 3 (it will read packets from this).
+     * Returns the native tunnel handle (0 = error) that the FD getters below take.
      * Native code creates the pipes.
      */
-    private external fun createPipe(tunnelId: String): Int
+    private external fun createPipe(tunnelId: String): Long
+    
+    /**
+     * Get the read FD for OpenVPN 3 (it will read packets from this).
+     */
+    private external fun getOpenVpnPipeFd(tunnelHandle: Long): Int
     
     /**
      * Get the write FD for writing packets to OpenVPN 3.
      */
-    private external fun getPipeWriteFd(tunnelId: String): Int
+    private external fun getPipeWriteFd(tunnelHandle: Long): Int
     
     /**
      * Get the read FD for reading responses from OpenVPN 3.
      */
-    private external fun getPipeReadFd(tunnelId: String): Int
+    private external fun getPipeReadFd(tunnelHandle: Long): Int
     
     /**
      * Start a background coroutine to read response packets from OpenVPN 3 via pipe.
@@ -424,6 +434,13 @@ class VpnConnectionManager(
     private fun startPipeReader(tunnelId: String, readFd: Int) {
         // Cancel existing reader if any
         pipeReaders[tunnelId]?.cancel()
+        pipeReaders.remove(tunnelId)
+        
+        // The native TUN pump reads tunnel responses and writes them to TUN itself
+        if (NativeTunPump.attachTunnel(tunnelId, readFd)) {
+            Log.d(TAG, "✅ Tunnel $tunnelId attached to native TUN pump (FD: $readFd)")
+            return
+        }
         
         // Start new reader coroutine
         val job = pipeReaderScope.launch {
@@ -434,6 +451,23 @@ class VpnConnectionManager(
                 // FIXED: Use pipeWritePfds since we only create one PFD per FD now
                 val pfd = pipeWritePfds[tunnelId]
                     ?: throw IllegalStateException("PFD not found for tunnel $tunnelId")
+                
+                // Batched reads into the registered direct buffer, one recvmmsg() per wakeup
+                val channel = directChannels[tunnelId]
+                if (channel != null) {
+                    var received = 0L
+                    while (isActive && connections.containsKey(tunnelId)) {
+                        val count = channel.receiveBatch { packet -> deliverPacket(tunnelId, packet) }
+                        if (count < 0) {
+                            Log.w(TAG, "❌ Direct channel closed for tunnel $tunnelId (read $received responses)")
+                            break
+                        }
+                        received += count
+                    }
+                    Log.d(TAG, "Pipe reader stopped for tunnel $tunnelId (read $received responses total)")
+                    return@launch
+                }
+                
                 val reader = java.io.FileInputStream(pfd.fileDescriptor)
                 
                 val buffer = ByteArray(32767) // Max IP packet size
@@ -491,8 +525,10 @@ class VpnConnectionManager(
      * Stop pipe reader for a tunnel (called when tunnel disconnects).
      */
     private fun stopPipeReader(tunnelId: String) {
+        NativeTunPump.detachTunnel(tunnelId)
         pipeReaders[tunnelId]?.cancel()
         pipeReaders.remove(tunnelId)
+        directChannels.remove(tunnelId)?.close()
         pipeWriters[tunnelId]?.close()
         pipeWriters.remove(tunnelId)
         
@@ -504,6 +540,22 @@ class VpnConnectionManager(
         Log.d(TAG, "Stopped pipe reader and writer for tunnel $tunnelId (FD properly closed once)")
     }
     
+    /**
+     * Points the tunnel's direct packet channel at [fd], opening it on first use.
+     * Must run before the previous FD is closed.
+     */
+    private fun bindDirectChannel(tunnelId: String, fd: Int) {
+        val existing = directChannels[tunnelId]
+        if (existing != null) {
+            if (!existing.bind(fd)) {
+                directChannels.remove(tunnelId)?.close()
+            }
+            return
+        }
+        val handle = tunnelHandles[tunnelId] ?: return
+        DirectPacketChannel.open(handle, fd)?.let { directChannels[tunnelId] = it }
+    }
+    
     /**
      * Checks if any OpenVPN tunnel is currently connected (fully established, not just connecting).
      * This is used to determine if VpnEngineService should stop reading from TUN
@@ -626,6 +678,7 @@ class VpnConnectionManager(
         client.setPacketReceiver { packet ->
             packetReceiver?.invoke(tunnelId, packet)
         }
+        client.setPacketBufferReceiver { packet -> deliverPacket(tunnelId, packet) }
         Log.d(TAG, "Packet receiver set for tunnel $tunnelId")
         
         // Add client to connections map BEFORE connecting (so it's tracked during connection)
@@ -642,6 +695,22 @@ class VpnConnectionManager(
         var connected: Boolean
         var connectionError: VpnError? = null
         
+        // Lifecycle pushes arrive on a native thread; hand them to a coroutine
+        val connectHandled = AtomicBoolean(false)
+        val pushesState = client.setStateListener { state ->
+            pipeReaderScope.launch {
+                if (connections[tunnelId] !== client) {
+                    return@launch
+                }
+                if (state == ConnectionState.CONNECTED && connectHandled.compareAndSet(false, true)) {
+                    Log.i(TAG, "✅✅✅ Tunnel $tunnelId connection completed ✅✅✅")
+                    onTunnelConnected(tunnelId)
+                } else {
+                    notifyConnectionStateChanged()
+                }
+            }
+        }
+        
         try {
             // Connect (this starts async connection - returns true immediately if started successfully)
             connected = client.connect(ovpnConfig, authFilePath)
@@ -742,102 +811,29 @@ class VpnConnectionManager(
             // (OpenVPN 3 connections are asynchronous)
             Log.i(TAG, "✅ Tunnel connection started for: $tunnelId (connection completing asynchronously)")
             
-            // Start a coroutine to monitor connection status and notify when it completes
-            // This ensures we only resume TUN reading when connection is actually established
-            Log.d(TAG, "🔍 Starting connection completion polling for tunnel $tunnelId")
-            GlobalScope.launch {
-                var attempts = 0
-                val maxAttempts = 120 // 2 minutes (120 * 1 second)
-                Log.d(TAG, "   Polling loop started for tunnel $tunnelId (max $maxAttempts attempts)")
-                
-                while (attempts < maxAttempts && connections.containsKey(tunnelId)) {
-                    delay(1000) // Check every second
-                    attempts++
-                    
-                    if (attempts % 10 == 0) {
-                        Log.d(TAG, "   Polling attempt #$attempts for tunnel $tunnelId (checking isConnected())")
-                    }
-                    
-                    val client = connections[tunnelId]
-                    if (client != null) {
-                        val isConnected = client.isConnected()
-                        if (attempts % 10 == 0) {
-                            Log.d(TAG, "   Tunnel $tunnelId: isConnected()=$isConnected (attempt #$attempts)")
-                        }
+            // Clients that push lifecycle changes (NativeOpenVpnClient) were given a listener
+            // before connect(); only the rest fall back to polling isConnected()
+            if (!pushesState) {
+                Log.d(TAG, "🔍 Starting connection completion polling for tunnel $tunnelId")
+                GlobalScope.launch {
+                    var attempts = 0
+                    val maxAttempts = 120 // 2 minutes (120 * 1 second)
+                    while (attempts < maxAttempts && connections.containsKey(tunnelId)) {
+                        delay(1000) // Check every second
+                        attempts++
                         
-                    if (isConnected) {
-                        // Connection completed - notify listener and flush queued packets
-                        Log.i(TAG, "✅✅✅ Tunnel $tunnelId connection completed (after $attempts seconds) ✅✅✅")
-                        
-                        // CRITICAL FOR EXTERNAL TUN FACTORY:
-                        // Now that connection is FULLY established, retrieve the app FD from the socketpair
-                        // that was created by CustomTunClient during tun_start().
-                        val currentClient = connections[tunnelId]
-                        if (currentClient is com.multiregionvpn.core.vpnclient.NativeOpenVpnClient) {
-                            try {
-                                val appFd = currentClient.getAppFd(tunnelId)
-                                if (appFd >= 0) {
-                                    Log.i(TAG, "═══════════════════════════════════════════════════════")
-                                    Log.i(TAG, "✅ External TUN Factory: Got app FD for tunnel $tunnelId")
-                                    Log.i(TAG, "   App FD: $appFd")
-                                    Log.i(TAG, "   Socketpair created by CustomTunClient ✅")
-                                    Log.i(TAG, "   OpenVPN 3 is actively polling lib_fd ✅")
-                                    Log.i(TAG, "   Updating FD storage and starting pipe reader...")
-                                    Log.i(TAG, "═══════════════════════════════════════════════════════")
-                                    
-                                    // Update stored FD (overwrite the one from createPipe if it exists)
-                                    pipeWriteFds[tunnelId] = appFd
-                                    
-                                    // Create PFD from app FD (don't use dup, use the actual FD)
-                                    // Close old PFD if it exists to avoid FD leak
-                                    pipeWritePfds[tunnelId]?.close()
-                                    pipeWritePfds[tunnelId] = android.os.ParcelFileDescriptor.fromFd(appFd)
-                                    
-                                    // Restart pipe reader with correct FD
-                                    // Stop old reader if running
-                                    pipeReaders[tunnelId]?.cancel()
-                                    pipeReaders.remove(tunnelId)
-                                    
-                                    // Start new reader with app FD
-                                    startPipeReader(tunnelId, appFd)
-                                    
-                                    Log.i(TAG, "✅ External TUN Factory setup complete for tunnel $tunnelId")
-                                } else {
-                                    Log.w(TAG, "⚠️  External TUN Factory returned invalid app FD: $appFd")
-                                    Log.w(TAG, "   Falling back to createPipe() FD if available")
-                                }
-                            } catch (e: Exception) {
-                                Log.e(TAG, "❌ Failed to get app FD from External TUN Factory", e)
-                                Log.w(TAG, "   Falling back to createPipe() FD if available")
-                            }
+                        if (connections[tunnelId]?.isConnected() == true) {
+                            Log.i(TAG, "✅✅✅ Tunnel $tunnelId connection completed (after $attempts seconds) ✅✅✅")
+                            onTunnelConnected(tunnelId)
+                            return@launch
                         }
-                        
-                        Log.i(TAG, "   Flushing queued packets and notifying state change...")
-                        
-                        // Flush any packets that were queued while tunnel was connecting
-                        flushQueuedPackets(tunnelId)
-                        
-                        Log.i(TAG, "   Calling notifyConnectionStateChanged() to resume TUN reading...")
-                        notifyConnectionStateChanged()
-                        return@launch
-                    }
-                    } else {
-                        Log.w(TAG, "   Client for tunnel $tunnelId is null (attempt #$attempts)")
                     }
                     
-                    // Check if connection failed (client removed or error occurred)
                     if (!connections.containsKey(tunnelId)) {
                         Log.w(TAG, "⚠️  Tunnel $tunnelId removed during connection attempt (attempt #$attempts)")
-                        notifyConnectionStateChanged()
-                        return@launch
+                    } else {
+                        Log.w(TAG, "⚠️  Tunnel $tunnelId connection check timed out after $maxAttempts seconds")
                     }
-                }
-                
-                if (attempts >= maxAttempts) {
-                    Log.w(TAG, "⚠️  Tunnel $tunnelId connection check timed out after $maxAttempts seconds")
-                    Log.w(TAG, "   Final state: isConnected()=${connections[tunnelId]?.isConnected()}")
-                    // Still notify - connection might be stuck in connecting state
-                    Log.i(TAG, "   Calling notifyConnectionStateChanged() anyway...")
                     notifyConnectionStateChanged()
                 }
             }
@@ -857,6 +853,73 @@ class VpnConnectionManager(
         }
     }
     
+    /**
+     * Logs the phase breakdown of [tunnelId]'s latest connect attempt
+     */
+    private fun logConnectTimeline(tunnelId: String) {
+        val timeline = ConnectTimeline.fromPacked(
+            NativeOpenVpnClient.nativeGetConnectTimelines(tunnelId)
+        ).lastOrNull() ?: return
+        val phases = ConnectTimeline.Mark.values()
+            .filter { timeline.phaseUs(it) >= 0 }
+            .joinToString { "${it.name.lowercase()}=${timeline.phaseUs(it) / 1000}ms" }
+        Log.i(TAG, "Connect timeline for $tunnelId (slowest: ${timeline.slowestPhase}): $phases")
+    }
+
+    /**
+     * Runs once a tunnel reports CONNECTED: picks up the External TUN Factory app FD,
+     * flushes queued packets and resumes TUN reading.
+     */
+    private fun onTunnelConnected(tunnelId: String) {
+        // CRITICAL FOR EXTERNAL TUN FACTORY:
+        // Now that connection is FULLY established, retrieve the app FD from the socketpair
+        // that was created by CustomTunClient during tun_start().
+        val currentClient = connections[tunnelId]
+        if (currentClient is com.multiregionvpn.core.vpnclient.NativeOpenVpnClient) {
+            logConnectTimeline(tunnelId)
+            try {
+                val appFd = currentClient.getAppFd()
+                if (appFd >= 0) {
+                    Log.i(TAG, "═══════════════════════════════════════════════════════")
+                    Log.i(TAG, "✅ External TUN Factory: Got app FD for tunnel $tunnelId")
+                    Log.i(TAG, "   App FD: $appFd")
+                    Log.i(TAG, "   Socketpair created by CustomTunClient ✅")
+                    Log.i(TAG, "   OpenVPN 3 is actively polling lib_fd ✅")
+                    Log.i(TAG, "   Updating FD storage and starting pipe reader...")
+                    Log.i(TAG, "═══════════════════════════════════════════════════════")
+
+                    // Update stored FD (overwrite the one from createPipe if it exists)
+                    pipeWriteFds[tunnelId] = appFd
+                    // Stop the old reader and move the direct channel before the old FD closes
+                    pipeReaders[tunnelId]?.cancel()
+                    pipeReaders.remove(tunnelId)
+                    bindDirectChannel(tunnelId, appFd)
+
+                    // Create PFD from app FD (don't use dup, use the actual FD)
+                    // Close old PFD if it exists to avoid FD leak
+                    pipeWritePfds[tunnelId]?.close()
+                    pipeWritePfds[tunnelId] = android.os.ParcelFileDescriptor.fromFd(appFd)
+
+                    // Restart pipe reader with app FD
+                    startPipeReader(tunnelId, appFd)
+
+                    Log.i(TAG, "✅ External TUN Factory setup complete for tunnel $tunnelId")
+                } else {
+                    Log.w(TAG, "⚠️  External TUN Factory returned invalid app FD: $appFd")
+                    Log.w(TAG, "   Falling back to createPipe() FD if available")
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "❌ Failed to get app FD from External TUN Factory", e)
+                Log.w(TAG, "   Falling back to createPipe() FD if available")
+            }
+        }
+
+        // Packets queued while connecting were already written to the app FD by
+        // CustomTunClient::tun_start() (native pre-connect queue)
+        Log.i(TAG, "   Calling notifyConnectionStateChanged() to resume TUN reading...")
+        notifyConnectionStateChanged()
+    }
+    
     suspend fun closeTunnel(tunnelId: String) {
         val client = connections[tunnelId]
         if (client != null) {
@@ -867,7 +930,7 @@ class VpnConnectionManager(
         stopPipeReader(tunnelId)
             
             // Clear any queued packets for this tunnel
-            packetQueues.remove(tunnelId)
+            tunnelHandles.remove(tunnelId)?.let { nativeClearQueuedPackets(it) }
             
             // Clear readiness state for this tunnel
             tunnelReadinessStates.remove(tunnelId)
@@ -881,12 +944,14 @@ class VpnConnectionManager(
             runBlocking { it.disconnect() }
         }
         
-        // Stop all pipe readers and close writers
-        pipeReaders.keys.forEach { tunnelId ->
+        // Stop all pipe readers and close writers (tunnels on the native pump have no reader job)
+        (pipeReaders.keys + pipeWritePfds.keys).toSet().forEach { tunnelId ->
             stopPipeReader(tunnelId)
         }
         
         connections.clear()
+        tunnelHandles.values.forEach { nativeClearQueuedPackets(it) }
+        tunnelHandles.clear()
         tunnelReadinessStates.clear()
         Log.d(TAG, "Closed all tunnels")
     }
@@ -996,6 +1061,8 @@ class VpnConnectionManager(
     
     companion object {
         private const val TAG = "VpnConnectionManager"
+        /** nativeQueuePacket() result for a packet that was neither queued nor sent */
+        private const val QUEUE_RESULT_DROPPED = -1
         @Volatile
         private var INSTANCE: VpnConnectionManager? = null
         
@@ -7,6 +7,7 @@ import android.app.PendingIntent
 import android.app.Service
 import android.content.Context
 import android.content.Intent
+import android.content.pm.PackageManager
 import android.net.ConnectivityManager
 import android.net.Network
 import android.net.NetworkCapabilities
@@ -18,11 +19,13 @@ import android.os.ParcelFileDescriptor
 import android.util.Log
 import com.multiregionvpn.ui.MainActivity
 import com.multiregionvpn.data.database.AppDatabase
+import com.multiregionvpn.data.database.AppRule
 import com.multiregionvpn.data.repository.SettingsRepository
 import dagger.hilt.android.AndroidEntryPoint
 import javax.inject.Inject
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
 import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.cancel
 import kotlinx.coroutines.delay
@@ -49,7 +52,11 @@ class VpnEngineService : VpnService() {
     lateinit var vpnTemplateService: VpnTemplateService
     
     private lateinit var packetRouter: PacketRouter
+    private val nativePacketRouter: NativePacketRouter? by lazy { NativePacketRouter.createOrNull() }
     private var connectionTracker: ConnectionTracker? = null
+    private val routingTable = RoutingTable()
+    private var ioLaneSampler: Job? = null
+    private var handoffWatcher: Job? = null
     private var vpnOutput: FileOutputStream? = null
     private val activeTunnels = mutableSetOf<String>() // Track tunnel IDs to avoid duplicates
     
@@ -160,6 +167,16 @@ class VpnEngineService : VpnService() {
             }
         }
         
+        // Packets lent as direct buffer views go to the TUN through the stream's
+        // FileChannel, so they reach write() without a copy on the Java heap
+        connectionManager.setPacketBufferReceiver { tunnelId, packet ->
+            try {
+                vpnOutput?.channel?.write(packet)
+            } catch (e: Exception) {
+                Log.e(TAG, "Error writing packet from tunnel $tunnelId to TUN", e)
+            }
+        }
+        
         // Set up tunnel IP address callback to receive DHCP-assigned IPs
         connectionManager.setTunnelIpCallback { tunnelId, ip, prefixLength ->
             onTunnelIpReceived(tunnelId, ip, prefixLength)
@@ -201,7 +218,7 @@ class VpnEngineService : VpnService() {
         }
         
         // Create connection tracker for UID detection (alternative to /proc/net)
-        connectionTracker = ConnectionTracker(this, packageManager)
+        connectionTracker = ConnectionTracker(this, packageManager, nativePacketRouter)
         
         // CRITICAL: Register all packages with app rules so ConnectionTracker knows about them
         // In Global VPN mode, we don't use addAllowedApplication(), so ConnectionTracker
@@ -225,6 +242,7 @@ class VpnEngineService : VpnService() {
                         }
                     }
                 }
+                publishRoutingSnapshot(appRules)
                 Log.i(TAG, "✅ Package registration complete - ConnectionTracker ready for routing")
             } catch (e: Exception) {
                 Log.e(TAG, "❌ Failed to register packages with ConnectionTracker", e)
@@ -237,7 +255,9 @@ class VpnEngineService : VpnService() {
             this,
             connectionManager,
             vpnOutput,
-            connectionTracker
+            connectionTracker,
+            nativePacketRouter,
+            routingTable
         )
     }
     
@@ -299,6 +319,9 @@ class VpnEngineService : VpnService() {
             // But log it so we know what went wrong
         }
         
+        // Tunnel event-loop threads started from here on are placed by cluster policy or core lanes
+        startIoLaneSampler()
+        
         try {
             // Get all app rules to determine which apps should use VPN
             // This implements proper split tunneling - only apps with rules use VPN
@@ -655,6 +678,8 @@ class VpnEngineService : VpnService() {
                 }
                 activeTunnels.clear()
                 connectionTracker?.clearAllMappings()
+                routingTable.clear()
+                stopIoLaneSampler()
                 Log.i(TAG, "   ✅ Connection tracker cleared")
             } catch (e: Exception) {
                 Log.e(TAG, "   ❌ Error closing tunnels (continuing with shutdown)", e)
@@ -675,6 +700,7 @@ class VpnEngineService : VpnService() {
             // the OS to stop routing traffic to it
             Log.i(TAG, "SHUTDOWN Step 3/4: Closing VPN interface...")
             try {
+                NativeTunPump.stop()
                 vpnInterface?.close()
                 vpnInterface = null
                 Log.i(TAG, "   ✅ VPN interface closed - traffic no longer blocked!")
@@ -760,12 +786,16 @@ class VpnEngineService : VpnService() {
                         Log.e(TAG, "❌ Failed to reconnect Kotlin-managed tunnels", e)
                     }
                     
-                    // 2b. Reconnect OpenVPN tunnels (handled in C++)
+                    // 2b. Move OpenVPN tunnels (handled in C++): rebind UDP transports in place
+                    // where the server floats peers, reconnect the rest
                     try {
-                        nativeOnNetworkChanged()
-                        Log.i(TAG, "✅ nativeOnNetworkChanged() called - OpenVPN C++ will reconnect")
+                        nativeOnNetworkChanged(networkKindOf(network), network.networkHandle)
+                        Log.i(TAG, "✅ nativeOnNetworkChanged() called - OpenVPN C++ will rebind or reconnect")
+                        watchNetworkHandoffs()
                     } catch (e: Exception) {
                         Log.e(TAG, "❌ Failed to notify native layer of network change", e)
+                    } catch (e: UnsatisfiedLinkError) {
+                        Log.e(TAG, "❌ Native library not loaded, cannot move OpenVPN tunnels", e)
                     }
                 }
                 
@@ -799,11 +829,46 @@ class VpnEngineService : VpnService() {
         }
     }
     
+    private fun networkKindOf(network: Network): Int {
+        val capabilities = connectivityManager?.getNetworkCapabilities(network)
+            ?: return NetworkHandoffStats.NETWORK_UNKNOWN
+        return when {
+            capabilities.hasTransport(NetworkCapabilities.TRANSPORT_WIFI) -> NetworkHandoffStats.NETWORK_WIFI
+            capabilities.hasTransport(NetworkCapabilities.TRANSPORT_CELLULAR) -> NetworkHandoffStats.NETWORK_CELLULAR
+            else -> NetworkHandoffStats.NETWORK_OTHER
+        }
+    }
+    
+    /**
+     * Polls native handoffs until every tunnel has data flowing again on the new
+     * network (rebinds that stay silent are escalated to a reconnect natively),
+     * then logs the handoff gaps seen so far.
+     */
+    private fun watchNetworkHandoffs() {
+        handoffWatcher?.cancel()
+        handoffWatcher = serviceScope.launch {
+            while (isActive && nativePollNetworkHandoffs() > 0) {
+                delay(HANDOFF_POLL_INTERVAL_MS)
+            }
+            NetworkHandoffStats.fromPacked(nativeGetNetworkHandoffStats()).forEach {
+                Log.i(TAG, "Handoff ${it.direction} via ${it.path}: ${it.count}x, last ${it.lastMs} ms, " +
+                    "avg ${it.averageMs} ms, max ${it.maxMs} ms, ${it.escalated} escalated")
+            }
+        }
+    }
+    
     /**
      * Native function to notify C++ router of network changes.
-     * This will be implemented in the JNI layer (openvpn_jni.cpp).
+     * @param networkKind NetworkHandoffStats.NETWORK_* type of the new network
+     * @param networkHandle Network.getNetworkHandle(); repeat reports of the same handle are coalesced
      */
-    private external fun nativeOnNetworkChanged()
+    private external fun nativeOnNetworkChanged(networkKind: Int, networkHandle: Long)
+    
+    /** Advances native network handoffs; returns how many are still waiting for data */
+    private external fun nativePollNetworkHandoffs(): Int
+    
+    /** Packed handoff gaps, see [NetworkHandoffStats.fromPacked] */
+    private external fun nativeGetNetworkHandoffStats(): LongArray?
     
     override fun onDestroy() {
         Log.i(TAG, "═══════════════════════════════════════════════════════")
@@ -812,8 +877,12 @@ class VpnEngineService : VpnService() {
         
         // Unregister network callback
         unregisterNetworkCallback()
+        handoffWatcher?.cancel()
+        handoffWatcher = null
         
         connectionTracker?.clearAllMappings()
+        routingTable.clear()
+        stopIoLaneSampler()
         runningInstance = null
         super.onDestroy()
     }
@@ -841,6 +910,14 @@ class VpnEngineService : VpnService() {
         Log.i(TAG, "📖 readPacketsFromTun() STARTING")
         Log.i(TAG, "═══════════════════════════════════════════════════════")
         
+        // Native pump moves packets between TUN and tunnel socketpairs in C++;
+        // only flow misses come up to PacketRouter
+        val pumpInterface = vpnInterface
+        if (pumpInterface != null && NativeTunPump.start(pumpInterface.fd)) {
+            routeNativePumpMisses(pumpInterface)
+            return
+        }
+        
         val vpnInput = vpnInterface?.let { pfd ->
             Log.d(TAG, "   VPN interface exists, FD: ${pfd.fileDescriptor}")
             FileInputStream(pfd.fileDescriptor)
@@ -908,6 +985,81 @@ class VpnEngineService : VpnService() {
         Log.i(TAG, "📖 readPacketsFromTun() coroutine stopped (read $packetCount packets total)")
     }
     
+    /**
+     * Routes packets the native pump could not place (first packet of a flow, or a
+     * tunnel not attached yet) until [pfd] is replaced or closed, or the pump stops. Routing teaches the
+     * native flow table, so later packets of the flow stay in C++.
+     */
+    private fun routeNativePumpMisses(pfd: ParcelFileDescriptor) {
+        Log.i(TAG, "📖 Native TUN pump started on FD ${pfd.fd} - routing flow misses in Kotlin")
+        val buffer = java.nio.ByteBuffer.allocateDirect(NativeTunPump.MAX_PACKET_SIZE)
+        var missCount = 0
+        
+        while (vpnInterface === pfd && serviceScope.isActive) {
+            try {
+                val length = NativeTunPump.takeMiss(buffer, 100)
+                if (length < 0) {
+                    break
+                }
+                if (length > 0) {
+                    missCount++
+                    val packet = ByteArray(length)
+                    buffer.clear()
+                    buffer.get(packet)
+                    packetRouter.routePacket(packet)
+                }
+            } catch (e: Exception) {
+                Log.e(TAG, "❌ Error routing native pump miss (routed $missCount misses so far)", e)
+            }
+        }
+        Log.i(TAG, "📖 Native pump miss routing stopped (routed $missCount misses total)")
+    }
+    
+    /**
+     * Places native tunnel threads and samples them periodically. On big.LITTLE
+     * devices tunnel event loops follow their CPU use between clusters and
+     * control threads stay on the little cores; elsewhere event loops are
+     * spread across core lanes, and a lane carrying several busy tunnels hands
+     * one off to a quieter core.
+     */
+    private fun startIoLaneSampler() {
+        if (!NativeIoLanes.isAvailable || ioLaneSampler?.isActive == true) {
+            return
+        }
+        val heterogeneous = NativeThreadPlacement.topology()?.heterogeneous == true
+        if (heterogeneous) {
+            NativeThreadPlacement.configure(BIG_LITTLE_PLACEMENT)
+        }
+        NativeIoLanes.setEnabled(true)
+        ioLaneSampler = serviceScope.launch {
+            var lastMigrations = 0L
+            var lastMoves = 0L
+            while (isActive) {
+                delay(IO_LANE_SAMPLE_INTERVAL_MS)
+                val placement = NativeThreadPlacement.sample()
+                if (placement != null && placement.promotions + placement.demotions != lastMoves) {
+                    lastMoves = placement.promotions + placement.demotions
+                    val summary = placement.threads.filter { it.dataPath }
+                        .joinToString { "${it.tid}=${it.cluster}/${it.utilizationPermille / 10}%" }
+                    Log.i(TAG, "Thread placement moved threads (${placement.promotions} up, ${placement.demotions} down): $summary")
+                }
+                val sample = NativeIoLanes.sample() ?: continue
+                if (sample.migrations != lastMigrations) {
+                    lastMigrations = sample.migrations
+                    val summary = sample.lanes.joinToString { "cpu${it.cpu}=${it.tunnels}t/${it.utilizationPermille / 10}%" }
+                    Log.i(TAG, "IO lanes rebalanced (${sample.migrations} migrations): $summary")
+                }
+            }
+        }
+    }
+    
+    private fun stopIoLaneSampler() {
+        ioLaneSampler?.cancel()
+        ioLaneSampler = null
+        NativeIoLanes.setEnabled(false)
+        NativeThreadPlacement.configure(NativeThreadPlacement.Config())
+    }
+    
     private suspend fun startInboundLoop() {
         // This loop is no longer needed - packets from tunnels are written
         // directly via the packet receiver callback set in initializePacketRouter()
@@ -956,6 +1108,7 @@ class VpnEngineService : VpnService() {
             }
             Log.i(TAG, "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━")
             connectionTracker?.clearAllMappings()
+            publishRoutingSnapshot(appRules)
             
             // Get packages with VPN rules
             val packagesWithRules = appRules
@@ -973,6 +1126,7 @@ class VpnEngineService : VpnService() {
                 Log.d(TAG, "   New: $packagesWithRules")
                 
                 // Close current interface
+                NativeTunPump.stop()
                 vpnInterface?.close()
                 vpnInterface = null
                 vpnOutput?.close()
@@ -1014,6 +1168,7 @@ class VpnEngineService : VpnService() {
             if (vpnInterface != null && packagesWithRules.isEmpty()) {
                 Log.i(TAG, "No app rules found - closing VPN interface (proper split tunneling)")
                 try {
+                    NativeTunPump.stop()
                     vpnInterface?.close()
                     vpnInterface = null
                     vpnOutput?.close()
@@ -1180,6 +1335,27 @@ class VpnEngineService : VpnService() {
         }
     }
     
+    /**
+     * Rebuilds the routing snapshot PacketRouter reads, resolving configs and UIDs here
+     * so the packet path never waits on Room or PackageManager.
+     */
+    private suspend fun publishRoutingSnapshot(appRules: List<AppRule>) {
+        val tunnelIds = mutableMapOf<String, String>()
+        appRules.mapNotNull { it.vpnConfigId }.distinct().forEach { vpnConfigId ->
+            settingsRepository.getVpnConfigById(vpnConfigId)?.let { vpnConfig ->
+                tunnelIds[vpnConfigId] = "${vpnConfig.templateId}_${vpnConfig.regionId}"
+            }
+        }
+        val snapshot = routingTable.publish(appRules, tunnelIds) { packageName ->
+            try {
+                packageManager.getApplicationInfo(packageName, 0).uid
+            } catch (e: PackageManager.NameNotFoundException) {
+                null
+            }
+        }
+        Log.i(TAG, "Routing snapshot v${snapshot.version}: ${snapshot.size} routed package(s)")
+    }
+    
     /**
      * Generates a unique tunnel ID from VPN config ID.
      * Format: templateId_regionId (e.g., "nordvpn_UK")
@@ -1442,6 +1618,7 @@ class VpnEngineService : VpnService() {
         Log.i(TAG, "🔄 Re-establishing VPN interface with ${subnetToPrimaryTunnel.size} subnet(s)")
         
         // Close current interface
+        NativeTunPump.stop()
         vpnInterface?.close()
         vpnInterface = null
         vpnOutput?.close()
@@ -1502,6 +1679,15 @@ class VpnEngineService : VpnService() {
         const val EXTRA_ERROR_TUNNEL_ID = "error_tunnel_id"
         const val EXTRA_ERROR_TIMESTAMP = "error_timestamp"
 
+        private const val IO_LANE_SAMPLE_INTERVAL_MS = 5000L
+        // Event loops follow their load between clusters at a slightly raised priority;
+        // callbacks and reconnect workers stay on the little cores
+        private val BIG_LITTLE_PLACEMENT = NativeThreadPlacement.Config(
+            dataPath = NativeThreadPlacement.RolePlacement(NativeThreadPlacement.Cluster.AUTO, nice = -4),
+            control = NativeThreadPlacement.RolePlacement(NativeThreadPlacement.Cluster.LITTLE)
+        )
+        private const val HANDOFF_POLL_INTERVAL_MS = 100L
+
         @Volatile
         private var runningInstance: VpnEngineService? = null
 
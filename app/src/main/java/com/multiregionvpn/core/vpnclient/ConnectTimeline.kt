@@ -0,0 +1,93 @@
+package com.multiregionvpn.core.vpnclient
+
+/**
+ * One connect attempt decoded from [NativeOpenVpnClient.nativeGetConnectTimelines].
+ *
+ * Mark indices mirror openvpn::ConnectMark in connect_timeline.h. Each mark is the
+ * microseconds from the start of the attempt to the first time OpenVPN reached it,
+ * or -1 if it never did.
+ */
+data class ConnectTimeline(
+    val id: Long,
+    val reconnect: Boolean,
+    /** True while the attempt is still being recorded (no first packet or disconnect yet) */
+    val open: Boolean,
+    val marksUs: LongArray
+) {
+    enum class Mark {
+        CONNECT_START,
+        RESOLVE,
+        TRANSPORT,
+        TLS,
+        AUTH_OK,
+        PUSH_REQUEST,
+        PUSH_REPLY,
+        TUN_START,
+        CONNECTED,
+        FIRST_PACKET
+    }
+
+    fun markUs(mark: Mark): Long = marksUs[mark.ordinal]
+
+    /**
+     * Time spent after [mark] until the next mark that was reached, or -1.
+     * Milestones OpenVPN skipped fold into the preceding phase.
+     */
+    fun phaseUs(mark: Mark): Long {
+        val start = markUs(mark)
+        if (start < 0) {
+            return -1
+        }
+        for (next in mark.ordinal + 1 until marksUs.size) {
+            if (marksUs[next] >= 0) {
+                return marksUs[next] - start
+            }
+        }
+        return -1
+    }
+
+    /** The mark whose phase took longest, or null if no phase completed */
+    val slowestPhase: Mark?
+        get() = Mark.values().filter { phaseUs(it) >= 0 }.maxByOrNull { phaseUs(it) }
+
+    override fun equals(other: Any?): Boolean =
+        other is ConnectTimeline && id == other.id && reconnect == other.reconnect &&
+            open == other.open && marksUs.contentEquals(other.marksUs)
+
+    override fun hashCode(): Int = id.hashCode() * 31 + marksUs.contentHashCode()
+
+    companion object {
+        const val LAYOUT_VERSION = 1L
+
+        private const val IDX_ID = 0
+        private const val IDX_RECONNECT = 1
+        private const val IDX_OPEN = 2
+        private const val IDX_MARK_0 = 3
+        val MARK_COUNT = Mark.values().size
+        val FIELD_COUNT = IDX_MARK_0 + MARK_COUNT
+
+        /**
+         * Decodes [version, count, fieldCount, records...], oldest first. Returns an
+         * empty list if the array is missing or from a different layout version.
+         */
+        fun fromPacked(packed: LongArray?): List<ConnectTimeline> {
+            if (packed == null || packed.size < 3 || packed[0] != LAYOUT_VERSION) {
+                return emptyList()
+            }
+            val count = packed[1].toInt()
+            val fieldCount = packed[2].toInt()
+            if (fieldCount < FIELD_COUNT || packed.size < 3 + count * fieldCount) {
+                return emptyList()
+            }
+            return (0 until count).map { i ->
+                val base = 3 + i * fieldCount
+                ConnectTimeline(
+                    id = packed[base + IDX_ID],
+                    reconnect = packed[base + IDX_RECONNECT] != 0L,
+                    open = packed[base + IDX_OPEN] != 0L,
+                    marksUs = packed.copyOfRange(base + IDX_MARK_0, base + IDX_MARK_0 + MARK_COUNT)
+                )
+            }
+        }
+    }
+}
@@ -0,0 +1,16 @@
+package com.multiregionvpn.core.vpnclient
+
+/**
+ * Tunnel lifecycle states pushed from native code (connection_lifecycle.h).
+ * Ordinals match the native LifecycleState values.
+ */
+enum class ConnectionState {
+    DISCONNECTED,
+    CONNECTING,
+    CONNECTED,
+    RECONNECTING;
+
+    companion object {
+        fun fromNative(value: Int): ConnectionState = values().getOrElse(value) { DISCONNECTED }
+    }
+}
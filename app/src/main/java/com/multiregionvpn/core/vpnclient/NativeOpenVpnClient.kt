@@ -4,6 +4,7 @@ import android.content.Context
 import android.net.VpnService
 import android.util.Log
 import kotlinx.coroutines.*
+import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicLong
 
@@ -34,6 +35,18 @@ interface TunnelDnsCallback {
     fun onTunnelDnsReceived(tunnelId: String, dnsServers: List<String>)
 }
 
+/**
+ * Callback interface for tunnel lifecycle changes.
+ * Called from native code once per transition of the session's lifecycle state machine.
+ */
+interface TunnelStateCallback {
+    /**
+     * @param state Native LifecycleState value (see [ConnectionState])
+     * @param connectLatencyMs Time from connect start to the first CONNECTED, or -1
+     */
+    fun onTunnelStateChanged(tunnelId: String, state: Int, connectLatencyMs: Long)
+}
+
 /**
  * Native OpenVPN client implementation using OpenVPN 3 C++ library via JNI.
  * 
@@ -51,9 +64,35 @@ class NativeOpenVpnClient(
 
     private val connected = AtomicBoolean(false)
     private val sessionHandle = AtomicLong(0)
+    /** Native tunnel slot handle from nativeSetTunnelIdAndCallback (0 = none) */
+    private val tunnelHandle = AtomicLong(0)
     private var packetReceiver: ((ByteArray) -> Unit)? = null
+    @Volatile private var packetBufferReceiver: ((ByteBuffer) -> Unit)? = null
+    // Reused for every nativeSendPacket / nativeReceivePacket (sends are serialized on sendBuffer)
+    private val sendBuffer: ByteBuffer = ByteBuffer.allocateDirect(MAX_PACKET_SIZE)
+    private val receiveBuffer: ByteBuffer = ByteBuffer.allocateDirect(MAX_PACKET_SIZE)
     private val connectionScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
     private var lastError: String? = null
+    private val receptionStarted = AtomicBoolean(false)
+    @Volatile private var stateListener: ((ConnectionState) -> Unit)? = null
+    
+    private val stateCallback = object : TunnelStateCallback {
+        override fun onTunnelStateChanged(tunnelId: String, state: Int, connectLatencyMs: Long) {
+            val connectionState = ConnectionState.fromNative(state)
+            when (connectionState) {
+                ConnectionState.CONNECTED -> {
+                    connected.set(true)
+                    Log.i(TAG, "✅ OpenVPN connection established for $tunnelId (connect latency ${connectLatencyMs}ms)")
+                    if (receptionStarted.compareAndSet(false, true)) {
+                        connectionScope.launch { startPacketReception() }
+                    }
+                }
+                ConnectionState.DISCONNECTED -> connected.set(false)
+                else -> Log.d(TAG, "Tunnel $tunnelId state: $connectionState")
+            }
+            stateListener?.invoke(connectionState)
+        }
+    }
     
     /**
      * OpenVPN error codes (matching C++ definitions)
@@ -80,6 +119,48 @@ class NativeOpenVpnClient(
                 throw RuntimeException("Failed to load OpenVPN native library", e)
             }
         }
+        
+        /**
+         * Packed per-tunnel data path counters, or null if [tunnelHandle] is stale.
+         * Decode with [TunnelStats.fromPacked].
+         */
+        @JvmStatic
+        external fun nativeGetTunnelStats(tunnelHandle: Long): LongArray?
+        
+        /**
+         * Packed recent connect timelines for [tunnelId], or for every tunnel if null.
+         * Decode with [ConnectTimeline.fromPacked].
+         */
+        @JvmStatic
+        external fun nativeGetConnectTimelines(tunnelId: String?): LongArray?
+        
+        /** Largest IP packet passed through nativeSendPacket / nativeReceivePacket */
+        private const val MAX_PACKET_SIZE = 32767
+        
+        /**
+         * Directory where earlier builds persisted normalized .ovpn profiles,
+         * including their inline keys; removed on first connect
+         */
+        private const val LEGACY_PROFILE_CACHE_DIR = "ovpn_profiles"
+        
+        /** File under app storage holding resolved VPN server addresses */
+        const val ENDPOINT_CACHE_FILE = "ovpn_endpoints"
+        
+        private val nativeCachesConfigured = AtomicBoolean(false)
+        
+        /**
+         * Points the native endpoint cache at app storage, once per process, so
+         * resolved server addresses survive restarts.
+         */
+        fun configureNativeCaches(context: Context) {
+            if (nativeCachesConfigured.compareAndSet(false, true)) {
+                java.io.File(context.filesDir, LEGACY_PROFILE_CACHE_DIR).deleteRecursively()
+                nativeSetEndpointCacheFile(java.io.File(context.filesDir, ENDPOINT_CACHE_FILE).absolutePath)
+            }
+        }
+        
+        @JvmStatic
+        private external fun nativeSetEndpointCacheFile(path: String?)
     }
 
     // Native methods (implemented in C++)
@@ -97,11 +178,13 @@ class NativeOpenVpnClient(
     @JvmName("nativeDisconnect")
     private external fun nativeDisconnect(sessionHandle: Long)
 
+    // Packets cross JNI in direct ByteBuffers by offset and length
     @JvmName("nativeSendPacket")
-    private external fun nativeSendPacket(sessionHandle: Long, packet: ByteArray): Int
+    private external fun nativeSendPacket(sessionHandle: Long, buffer: ByteBuffer, offset: Int, length: Int): Int
 
+    // Returns the packet length, 0 if none is pending, or -1 on error
     @JvmName("nativeReceivePacket")
-    private external fun nativeReceivePacket(sessionHandle: Long): ByteArray?
+    private external fun nativeReceivePacket(sessionHandle: Long, buffer: ByteBuffer, offset: Int): Int
 
     @JvmName("nativeIsConnected")
     private external fun nativeIsConnected(sessionHandle: Long): Boolean
@@ -109,11 +192,27 @@ class NativeOpenVpnClient(
     @JvmName("nativeGetLastError")
     private external fun nativeGetLastError(sessionHandle: Long): String
 
+    /** Returns the tunnel handle for [getAppFd] and [nativeGetTunnelStats] (0 = error) */
     @JvmName("nativeSetTunnelIdAndCallback")
-    private external fun nativeSetTunnelIdAndCallback(sessionHandle: Long, tunnelId: String, ipCallback: TunnelIpCallback, dnsCallback: TunnelDnsCallback?)
+    private external fun nativeSetTunnelIdAndCallback(sessionHandle: Long, tunnelId: String, ipCallback: TunnelIpCallback, dnsCallback: TunnelDnsCallback?): Long
+
+    @JvmName("nativeSetStateCallback")
+    private external fun nativeSetStateCallback(sessionHandle: Long, callback: TunnelStateCallback)
 
     @JvmName("getAppFd")
-    external fun getAppFd(tunnelId: String): Int  // Get app FD from External TUN Factory
+    private external fun getAppFd(tunnelHandle: Long): Int
+
+    /** App FD from External TUN Factory, or -1 before the tunnel is registered */
+    fun getAppFd(): Int {
+        val handle = tunnelHandle.get()
+        return if (handle != 0L) getAppFd(handle) else -1
+    }
+
+    /** Data path counters for this tunnel, or null before it is registered */
+    fun getTunnelStats(): TunnelStats? {
+        val handle = tunnelHandle.get()
+        return if (handle != 0L) TunnelStats.fromPacked(nativeGetTunnelStats(handle)) else null
+    }
 
     override suspend fun connect(ovpnConfig: String, authFilePath: String?): Boolean {
         // NOTE: We don't need to call protect() here anymore
@@ -229,6 +328,7 @@ class NativeOpenVpnClient(
                 
                 // Call native connect with VpnService.Builder, TUN FD, VpnService, and tunnel ID
                 val handle = try {
+                    configureNativeCaches(context)
                     nativeConnect(ovpnConfig, username, password, builder, finalTunFd, vpnService, tunnelIdForConnect)
                 } catch (e: UnsatisfiedLinkError) {
                     Log.e(TAG, "❌ UnsatisfiedLinkError - native library not loaded properly", e)
@@ -283,7 +383,7 @@ class NativeOpenVpnClient(
                 // This ensures callbacks are registered even if set during connect failed
                 if (tunnelId != null && ipCallback != null) {
                     try {
-                        nativeSetTunnelIdAndCallback(handle, tunnelId, ipCallback, dnsCallback)
+                        tunnelHandle.set(nativeSetTunnelIdAndCallback(handle, tunnelId, ipCallback, dnsCallback))
                         Log.d(TAG, "✅ Tunnel ID and callbacks confirmed: tunnelId=$tunnelId")
                     } catch (e: Exception) {
                         Log.w(TAG, "Failed to set tunnel ID and callbacks: ${e.message}")
@@ -291,57 +391,14 @@ class NativeOpenVpnClient(
                     }
                 }
                 
-                // CRITICAL: Do NOT set connected=true here!
-                // nativeConnect() returns successfully when connection is STARTED, not when it completes.
-                // The connection completes asynchronously in the background thread.
-                // We'll set connected=true when nativeIsConnected() actually returns true.
-                // For now, keep connected=false and poll for actual connection completion.
+                // nativeConnect() returns once the connection has STARTED. The native lifecycle
+                // pushes CONNECTED through stateCallback, which sets connected and starts reception.
                 connected.set(false)
+                receptionStarted.set(false)
+                nativeSetStateCallback(handle, stateCallback)
                 
                 Log.i(TAG, "✅ Native OpenVPN connection STARTED (completing asynchronously)")
                 Log.i(TAG, "   Session handle: $handle")
-                Log.i(TAG, "   Connection will complete in background thread")
-                
-                // Start a coroutine to monitor connection status and set connected=true when ready
-                connectionScope.launch {
-                    var attempts = 0
-                    val maxAttempts = 120 // 2 minutes
-                    while (attempts < maxAttempts && sessionHandle.get() != 0L) {
-                        delay(1000) // Check every second
-                        attempts++
-                        
-                        val isConnected = try {
-                            nativeIsConnected(handle)
-                        } catch (e: Exception) {
-                            Log.w(TAG, "Error checking connection status: ${e.message}")
-                            false
-                        }
-                        
-                        if (attempts % 10 == 0) {
-                            Log.d(TAG, "Connection status check (attempt $attempts/$maxAttempts): isConnected=$isConnected")
-                        }
-                        
-                        if (isConnected) {
-                            // Connection actually established - set connected flag
-                            connected.set(true)
-                            Log.i(TAG, "✅ OpenVPN connection FULLY ESTABLISHED (after $attempts seconds)")
-                            Log.i(TAG, "   Session handle: $handle")
-                            Log.i(TAG, "   Native isConnected() returned: true")
-                            
-                            // Now start receiving packets
-                            startPacketReception()
-                            return@launch
-                        }
-                    }
-                    
-                    if (attempts >= maxAttempts) {
-                        Log.w(TAG, "❌ Connection monitoring timed out after $maxAttempts seconds")
-                        Log.w(TAG, "   Session handle: $handle")
-                        Log.w(TAG, "   Final isConnected() check: ${try { nativeIsConnected(handle) } catch (e: Exception) { "error: ${e.message}" }}")
-                        // Connection might have failed or is stuck
-                        connected.set(false)
-                    }
-                }
 
                 Log.i(TAG, "═══════════════════════════════════════════════════════")
                 true
@@ -379,8 +436,17 @@ class NativeOpenVpnClient(
             return
         }
 
+        if (packet.size > sendBuffer.capacity()) {
+            Log.w(TAG, "Cannot send packet: ${packet.size} bytes exceeds ${sendBuffer.capacity()}")
+            return
+        }
+
         try {
-            val result = nativeSendPacket(handle, packet)
+            val result = synchronized(sendBuffer) {
+                sendBuffer.clear()
+                sendBuffer.put(packet)
+                nativeSendPacket(handle, sendBuffer, 0, packet.size)
+            }
             if (result != 0) {
                 Log.e(TAG, "Failed to send packet, error code: $result")
             }
@@ -402,6 +468,7 @@ class NativeOpenVpnClient(
                     Log.e(TAG, "Error during disconnect", e)
                 }
                 sessionHandle.set(0)
+                tunnelHandle.set(0)
             }
         }
     }
@@ -412,31 +479,24 @@ class NativeOpenVpnClient(
         packetReceiver = callback
     }
 
+    override fun setPacketBufferReceiver(callback: (ByteBuffer) -> Unit): Boolean {
+        packetBufferReceiver = callback
+        return true
+    }
+
+    override fun setStateListener(listener: (ConnectionState) -> Unit): Boolean {
+        stateListener = listener
+        return true
+    }
+
     /**
      * Receives packets from the native OpenVPN connection.
      */
     private suspend fun startPacketReception() {
         try {
+            // Started from the CONNECTED push; DISCONNECTED clears connected and ends the loop
             Log.d(TAG, "Packet reception started")
             
-            // Wait for connection to be fully established before starting packet reception
-            // OpenVPN 3 connection might take a moment to become fully ready
-            var connectionWaitAttempts = 0
-            val maxConnectionWaitAttempts = 50 // 5 seconds total (50 * 100ms)
-            while (!nativeIsConnected(sessionHandle.get()) && connectionWaitAttempts < maxConnectionWaitAttempts) {
-                delay(100)
-                connectionWaitAttempts++
-                if (connectionWaitAttempts % 10 == 0) {
-                    Log.d(TAG, "Waiting for connection to be ready... (attempt $connectionWaitAttempts/$maxConnectionWaitAttempts)")
-                }
-            }
-            
-            if (!nativeIsConnected(sessionHandle.get())) {
-                Log.w(TAG, "Connection not ready after waiting, but continuing anyway...")
-            } else {
-                Log.d(TAG, "✅ Connection is ready, starting packet reception loop")
-            }
-            
             while (connected.get() && connectionScope.isActive) {
                 val handle = sessionHandle.get()
                 if (handle == 0L) {
@@ -444,27 +504,25 @@ class NativeOpenVpnClient(
                     continue
                 }
 
-                // Try to receive a packet
-                val packet = nativeReceivePacket(handle)
+                // Try to receive a packet into the direct buffer
+                val length = nativeReceivePacket(handle, receiveBuffer, 0)
                 
-                if (packet != null) {
-                    // Forward to callback
-                    packetReceiver?.invoke(packet)
+                if (length > 0) {
+                    // Forward to callback: a view of the buffer, or a copy for ByteArray receivers
+                    receiveBuffer.clear()
+                    receiveBuffer.limit(length)
+                    val bufferReceiver = packetBufferReceiver
+                    if (bufferReceiver != null) {
+                        bufferReceiver(receiveBuffer)
+                    } else {
+                        val packet = ByteArray(length)
+                        receiveBuffer.get(packet)
+                        packetReceiver?.invoke(packet)
+                    }
                 } else {
                     // No packet available, wait a bit
                     delay(10)
                 }
-                
-                // Check connection status less frequently to avoid false positives
-                // Only check every 100 iterations (about once per second)
-                if (connectionWaitAttempts % 100 == 0) {
-                    if (!nativeIsConnected(handle)) {
-                        Log.w(TAG, "Native connection lost")
-                        connected.set(false)
-                        break
-                    }
-                }
-                connectionWaitAttempts++
             }
         } catch (e: Exception) {
             if (connected.get()) {
@@ -1,5 +1,7 @@
 package com.multiregionvpn.core.vpnclient
 
+import java.nio.ByteBuffer
+
 /**
  * Interface for OpenVPN client implementations.
  * This allows for testable mocks and future real implementations.
@@ -34,6 +36,20 @@ interface OpenVpnClient {
      * The callback receives raw IP packets that should be written back to the TUN interface.
      */
     fun setPacketReceiver(callback: (ByteArray) -> Unit)
+    
+    /**
+     * Sets a callback that receives packets as a view of the client's receive
+     * buffer (position to limit), valid only during the call, instead of a copy.
+     * Takes precedence over [setPacketReceiver] once set.
+     * @return false if this client only delivers packets through [setPacketReceiver]
+     */
+    fun setPacketBufferReceiver(callback: (ByteBuffer) -> Unit): Boolean = false
+    
+    /**
+     * Registers a listener for lifecycle changes, called from a background thread.
+     * @return false if this client cannot push state changes; callers then poll [isConnected]
+     */
+    fun setStateListener(listener: (ConnectionState) -> Unit): Boolean = false
 }
 
 
@@ -0,0 +1,165 @@
+package com.multiregionvpn.core.vpnclient
+
+/**
+ * Per-tunnel data path counters decoded from [NativeOpenVpnClient.nativeGetTunnelStats].
+ *
+ * Indices mirror openvpn::TunnelStatsField in tunnel_stats.h. Traffic, drop and
+ * EAGAIN counters are cumulative for the tunnel ID across reconnects; queue depths
+ * are instantaneous. "Out" is app → server, "in" is server → app.
+ */
+data class TunnelStats(
+    val packetsOut: Long = 0,
+    val bytesOut: Long = 0,
+    val packetsIn: Long = 0,
+    val bytesIn: Long = 0,
+    val dropOversized: Long = 0,
+    val dropEncryptError: Long = 0,
+    val dropQueueTail: Long = 0,
+    val dropQueueHead: Long = 0,
+    val dropQueueAge: Long = 0,
+    val dropWriteError: Long = 0,
+    val dropHalted: Long = 0,
+    val eagainWrite: Long = 0,
+    val eagainRead: Long = 0,
+    val egressQueueDepth: Long = 0,
+    val egressQueueHighWater: Long = 0,
+    val libFdInqBytes: Long = 0,
+    val libFdOutqBytes: Long = 0,
+    val bridgeInqBytes: Long = 0,
+    val bridgeOutqBytes: Long = 0,
+    /** Read → tun_recv() latency; bucket i counts [2^(i-1), 2^i) µs, bucket 0 is < 1 µs */
+    val latencyHistogramUs: LongArray = LongArray(LATENCY_BUCKETS),
+    /** TCP SYN / SYN-ACK packets whose MSS option was lowered to fit the tunnel */
+    val mssClamped: Long = 0,
+    /** UDP/53 queries from apps routed to this tunnel */
+    val dnsQueries: Long = 0,
+    /** Queries answered on-device from the tunnel's DNS cache */
+    val dnsCacheHits: Long = 0,
+    /** Queries sent on to the tunnel's resolver */
+    val dnsForwarded: Long = 0,
+    /** Resolver responses matched to a forwarded query */
+    val dnsResponses: Long = 0,
+    /** Sum of forward → response times over [dnsResponses] */
+    val dnsLatencyUsTotal: Long = 0,
+    val dnsCacheEntries: Long = 0,
+    /** Batched lib_fd reads that returned at least one outbound packet */
+    val readBatches: Long = 0,
+    val readBatchPackets: Long = 0,
+    /** Batches that filled every slot; a high share means the batch size is too small */
+    val readBatchesFull: Long = 0,
+    /** Packets per batch; bucket 0 is 1 packet, bucket i is [2^i, 2^(i+1)) */
+    val readBatchFillHistogram: LongArray = LongArray(FILL_BUCKETS),
+    val bufferPoolHits: Long = 0,
+    /** Packet buffers allocated because the pool had none idle */
+    val bufferPoolMisses: Long = 0,
+    /** Buffers freed instead of returned to the pool (pool full or undersized) */
+    val bufferPoolDiscards: Long = 0,
+    val bufferPoolHighWater: Long = 0
+) {
+    val totalDrops: Long
+        get() = dropOversized + dropEncryptError + dropQueueTail + dropQueueHead +
+            dropQueueAge + dropWriteError + dropHalted
+
+    /** Share of DNS queries answered from the cache, 0.0 before the first query */
+    val dnsHitRate: Double
+        get() = if (dnsQueries > 0) dnsCacheHits.toDouble() / dnsQueries else 0.0
+
+    /** Mean resolver round trip for cache misses, 0 before the first response */
+    val dnsAverageLatencyUs: Long
+        get() = if (dnsResponses > 0) dnsLatencyUsTotal / dnsResponses else 0
+
+    /** Mean outbound packets per batched read, 0.0 before the first batch */
+    val readBatchAverageFill: Double
+        get() = if (readBatches > 0) readBatchPackets.toDouble() / readBatches else 0.0
+
+    companion object {
+        const val LAYOUT_VERSION = 4L
+        const val LATENCY_BUCKETS = 16
+        const val FILL_BUCKETS = 8
+
+        private const val IDX_VERSION = 0
+        private const val IDX_PACKETS_OUT = 1
+        private const val IDX_BYTES_OUT = 2
+        private const val IDX_PACKETS_IN = 3
+        private const val IDX_BYTES_IN = 4
+        private const val IDX_DROP_OVERSIZED = 5
+        private const val IDX_DROP_ENCRYPT_ERROR = 6
+        private const val IDX_DROP_QUEUE_TAIL = 7
+        private const val IDX_DROP_QUEUE_HEAD = 8
+        private const val IDX_DROP_QUEUE_AGE = 9
+        private const val IDX_DROP_WRITE_ERROR = 10
+        private const val IDX_DROP_HALTED = 11
+        private const val IDX_EAGAIN_WRITE = 12
+        private const val IDX_EAGAIN_READ = 13
+        private const val IDX_EGRESS_QUEUE_DEPTH = 14
+        private const val IDX_EGRESS_QUEUE_HIGH_WATER = 15
+        private const val IDX_LIB_FD_INQ = 16
+        private const val IDX_LIB_FD_OUTQ = 17
+        private const val IDX_BRIDGE_INQ = 18
+        private const val IDX_BRIDGE_OUTQ = 19
+        private const val IDX_LATENCY_BUCKET_0 = 20
+        private const val IDX_MSS_CLAMPED = IDX_LATENCY_BUCKET_0 + LATENCY_BUCKETS
+        private const val IDX_DNS_QUERIES = IDX_MSS_CLAMPED + 1
+        private const val IDX_DNS_CACHE_HITS = IDX_DNS_QUERIES + 1
+        private const val IDX_DNS_FORWARDED = IDX_DNS_QUERIES + 2
+        private const val IDX_DNS_RESPONSES = IDX_DNS_QUERIES + 3
+        private const val IDX_DNS_LATENCY_US_TOTAL = IDX_DNS_QUERIES + 4
+        private const val IDX_DNS_CACHE_ENTRIES = IDX_DNS_QUERIES + 5
+        private const val IDX_READ_BATCHES = IDX_DNS_CACHE_ENTRIES + 1
+        private const val IDX_READ_BATCH_PACKETS = IDX_READ_BATCHES + 1
+        private const val IDX_READ_BATCHES_FULL = IDX_READ_BATCHES + 2
+        private const val IDX_READ_BATCH_FILL_BUCKET_0 = IDX_READ_BATCHES + 3
+        private const val IDX_POOL_HITS = IDX_READ_BATCH_FILL_BUCKET_0 + FILL_BUCKETS
+        private const val IDX_POOL_MISSES = IDX_POOL_HITS + 1
+        private const val IDX_POOL_DISCARDS = IDX_POOL_HITS + 2
+        private const val IDX_POOL_HIGH_WATER = IDX_POOL_HITS + 3
+        const val FIELD_COUNT = IDX_POOL_HIGH_WATER + 1
+
+        /**
+         * Decodes the packed array, or returns null if it is missing or from a
+         * different layout version.
+         */
+        fun fromPacked(packed: LongArray?): TunnelStats? {
+            if (packed == null || packed.size < FIELD_COUNT || packed[IDX_VERSION] != LAYOUT_VERSION) {
+                return null
+            }
+            return TunnelStats(
+                packetsOut = packed[IDX_PACKETS_OUT],
+                bytesOut = packed[IDX_BYTES_OUT],
+                packetsIn = packed[IDX_PACKETS_IN],
+                bytesIn = packed[IDX_BYTES_IN],
+                dropOversized = packed[IDX_DROP_OVERSIZED],
+                dropEncryptError = packed[IDX_DROP_ENCRYPT_ERROR],
+                dropQueueTail = packed[IDX_DROP_QUEUE_TAIL],
+                dropQueueHead = packed[IDX_DROP_QUEUE_HEAD],
+                dropQueueAge = packed[IDX_DROP_QUEUE_AGE],
+                dropWriteError = packed[IDX_DROP_WRITE_ERROR],
+                dropHalted = packed[IDX_DROP_HALTED],
+                eagainWrite = packed[IDX_EAGAIN_WRITE],
+                eagainRead = packed[IDX_EAGAIN_READ],
+                egressQueueDepth = packed[IDX_EGRESS_QUEUE_DEPTH],
+                egressQueueHighWater = packed[IDX_EGRESS_QUEUE_HIGH_WATER],
+                libFdInqBytes = packed[IDX_LIB_FD_INQ],
+                libFdOutqBytes = packed[IDX_LIB_FD_OUTQ],
+                bridgeInqBytes = packed[IDX_BRIDGE_INQ],
+                bridgeOutqBytes = packed[IDX_BRIDGE_OUTQ],
+                latencyHistogramUs = packed.copyOfRange(IDX_LATENCY_BUCKET_0, IDX_LATENCY_BUCKET_0 + LATENCY_BUCKETS),
+                mssClamped = packed[IDX_MSS_CLAMPED],
+                dnsQueries = packed[IDX_DNS_QUERIES],
+                dnsCacheHits = packed[IDX_DNS_CACHE_HITS],
+                dnsForwarded = packed[IDX_DNS_FORWARDED],
+                dnsResponses = packed[IDX_DNS_RESPONSES],
+                dnsLatencyUsTotal = packed[IDX_DNS_LATENCY_US_TOTAL],
+                dnsCacheEntries = packed[IDX_DNS_CACHE_ENTRIES],
+                readBatches = packed[IDX_READ_BATCHES],
+                readBatchPackets = packed[IDX_READ_BATCH_PACKETS],
+                readBatchesFull = packed[IDX_READ_BATCHES_FULL],
+                readBatchFillHistogram = packed.copyOfRange(IDX_READ_BATCH_FILL_BUCKET_0, IDX_READ_BATCH_FILL_BUCKET_0 + FILL_BUCKETS),
+                bufferPoolHits = packed[IDX_POOL_HITS],
+                bufferPoolMisses = packed[IDX_POOL_MISSES],
+                bufferPoolDiscards = packed[IDX_POOL_DISCARDS],
+                bufferPoolHighWater = packed[IDX_POOL_HIGH_WATER]
+            )
+        }
+    }
+}
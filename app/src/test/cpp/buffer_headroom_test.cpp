@@ -13,16 +13,20 @@
  */
 
 #include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #include <cstring>
 #include <vector>
 
+#include "tun_batch_reader.h"
+
 // Mock OpenVPN's BufferAllocated for testing
 namespace openvpn {
     
     // Simple buffer that tracks offset and capacity
     class BufferAllocated {
     public:
-        BufferAllocated(size_t capacity, int flags = 0) 
+        BufferAllocated(size_t capacity, int = 0) 
             : data_(capacity), offset_(0), size_(0) {}
         
         void init_headroom(size_t headroom) {
@@ -30,6 +34,12 @@ namespace openvpn {
             size_ = 0;
         }
         
+        uint8_t* data() { return data_.data() + offset_; }
+        void set_size(size_t size) { size_ = size; }
+        size_t remaining(size_t tailroom) const {
+            return data_.size() - offset_ - size_ - tailroom;
+        }
+        
         uint8_t* write_alloc(size_t len) {
             if (offset_ + size_ + len > data_.size()) {
                 throw std::runtime_error("Buffer overflow");
@@ -223,6 +233,43 @@ TEST_F(BufferHeadroomTest, VerifyPacketDataIntegrity) {
     }
 }
 
+TEST_F(BufferHeadroomTest, RecycledSlot_ReadsInPlaceAfterHeadroom) {
+    // Mirrors CustomTunClient::prepare_read_slots(): recvmmsg() writes straight
+    // into the payload region of a recycled buffer, no copy or zero-fill
+    constexpr size_t SLOT_SIZE = 2048;
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+    
+    openvpn::BufferAllocated buf(HEADROOM + SLOT_SIZE + TAILROOM);
+    openvpn::TunBatchReader reader(1);
+    
+    uint8_t* first_payload = nullptr;
+    for (int round = 0; round < 3; ++round) {
+        std::vector<uint8_t> packet(PACKET_SIZE + round, static_cast<uint8_t>(0xA0 + round));
+        ASSERT_EQ(write(fds[0], packet.data(), packet.size()), static_cast<ssize_t>(packet.size()));
+        
+        buf.init_headroom(HEADROOM);
+        reader.set_slot(0, buf.data(), buf.remaining(TAILROOM));
+        EXPECT_EQ(buf.remaining(TAILROOM), SLOT_SIZE);
+        
+        ASSERT_EQ(reader.read_batch(fds[1]), 1);
+        buf.set_size(reader.length(0));
+        
+        if (round == 0) {
+            first_payload = buf.data();
+        }
+        EXPECT_EQ(buf.data(), first_payload) << "Slot should reuse the same storage";
+        EXPECT_EQ(buf.offset(), HEADROOM);
+        EXPECT_EQ(buf.size(), packet.size());
+        EXPECT_EQ(std::memcmp(buf.c_data(), packet.data(), packet.size()), 0);
+        
+        EXPECT_NO_THROW(buf.simulate_encrypt()) << "Reserved headroom must survive recycling";
+    }
+    
+    close(fds[0]);
+    close(fds[1]);
+}
+
 // Main function
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
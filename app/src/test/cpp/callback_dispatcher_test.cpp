@@ -0,0 +1,284 @@
+/**
+ * Callback Dispatcher Unit Tests
+ *
+ * Tests the lock-free MPSC queue and the dispatcher thread that JniBridge uses
+ * to deliver tunnel callbacks to Kotlin: FIFO order per producer, no lost
+ * tasks under concurrent posting, start/stop hooks, draining on stop and the
+ * pending limit.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpsc_queue.h"
+#include "callback_dispatcher.h"
+
+using openvpn::CallbackDispatcher;
+using openvpn::MpscQueue;
+
+namespace {
+
+// Blocks until the dispatcher has run every task posted so far
+bool wait_idle(const CallbackDispatcher& dispatcher) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (dispatcher.dispatched() < dispatcher.posted()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(MpscQueueTest, PopsInPushOrder) {
+    MpscQueue<int> queue;
+    int value = 0;
+    EXPECT_FALSE(queue.pop(value));
+
+    for (int i = 1; i <= 5; ++i) {
+        queue.push(i);
+    }
+    for (int i = 1; i <= 5; ++i) {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueueTest, ConcurrentProducersLoseNothing) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    MpscQueue<int> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < PER_PRODUCER; ++i) {
+                queue.push(p * PER_PRODUCER + i);
+            }
+        });
+    }
+
+    // Each producer's values must come out in the order it pushed them
+    std::vector<int> last(PRODUCERS, -1);
+    int received = 0;
+    while (received < PRODUCERS * PER_PRODUCER) {
+        int value;
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int producer = value / PER_PRODUCER;
+        EXPECT_GT(value, last[producer]);
+        last[producer] = value;
+        received++;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    int value;
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueueTest, DestructorFreesUnpoppedElements) {
+    auto tracked = std::make_shared<int>(7);
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.push(tracked);
+        queue.push(tracked);
+        EXPECT_EQ(tracked.use_count(), 3);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(CallbackDispatcherTest, RejectsPostsWhenNotRunning) {
+    CallbackDispatcher dispatcher;
+    EXPECT_FALSE(dispatcher.running());
+    EXPECT_FALSE(dispatcher.post([] {}));
+    EXPECT_EQ(dispatcher.posted(), 0u);
+}
+
+TEST(CallbackDispatcherTest, RunsTasksInOrderOnOneThread) {
+    CallbackDispatcher dispatcher;
+    ASSERT_TRUE(dispatcher.start());
+    EXPECT_FALSE(dispatcher.start());
+
+    std::vector<int> order;
+    std::vector<std::thread::id> threads;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(dispatcher.post([&, i] {
+            EXPECT_TRUE(dispatcher.on_dispatcher_thread());
+            order.push_back(i);
+            threads.push_back(std::this_thread::get_id());
+        }));
+    }
+    ASSERT_TRUE(wait_idle(dispatcher));
+    dispatcher.stop();
+
+    ASSERT_EQ(order.size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(order[i], i);
+        EXPECT_EQ(threads[i], threads[0]);
+    }
+    EXPECT_NE(threads[0], std::this_thread::get_id());
+    EXPECT_FALSE(dispatcher.on_dispatcher_thread());
+}
+
+TEST(CallbackDispatcherTest, HooksBracketTasksOnTheDispatcherThread) {
+    CallbackDispatcher dispatcher;
+    std::mutex mutex;
+    std::vector<std::string> events;
+    auto record = [&](const char* event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+    };
+
+    ASSERT_TRUE(dispatcher.start([&] { record("start"); }, [&] { record("stop"); }));
+    dispatcher.post([&] { record("task"); });
+    dispatcher.stop();
+
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0], "start");
+    EXPECT_EQ(events[1], "task");
+    EXPECT_EQ(events[2], "stop");
+}
+
+TEST(CallbackDispatcherTest, StopRunsQueuedTasks) {
+    CallbackDispatcher dispatcher;
+    ASSERT_TRUE(dispatcher.start());
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> ran{0};
+    dispatcher.post([released] { released.wait(); });
+    for (int i = 0; i < 10; ++i) {
+        dispatcher.post([&ran] { ran++; });
+    }
+
+    // The first task blocks the dispatcher, so the rest are still queued at stop()
+    std::thread stopper([&dispatcher] { dispatcher.stop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(ran.load(), 0);
+    release.set_value();
+    stopper.join();
+
+    EXPECT_EQ(ran.load(), 10);
+    EXPECT_EQ(dispatcher.pending(), 0u);
+    EXPECT_FALSE(dispatcher.post([] {}));
+}
+
+TEST(CallbackDispatcherTest, ConcurrentPostersKeepPerThreadOrder) {
+    constexpr int POSTERS = 4;
+    constexpr int PER_POSTER = 2000;
+    CallbackDispatcher dispatcher(POSTERS * PER_POSTER);
+    ASSERT_TRUE(dispatcher.start());
+
+    std::vector<int> last(POSTERS, -1);
+    std::atomic<int> out_of_order{0};
+    std::vector<std::thread> posters;
+    for (int p = 0; p < POSTERS; ++p) {
+        posters.emplace_back([&, p] {
+            for (int i = 0; i < PER_POSTER; ++i) {
+                dispatcher.post([&, p, i] {
+                    if (i <= last[p]) {
+                        out_of_order++;
+                    }
+                    last[p] = i;
+                });
+            }
+        });
+    }
+    for (auto& poster : posters) {
+        poster.join();
+    }
+    ASSERT_TRUE(wait_idle(dispatcher));
+    dispatcher.stop();
+
+    EXPECT_EQ(dispatcher.dispatched(), static_cast<uint64_t>(POSTERS * PER_POSTER));
+    EXPECT_EQ(out_of_order.load(), 0);
+    for (int p = 0; p < POSTERS; ++p) {
+        EXPECT_EQ(last[p], PER_POSTER - 1);
+    }
+}
+
+TEST(CallbackDispatcherTest, DropsPostsBeyondMaxPending) {
+    CallbackDispatcher dispatcher(2);
+    ASSERT_TRUE(dispatcher.start());
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> blocked;
+    ASSERT_TRUE(dispatcher.post([&blocked, released] {
+        blocked.set_value();
+        released.wait();
+    }));
+    blocked.get_future().wait();
+
+    EXPECT_TRUE(dispatcher.post([] {}));
+    EXPECT_TRUE(dispatcher.post([] {}));
+    EXPECT_FALSE(dispatcher.post([] {}));
+    EXPECT_EQ(dispatcher.dropped(), 1u);
+
+    release.set_value();
+    ASSERT_TRUE(wait_idle(dispatcher));
+    EXPECT_TRUE(dispatcher.post([] {}));
+    dispatcher.stop();
+    EXPECT_EQ(dispatcher.dispatched(), 4u);
+}
+
+TEST(CallbackDispatcherTest, UncappedPostsRunAfterQueuedTasksWhenFull) {
+    CallbackDispatcher dispatcher(1);
+    ASSERT_TRUE(dispatcher.start());
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> blocked;
+    std::vector<int> order;
+    ASSERT_TRUE(dispatcher.post([&blocked, released] {
+        blocked.set_value();
+        released.wait();
+    }));
+    blocked.get_future().wait();
+
+    EXPECT_TRUE(dispatcher.post([&order] { order.push_back(1); }));
+    EXPECT_FALSE(dispatcher.post([&order] { order.push_back(99); }));
+    EXPECT_TRUE(dispatcher.post_uncapped([&order] { order.push_back(2); }));
+
+    release.set_value();
+    dispatcher.stop();
+    EXPECT_EQ(order, (std::vector<int>{1, 2}));
+    EXPECT_FALSE(dispatcher.post_uncapped([] {}));
+}
+
+TEST(CallbackDispatcherTest, ThrowingTaskDoesNotStopDispatch) {
+    CallbackDispatcher dispatcher;
+    ASSERT_TRUE(dispatcher.start());
+
+    std::atomic<bool> ran{false};
+    dispatcher.post([] { throw std::runtime_error("callback failed"); });
+    dispatcher.post([&ran] { ran = true; });
+    ASSERT_TRUE(wait_idle(dispatcher));
+    dispatcher.stop();
+    EXPECT_TRUE(ran.load());
+}
+
+TEST(CallbackDispatcherTest, RestartsAfterStop) {
+    CallbackDispatcher dispatcher;
+    std::atomic<int> ran{0};
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_TRUE(dispatcher.start());
+        dispatcher.post([&ran] { ran++; });
+        dispatcher.stop();
+    }
+    EXPECT_EQ(ran.load(), 3);
+}
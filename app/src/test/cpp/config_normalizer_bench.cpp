@@ -0,0 +1,122 @@
+/**
+ * Config Normalizer Benchmark
+ *
+ * Compares the per-connect cost of preparing a profile for eval_config():
+ *   legacy  - the find/rfind/erase rewrite openvpn_wrapper_connect() used to run
+ *   single  - normalize_profile()
+ *   cached  - ProfileCache hit (reconnect)
+ *
+ * Usage: config_normalizer_bench [profile.ovpn ...]
+ * Real NordVPN profiles can be fetched from
+ * https://downloads.nordcdn.com/configs/files/ovpn_udp/servers/<host>.udp.ovpn;
+ * without arguments a NordVPN-format sample is used.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "config_normalizer.h"
+#include "profile_cache.h"
+#include "nordvpn_profile_sample.h"
+
+namespace {
+
+constexpr int ITERATIONS = 2000;
+
+void remove_lines_containing(std::string& config, const std::string& pattern) {
+    size_t pos = 0;
+    while ((pos = config.find(pattern, pos)) != std::string::npos) {
+        size_t line_start = config.rfind('\n', pos);
+        line_start = line_start == std::string::npos ? 0 : line_start + 1;
+        size_t line_end = config.find('\n', pos);
+        line_end = line_end == std::string::npos ? config.length() : line_end + 1;
+        config.erase(line_start, line_end - line_start);
+        pos = line_start;
+    }
+}
+
+// The rewrite previously inlined in openvpn_wrapper_connect()
+std::string legacy_normalize(const char* config_str) {
+    std::string config = config_str;
+    for (const char* option : {"ping-timer-rem", "remote-random", "fast-io"}) {
+        remove_lines_containing(config, option);
+    }
+    if (config.find("auth-user-pass") == std::string::npos) {
+        config += "\nauth-user-pass\n";
+    } else {
+        size_t pos = config.find("auth-user-pass");
+        size_t line_start = config.rfind('\n', pos);
+        line_start = line_start == std::string::npos ? 0 : line_start + 1;
+        size_t line_end = config.find('\n', pos);
+        line_end = line_end == std::string::npos ? config.length() : line_end + 1;
+        config.replace(line_start, line_end - line_start, "auth-user-pass\n");
+    }
+    if (config.find("client-cert-not-required") == std::string::npos) {
+        if (config.find("auth ") != std::string::npos) {
+            config.insert(config.find("auth "), "client-cert-not-required\n");
+        } else {
+            config += "\nclient-cert-not-required\n";
+        }
+    }
+    size_t verb_pos = config.find("verb ");
+    if (verb_pos != std::string::npos) {
+        size_t line_start = config.rfind('\n', verb_pos);
+        line_start = line_start == std::string::npos ? 0 : line_start + 1;
+        size_t line_end = config.find('\n', verb_pos);
+        line_end = line_end == std::string::npos ? config.length() : line_end + 1;
+        config.replace(line_start, line_end - line_start, "verb 5\n");
+    } else {
+        config += "\nverb 5\n";
+    }
+    return config;
+}
+
+template <typename Fn>
+double micros_per_call(Fn&& fn) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        sink += fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sink == 1) {
+        printf(" ");
+    }
+    return std::chrono::duration<double, std::micro>(elapsed).count() / ITERATIONS;
+}
+
+void bench(const std::string& name, const std::string& raw) {
+    openvpn::ProfileCache warm(4);
+    warm.normalized(raw);
+
+    const double legacy = micros_per_call([&] { return legacy_normalize(raw.c_str()).size(); });
+    const double single = micros_per_call([&] { return openvpn::normalize_profile(raw).content.size(); });
+    const double cached = micros_per_call([&] { return warm.normalized(raw).content->size(); });
+
+    printf("%-32s %7zu B  legacy %8.2f us  single %8.2f us  cached %8.2f us\n",
+           name.c_str(), raw.size(), legacy, single, cached);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        bench("nordvpn-sample.udp.ovpn", nordvpn_profile_sample());
+        return 0;
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            fprintf(stderr, "Cannot read %s\n", argv[i]);
+            return 1;
+        }
+        std::stringstream content;
+        content << in.rdbuf();
+        bench(argv[i], content.str());
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * Config Normalizer and Profile Cache Unit Tests
+ *
+ * Tests the single-pass .ovpn rewrite applied before eval_config() and the
+ * content-keyed cache that lets known profiles skip it.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "config_normalizer.h"
+#include "profile_cache.h"
+#include "nordvpn_profile_sample.h"
+
+using openvpn::NormalizedProfile;
+using openvpn::ProfileCache;
+using openvpn::ProfileEvalSummary;
+using openvpn::normalize_profile;
+
+namespace {
+
+size_t count_lines(const std::string& text, const std::string& line) {
+    size_t count = 0;
+    size_t pos = 0;
+    while ((pos = text.find(line, pos)) != std::string::npos) {
+        if (pos == 0 || text[pos - 1] == '\n') {
+            ++count;
+        }
+        pos += line.size();
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(ConfigNormalizerTest, RewritesNordVpnProfile) {
+    NormalizedProfile out = normalize_profile(nordvpn_profile_sample());
+
+    EXPECT_EQ(out.removed_lines, 3u);
+    EXPECT_EQ(out.content.find("ping-timer-rem"), std::string::npos);
+    EXPECT_EQ(out.content.find("remote-random"), std::string::npos);
+    EXPECT_EQ(out.content.find("fast-io"), std::string::npos);
+
+    EXPECT_EQ(count_lines(out.content, "auth-user-pass\n"), 1u);
+    EXPECT_FALSE(out.auth_user_pass_added);
+    EXPECT_FALSE(out.auth_user_pass_rewritten);
+
+    EXPECT_TRUE(out.verb_replaced);
+    EXPECT_EQ(count_lines(out.content, "verb 5\n"), 1u);
+    EXPECT_EQ(out.content.find("verb 3"), std::string::npos);
+
+    // Inserted directly before the auth directive
+    EXPECT_TRUE(out.client_cert_not_required_added);
+    EXPECT_NE(out.content.find("client-cert-not-required\nauth SHA512\n"), std::string::npos);
+
+    // Inline blocks survive byte for byte
+    const std::string sample = nordvpn_profile_sample();
+    const std::string tls_auth = sample.substr(sample.find("<tls-auth>"));
+    EXPECT_NE(out.content.find(tls_auth), std::string::npos);
+}
+
+TEST(ConfigNormalizerTest, RewritesAuthUserPassFileAndAddsMissingDirectives) {
+    NormalizedProfile out = normalize_profile("client\r\nauth-user-pass /sdcard/creds.txt\r\nremote a 1194");
+
+    EXPECT_TRUE(out.auth_user_pass_rewritten);
+    EXPECT_EQ(out.content.find("creds.txt"), std::string::npos);
+    EXPECT_EQ(count_lines(out.content, "auth-user-pass\n"), 1u);
+    // Last line had no newline; appended directives still start on their own line
+    EXPECT_NE(out.content.find("remote a 1194\nclient-cert-not-required\nverb 5\n"), std::string::npos);
+
+    NormalizedProfile bare = normalize_profile("client\n");
+    EXPECT_TRUE(bare.auth_user_pass_added);
+    EXPECT_EQ(bare.content, "client\nauth-user-pass\nclient-cert-not-required\nverb 5\n");
+}
+
+TEST(ConfigNormalizerTest, IgnoresDirectivesInsideInlineBlocksAndComments) {
+    const std::string config =
+        "client\n"
+        "# fast-io is not supported\n"
+        "client-cert-not-required\n"
+        "<ca>\n"
+        "verb 9\n"
+        "fast-io\n"
+        "</ca>\n"
+        "verb 4\n";
+    NormalizedProfile out = normalize_profile(config);
+
+    EXPECT_EQ(out.removed_lines, 0u);
+    EXPECT_FALSE(out.client_cert_not_required_added);
+    EXPECT_NE(out.content.find("# fast-io is not supported\n"), std::string::npos);
+    EXPECT_NE(out.content.find("<ca>\nverb 9\nfast-io\n</ca>\nverb 5\n"), std::string::npos);
+}
+
+TEST(ConfigNormalizerTest, IsIdempotent) {
+    NormalizedProfile once = normalize_profile(nordvpn_profile_sample());
+    NormalizedProfile twice = normalize_profile(once.content);
+    EXPECT_EQ(once.content, twice.content);
+    EXPECT_EQ(twice.removed_lines, 0u);
+}
+
+TEST(ProfileCacheTest, HitsMemoryOnRepeatConnect) {
+    ProfileCache cache(4);
+    const std::string raw = nordvpn_profile_sample();
+
+    ProfileCache::Lookup first = cache.normalized(raw);
+    EXPECT_FALSE(first.memory_hit);
+    EXPECT_EQ(*first.content, normalize_profile(raw).content);
+
+    ProfileCache::Lookup second = cache.normalized(raw);
+    EXPECT_TRUE(second.memory_hit);
+    EXPECT_EQ(second.key, first.key);
+    EXPECT_EQ(second.content, first.content);
+    EXPECT_EQ(cache.misses(), 1u);
+    EXPECT_EQ(cache.memory_hits(), 1u);
+
+    EXPECT_NE(ProfileCache::key_for(raw + " "), first.key);
+}
+
+TEST(ProfileCacheTest, ClearForgetsProfilesAndEvalOutcomes) {
+    ProfileCache cache(4);
+    const std::string raw = nordvpn_profile_sample();
+    ProfileCache::Lookup lookup = cache.normalized(raw);
+    ProfileEvalSummary failed;
+    failed.error = true;
+    cache.store_eval(lookup.key, failed);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    ProfileEvalSummary eval;
+    EXPECT_FALSE(cache.find_eval(lookup.key, eval));
+    EXPECT_FALSE(cache.normalized(raw).memory_hit);
+}
+
+TEST(ProfileCacheTest, StoresEvalOutcome) {
+    ProfileCache cache(4);
+    ProfileCache::Lookup lookup = cache.normalized("client\n");
+
+    ProfileEvalSummary eval;
+    EXPECT_FALSE(cache.find_eval(lookup.key, eval));
+
+    ProfileEvalSummary failed;
+    failed.error = true;
+    failed.message = "option_error: remote: empty";
+    cache.store_eval(lookup.key, failed);
+
+    ASSERT_TRUE(cache.find_eval(lookup.key, eval));
+    EXPECT_TRUE(eval.error);
+    EXPECT_EQ(eval.message, failed.message);
+}
+
+TEST(ProfileCacheTest, EvictsLeastRecentlyUsed) {
+    ProfileCache cache(2);
+    cache.normalized("client\nremote a\n");
+    cache.normalized("client\nremote b\n");
+    cache.normalized("client\nremote a\n");
+    cache.normalized("client\nremote c\n");
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.normalized("client\nremote a\n").memory_hit);
+    EXPECT_FALSE(cache.normalized("client\nremote b\n").memory_hit);
+}
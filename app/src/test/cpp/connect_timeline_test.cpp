@@ -0,0 +1,124 @@
+/**
+ * Connect Timeline Unit Tests
+ *
+ * Tests the per-connect milestone ring: event mapping, first-occurrence marks,
+ * phase durations, timeline closing, ring eviction and the packed JNI layout.
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "connect_timeline.h"
+
+using namespace openvpn;
+
+TEST(ConnectTimelineTest, MapsOpenVpnEvents) {
+    EXPECT_EQ(connect_mark_for_event("RESOLVE"), MARK_RESOLVE);
+    EXPECT_EQ(connect_mark_for_event("WAIT"), MARK_TRANSPORT);
+    EXPECT_EQ(connect_mark_for_event("CONNECTING"), MARK_TLS);
+    EXPECT_EQ(connect_mark_for_event("AUTH_OK"), MARK_AUTH_OK);
+    EXPECT_EQ(connect_mark_for_event("GET_CONFIG"), MARK_PUSH_REQUEST);
+    EXPECT_EQ(connect_mark_for_event("ASSIGN_IP"), MARK_PUSH_REPLY);
+    EXPECT_EQ(connect_mark_for_event("CONNECTED"), MARK_CONNECTED);
+    EXPECT_EQ(connect_mark_for_event("INFO"), MARK_COUNT);
+}
+
+TEST(ConnectTimelineTest, RecordsColdStartPhases) {
+    ConnectTimelineRing ring(8);
+    ring.begin("uk", false, 1000);
+    EXPECT_TRUE(ring.on_event("uk", "RESOLVE", false, 1100));
+    EXPECT_TRUE(ring.on_event("uk", "WAIT", false, 31000));
+    EXPECT_TRUE(ring.on_event("uk", "CONNECTING", false, 41000));
+    EXPECT_FALSE(ring.on_event("uk", "INFO", false, 42000));
+    EXPECT_TRUE(ring.on_event("uk", "GET_CONFIG", false, 241000));
+    EXPECT_TRUE(ring.on_event("uk", "ASSIGN_IP", false, 261000));
+    EXPECT_TRUE(ring.mark("uk", MARK_TUN_START, 262000));
+    EXPECT_TRUE(ring.on_event("uk", "CONNECTED", false, 263000));
+
+    std::vector<ConnectTimeline> timelines = ring.snapshot("uk");
+    ASSERT_EQ(timelines.size(), 1u);
+    ConnectTimeline t = timelines[0];
+    EXPECT_TRUE(t.open);
+    EXPECT_FALSE(t.reconnect);
+    EXPECT_EQ(t.marks_us[MARK_RESOLVE], 100);
+    EXPECT_EQ(t.phase_us(MARK_RESOLVE), 29900);
+    EXPECT_EQ(t.phase_us(MARK_TRANSPORT), 10000);
+    // AUTH_OK never fired, so TLS runs until the push request
+    EXPECT_EQ(t.phase_us(MARK_TLS), 200000);
+    EXPECT_EQ(t.phase_us(MARK_AUTH_OK), -1);
+    EXPECT_EQ(t.phase_us(MARK_CONNECTED), -1);
+
+    // First packet completes and closes the timeline
+    EXPECT_TRUE(ring.mark("uk", MARK_FIRST_PACKET, 300000));
+    t = ring.snapshot("uk")[0];
+    EXPECT_FALSE(t.open);
+    EXPECT_EQ(t.phase_us(MARK_CONNECTED), 37000);
+    EXPECT_FALSE(ring.mark("uk", MARK_FIRST_PACKET, 400000));
+}
+
+TEST(ConnectTimelineTest, KeepsFirstOccurrenceOnly) {
+    ConnectTimelineRing ring(8);
+    ring.begin("uk", false, 0);
+    EXPECT_TRUE(ring.on_event("uk", "WAIT", false, 10));
+    EXPECT_FALSE(ring.on_event("uk", "WAIT", false, 50));
+    EXPECT_EQ(ring.snapshot("uk")[0].marks_us[MARK_TRANSPORT], 10);
+
+    // Marks for a tunnel without an open timeline are ignored
+    EXPECT_FALSE(ring.mark("fr", MARK_TUN_START, 10));
+}
+
+TEST(ConnectTimelineTest, ReconnectOpensNewTimeline) {
+    ConnectTimelineRing ring(8);
+    ring.begin("uk", false, 0);
+    ring.on_event("uk", "CONNECTED", false, 100);
+    ring.on_event("uk", "RECONNECTING", false, 5000);
+    ring.on_event("uk", "RESOLVE", false, 5010);
+
+    std::vector<ConnectTimeline> timelines = ring.snapshot("uk");
+    ASSERT_EQ(timelines.size(), 2u);
+    EXPECT_FALSE(timelines[0].open);
+    EXPECT_TRUE(timelines[1].reconnect);
+    EXPECT_TRUE(timelines[1].open);
+    EXPECT_EQ(timelines[1].marks_us[MARK_RESOLVE], 10);
+
+    // A fatal event closes the attempt
+    EXPECT_TRUE(ring.on_event("uk", "AUTH_FAILED", true, 6000));
+    EXPECT_FALSE(ring.snapshot("uk")[1].open);
+}
+
+TEST(ConnectTimelineTest, RingKeepsMostRecent) {
+    ConnectTimelineRing ring(3);
+    ring.begin("uk", false, 0);
+    ring.begin("fr", false, 0);
+    ring.begin("de", false, 0);
+    ring.begin("us", false, 0);
+
+    std::vector<ConnectTimeline> all = ring.snapshot();
+    ASSERT_EQ(all.size(), 3u);
+    EXPECT_EQ(all[0].tunnel_id, "fr");
+    EXPECT_EQ(all[2].tunnel_id, "us");
+
+    // The evicted timeline no longer accepts marks
+    EXPECT_FALSE(ring.mark("uk", MARK_RESOLVE, 10));
+    EXPECT_TRUE(ring.mark("fr", MARK_RESOLVE, 10));
+}
+
+TEST(ConnectTimelineTest, PacksLayout) {
+    ConnectTimelineRing ring(4);
+    ring.begin("uk", false, 0);
+    ring.on_event("uk", "RESOLVE", false, 7);
+    ring.begin("fr", true, 0);
+
+    std::vector<int64_t> packed = ring.pack("uk");
+    ASSERT_EQ(packed.size(), 3u + TIMELINE_FIELD_COUNT);
+    EXPECT_EQ(packed[0], ConnectTimelineRing::TIMELINE_LAYOUT_VERSION);
+    EXPECT_EQ(packed[1], 1);
+    EXPECT_EQ(packed[2], static_cast<int64_t>(TIMELINE_FIELD_COUNT));
+    EXPECT_EQ(packed[3 + TIMELINE_ID], 1);
+    EXPECT_EQ(packed[3 + TIMELINE_OPEN], 1);
+    EXPECT_EQ(packed[3 + TIMELINE_MARK_0 + MARK_CONNECT_START], 0);
+    EXPECT_EQ(packed[3 + TIMELINE_MARK_0 + MARK_RESOLVE], 7);
+    EXPECT_EQ(packed[3 + TIMELINE_MARK_0 + MARK_TRANSPORT], -1);
+
+    EXPECT_EQ(ring.pack()[1], 2);
+}
@@ -0,0 +1,140 @@
+/**
+ * Connection Lifecycle Unit Tests
+ *
+ * Tests the event-driven state machine behind openvpn_wrapper_connect() and
+ * openvpn_wrapper_disconnect(): event mapping, condition-variable waits,
+ * connect latency, and in-order listener pushes.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "connection_lifecycle.h"
+
+using openvpn::ConnectionLifecycle;
+using openvpn::LifecycleState;
+using namespace std::chrono_literals;
+
+TEST(ConnectionLifecycleTest, MapsOpenVpnEvents) {
+    ConnectionLifecycle lifecycle;
+    EXPECT_EQ(lifecycle.state(), LifecycleState::DISCONNECTED);
+
+    lifecycle.begin_connect();
+    EXPECT_EQ(lifecycle.state(), LifecycleState::CONNECTING);
+
+    // Intermediate events leave the state alone
+    EXPECT_FALSE(lifecycle.on_event("RESOLVE", false));
+    EXPECT_FALSE(lifecycle.on_event("AUTH_PENDING", false));
+    EXPECT_EQ(lifecycle.state(), LifecycleState::CONNECTING);
+
+    EXPECT_TRUE(lifecycle.on_event("CONNECTED", false));
+    EXPECT_FALSE(lifecycle.on_event("CONNECTED", false));
+    EXPECT_TRUE(lifecycle.on_event("RECONNECTING", false));
+    EXPECT_FALSE(lifecycle.on_event("WAIT", false));
+    EXPECT_EQ(lifecycle.state(), LifecycleState::RECONNECTING);
+    EXPECT_TRUE(lifecycle.on_event("CONNECTED", false));
+
+    EXPECT_TRUE(lifecycle.on_event("AUTH_FAILED", true));
+    EXPECT_EQ(lifecycle.state(), LifecycleState::DISCONNECTED);
+}
+
+TEST(ConnectionLifecycleTest, WaitersWakeOnTransition) {
+    ConnectionLifecycle lifecycle;
+    lifecycle.begin_connect();
+
+    std::thread events([&] {
+        std::this_thread::sleep_for(20ms);
+        lifecycle.on_event("CONNECTED", false);
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(lifecycle.wait_for(LifecycleState::CONNECTED, 5000ms), LifecycleState::CONNECTED);
+    const auto waited = std::chrono::steady_clock::now() - start;
+    events.join();
+
+    // Woken by the transition, not by the timeout
+    EXPECT_LT(waited, 2000ms);
+    EXPECT_GE(lifecycle.connect_latency_ms(), 15);
+}
+
+TEST(ConnectionLifecycleTest, WaitTimesOutWithCurrentState) {
+    ConnectionLifecycle lifecycle;
+    lifecycle.begin_connect();
+    EXPECT_EQ(lifecycle.wait_for(LifecycleState::DISCONNECTED, 10ms), LifecycleState::CONNECTING);
+    EXPECT_EQ(lifecycle.wait_while(LifecycleState::CONNECTING, 10ms), LifecycleState::CONNECTING);
+    EXPECT_EQ(lifecycle.connect_latency_ms(), -1);
+}
+
+TEST(ConnectionLifecycleTest, LatencyMeasuresFirstConnectOnly) {
+    ConnectionLifecycle lifecycle;
+    lifecycle.begin_connect();
+    lifecycle.on_event("CONNECTED", false);
+    const int64_t first = lifecycle.connect_latency_ms();
+    ASSERT_GE(first, 0);
+
+    std::this_thread::sleep_for(5ms);
+    lifecycle.on_event("RECONNECTING", false);
+    lifecycle.on_event("CONNECTED", false);
+    EXPECT_EQ(lifecycle.connect_latency_ms(), first);
+
+    // A new connect restarts the clock
+    lifecycle.transition(LifecycleState::DISCONNECTED);
+    lifecycle.begin_connect();
+    EXPECT_EQ(lifecycle.connect_latency_ms(), -1);
+}
+
+TEST(ConnectionLifecycleTest, ListenerSeesCurrentStateThenEveryChangeInOrder) {
+    ConnectionLifecycle lifecycle;
+    lifecycle.begin_connect();
+
+    std::vector<LifecycleState> seen;
+    std::vector<int64_t> latencies;
+    lifecycle.set_listener([&](LifecycleState state, int64_t latency) {
+        seen.push_back(state);
+        latencies.push_back(latency);
+    });
+
+    lifecycle.on_event("CONNECTED", false);
+    lifecycle.on_event("CONNECTED", false);      // No change, no push
+    lifecycle.on_event("DISCONNECTED", false);
+
+    ASSERT_EQ(seen.size(), 3u);
+    EXPECT_EQ(seen[0], LifecycleState::CONNECTING);
+    EXPECT_EQ(seen[1], LifecycleState::CONNECTED);
+    EXPECT_EQ(seen[2], LifecycleState::DISCONNECTED);
+    EXPECT_EQ(latencies[0], -1);
+    EXPECT_GE(latencies[1], 0);
+
+    lifecycle.clear_listener();
+    lifecycle.begin_connect();
+    EXPECT_EQ(seen.size(), 3u);
+}
+
+TEST(ConnectionLifecycleTest, ConcurrentTransitionsReachListenerSerially) {
+    ConnectionLifecycle lifecycle;
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+    lifecycle.set_listener([&](LifecycleState, int64_t) {
+        if (inside.fetch_add(1) != 0) {
+            overlapped = true;
+        }
+        std::this_thread::sleep_for(100us);
+        inside.fetch_sub(1);
+    });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) {
+                lifecycle.transition(static_cast<LifecycleState>((i + t) % 4));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(overlapped.load());
+}
@@ -0,0 +1,226 @@
+/**
+ * Direct Packet Channel Unit Tests
+ *
+ * Tests the direct ByteBuffer packet channel behind the per-tunnel JNI
+ * send/receive calls: single packets by offset and length, sendmmsg() /
+ * recvmmsg() batches described by the buffer's descriptor table, truncation
+ * and bounds handling, and registration in the tunnel slot table.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "direct_packet_channel.h"
+#include "tunnel_slots.h"
+
+using openvpn::DirectPacketBuffer;
+using openvpn::DirectPacketChannel;
+using openvpn::TunnelSlotTable;
+
+namespace {
+
+constexpr size_t BUFFER_SIZE = DirectPacketChannel::DATA_OFFSET + 8 * DirectPacketChannel::SLOT_SIZE;
+
+// Stand-ins for the two direct ByteBuffers Kotlin registers, plus the tunnel socketpair
+class DirectPacketChannelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds_), 0);
+        channel_ = std::make_unique<DirectPacketChannel>(fds_[0], DirectPacketBuffer{send_.data(), send_.size()},
+                                                         DirectPacketBuffer{receive_.data(), receive_.size()});
+    }
+
+    void TearDown() override {
+        close(fds_[0]);
+        if (fds_[1] >= 0) {
+            close(fds_[1]);
+        }
+    }
+
+    int kotlin_fd() const { return fds_[0]; }
+    int openvpn_fd() const { return fds_[1]; }
+
+    void describe(std::vector<uint8_t>& buffer, size_t index, int32_t offset, int32_t length) {
+        std::memcpy(buffer.data() + index * DirectPacketChannel::DESCRIPTOR_SIZE, &offset, 4);
+        std::memcpy(buffer.data() + index * DirectPacketChannel::DESCRIPTOR_SIZE + 4, &length, 4);
+    }
+
+    void descriptor(size_t index, int32_t& offset, int32_t& length) {
+        std::memcpy(&offset, receive_.data() + index * DirectPacketChannel::DESCRIPTOR_SIZE, 4);
+        std::memcpy(&length, receive_.data() + index * DirectPacketChannel::DESCRIPTOR_SIZE + 4, 4);
+    }
+
+    std::vector<uint8_t> read_openvpn() {
+        std::vector<uint8_t> buf(4096);
+        const ssize_t n = recv(openvpn_fd(), buf.data(), buf.size(), MSG_DONTWAIT);
+        buf.resize(n > 0 ? static_cast<size_t>(n) : 0);
+        return buf;
+    }
+
+    void write_openvpn(size_t len, uint8_t marker) {
+        std::vector<uint8_t> packet(len, marker);
+        ASSERT_EQ(send(openvpn_fd(), packet.data(), packet.size(), 0), static_cast<ssize_t>(len));
+    }
+
+    int fds_[2] = {-1, -1};
+    std::vector<uint8_t> send_ = std::vector<uint8_t>(BUFFER_SIZE);
+    std::vector<uint8_t> receive_ = std::vector<uint8_t>(BUFFER_SIZE);
+    std::unique_ptr<DirectPacketChannel> channel_;
+};
+
+} // namespace
+
+TEST_F(DirectPacketChannelTest, RejectsBuffersWithoutRoomForOneSlot) {
+    EXPECT_TRUE(channel_->valid());
+    uint8_t small[DirectPacketChannel::DATA_OFFSET + 100];
+    DirectPacketChannel tiny(kotlin_fd(), DirectPacketBuffer{small, sizeof(small)}, DirectPacketBuffer{receive_.data(), receive_.size()});
+    EXPECT_FALSE(tiny.valid());
+    DirectPacketChannel missing(kotlin_fd(), DirectPacketBuffer{}, DirectPacketBuffer{receive_.data(), receive_.size()});
+    EXPECT_FALSE(missing.valid());
+    DirectPacketChannel no_socket(-1, DirectPacketBuffer{send_.data(), send_.size()}, DirectPacketBuffer{receive_.data(), receive_.size()});
+    EXPECT_FALSE(no_socket.valid());
+}
+
+TEST_F(DirectPacketChannelTest, SendsOnePacketByOffsetAndLength) {
+    std::memset(send_.data() + 1000, 0xAB, 300);
+    EXPECT_EQ(channel_->send(1000, 300), 300);
+    EXPECT_EQ(read_openvpn(), std::vector<uint8_t>(300, 0xAB));
+    EXPECT_EQ(channel_->stats().packets_sent.load(), 1u);
+
+    EXPECT_EQ(channel_->send(BUFFER_SIZE - 10, 11), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(channel_->send(0, 0), -1);
+    EXPECT_EQ(channel_->stats().invalid.load(), 2u);
+}
+
+TEST_F(DirectPacketChannelTest, SendBatchFollowsDescriptorsInOrder) {
+    const size_t base = DirectPacketChannel::DATA_OFFSET;
+    for (uint8_t i = 0; i < 5; ++i) {
+        std::memset(send_.data() + base + i * 100, i + 1, 60 + i);
+        describe(send_, i, static_cast<int32_t>(base + i * 100), 60 + i);
+    }
+
+    EXPECT_EQ(channel_->send_batch(5), 5);
+    for (uint8_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(read_openvpn(), std::vector<uint8_t>(60 + i, i + 1));
+    }
+    EXPECT_TRUE(read_openvpn().empty());
+    EXPECT_EQ(channel_->stats().packets_sent.load(), 5u);
+    EXPECT_EQ(channel_->stats().send_calls.load(), 1u);
+}
+
+TEST_F(DirectPacketChannelTest, SendBatchReportsPartialSendWhenSocketFills) {
+    int sndbuf = 4096;
+    setsockopt(kotlin_fd(), SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    const size_t base = DirectPacketChannel::DATA_OFFSET;
+    for (size_t i = 0; i < DirectPacketChannel::MAX_BATCH; ++i) {
+        describe(send_, i, static_cast<int32_t>(base), 1400);
+    }
+
+    const int sent = channel_->send_batch(DirectPacketChannel::MAX_BATCH);
+    ASSERT_GT(sent, 0);
+    EXPECT_LT(sent, static_cast<int>(DirectPacketChannel::MAX_BATCH));
+    EXPECT_EQ(channel_->send_batch(1), -1);
+    EXPECT_EQ(errno, EAGAIN);
+}
+
+TEST_F(DirectPacketChannelTest, SendBatchStopsAtInvalidDescriptor) {
+    const size_t base = DirectPacketChannel::DATA_OFFSET;
+    describe(send_, 0, static_cast<int32_t>(base), 40);
+    describe(send_, 1, -1, 40);
+    describe(send_, 2, static_cast<int32_t>(base), 40);
+
+    EXPECT_EQ(channel_->send_batch(3), 1);
+    EXPECT_EQ(read_openvpn().size(), 40u);
+    EXPECT_TRUE(read_openvpn().empty());
+    EXPECT_EQ(channel_->stats().invalid.load(), 1u);
+
+    describe(send_, 0, static_cast<int32_t>(BUFFER_SIZE), 1);
+    EXPECT_EQ(channel_->send_batch(1), -1);
+}
+
+TEST_F(DirectPacketChannelTest, ReceivesOnePacketAtOffset) {
+    EXPECT_EQ(channel_->receive(100), 0);
+
+    write_openvpn(1400, 0x5A);
+    EXPECT_EQ(channel_->receive(100), 1400);
+    EXPECT_EQ(receive_[100], 0x5A);
+    EXPECT_EQ(receive_[1499], 0x5A);
+    EXPECT_EQ(receive_[1500], 0);
+}
+
+TEST_F(DirectPacketChannelTest, ReceiveReportsPacketTooLargeForRemainingSpace) {
+    write_openvpn(200, 1);
+    EXPECT_EQ(channel_->receive(BUFFER_SIZE - 100), -1);
+    EXPECT_EQ(errno, EMSGSIZE);
+    EXPECT_EQ(channel_->stats().truncated.load(), 1u);
+}
+
+TEST_F(DirectPacketChannelTest, ReceiveBatchDescribesEachPacket) {
+    for (uint8_t i = 0; i < 6; ++i) {
+        write_openvpn(100 + i, i);
+    }
+
+    EXPECT_EQ(channel_->receive_batch(64), 6);
+    for (uint8_t i = 0; i < 6; ++i) {
+        int32_t offset;
+        int32_t length;
+        descriptor(i, offset, length);
+        EXPECT_EQ(offset, static_cast<int32_t>(DirectPacketChannel::DATA_OFFSET + i * DirectPacketChannel::SLOT_SIZE));
+        EXPECT_EQ(length, 100 + i);
+        EXPECT_EQ(receive_[offset], i);
+    }
+    EXPECT_EQ(channel_->receive_batch(64), 0);
+    EXPECT_EQ(channel_->stats().packets_received.load(), 6u);
+}
+
+TEST_F(DirectPacketChannelTest, ReceiveBatchIsLimitedBySlotsAndMaxCount) {
+    for (int i = 0; i < 12; ++i) {
+        write_openvpn(64, static_cast<uint8_t>(i));
+    }
+    EXPECT_EQ(channel_->receive_batch(3), 3);
+    EXPECT_EQ(channel_->receive_batch(64), 8);   // Buffer has 8 slots
+    EXPECT_EQ(channel_->receive_batch(64), 1);
+}
+
+TEST_F(DirectPacketChannelTest, ReceiveBatchDropsTruncatedPackets) {
+    write_openvpn(100, 1);
+    write_openvpn(DirectPacketChannel::SLOT_SIZE + 1, 2);
+    write_openvpn(100, 3);
+
+    EXPECT_EQ(channel_->receive_batch(64), 2);
+    int32_t offset;
+    int32_t length;
+    descriptor(1, offset, length);
+    EXPECT_EQ(receive_[offset], 3);
+    EXPECT_EQ(channel_->stats().truncated.load(), 1u);
+}
+
+TEST_F(DirectPacketChannelTest, ReceiveReportsClosedPeer) {
+    close(fds_[1]);
+    fds_[1] = -1;
+    EXPECT_EQ(channel_->receive(0), -1);
+    EXPECT_EQ(channel_->receive_batch(64), -1);
+}
+
+TEST_F(DirectPacketChannelTest, SlotOwnsRegisteredChannelUntilRelease) {
+    TunnelSlotTable table;
+    const int64_t handle = table.open("direct-uk");
+    DirectPacketChannel* raw = channel_.get();
+    ASSERT_TRUE(table.set_direct(handle, std::move(channel_)));
+    {
+        TunnelSlotTable::Pin pin = table.pin(handle);
+        ASSERT_TRUE(pin);
+        EXPECT_EQ(pin.direct(), raw);
+    }
+
+    ASSERT_TRUE(table.set_direct(handle, nullptr));
+    EXPECT_EQ(table.pin(handle).direct(), nullptr);
+
+    table.release(handle);
+    EXPECT_FALSE(table.set_direct(handle, nullptr));
+}
@@ -0,0 +1,393 @@
+/**
+ * DNS Forwarder Unit Tests
+ *
+ * Tests the per-tunnel DNS forwarder on CustomTunClient's packet path:
+ * readdressing misses to the tunnel's resolver, restoring the source of
+ * responses, TTL-bounded caching (including RFC 2308 negative answers),
+ * answering repeats in place, and the hit / latency counters.
+ */
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <string>
+#include <vector>
+
+#include "dns_forwarder.h"
+
+using openvpn::DnsCache;
+using openvpn::DnsForwarder;
+namespace dns_detail = openvpn::dns_detail;
+
+namespace {
+
+using Action = DnsForwarder::Action;
+
+constexpr size_t CAPACITY = 2048;
+constexpr uint64_t SEC = 1000000;
+
+void put16(std::vector<uint8_t>& v, uint16_t x) {
+    v.push_back(static_cast<uint8_t>(x >> 8));
+    v.push_back(static_cast<uint8_t>(x));
+}
+
+void put32(std::vector<uint8_t>& v, uint32_t x) {
+    put16(v, static_cast<uint16_t>(x >> 16));
+    put16(v, static_cast<uint16_t>(x));
+}
+
+std::vector<uint8_t> addr(const char* text) {
+    const bool v6 = std::string(text).find(':') != std::string::npos;
+    std::vector<uint8_t> out(v6 ? 16 : 4);
+    EXPECT_EQ(inet_pton(v6 ? AF_INET6 : AF_INET, text, out.data()), 1);
+    return out;
+}
+
+std::vector<uint8_t> question(uint16_t id, uint16_t flags, const std::string& name, uint16_t qtype = 1) {
+    std::vector<uint8_t> msg;
+    put16(msg, id);
+    put16(msg, flags);
+    put16(msg, 1);
+    put16(msg, 0);
+    put16(msg, 0);
+    put16(msg, 0);
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) {
+            dot = name.size();
+        }
+        msg.push_back(static_cast<uint8_t>(dot - start));
+        msg.insert(msg.end(), name.begin() + start, name.begin() + dot);
+        start = dot + 1;
+    }
+    msg.push_back(0);
+    put16(msg, qtype);
+    put16(msg, 1);
+    return msg;
+}
+
+// Response to the question in query with one A record, or an SOA in the authority section
+std::vector<uint8_t> response(const std::vector<uint8_t>& query, uint8_t rcode, uint32_t ttl,
+                              bool soa = false, uint32_t soa_minimum = 0) {
+    std::vector<uint8_t> msg = query;
+    msg[2] |= 0x80;
+    msg[3] = static_cast<uint8_t>((msg[3] & 0xF0) | rcode);
+    put16(msg, 0xC00C);
+    if (soa) {
+        msg[9] = 1;   // NSCOUNT
+        put16(msg, 6);
+        put16(msg, 1);
+        put32(msg, ttl);
+        put16(msg, 2 + 2 + 20);
+        put16(msg, 0xC00C);   // MNAME
+        put16(msg, 0xC00C);   // RNAME
+        put32(msg, 1);        // SERIAL
+        put32(msg, 7200);
+        put32(msg, 900);
+        put32(msg, 86400);
+        put32(msg, soa_minimum);
+    } else {
+        msg[7] = 1;   // ANCOUNT
+        put16(msg, 1);
+        put16(msg, 1);
+        put32(msg, ttl);
+        put16(msg, 4);
+        put32(msg, 0x01020304);
+    }
+    return msg;
+}
+
+// IP/UDP packet carrying payload, with valid checksums and room to grow
+std::vector<uint8_t> udp_packet(const char* src, const char* dst, uint16_t sport, uint16_t dport,
+                                const std::vector<uint8_t>& payload) {
+    const std::vector<uint8_t> s = addr(src);
+    const std::vector<uint8_t> d = addr(dst);
+    const bool v6 = s.size() == 16;
+    const size_t header = v6 ? 40 : 20;
+    std::vector<uint8_t> p(header + 8 + payload.size());
+    if (v6) {
+        p[0] = 0x60;
+        dns_detail::write_be16(&p[4], static_cast<uint16_t>(8 + payload.size()));
+        p[6] = 17;
+        p[7] = 64;
+    } else {
+        p[0] = 0x45;
+        dns_detail::write_be16(&p[2], static_cast<uint16_t>(p.size()));
+        p[8] = 64;
+        p[9] = 17;
+    }
+    std::copy(s.begin(), s.end(), p.begin() + (v6 ? 8 : 12));
+    std::copy(d.begin(), d.end(), p.begin() + (v6 ? 24 : 16));
+    dns_detail::write_be16(&p[header], sport);
+    dns_detail::write_be16(&p[header + 2], dport);
+    dns_detail::write_be16(&p[header + 4], static_cast<uint16_t>(8 + payload.size()));
+    std::copy(payload.begin(), payload.end(), p.begin() + header + 8);
+
+    dns_detail::UdpView view;
+    EXPECT_TRUE(dns_detail::parse_udp(p.data(), p.size(), view));
+    dns_detail::update_checksums(p.data(), view);
+    p.resize(CAPACITY);
+    return p;
+}
+
+size_t packet_len(const std::vector<uint8_t>& p) {
+    return p[0] >> 4 == 6 ? 40 + dns_detail::read_be16(&p[4]) : dns_detail::read_be16(&p[2]);
+}
+
+bool checksums_valid(const std::vector<uint8_t>& p) {
+    dns_detail::UdpView view;
+    if (!dns_detail::parse_udp(p.data(), packet_len(p), view)) {
+        return false;
+    }
+    if (!view.ipv6 && dns_detail::fold(dns_detail::sum_words(p.data(), view.udp, 0)) != 0) {
+        return false;
+    }
+    uint32_t sum = dns_detail::sum_words(&p[view.src_addr()], view.addr_len() * 2, 0);
+    sum += 17 + static_cast<uint32_t>(view.payload_len + 8);
+    return dns_detail::fold(dns_detail::sum_words(&p[view.udp], view.payload_len + 8, sum)) == 0;
+}
+
+std::vector<uint8_t> src_of(const std::vector<uint8_t>& p) {
+    const bool v6 = p[0] >> 4 == 6;
+    return std::vector<uint8_t>(p.begin() + (v6 ? 8 : 12), p.begin() + (v6 ? 24 : 16));
+}
+
+std::vector<uint8_t> dst_of(const std::vector<uint8_t>& p) {
+    const bool v6 = p[0] >> 4 == 6;
+    return std::vector<uint8_t>(p.begin() + (v6 ? 24 : 16), p.begin() + (v6 ? 40 : 20));
+}
+
+const uint8_t* dns_of(const std::vector<uint8_t>& p) {
+    return p.data() + (p[0] >> 4 == 6 ? 48 : 28);
+}
+
+Action send_query(DnsForwarder& dns, std::vector<uint8_t>& packet, uint64_t now_us) {
+    size_t len = packet_len(packet);
+    const Action action = dns.on_outbound(packet.data(), len, packet.size(), now_us);
+    EXPECT_EQ(len, packet_len(packet));
+    return action;
+}
+
+// Client at 10.0.0.2:40000 asking the system resolver 8.8.8.8 through a tunnel whose resolver is 10.8.0.1
+class DnsForwarderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dns.set_resolvers({"10.8.0.1", "fd00::53"});
+    }
+
+    // Query → forwarded → response from the tunnel resolver, returned as the app sees it
+    std::vector<uint8_t> resolve(const std::vector<uint8_t>& query, const std::vector<uint8_t>& answer,
+                                 uint64_t sent_us, uint64_t answered_us) {
+        std::vector<uint8_t> out = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, query);
+        EXPECT_EQ(send_query(dns, out, sent_us), Action::FORWARD);
+        std::vector<uint8_t> in = udp_packet("10.8.0.1", "10.0.0.2", 53, 40000, answer);
+        EXPECT_TRUE(dns.on_inbound(in.data(), packet_len(in), answered_us));
+        return in;
+    }
+
+    DnsForwarder dns;
+};
+
+} // namespace
+
+TEST_F(DnsForwarderTest, MissIsReaddressedToTunnelResolver) {
+    std::vector<uint8_t> packet = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, question(0x1234, 0x0100, "example.com"));
+
+    EXPECT_EQ(send_query(dns, packet, 0), Action::FORWARD);
+    EXPECT_EQ(dst_of(packet), addr("10.8.0.1"));
+    EXPECT_EQ(src_of(packet), addr("10.0.0.2"));
+    EXPECT_TRUE(checksums_valid(packet));
+    EXPECT_EQ(dns.stats().queries.load(), 1u);
+    EXPECT_EQ(dns.stats().forwarded.load(), 1u);
+}
+
+TEST_F(DnsForwarderTest, ResponseGetsQueriedAddressBackAndIsCached) {
+    const std::vector<uint8_t> query = question(0x1234, 0x0100, "example.com");
+    const std::vector<uint8_t> in = resolve(query, response(query, 0, 300), 1 * SEC, 1 * SEC + 2500);
+
+    EXPECT_EQ(src_of(in), addr("8.8.8.8"));
+    EXPECT_EQ(dst_of(in), addr("10.0.0.2"));
+    EXPECT_TRUE(checksums_valid(in));
+    EXPECT_EQ(dns.cache_size(), 1u);
+    EXPECT_EQ(dns.stats().responses.load(), 1u);
+    EXPECT_EQ(dns.stats().latency_us_total.load(), 2500u);
+    EXPECT_EQ(dns.stats().cache_entries.load(), 1u);
+}
+
+TEST_F(DnsForwarderTest, RepeatQueryIsAnsweredFromCacheWithAgedTtl) {
+    const std::vector<uint8_t> query = question(0x1234, 0x0100, "example.com");
+    resolve(query, response(query, 0, 300), 0, 1000);
+
+    // Same name, different case, new ID and port, 10 s later
+    std::vector<uint8_t> packet = udp_packet("10.0.0.2", "8.8.8.8", 41000, 53, question(0xBEEF, 0x0100, "Example.COM"));
+    EXPECT_EQ(send_query(dns, packet, 10 * SEC), Action::ANSWERED);
+
+    EXPECT_EQ(src_of(packet), addr("8.8.8.8"));
+    EXPECT_EQ(dst_of(packet), addr("10.0.0.2"));
+    EXPECT_EQ(dns_detail::read_be16(&packet[20]), 53);
+    EXPECT_EQ(dns_detail::read_be16(&packet[22]), 41000);
+    EXPECT_TRUE(checksums_valid(packet));
+
+    const uint8_t* msg = dns_of(packet);
+    EXPECT_EQ(dns_detail::read_be16(msg), 0xBEEF);
+    EXPECT_TRUE(msg[2] & 0x80);
+    const size_t answer = 12 + 13 + 4;
+    EXPECT_EQ(dns_detail::read_be32(msg + answer + 6), 290u);
+
+    EXPECT_EQ(dns.stats().queries.load(), 2u);
+    EXPECT_EQ(dns.stats().cache_hits.load(), 1u);
+    EXPECT_EQ(dns.stats().forwarded.load(), 1u);
+}
+
+TEST_F(DnsForwarderTest, ExpiredEntryIsForwardedAgain) {
+    const std::vector<uint8_t> query = question(1, 0x0100, "example.com");
+    resolve(query, response(query, 0, 30), 0, 0);
+
+    std::vector<uint8_t> packet = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, question(2, 0x0100, "example.com"));
+    EXPECT_EQ(send_query(dns, packet, 30 * SEC), Action::FORWARD);
+    EXPECT_EQ(dst_of(packet), addr("10.8.0.1"));
+}
+
+TEST_F(DnsForwarderTest, DifferentQuestionTypeOrCdBitMisses) {
+    const std::vector<uint8_t> query = question(1, 0x0100, "example.com");
+    resolve(query, response(query, 0, 300), 0, 0);
+
+    std::vector<uint8_t> aaaa = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, question(2, 0x0100, "example.com", 28));
+    EXPECT_EQ(send_query(dns, aaaa, SEC), Action::FORWARD);
+    std::vector<uint8_t> cd = udp_packet("10.0.0.2", "8.8.8.8", 40001, 53, question(3, 0x0110, "example.com"));
+    EXPECT_EQ(send_query(dns, cd, SEC), Action::FORWARD);
+}
+
+TEST_F(DnsForwarderTest, NegativeAnswerIsCachedForSoaMinimum) {
+    const std::vector<uint8_t> query = question(1, 0x0100, "missing.example");
+    resolve(query, response(query, 3, 3600, true, 60), 0, 0);
+    EXPECT_EQ(dns.cache_size(), 1u);
+
+    std::vector<uint8_t> hit = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, question(2, 0x0100, "missing.example"));
+    EXPECT_EQ(send_query(dns, hit, 59 * SEC), Action::ANSWERED);
+    EXPECT_EQ(dns_of(hit)[3] & 0x0F, 3);
+
+    std::vector<uint8_t> miss = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, question(3, 0x0100, "missing.example"));
+    EXPECT_EQ(send_query(dns, miss, 60 * SEC), Action::FORWARD);
+}
+
+TEST_F(DnsForwarderTest, UncacheableResponsesAreOnlyRelayed) {
+    const std::vector<uint8_t> nx = question(1, 0x0100, "nosoa.example");
+    resolve(nx, response(nx, 3, 300), 0, 0);   // NXDOMAIN without SOA
+
+    const std::vector<uint8_t> fail = question(2, 0x0100, "servfail.example");
+    resolve(fail, response(fail, 2, 300), 0, 0);
+
+    const std::vector<uint8_t> tc = question(3, 0x0100, "big.example");
+    std::vector<uint8_t> truncated = response(tc, 0, 300);
+    truncated[2] |= 0x02;
+    const std::vector<uint8_t> in = resolve(tc, truncated, 0, 0);
+
+    EXPECT_EQ(src_of(in), addr("8.8.8.8"));
+    EXPECT_EQ(dns.cache_size(), 0u);
+    EXPECT_EQ(dns.stats().responses.load(), 3u);
+}
+
+TEST_F(DnsForwarderTest, TtlIsCappedAtMaximum) {
+    const std::vector<uint8_t> query = question(1, 0x0100, "example.com");
+    resolve(query, response(query, 0, 86400), 0, 0);
+
+    std::vector<uint8_t> packet = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, question(2, 0x0100, "example.com"));
+    EXPECT_EQ(send_query(dns, packet, TUN_DNS_MAX_TTL_SEC * SEC), Action::FORWARD);
+}
+
+TEST_F(DnsForwarderTest, NonDnsAndUnsolicitedTrafficPassesUntouched) {
+    std::vector<uint8_t> https = udp_packet("10.0.0.2", "8.8.8.8", 40000, 443, question(1, 0x0100, "example.com"));
+    const std::vector<uint8_t> before = https;
+    EXPECT_EQ(send_query(dns, https, 0), Action::PASS);
+    EXPECT_EQ(https, before);
+
+    const std::vector<uint8_t> query = question(7, 0x0100, "example.com");
+    std::vector<uint8_t> stray = udp_packet("10.8.0.1", "10.0.0.2", 53, 40000, response(query, 0, 300));
+    EXPECT_FALSE(dns.on_inbound(stray.data(), packet_len(stray), 0));
+    EXPECT_EQ(src_of(stray), addr("10.8.0.1"));
+    EXPECT_EQ(dns.stats().queries.load(), 0u);
+    EXPECT_EQ(dns.cache_size(), 0u);
+}
+
+TEST_F(DnsForwarderTest, QueryAlreadyForTunnelResolverIsNotRewritten) {
+    const std::vector<uint8_t> query = question(1, 0x0100, "example.com");
+    std::vector<uint8_t> out = udp_packet("10.0.0.2", "10.8.0.1", 40000, 53, query);
+    EXPECT_EQ(send_query(dns, out, 0), Action::FORWARD);
+    EXPECT_EQ(dst_of(out), addr("10.8.0.1"));
+
+    std::vector<uint8_t> in = udp_packet("10.8.0.1", "10.0.0.2", 53, 40000, response(query, 0, 300));
+    EXPECT_TRUE(dns.on_inbound(in.data(), packet_len(in), 0));
+    EXPECT_EQ(src_of(in), addr("10.8.0.1"));
+    EXPECT_EQ(dns.cache_size(), 1u);
+}
+
+TEST(DnsForwarderNoResolverTest, ForwardsUnchangedAndStillCaches) {
+    DnsForwarder dns;
+    const std::vector<uint8_t> query = question(1, 0x0100, "example.com");
+    std::vector<uint8_t> out = udp_packet("10.0.0.2", "8.8.8.8", 40000, 53, query);
+    const std::vector<uint8_t> before = out;
+    EXPECT_EQ(send_query(dns, out, 0), Action::FORWARD);
+    EXPECT_EQ(out, before);
+
+    std::vector<uint8_t> in = udp_packet("8.8.8.8", "10.0.0.2", 53, 40000, response(query, 0, 300));
+    EXPECT_TRUE(dns.on_inbound(in.data(), packet_len(in), 0));
+    EXPECT_EQ(dns.cache_size(), 1u);
+}
+
+TEST_F(DnsForwarderTest, Ipv6QueriesUseIpv6Resolver) {
+    const std::vector<uint8_t> query = question(9, 0x0100, "example.com", 28);
+    std::vector<uint8_t> out = udp_packet("fd00::2", "2001:4860:4860::8888", 40000, 53, query);
+    EXPECT_EQ(send_query(dns, out, 0), Action::FORWARD);
+    EXPECT_EQ(dst_of(out), addr("fd00::53"));
+    EXPECT_TRUE(checksums_valid(out));
+
+    std::vector<uint8_t> in = udp_packet("fd00::53", "fd00::2", 53, 40000, response(query, 0, 300));
+    EXPECT_TRUE(dns.on_inbound(in.data(), packet_len(in), 0));
+    EXPECT_EQ(src_of(in), addr("2001:4860:4860::8888"));
+    EXPECT_TRUE(checksums_valid(in));
+
+    std::vector<uint8_t> repeat = udp_packet("fd00::2", "2001:4860:4860::8888", 40001, 53, question(10, 0x0100, "example.com", 28));
+    EXPECT_EQ(send_query(dns, repeat, SEC), Action::ANSWERED);
+    EXPECT_EQ(dst_of(repeat), addr("fd00::2"));
+    EXPECT_TRUE(checksums_valid(repeat));
+}
+
+TEST(DnsCacheTest, EvictsLeastRecentlyUsed) {
+    DnsCache cache(2);
+    std::string a, b, c;
+    const std::vector<uint8_t> qa = response(question(1, 0x0100, "a.example"), 0, 300);
+    const std::vector<uint8_t> qb = response(question(1, 0x0100, "b.example"), 0, 300);
+    const std::vector<uint8_t> qc = response(question(1, 0x0100, "c.example"), 0, 300);
+    const size_t end_a = dns_detail::question_key(qa.data(), qa.size(), a);
+    const size_t end_b = dns_detail::question_key(qb.data(), qb.size(), b);
+    const size_t end_c = dns_detail::question_key(qc.data(), qc.size(), c);
+
+    uint8_t out[512];
+    cache.insert(a, qa.data(), qa.size(), end_a, 300, 0);
+    cache.insert(b, qb.data(), qb.size(), end_b, 300, 0);
+    EXPECT_GT(cache.lookup(a, 0, out, sizeof(out)), 0u);   // a is now most recent
+    cache.insert(c, qc.data(), qc.size(), end_c, 300, 0);
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_GT(cache.lookup(a, 0, out, sizeof(out)), 0u);
+    EXPECT_EQ(cache.lookup(b, 0, out, sizeof(out)), 0u);
+    EXPECT_GT(cache.lookup(c, 0, out, sizeof(out)), 0u);
+}
+
+TEST(DnsDetailTest, RejectsMalformedMessages) {
+    std::string key;
+    std::vector<uint8_t> two = question(1, 0x0100, "example.com");
+    two[5] = 2;   // QDCOUNT
+    EXPECT_EQ(dns_detail::question_key(two.data(), two.size(), key), 0u);
+
+    std::vector<uint8_t> cut = question(1, 0x0100, "example.com");
+    cut.resize(cut.size() - 3);
+    EXPECT_EQ(dns_detail::question_key(cut.data(), cut.size(), key), 0u);
+
+    std::vector<uint8_t> bad = response(question(1, 0x0100, "example.com"), 0, 300);
+    const size_t end = dns_detail::question_key(bad.data(), bad.size(), key);
+    ASSERT_GT(end, 0u);
+    bad.resize(bad.size() - 2);   // RDATA runs past the end
+    EXPECT_EQ(dns_detail::cache_ttl(bad.data(), bad.size(), end), 0u);
+}
@@ -0,0 +1,270 @@
+/**
+ * Endpoint Cache Unit Tests
+ *
+ * Tests reading remotes from a profile, the attempt order (cached address,
+ * then live DNS, then the next remote), recording connects and failures,
+ * background refresh, maximum age, and persistence across cache instances
+ * (cold start). Resolution, the refresh thread and the clock are faked.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <string>
+#include <unistd.h>
+
+#include "endpoint_cache.h"
+#include "nordvpn_profile_sample.h"
+
+using openvpn::EndpointAttempt;
+using openvpn::EndpointCache;
+using openvpn::EndpointPlan;
+
+namespace {
+
+// Fake DNS, inline refreshes and a settable wall clock
+struct FakeNetwork {
+    std::map<std::string, std::string> dns;
+    int lookups = 0;
+    int64_t now = 1000000;
+
+    EndpointCache::Resolver resolver() {
+        return [this](const std::string& host) { lookups++; return dns[host]; };
+    }
+    EndpointCache::Executor inline_executor() {
+        return [](std::function<void()> task) { task(); };
+    }
+    EndpointCache::Clock clock() {
+        return [this] { return now; };
+    }
+};
+
+std::string make_temp_path() {
+    char path[] = "/tmp/endpoint_cache_testXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return std::string();
+    }
+    close(fd);
+    unlink(path);
+    return path;
+}
+
+const char* TWO_REMOTES =
+    "client\n"
+    "proto udp\n"
+    "port 443\n"
+    "remote vpn1.example.com\n"
+    "remote vpn2.example.com 1194 tcp  # fallback\n"
+    "<ca>\n"
+    "remote not-a-directive.example.com\n"
+    "</ca>\n";
+
+} // namespace
+
+TEST(EndpointCacheTest, PlanReadsRemotesWithDefaults) {
+    EndpointPlan plan = EndpointPlan::from_profile(TWO_REMOTES);
+    ASSERT_EQ(plan.remotes().size(), 2u);
+    EXPECT_EQ(plan.remotes()[0].host, "vpn1.example.com");
+    EXPECT_EQ(plan.remotes()[0].port, "443");
+    EXPECT_EQ(plan.remotes()[0].proto, "udp");
+    EXPECT_EQ(plan.remotes()[1].port, "1194");
+    EXPECT_EQ(plan.remotes()[1].proto, "tcp");
+
+    EndpointPlan nord = EndpointPlan::from_profile(nordvpn_profile_sample());
+    ASSERT_EQ(nord.remotes().size(), 1u);
+    EXPECT_EQ(nord.remotes()[0].host, "185.169.255.9");
+
+    EXPECT_TRUE(EndpointPlan::from_profile("client\n<connection>\nremote a.example.com\n</connection>\n").empty());
+}
+
+TEST(EndpointCacheTest, ColdCacheResolvesLiveAndRecordsTheConnect) {
+    FakeNetwork net;
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    EndpointPlan plan = EndpointPlan::from_profile(TWO_REMOTES);
+
+    EndpointAttempt attempt;
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_EQ(attempt.host, "vpn1.example.com");
+    EXPECT_TRUE(attempt.ip.empty());
+    EXPECT_FALSE(attempt.cached);
+    EXPECT_EQ(cache.misses(), 1u);
+
+    plan.on_connected(cache, "203.0.113.10");
+    std::string ip;
+    ASSERT_TRUE(cache.lookup("vpn1.example.com", ip));
+    EXPECT_EQ(ip, "203.0.113.10");
+    EXPECT_EQ(net.lookups, 0);
+}
+
+TEST(EndpointCacheTest, WarmCacheConnectsAtCachedAddressAndRefreshes) {
+    FakeNetwork net;
+    net.dns["vpn1.example.com"] = "203.0.113.20";
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    cache.record_success("vpn1.example.com", "203.0.113.10");
+    EndpointPlan plan = EndpointPlan::from_profile(TWO_REMOTES);
+
+    EndpointAttempt attempt;
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_TRUE(attempt.cached);
+    EXPECT_EQ(attempt.ip, "203.0.113.10");
+    EXPECT_EQ(cache.hits(), 1u);
+
+    // The refresh found a new address for the next connect
+    EXPECT_EQ(net.lookups, 1);
+    EXPECT_EQ(cache.refreshes(), 1u);
+    std::string ip;
+    ASSERT_TRUE(cache.lookup("vpn1.example.com", ip));
+    EXPECT_EQ(ip, "203.0.113.20");
+}
+
+TEST(EndpointCacheTest, FailedCachedAddressFallsBackToLiveDnsThenNextRemote) {
+    FakeNetwork net;
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    cache.record_success("vpn1.example.com", "203.0.113.10");
+    EndpointPlan plan = EndpointPlan::from_profile(TWO_REMOTES);
+
+    EndpointAttempt attempt;
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_TRUE(attempt.cached);
+
+    // The cached address did not connect: dropped, same host retried with DNS
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_EQ(attempt.host, "vpn1.example.com");
+    EXPECT_FALSE(attempt.cached);
+    EXPECT_EQ(cache.failures(), 1u);
+    std::string ip;
+    EXPECT_FALSE(cache.lookup("vpn1.example.com", ip));
+
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_EQ(attempt.host, "vpn2.example.com");
+    EXPECT_EQ(attempt.proto, "tcp");
+
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_EQ(attempt.host, "vpn1.example.com");
+}
+
+TEST(EndpointCacheTest, ReconnectAfterSuccessStartsAtTheSameRemote) {
+    FakeNetwork net;
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    EndpointPlan plan = EndpointPlan::from_profile(TWO_REMOTES);
+
+    EndpointAttempt attempt;
+    plan.next(cache, attempt);
+    plan.next(cache, attempt);
+    ASSERT_EQ(attempt.host, "vpn2.example.com");
+    plan.on_connected(cache, "198.51.100.7");
+
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_EQ(attempt.host, "vpn2.example.com");
+    EXPECT_EQ(attempt.ip, "198.51.100.7");
+    EXPECT_TRUE(attempt.cached);
+}
+
+TEST(EndpointCacheTest, IpLiteralRemotesAreNotCached) {
+    FakeNetwork net;
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    EndpointPlan plan = EndpointPlan::from_profile(nordvpn_profile_sample());
+
+    EndpointAttempt attempt;
+    ASSERT_TRUE(plan.next(cache, attempt));
+    EXPECT_EQ(attempt.host, "185.169.255.9");
+    EXPECT_FALSE(attempt.cached);
+    plan.on_connected(cache, "185.169.255.9");
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.misses(), 0u);
+}
+
+TEST(EndpointCacheTest, OldEntriesAreNotServedAndCapacityEvictsLeastRecent) {
+    FakeNetwork net;
+    EndpointCache cache(2, 3600, net.resolver(), net.inline_executor(), net.clock());
+    cache.record_success("a.example.com", "192.0.2.1");
+    cache.record_success("b.example.com", "192.0.2.2");
+
+    std::string ip;
+    net.now += 3601;
+    EXPECT_FALSE(cache.lookup("a.example.com", ip));
+
+    cache.record_success("b.example.com", "192.0.2.2");
+    cache.record_success("c.example.com", "192.0.2.3");
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.lookup("b.example.com", ip));
+    EXPECT_TRUE(cache.lookup("c.example.com", ip));
+}
+
+TEST(EndpointCacheTest, FailureOnlyDropsTheAddressThatFailed) {
+    FakeNetwork net;
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    cache.record_success("vpn1.example.com", "203.0.113.20");
+    cache.record_failure("vpn1.example.com", "203.0.113.10");
+
+    std::string ip;
+    EXPECT_TRUE(cache.lookup("vpn1.example.com", ip));
+    EXPECT_EQ(cache.failures(), 0u);
+}
+
+TEST(EndpointCacheTest, RefreshIsSkippedWhileOneIsInFlight) {
+    FakeNetwork net;
+    std::function<void()> pending;
+    EndpointCache cache(8, 3600, net.resolver(),
+                        [&](std::function<void()> task) { pending = std::move(task); }, net.clock());
+    net.dns["vpn1.example.com"] = "203.0.113.20";
+
+    cache.refresh_async("vpn1.example.com");
+    std::function<void()> first = pending;
+    pending = nullptr;
+    cache.refresh_async("vpn1.example.com");
+    EXPECT_FALSE(pending);
+
+    first();
+    EXPECT_EQ(cache.refreshes(), 1u);
+    cache.refresh_async("vpn1.example.com");
+    EXPECT_TRUE(pending);
+}
+
+TEST(EndpointCacheTest, EntriesSurviveAColdStart) {
+    const std::string path = make_temp_path();
+    ASSERT_FALSE(path.empty());
+    FakeNetwork net;
+    {
+        EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+        cache.set_storage_path(path);
+        cache.record_success("vpn1.example.com", "203.0.113.10");
+        cache.record_success("vpn6.example.com", "2001:db8::1");
+    }
+
+    EndpointCache restarted(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    restarted.set_storage_path(path);
+    std::string ip;
+    ASSERT_TRUE(restarted.lookup("vpn1.example.com", ip));
+    EXPECT_EQ(ip, "203.0.113.10");
+    ASSERT_TRUE(restarted.lookup("vpn6.example.com", ip));
+    EXPECT_EQ(ip, "2001:db8::1");
+
+    // Age carries over the restart
+    net.now += 3601;
+    EndpointCache later(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    later.set_storage_path(path);
+    EXPECT_FALSE(later.lookup("vpn1.example.com", ip));
+
+    restarted.clear();
+    EndpointCache cleared(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    cleared.set_storage_path(path);
+    EXPECT_EQ(cleared.size(), 0u);
+}
+
+TEST(EndpointCacheTest, MalformedFileLinesAreSkipped) {
+    const std::string path = make_temp_path();
+    ASSERT_FALSE(path.empty());
+    FILE* file = fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    fputs("vpn1.example.com 203.0.113.10 1000000\ngarbage\nvpn2.example.com not-an-ip 5\nvpn3.example.com 192.0.2.3\n", file);
+    fclose(file);
+
+    FakeNetwork net;
+    EndpointCache cache(8, 3600, net.resolver(), net.inline_executor(), net.clock());
+    cache.set_storage_path(path);
+    EXPECT_EQ(cache.size(), 1u);
+    cache.clear();
+}
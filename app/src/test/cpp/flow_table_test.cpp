@@ -0,0 +1,203 @@
+/**
+ * Flow Table Unit Tests
+ *
+ * Tests the open-addressing flow table behind NativePacketRouter: lookups,
+ * TTL expiry, clock-sweep aging, LRU eviction within a probe window,
+ * bulk clears, and lock-free reads racing a writer.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "flow_table.h"
+
+using openvpn::FlowKey;
+using openvpn::FlowTable;
+
+namespace {
+
+FlowKey make_key(uint32_t n) {
+    FlowKey key{};
+    key.family = 4;
+    key.protocol = 6;
+    key.src[0] = 10;
+    key.src[1] = static_cast<uint8_t>(n >> 16);
+    key.src[2] = static_cast<uint8_t>(n >> 8);
+    key.src[3] = static_cast<uint8_t>(n);
+    key.src_port = static_cast<uint16_t>(1024 + (n & 0x7FFF));
+    key.dst_port = 443;
+    return key;
+}
+
+} // namespace
+
+TEST(FlowTableTest, InsertLookupAndReplace) {
+    FlowTable table(64, 1000);
+    FlowTable::Match match;
+    EXPECT_FALSE(table.lookup(make_key(1), 0, match));
+
+    ASSERT_TRUE(table.insert(make_key(1), 3, 10000, 0));
+    ASSERT_TRUE(table.lookup(make_key(1), 10, match));
+    EXPECT_EQ(match.tunnel_index, 3);
+    EXPECT_EQ(match.uid, 10000);
+
+    // Re-learning a flow replaces it in place
+    table.insert(make_key(1), 5, 10001, 20);
+    ASSERT_TRUE(table.lookup(make_key(1), 30, match));
+    EXPECT_EQ(match.tunnel_index, 5);
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(FlowTableTest, IdleEntriesExpireAndLookupsRefreshThem) {
+    FlowTable table(4, 100);
+    table.insert(make_key(1), 3, 10000, 0);
+
+    FlowTable::Match match;
+    EXPECT_TRUE(table.lookup(make_key(1), 90, match));
+
+    // The lookup at 90 refreshed the entry
+    EXPECT_TRUE(table.lookup(make_key(1), 180, match));
+    EXPECT_FALSE(table.lookup(make_key(1), 281, match));
+}
+
+TEST(FlowTableTest, FullWindowEvictsLeastRecentlySeen) {
+    FlowTable table(2, 100);
+
+    ASSERT_TRUE(table.insert(make_key(0), 0, 1, 0));
+    ASSERT_TRUE(table.insert(make_key(1), 1, 1, 10));
+    FlowTable::Match match;
+    ASSERT_TRUE(table.lookup(make_key(0), 50, match));   // key 0 now most recent
+
+    ASSERT_TRUE(table.insert(make_key(2), 2, 1, 60));
+    EXPECT_EQ(table.evictions(), 1u);
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_TRUE(table.lookup(make_key(0), 70, match));
+    EXPECT_FALSE(table.lookup(make_key(1), 70, match));
+    EXPECT_TRUE(table.lookup(make_key(2), 70, match));
+}
+
+TEST(FlowTableTest, ExpiredSlotsAreReusedBeforeEvicting) {
+    FlowTable table(2, 100);
+    table.insert(make_key(0), 0, 1, 0);
+    table.insert(make_key(1), 1, 1, 50);
+
+    table.insert(make_key(2), 2, 1, 120);                // key 0 idle for 120ms
+    EXPECT_EQ(table.evictions(), 0u);
+    FlowTable::Match match;
+    EXPECT_TRUE(table.lookup(make_key(1), 130, match));
+    EXPECT_TRUE(table.lookup(make_key(2), 130, match));
+}
+
+TEST(FlowTableTest, ClockSweepAgesOutIdleFlowsIncrementally) {
+    FlowTable table(64, 100);
+    for (uint32_t i = 0; i < 20; ++i) {
+        table.insert(make_key(i), 0, 1, 0);
+    }
+    EXPECT_EQ(table.size(), 20u);
+
+    // Each sweep step only visits a bounded number of slots
+    table.sweep(1000, 16);
+    EXPECT_GT(table.size(), 0u);
+    table.sweep(1000, table.capacity());
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(FlowTableTest, EraseUidAndTunnelAndKey) {
+    FlowTable table(64, 1000);
+    for (uint32_t i = 0; i < 10; ++i) {
+        table.insert(make_key(i), static_cast<int32_t>(i % 2), static_cast<int32_t>(10000 + i % 3), 0);
+    }
+
+    EXPECT_EQ(table.erase_uid(10000), 4u);    // i = 0, 3, 6, 9
+    EXPECT_EQ(table.size(), 6u);
+    EXPECT_EQ(table.erase_tunnel(1), 3u);     // i = 1, 5, 7
+    EXPECT_TRUE(table.erase(make_key(2)));
+    EXPECT_FALSE(table.erase(make_key(2)));
+
+    FlowTable::Match match;
+    EXPECT_TRUE(table.lookup(make_key(4), 1, match));
+    EXPECT_FALSE(table.lookup(make_key(1), 1, match));
+
+    table.clear();
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_FALSE(table.lookup(make_key(4), 1, match));
+}
+
+TEST(FlowTableTest, CountsLiveFlowsPerTunnel) {
+    FlowTable table(64, 100);
+    for (uint32_t i = 0; i < 6; ++i) {
+        table.insert(make_key(i), static_cast<int32_t>(i % 3), 10000, i < 4 ? 0 : 50);
+    }
+
+    EXPECT_EQ(table.count_tunnel(0, 60), 2u);   // i = 0, 3
+    EXPECT_EQ(table.count_tunnel(1, 60), 2u);   // i = 1, 4
+    EXPECT_EQ(table.count_tunnel(7, 60), 0u);
+
+    // Flows idle past the TTL stop counting even before a sweep removes them
+    EXPECT_EQ(table.count_tunnel(0, 120), 0u);
+    EXPECT_EQ(table.count_tunnel(1, 120), 1u);  // i = 4
+    EXPECT_EQ(table.count_tunnel(2, 120), 1u);  // i = 5
+}
+
+TEST(FlowTableTest, ManyFlowsStayReachableAfterChurn) {
+    FlowTable table(1024, 1000000);
+    for (uint32_t i = 0; i < 600; ++i) {
+        ASSERT_TRUE(table.insert(make_key(i), static_cast<int32_t>(i % 7), static_cast<int32_t>(i), 0));
+    }
+    for (uint32_t i = 0; i < 600; i += 2) {
+        table.erase(make_key(i));
+    }
+    for (uint32_t i = 600; i < 900; ++i) {
+        table.insert(make_key(i), static_cast<int32_t>(i % 7), static_cast<int32_t>(i), 0);
+    }
+
+    size_t found = 0;
+    FlowTable::Match match;
+    for (uint32_t i = 1; i < 600; i += 2) {
+        found += table.lookup(make_key(i), 1, match) && match.uid == static_cast<int32_t>(i);
+    }
+    for (uint32_t i = 600; i < 900; ++i) {
+        found += table.lookup(make_key(i), 1, match) && match.uid == static_cast<int32_t>(i);
+    }
+    // 600 live flows in 1024 slots: bounded probing may evict a few
+    EXPECT_GE(found + table.evictions(), 600u);
+    EXPECT_GT(found, 580u);
+}
+
+TEST(FlowTableTest, ReadersNeverSeeTornEntries) {
+    FlowTable table(256, 1000000);
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+
+    // Every entry is written with tunnel_index == uid, so a mismatch means a torn read
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            FlowTable::Match match;
+            while (!done.load()) {
+                for (uint32_t i = 0; i < 64; ++i) {
+                    if (table.lookup(make_key(i), 1, match) && match.tunnel_index != match.uid) {
+                        torn.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 2000; ++round) {
+        for (uint32_t i = 0; i < 64; ++i) {
+            const int32_t value = round * 64 + static_cast<int32_t>(i);
+            table.insert(make_key(i), value, value, 0);
+        }
+        if (round % 100 == 0) {
+            table.clear();
+        }
+    }
+    done.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(torn.load(), 0u);
+}
@@ -0,0 +1,156 @@
+/**
+ * IO Lane Pool Unit Tests
+ *
+ * Tests placement of tunnel event-loop threads onto core lanes: least-loaded
+ * assignment, manual migration, utilization sampling and rebalancing. CPU time
+ * and pinning are faked so results do not depend on the host scheduler.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+#include "io_lane_pool.h"
+
+using openvpn::IoLanePool;
+using openvpn::IoLaneStats;
+
+namespace {
+
+constexpr uint64_t MS = 1000000ull;
+
+// Fake per-thread CPU clocks and a record of the last core each tid was pinned to
+struct FakeScheduler {
+    std::map<pthread_t, uint64_t> cpu_ns;
+    std::map<pid_t, int> pinned;
+
+    IoLanePool make_pool(std::vector<int> cpus) {
+        return IoLanePool(
+            std::move(cpus),
+            [this](pthread_t thread) { return cpu_ns[thread]; },
+            [this](pid_t tid, int cpu) { pinned[tid] = cpu; return true; });
+    }
+};
+
+pthread_t thread_id(int n) { return static_cast<pthread_t>(n); }
+
+} // namespace
+
+TEST(IoLanePoolTest, DisabledByDefault) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({0, 1});
+    EXPECT_FALSE(pool.enabled());
+    EXPECT_EQ(pool.join_current_thread("uk"), -1);
+    EXPECT_EQ(pool.lane_of("uk"), -1);
+    EXPECT_TRUE(sched.pinned.empty());
+}
+
+TEST(IoLanePoolTest, NewTunnelsSpreadAcrossLanes) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({2, 3, 5});
+
+    EXPECT_EQ(pool.join("uk", thread_id(1), 101, 0), 0);
+    EXPECT_EQ(pool.join("fr", thread_id(2), 102, 0), 1);
+    EXPECT_EQ(pool.join("de", thread_id(3), 103, 0), 2);
+    EXPECT_EQ(pool.join("us", thread_id(4), 104, 0), 0);
+
+    EXPECT_EQ(sched.pinned[101], 2);
+    EXPECT_EQ(sched.pinned[102], 3);
+    EXPECT_EQ(sched.pinned[103], 5);
+    EXPECT_EQ(sched.pinned[104], 2);
+
+    std::vector<IoLaneStats> stats = pool.stats();
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].tunnels, 2u);
+    EXPECT_EQ(stats[1].tunnels, 1u);
+    EXPECT_EQ(stats[2].cpu, 5);
+
+    // A freed slot is reused by the next tunnel
+    pool.leave("fr");
+    EXPECT_EQ(pool.lane_of("fr"), -1);
+    EXPECT_EQ(pool.join("jp", thread_id(5), 105, 0), 1);
+}
+
+TEST(IoLanePoolTest, RejoinReplacesPreviousThread) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({0, 1});
+
+    pool.join("uk", thread_id(1), 101, 0);
+    pool.join("uk", thread_id(2), 102, 0);
+
+    std::vector<IoLaneStats> stats = pool.stats();
+    EXPECT_EQ(stats[0].tunnels + stats[1].tunnels, 1u);
+}
+
+TEST(IoLanePoolTest, MigrateRepinsThread) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({0, 1});
+    pool.join("uk", thread_id(1), 101, 0);
+
+    EXPECT_TRUE(pool.migrate("uk", 1));
+    EXPECT_EQ(pool.lane_of("uk"), 1);
+    EXPECT_EQ(sched.pinned[101], 1);
+    EXPECT_EQ(pool.migrations(), 1u);
+
+    EXPECT_FALSE(pool.migrate("uk", 2));
+    EXPECT_FALSE(pool.migrate("missing", 0));
+    EXPECT_EQ(pool.stats()[0].tunnels, 0u);
+    EXPECT_EQ(pool.stats()[1].tunnels, 1u);
+}
+
+TEST(IoLanePoolTest, SampleMeasuresUtilization) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({0, 1});
+    pool.join("uk", thread_id(1), 101, 0);
+    pool.join("fr", thread_id(2), 102, 0);
+
+    // 100 ms wall: uk used 30 ms of CPU, fr used 10 ms
+    sched.cpu_ns[thread_id(1)] = 30 * MS;
+    sched.cpu_ns[thread_id(2)] = 10 * MS;
+    EXPECT_EQ(pool.sample(100 * MS), 0);
+
+    std::vector<IoLaneStats> stats = pool.stats();
+    EXPECT_EQ(stats[0].utilization_permille, 300u);
+    EXPECT_EQ(stats[1].utilization_permille, 100u);
+}
+
+TEST(IoLanePoolTest, RebalancesHotLane) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({0, 1});
+    pool.join("uk", thread_id(1), 101, 0);
+    pool.join("fr", thread_id(2), 102, 0);
+    pool.join("de", thread_id(3), 103, 0);
+    ASSERT_EQ(pool.lane_of("uk"), 0);
+    ASSERT_EQ(pool.lane_of("de"), 0);
+
+    // Lane 0 carries uk (60%) and de (30%); lane 1 carries an idle fr
+    sched.cpu_ns[thread_id(1)] = 60 * MS;
+    sched.cpu_ns[thread_id(3)] = 30 * MS;
+    EXPECT_EQ(pool.sample(100 * MS), 1);
+
+    // Either move leaves a 600 peak; the first candidate that lowers it wins
+    EXPECT_EQ(pool.lane_of("de"), 1);
+    EXPECT_EQ(sched.pinned[103], 1);
+    std::vector<IoLaneStats> stats = pool.stats();
+    EXPECT_EQ(stats[0].utilization_permille, 600u);
+    EXPECT_EQ(stats[1].utilization_permille, 300u);
+    EXPECT_EQ(stats[0].tunnels + stats[1].tunnels, 3u);
+    EXPECT_EQ(pool.migrations(), 1u);
+
+    // Gap is now within REBALANCE_GAP_PERMILLE: no further moves
+    sched.cpu_ns[thread_id(1)] += 60 * MS;
+    sched.cpu_ns[thread_id(3)] += 30 * MS;
+    EXPECT_EQ(pool.sample(200 * MS), 0);
+    EXPECT_EQ(pool.migrations(), 1u);
+}
+
+TEST(IoLanePoolTest, SingleBusyTunnelStaysPut) {
+    FakeScheduler sched;
+    IoLanePool pool = sched.make_pool({0, 1});
+    pool.join("uk", thread_id(1), 101, 0);
+
+    // Moving the only tunnel would not lower the peak
+    sched.cpu_ns[thread_id(1)] = 90 * MS;
+    EXPECT_EQ(pool.sample(100 * MS), 0);
+    EXPECT_EQ(pool.lane_of("uk"), 0);
+}
@@ -0,0 +1,42 @@
+/**
+ * Release Logging Unit Tests
+ *
+ * Compiled with LOGGING_LEVEL_RELEASE against the android/log.h stub to verify
+ * that hot-path and info logging compile to nothing in RELEASE builds.
+ */
+
+#include <gtest/gtest.h>
+
+#include "logging_config.h"
+
+static_assert(LOGGING_HOT_PATH_ENABLED == 0, "LOG_HOT_PATH must be compiled out in RELEASE");
+static_assert(LOGGING_INFO_ENABLED == 0, "LOG_INFO must be compiled out in RELEASE");
+
+class ReleaseLoggingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        g_android_log_calls = 0;
+    }
+};
+
+TEST_F(ReleaseLoggingTest, HotPathMacrosMakeNoLogCalls) {
+    for (int i = 0; i < 1000; ++i) {
+        LOG_HOT_PATH("Test", "packet %d", i);
+        LOG_PACKET("Test", "packet %d", i);
+        LOG_INFO("Test", "packet %d", i);
+        LOG_DEBUG("Test", "packet %d", i);
+    }
+    EXPECT_EQ(g_android_log_calls, 0);
+}
+
+TEST_F(ReleaseLoggingTest, HotPathArgumentsAreNotEvaluated) {
+    int evaluations = 0;
+    LOG_HOT_PATH("Test", "%d", ++evaluations);
+    LOG_INFO("Test", "%d", ++evaluations);
+    EXPECT_EQ(evaluations, 0) << "Compiled-out macros must not evaluate their arguments";
+}
+
+TEST_F(ReleaseLoggingTest, ErrorsAreStillLogged) {
+    LOG_ERROR("Test", "write failed: %d", 11);
+    EXPECT_EQ(g_android_log_calls, 1);
+}
@@ -0,0 +1,182 @@
+/**
+ * Native Packet Router Unit Tests
+ *
+ * Tests in-place 5-tuple parsing for IPv4/IPv6 TCP/UDP packets and the
+ * routing decisions behind NativePacketRouter.nativeClassify().
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "native_packet_router.h"
+
+using openvpn::ClassifyResult;
+using openvpn::FlowKey;
+using openvpn::NativePacketRouter;
+using openvpn::classify_packet;
+
+namespace {
+
+std::vector<uint8_t> ipv4_packet(uint8_t protocol, uint16_t src_port, uint16_t dst_port,
+                                 uint8_t last_src_octet = 2) {
+    std::vector<uint8_t> p(40, 0);
+    p[0] = 0x45;                 // IPv4, IHL 5
+    p[9] = protocol;
+    p[12] = 10; p[13] = 100; p[14] = 0; p[15] = last_src_octet;
+    p[16] = 93; p[17] = 184; p[18] = 216; p[19] = 34;
+    p[20] = src_port >> 8; p[21] = src_port & 0xFF;
+    p[22] = dst_port >> 8; p[23] = dst_port & 0xFF;
+    return p;
+}
+
+std::vector<uint8_t> ipv6_packet(uint8_t next_header, uint16_t src_port, uint16_t dst_port) {
+    std::vector<uint8_t> p(48, 0);
+    p[0] = 0x60;
+    p[6] = next_header;
+    p[8] = 0xFD;                 // src fd00::1
+    p[23] = 1;
+    p[24] = 0x20; p[25] = 0x01;  // dst 2001::2
+    p[39] = 2;
+    p[40] = src_port >> 8; p[41] = src_port & 0xFF;
+    p[42] = dst_port >> 8; p[43] = dst_port & 0xFF;
+    return p;
+}
+
+} // namespace
+
+TEST(PacketClassifierTest, ParsesIpv4Tcp) {
+    auto p = ipv4_packet(6, 40000, 443);
+    FlowKey key;
+    ASSERT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::OK);
+
+    EXPECT_EQ(key.family, 4);
+    EXPECT_EQ(key.protocol, 6);
+    EXPECT_EQ(key.src_port, 40000);
+    EXPECT_EQ(key.dst_port, 443);
+    EXPECT_EQ(key.src[0], 10);
+    EXPECT_EQ(key.src[3], 2);
+    EXPECT_EQ(key.src[4], 0);    // Unused IPv6 bytes stay zero
+    EXPECT_EQ(key.dst[0], 93);
+}
+
+TEST(PacketClassifierTest, HonoursIpv4Options) {
+    std::vector<uint8_t> p(48, 0);
+    p[0] = 0x46;                 // IHL 6: 4 bytes of options
+    p[9] = 17;
+    p[24] = 0x13; p[25] = 0x88;  // 5000
+    p[26] = 0x00; p[27] = 0x35;  // 53
+
+    FlowKey key;
+    ASSERT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::OK);
+    EXPECT_EQ(key.src_port, 5000);
+    EXPECT_EQ(key.dst_port, 53);
+}
+
+TEST(PacketClassifierTest, NonFirstIpv4FragmentHasNoPorts) {
+    auto p = ipv4_packet(17, 1234, 53);
+    p[6] = 0x00; p[7] = 0x10;    // Fragment offset 16
+
+    FlowKey key;
+    ASSERT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::OK);
+    EXPECT_EQ(key.protocol, 17);
+    EXPECT_EQ(key.src_port, 0);
+    EXPECT_EQ(key.dst_port, 0);
+}
+
+TEST(PacketClassifierTest, ParsesIpv6Udp) {
+    auto p = ipv6_packet(17, 5353, 53);
+    FlowKey key;
+    ASSERT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::OK);
+
+    EXPECT_EQ(key.family, 6);
+    EXPECT_EQ(key.protocol, 17);
+    EXPECT_EQ(key.src_port, 5353);
+    EXPECT_EQ(key.dst_port, 53);
+    EXPECT_EQ(key.src[0], 0xFD);
+    EXPECT_EQ(key.dst[15], 2);
+}
+
+TEST(PacketClassifierTest, WalksIpv6ExtensionHeaders) {
+    // Hop-by-hop header (8 bytes) in front of TCP
+    std::vector<uint8_t> p(56, 0);
+    p[0] = 0x60;
+    p[6] = 0;                    // Hop-by-hop
+    p[40] = 6;                   // Next: TCP
+    p[41] = 0;                   // Length: 8 bytes
+    p[48] = 0x1F; p[49] = 0x90;  // 8080
+    p[50] = 0x00; p[51] = 0x50;  // 80
+
+    FlowKey key;
+    ASSERT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::OK);
+    EXPECT_EQ(key.protocol, 6);
+    EXPECT_EQ(key.src_port, 8080);
+    EXPECT_EQ(key.dst_port, 80);
+}
+
+TEST(PacketClassifierTest, RejectsTruncatedAndUnknownPackets) {
+    FlowKey key;
+    auto p = ipv4_packet(6, 1, 2);
+    EXPECT_EQ(classify_packet(p.data(), 19, key), ClassifyResult::TOO_SHORT);
+    EXPECT_EQ(classify_packet(p.data(), 22, key), ClassifyResult::TOO_SHORT);
+
+    auto v6 = ipv6_packet(6, 1, 2);
+    EXPECT_EQ(classify_packet(v6.data(), 39, key), ClassifyResult::TOO_SHORT);
+
+    p[0] = 0x55;
+    EXPECT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::BAD_VERSION);
+
+    p[0] = 0x44;                 // IHL below minimum
+    EXPECT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::BAD_HEADER);
+}
+
+TEST(PacketClassifierTest, IcmpClassifiesWithoutPorts) {
+    auto p = ipv4_packet(1, 0x0800, 0x1234);
+    FlowKey key;
+    ASSERT_EQ(classify_packet(p.data(), p.size(), key), ClassifyResult::OK);
+    EXPECT_EQ(key.protocol, 1);
+    EXPECT_EQ(key.src_port, 0);
+}
+
+TEST(NativePacketRouterTest, RoutesLearnedFlows) {
+    NativePacketRouter router;
+    const int uk = router.register_tunnel("nordvpn_UK");
+    const int fr = router.register_tunnel("nordvpn_FR");
+    EXPECT_NE(uk, fr);
+    EXPECT_EQ(router.register_tunnel("nordvpn_UK"), uk);
+    EXPECT_EQ(router.tunnel_id(fr), "nordvpn_FR");
+    EXPECT_EQ(router.tunnel_id(99), "");
+
+    auto a = ipv4_packet(6, 40000, 443);
+    auto b = ipv4_packet(6, 40001, 443);
+    EXPECT_EQ(router.route(a.data(), a.size(), 0), NativePacketRouter::ROUTE_MISS);
+
+    ASSERT_TRUE(router.learn(a.data(), a.size(), uk, 10123, 0));
+    ASSERT_TRUE(router.learn(b.data(), b.size(), fr, 10456, 0));
+    EXPECT_EQ(router.route(a.data(), a.size(), 10), uk);
+    EXPECT_EQ(router.route(b.data(), b.size(), 10), fr);
+
+    openvpn::FlowTable::Match match;
+    ASSERT_TRUE(router.lookup(b.data(), b.size(), 10, match));
+    EXPECT_EQ(match.tunnel_index, fr);
+    EXPECT_EQ(match.uid, 10456);
+
+    uint8_t garbage[4] = {0xFF, 0, 0, 0};
+    EXPECT_EQ(router.route(garbage, sizeof(garbage), 10), NativePacketRouter::ROUTE_PARSE_ERROR);
+    EXPECT_FALSE(router.learn(garbage, sizeof(garbage), uk, 1, 0));
+}
+
+TEST(NativePacketRouterTest, ForgetUidDropsOnlyThatAppsFlows) {
+    NativePacketRouter router;
+    auto a = ipv4_packet(17, 1000, 53);
+    auto b = ipv4_packet(17, 1001, 53);
+    router.learn(a.data(), a.size(), 0, 10123, 0);
+    router.learn(b.data(), b.size(), 1, 10456, 0);
+
+    EXPECT_EQ(router.flows().erase_uid(10123), 1u);
+    EXPECT_EQ(router.route(a.data(), a.size(), 0), NativePacketRouter::ROUTE_MISS);
+    EXPECT_EQ(router.route(b.data(), b.size(), 0), 1);
+
+    router.flows().clear();
+    EXPECT_EQ(router.flows().size(), 0u);
+}
@@ -0,0 +1,202 @@
+/**
+ * Network Handoff Unit Tests
+ *
+ * Tests the pieces behind moving a tunnel to a new network without a full
+ * reconnect: rebinding a connected UDP socket in place, the ICMP probe that
+ * floats the peer, and the tracker that measures the handoff gap and
+ * escalates silent rebinds to a reconnect.
+ */
+
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "network_handoff.h"
+
+using openvpn::NetworkHandoffTracker;
+using Poll = openvpn::NetworkHandoffTracker::Poll;
+
+namespace {
+
+int bound_udp_socket(sockaddr_in& addr) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    addr = sockaddr_in{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    return fd;
+}
+
+// Packed value for row `row`, field `field`
+int64_t packed_field(const std::vector<int64_t>& packed, size_t row, size_t field) {
+    return packed[3 + row * openvpn::HANDOFF_FIELD_COUNT + field];
+}
+
+} // namespace
+
+TEST(RebindUdpSocketTest, KeepsPeerAndDelivery) {
+    sockaddr_in server{};
+    const int server_fd = bound_udp_socket(server);
+    const int client_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_EQ(connect(client_fd, reinterpret_cast<sockaddr*>(&server), sizeof(server)), 0);
+
+    ASSERT_TRUE(openvpn::rebind_udp_socket(client_fd));
+
+    sockaddr_in peer{};
+    socklen_t peer_len = sizeof(peer);
+    ASSERT_EQ(getpeername(client_fd, reinterpret_cast<sockaddr*>(&peer), &peer_len), 0);
+    EXPECT_EQ(peer.sin_port, server.sin_port);
+    EXPECT_EQ(peer.sin_addr.s_addr, server.sin_addr.s_addr);
+
+    const char payload[] = "ping";
+    ASSERT_EQ(send(client_fd, payload, sizeof(payload), 0), static_cast<ssize_t>(sizeof(payload)));
+    char received[16] = {};
+    EXPECT_EQ(recv(server_fd, received, sizeof(received), 0), static_cast<ssize_t>(sizeof(payload)));
+    EXPECT_STREQ(received, payload);
+
+    close(client_fd);
+    close(server_fd);
+}
+
+TEST(RebindUdpSocketTest, RejectsUnconnectedAndNonUdpSockets) {
+    EXPECT_FALSE(openvpn::rebind_udp_socket(-1));
+
+    const int unconnected = socket(AF_INET, SOCK_DGRAM, 0);
+    EXPECT_FALSE(openvpn::rebind_udp_socket(unconnected));
+    close(unconnected);
+
+    const int tcp = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_FALSE(openvpn::rebind_udp_socket(tcp));
+    close(tcp);
+}
+
+TEST(IcmpProbeTest, BuildsValidEchoRequest) {
+    const std::vector<uint8_t> packet = openvpn::build_icmp_echo("10.8.0.6", "10.8.0.1", 0x1234, 1);
+    ASSERT_EQ(packet.size(), 28u);
+    EXPECT_EQ(packet[0], 0x45);
+    EXPECT_EQ(packet[9], 1);   // ICMP
+    EXPECT_EQ(packet[20], 8);  // Echo request
+    EXPECT_EQ(packet[24], 0x12);
+    EXPECT_EQ(packet[25], 0x34);
+
+    // A correct checksum sums (with itself included) to zero
+    EXPECT_EQ(openvpn::detail::inet_checksum(packet.data(), 20), 0);
+    EXPECT_EQ(openvpn::detail::inet_checksum(packet.data() + 20, 8), 0);
+
+    in_addr src{};
+    inet_pton(AF_INET, "10.8.0.6", &src);
+    EXPECT_EQ(memcmp(packet.data() + 12, &src, 4), 0);
+}
+
+TEST(IcmpProbeTest, EmptyWithoutIpv4Addresses) {
+    EXPECT_TRUE(openvpn::build_icmp_echo("", "10.8.0.1", 1, 1).empty());
+    EXPECT_TRUE(openvpn::build_icmp_echo("10.8.0.6", "fd00::1", 1, 1).empty());
+}
+
+TEST(NetworkHandoffTest, EligibleOnlyForFloatingUdp) {
+    openvpn::TransportTraits traits;
+    traits.udp = true;
+    EXPECT_FALSE(openvpn::rebind_eligible(traits));
+    traits.peer_id = true;
+    EXPECT_TRUE(openvpn::rebind_eligible(traits));
+    traits.udp = false;
+    EXPECT_FALSE(openvpn::rebind_eligible(traits));
+}
+
+TEST(NetworkHandoffTest, DirectionFollowsNetworkChanges) {
+    NetworkHandoffTracker tracker;
+    EXPECT_EQ(tracker.network_changed(openvpn::NETWORK_WIFI), openvpn::HANDOFF_OTHER);
+    EXPECT_EQ(tracker.network_changed(openvpn::NETWORK_CELLULAR), openvpn::HANDOFF_WIFI_TO_CELLULAR);
+    EXPECT_EQ(tracker.network_changed(openvpn::NETWORK_WIFI), openvpn::HANDOFF_CELLULAR_TO_WIFI);
+    EXPECT_EQ(tracker.network_changed(openvpn::NETWORK_OTHER), openvpn::HANDOFF_OTHER);
+}
+
+TEST(NetworkHandoffTest, RecordsGapWhenDataFlowsBack) {
+    NetworkHandoffTracker tracker(3000);
+    tracker.network_changed(openvpn::NETWORK_WIFI);
+    tracker.network_changed(openvpn::NETWORK_CELLULAR);
+
+    EXPECT_EQ(tracker.poll("uk", 10, 0), Poll::IDLE);
+    tracker.begin("uk", openvpn::HANDOFF_REBIND, 10, 1000);
+    EXPECT_EQ(tracker.pending(), 1u);
+    EXPECT_EQ(tracker.poll("uk", 10, 1100), Poll::PENDING);
+    EXPECT_EQ(tracker.poll("uk", 11, 1250), Poll::DONE);
+    EXPECT_EQ(tracker.pending(), 0u);
+
+    const std::vector<int64_t> packed = tracker.pack();
+    ASSERT_EQ(packed[1], 1);
+    EXPECT_EQ(packed[2], openvpn::HANDOFF_FIELD_COUNT);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_DIRECTION), openvpn::HANDOFF_WIFI_TO_CELLULAR);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_PATH), openvpn::HANDOFF_REBIND);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_COUNT_DONE), 1);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_LAST_MS), 250);
+}
+
+TEST(NetworkHandoffTest, SilentRebindEscalatesToReconnect) {
+    NetworkHandoffTracker tracker(3000);
+    tracker.network_changed(openvpn::NETWORK_CELLULAR);
+    tracker.network_changed(openvpn::NETWORK_WIFI);
+
+    tracker.begin("us", openvpn::HANDOFF_REBIND, 5, 0);
+    EXPECT_EQ(tracker.poll("us", 5, 2999), Poll::PENDING);
+    EXPECT_EQ(tracker.poll("us", 5, 3000), Poll::ESCALATE);
+
+    openvpn::HandoffPath path;
+    ASSERT_TRUE(tracker.pending_path("us", path));
+    EXPECT_EQ(path, openvpn::HANDOFF_RECONNECT);
+
+    // The reconnect has no deadline; its gap counts from the network change
+    EXPECT_EQ(tracker.poll("us", 5, 9000), Poll::PENDING);
+    EXPECT_EQ(tracker.poll("us", 6, 9500), Poll::DONE);
+
+    const std::vector<int64_t> packed = tracker.pack();
+    ASSERT_EQ(packed[1], 2);
+    // Rows are ordered by direction, then path
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_PATH), openvpn::HANDOFF_REBIND);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_ESCALATED), 1);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_COUNT_DONE), 0);
+    EXPECT_EQ(packed_field(packed, 1, openvpn::HANDOFF_FIELD_PATH), openvpn::HANDOFF_RECONNECT);
+    EXPECT_EQ(packed_field(packed, 1, openvpn::HANDOFF_FIELD_DIRECTION), openvpn::HANDOFF_CELLULAR_TO_WIFI);
+    EXPECT_EQ(packed_field(packed, 1, openvpn::HANDOFF_FIELD_LAST_MS), 9500);
+}
+
+TEST(NetworkHandoffTest, GivesUpAfterAbandonTimeout) {
+    NetworkHandoffTracker tracker;
+    tracker.begin("de", openvpn::HANDOFF_RECONNECT, 0, 0);
+    EXPECT_EQ(tracker.poll("de", 0, NetworkHandoffTracker::ABANDON_MS - 1), Poll::PENDING);
+    EXPECT_EQ(tracker.poll("de", 0, NetworkHandoffTracker::ABANDON_MS), Poll::ABANDONED);
+    EXPECT_EQ(tracker.pending(), 0u);
+
+    const std::vector<int64_t> packed = tracker.pack();
+    ASSERT_EQ(packed[1], 1);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_ABANDONED), 1);
+}
+
+TEST(NetworkHandoffTest, AggregatesMinMaxAndRetainsLiveTunnels) {
+    NetworkHandoffTracker tracker;
+    tracker.begin("a", openvpn::HANDOFF_RECONNECT, 0, 0);
+    tracker.poll("a", 1, 2000);
+    tracker.begin("a", openvpn::HANDOFF_RECONNECT, 1, 10000);
+    tracker.poll("a", 2, 10500);
+
+    const std::vector<int64_t> packed = tracker.pack();
+    ASSERT_EQ(packed[1], 1);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_COUNT_DONE), 2);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_MIN_MS), 500);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_MAX_MS), 2000);
+    EXPECT_EQ(packed_field(packed, 0, openvpn::HANDOFF_FIELD_TOTAL_MS), 2500);
+
+    tracker.begin("gone", openvpn::HANDOFF_REBIND, 0, 0);
+    tracker.begin("kept", openvpn::HANDOFF_REBIND, 0, 0);
+    tracker.retain({"kept"});
+    EXPECT_EQ(tracker.pending(), 1u);
+    EXPECT_EQ(tracker.poll("gone", 1, 100), Poll::IDLE);
+}
@@ -0,0 +1,62 @@
+#ifndef NORDVPN_PROFILE_SAMPLE_H
+#define NORDVPN_PROFILE_SAMPLE_H
+
+#include <string>
+
+/**
+ * Profile in the layout NordVPN serves from downloads.nordcdn.com
+ * (ovpn_udp/servers/<host>.udp.ovpn), with key material replaced by filler of
+ * the same size.
+ */
+inline std::string nordvpn_profile_sample() {
+    std::string key_block;
+    for (int i = 0; i < 16; ++i) {
+        key_block += "e685bdaf659a25a200e2b9e39e51ff03\n";
+    }
+    std::string cert_block;
+    for (int i = 0; i < 30; ++i) {
+        cert_block += "MIIFCjCCAvKgAwIBAgIBATANBgkqhkiG9w0BAQ0FADA5MQswCQYDVQQGEwJQQTEQ\n";
+    }
+    return
+        "client\n"
+        "dev tun\n"
+        "proto udp\n"
+        "remote 185.169.255.9 1194\n"
+        "resolv-retry infinite\n"
+        "remote-random\n"
+        "nobind\n"
+        "tun-mtu 1500\n"
+        "tun-mtu-extra 32\n"
+        "mssfix 1450\n"
+        "persist-key\n"
+        "persist-tun\n"
+        "ping 15\n"
+        "ping-restart 0\n"
+        "ping-timer-rem\n"
+        "reneg-sec 0\n"
+        "comp-lzo no\n"
+        "verify-x509-name CN=uk1827.nordvpn.com\n"
+        "\n"
+        "remote-cert-tls server\n"
+        "\n"
+        "auth-user-pass\n"
+        "verb 3\n"
+        "pull\n"
+        "fast-io\n"
+        "cipher AES-256-CBC\n"
+        "auth SHA512\n"
+        "<ca>\n"
+        "-----BEGIN CERTIFICATE-----\n" + cert_block +
+        "-----END CERTIFICATE-----\n"
+        "</ca>\n"
+        "key-direction 1\n"
+        "<tls-auth>\n"
+        "#\n"
+        "# 2048 bit OpenVPN static key\n"
+        "#\n"
+        "-----BEGIN OpenVPN Static key V1-----\n" + key_block +
+        "-----END OpenVPN Static key V1-----\n"
+        "</tls-auth>\n";
+}
+
+#endif // NORDVPN_PROFILE_SAMPLE_H
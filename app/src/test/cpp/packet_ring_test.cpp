@@ -0,0 +1,267 @@
+/**
+ * Packet Ring Unit Tests
+ *
+ * Tests the memfd-backed SPSC packet rings used between CustomTunClient and
+ * the TUN pump: ordering, wrap-around padding, full and oversized rejection,
+ * doorbell suppression while the consumer is awake, the park/re-check
+ * handshake on both sides, and a two-thread stress run.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "packet_ring.h"
+
+using openvpn::PacketRing;
+using openvpn::PacketRingPair;
+using openvpn::PacketRingRegistry;
+
+namespace {
+
+std::vector<uint8_t> packet(size_t len, uint8_t marker) {
+    std::vector<uint8_t> p(len, marker);
+    p[0] = static_cast<uint8_t>(len);
+    return p;
+}
+
+std::vector<uint8_t> take(PacketRing& ring) {
+    size_t len = 0;
+    const uint8_t* data = ring.front(len);
+    if (!data) {
+        return {};
+    }
+    std::vector<uint8_t> out(data, data + len);
+    ring.pop();
+    return out;
+}
+
+bool readable(int fd) {
+    pollfd pfd{fd, POLLIN, 0};
+    return poll(&pfd, 1, 0) == 1;
+}
+
+} // namespace
+
+TEST(PacketRingTest, DeliversPacketsInOrderAfterPublish) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->outbound();
+
+    ASSERT_TRUE(ring.push(packet(60, 0xA1).data(), 60));
+    ASSERT_TRUE(ring.push(packet(1400, 0xA2).data(), 1400));
+
+    // Nothing is visible until the batch is published
+    EXPECT_TRUE(ring.empty());
+    ring.publish();
+    EXPECT_EQ(take(ring), packet(60, 0xA1));
+    EXPECT_EQ(take(ring), packet(1400, 0xA2));
+    EXPECT_TRUE(take(ring).empty());
+    EXPECT_EQ(ring.header().pushed.load(), 2u);
+    EXPECT_EQ(ring.header().popped.load(), 2u);
+}
+
+TEST(PacketRingTest, WrapsWithoutSplittingPackets) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->inbound();
+
+    // Odd sizes walk the write offset around the 4 KiB ring many times
+    for (int round = 0; round < 200; ++round) {
+        const size_t len = 700 + (round * 37) % 900;
+        const auto p = packet(len, static_cast<uint8_t>(round));
+        ASSERT_TRUE(ring.push(p.data(), p.size())) << "round " << round;
+        ring.publish();
+        ASSERT_EQ(take(ring), p) << "round " << round;
+        ring.release();
+    }
+}
+
+TEST(PacketRingTest, RejectsWhenFullUntilSpaceIsReleased) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->outbound();
+    const auto p = packet(1000, 0xB0);
+
+    int pushed = 0;
+    while (ring.push(p.data(), p.size())) {
+        pushed++;
+    }
+    EXPECT_EQ(pushed, 4);
+    EXPECT_EQ(ring.header().full.load(), 1u);
+    ring.publish();
+
+    // Popping alone does not hand space back; release() does
+    take(ring);
+    EXPECT_FALSE(ring.push(p.data(), p.size()));
+    ring.release();
+    EXPECT_TRUE(ring.push(p.data(), p.size()));
+}
+
+TEST(PacketRingTest, RejectsEmptyAndOversizedPackets) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->outbound();
+    std::vector<uint8_t> big(ring.max_packet() + 1, 0);
+    EXPECT_FALSE(ring.push(big.data(), 0));
+    EXPECT_FALSE(ring.push(big.data(), big.size()));
+    EXPECT_TRUE(ring.push(big.data(), ring.max_packet()));
+}
+
+TEST(PacketRingTest, DoorbellOnlyRingsForParkedConsumer) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->outbound();
+    const auto p = packet(100, 0xC0);
+
+    // Awake consumer: publishing costs no eventfd write
+    ring.push(p.data(), p.size());
+    EXPECT_FALSE(ring.publish());
+    EXPECT_FALSE(readable(ring.data_fd()));
+    EXPECT_EQ(ring.header().doorbells_suppressed.load(), 1u);
+
+    // Data waiting: the consumer must not sleep
+    EXPECT_FALSE(ring.park_consumer());
+    take(ring);
+    ring.release();
+
+    // Parked consumer: one doorbell for a whole batch
+    ASSERT_TRUE(ring.park_consumer());
+    for (int i = 0; i < 8; ++i) {
+        ring.push(p.data(), p.size());
+    }
+    EXPECT_TRUE(ring.publish());
+    EXPECT_TRUE(readable(ring.data_fd()));
+    EXPECT_EQ(ring.header().doorbells.load(), 1u);
+
+    PacketRing::drain_doorbell(ring.data_fd());
+    EXPECT_FALSE(readable(ring.data_fd()));
+
+    // Woken consumer is awake until it parks again
+    ring.push(p.data(), p.size());
+    EXPECT_FALSE(ring.publish());
+    EXPECT_EQ(ring.header().doorbells.load(), 1u);
+}
+
+TEST(PacketRingTest, ParkedProducerIsWokenByRelease) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->inbound();
+    const auto p = packet(1000, 0xD0);
+    while (ring.push(p.data(), p.size())) {
+    }
+    ring.publish();
+
+    ASSERT_TRUE(ring.park_producer(p.size()));
+    take(ring);
+    EXPECT_FALSE(readable(ring.space_fd()));
+    ring.release();
+    EXPECT_TRUE(readable(ring.space_fd()));
+    EXPECT_FALSE(ring.park_producer(p.size()));
+}
+
+TEST(PacketRingTest, DetachWakesParkedProducer) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    pair->set_app_attached(true);
+    EXPECT_TRUE(pair->app_attached());
+    EXPECT_FALSE(readable(pair->inbound().space_fd()));
+    pair->set_app_attached(false);
+    EXPECT_FALSE(pair->app_attached());
+    EXPECT_TRUE(readable(pair->inbound().space_fd()));
+}
+
+TEST(PacketRingTest, RingsLiveInTheSharedMemfd) {
+    auto pair = PacketRingPair::create(4096);
+    ASSERT_NE(pair, nullptr);
+    ASSERT_GE(pair->memfd(), 0);
+    const auto p = packet(64, 0xE0);
+    pair->outbound().push(p.data(), p.size());
+    pair->outbound().publish();
+
+    // A second mapping of the memfd (as another process would have) sees the record
+    const size_t bytes = 2 * (4096 + pair->outbound().capacity());
+    void* view = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, pair->memfd(), 0);
+    ASSERT_NE(view, MAP_FAILED);
+    uint32_t len;
+    std::memcpy(&len, static_cast<uint8_t*>(view) + 4096, sizeof(len));
+    EXPECT_EQ(len, p.size());
+    EXPECT_EQ(std::memcmp(static_cast<uint8_t*>(view) + 4096 + 4, p.data(), p.size()), 0);
+    munmap(view, bytes);
+}
+
+TEST(PacketRingTest, RegistryEraseOnlyRemovesMatchingPair) {
+    auto first = PacketRingPair::create(4096);
+    auto second = PacketRingPair::create(4096);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    PacketRingRegistry& registry = PacketRingRegistry::instance();
+
+    registry.publish("ring-uk", first);
+    registry.publish("ring-uk", second);   // Reconnect replaced the tunnel's rings
+    registry.erase("ring-uk", first.get());
+    EXPECT_EQ(registry.find("ring-uk"), second);
+    registry.erase("ring-uk", second.get());
+    EXPECT_EQ(registry.find("ring-uk"), nullptr);
+}
+
+TEST(PacketRingTest, ProducerAndConsumerThreadsAgreeOnEveryPacket) {
+    auto pair = PacketRingPair::create(16384);
+    ASSERT_NE(pair, nullptr);
+    PacketRing& ring = pair->outbound();
+    constexpr uint32_t COUNT = 200000;
+
+    std::thread producer([&] {
+        uint8_t buf[1500];
+        for (uint32_t seq = 0; seq < COUNT;) {
+            const size_t len = 20 + seq % 1400;
+            std::memcpy(buf, &seq, sizeof(seq));
+            std::memset(buf + sizeof(seq), static_cast<uint8_t>(seq), len - sizeof(seq));
+            if (ring.push(buf, len)) {
+                ++seq;
+                if (seq % 16 == 0) {
+                    ring.publish();
+                }
+                continue;
+            }
+            ring.publish();
+            if (ring.park_producer(len)) {
+                pollfd pfd{ring.space_fd(), POLLIN, 0};
+                poll(&pfd, 1, 100);
+                PacketRing::drain_doorbell(ring.space_fd());
+            }
+        }
+        ring.publish();
+    });
+
+    uint32_t expected = 0;
+    bool intact = true;
+    while (expected < COUNT && intact) {
+        size_t len;
+        const uint8_t* data = ring.front(len);
+        if (!data) {
+            ring.release();
+            if (ring.park_consumer()) {
+                pollfd pfd{ring.data_fd(), POLLIN, 0};
+                poll(&pfd, 1, 100);
+                PacketRing::drain_doorbell(ring.data_fd());
+            }
+            continue;
+        }
+        uint32_t seq;
+        std::memcpy(&seq, data, sizeof(seq));
+        intact = seq == expected && len == 20 + seq % 1400 &&
+                 data[len - 1] == static_cast<uint8_t>(seq);
+        ring.pop();
+        ++expected;
+    }
+    ring.release();
+    producer.join();
+
+    EXPECT_TRUE(intact) << "corrupt packet at " << expected;
+    EXPECT_EQ(expected, COUNT);
+    EXPECT_TRUE(ring.empty());
+}
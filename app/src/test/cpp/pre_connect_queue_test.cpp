@@ -0,0 +1,239 @@
+/**
+ * Pre-Connect Queue Unit Tests
+ *
+ * Tests the native per-tunnel queue that holds app packets until
+ * CustomTunClient::tun_start(): bounded tail-drop, head-only age expiry,
+ * the flush into app_fd on open(), resuming a flush that filled app_fd,
+ * direct sends after open(), and the registry / tunnel slot wiring.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+
+#include "pre_connect_queue.h"
+#include "tunnel_slots.h"
+
+using openvpn::PreConnectQueue;
+using openvpn::PreConnectQueueRegistry;
+using openvpn::PreConnectResult;
+using openvpn::TunnelSlotTable;
+
+namespace {
+
+std::vector<uint8_t> packet(size_t len, uint8_t marker) {
+    return std::vector<uint8_t>(len, marker);
+}
+
+// Socketpair standing in for CustomTunClient's app_fd / lib_fd
+class SocketPair {
+public:
+    explicit SocketPair(int sndbuf = 0) {
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds_), 0);
+        if (sndbuf > 0) {
+            setsockopt(fds_[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        }
+    }
+    ~SocketPair() {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    int app_fd() const { return fds_[0]; }
+
+    // Next packet OpenVPN would read from lib_fd, or empty if none
+    std::vector<uint8_t> read_lib() {
+        std::vector<uint8_t> buf(4096);
+        const ssize_t n = recv(fds_[1], buf.data(), buf.size(), MSG_DONTWAIT);
+        buf.resize(n > 0 ? static_cast<size_t>(n) : 0);
+        return buf;
+    }
+
+private:
+    int fds_[2];
+};
+
+PreConnectResult push(PreConnectQueue& queue, const std::vector<uint8_t>& p, uint64_t now_ms) {
+    return queue.push(p.data(), p.size(), now_ms);
+}
+
+} // namespace
+
+TEST(PreConnectQueueTest, QueuesUntilCapacityThenTailDrops) {
+    PreConnectQueue queue(4, 10000);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(push(queue, packet(100, i), 1000), PreConnectResult::QUEUED);
+    }
+    EXPECT_EQ(push(queue, packet(100, 9), 1000), PreConnectResult::DROPPED);
+    EXPECT_EQ(queue.size(), 4u);
+    EXPECT_EQ(queue.stats().queue.tail_drops.load(), 1u);
+    EXPECT_FALSE(queue.backlog());
+}
+
+TEST(PreConnectQueueTest, RejectsEmptyAndOversizedPackets) {
+    PreConnectQueue queue(4, 10000);
+    EXPECT_EQ(push(queue, packet(PreConnectQueue::MAX_PACKET_SIZE + 1, 0), 0), PreConnectResult::DROPPED);
+    EXPECT_EQ(queue.push(nullptr, 0, 0), PreConnectResult::DROPPED);
+    EXPECT_EQ(queue.stats().oversized.load(), 2u);
+    EXPECT_EQ(push(queue, packet(PreConnectQueue::MAX_PACKET_SIZE, 0), 0), PreConnectResult::QUEUED);
+}
+
+TEST(PreConnectQueueTest, ExpiresOldestPacketsOnPush) {
+    PreConnectQueue queue(8, 100);
+    push(queue, packet(60, 1), 1000);
+    push(queue, packet(60, 2), 1050);
+    push(queue, packet(60, 3), 1120);   // First packet is now 120 ms old
+
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.stats().queue.age_drops.load(), 1u);
+}
+
+TEST(PreConnectQueueTest, OpenFlushesUnexpiredPacketsInOrder) {
+    PreConnectQueue queue(8, 100);
+    push(queue, packet(60, 1), 1000);
+    push(queue, packet(70, 2), 1080);
+    push(queue, packet(80, 3), 1090);
+
+    SocketPair pair;
+    EXPECT_EQ(queue.open(pair.app_fd(), 1150), 0u);
+
+    // The first packet aged out while connecting
+    EXPECT_EQ(pair.read_lib(), packet(70, 2));
+    EXPECT_EQ(pair.read_lib(), packet(80, 3));
+    EXPECT_TRUE(pair.read_lib().empty());
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.stats().queue.flushed.load(), 2u);
+    EXPECT_EQ(queue.stats().queue.age_drops.load(), 1u);
+}
+
+TEST(PreConnectQueueTest, SendsDirectlyAfterOpenUntilClose) {
+    PreConnectQueue queue(8, 10000);
+    SocketPair pair;
+    queue.open(pair.app_fd(), 0);
+
+    EXPECT_EQ(push(queue, packet(90, 4), 10), PreConnectResult::SENT);
+    EXPECT_EQ(pair.read_lib(), packet(90, 4));
+    EXPECT_EQ(queue.stats().sent_direct.load(), 1u);
+
+    // Once the client closes app_fd, packets wait for the next tun_start()
+    queue.close();
+    EXPECT_EQ(push(queue, packet(90, 5), 20), PreConnectResult::QUEUED);
+    EXPECT_TRUE(pair.read_lib().empty());
+    EXPECT_FALSE(queue.backlog());
+}
+
+TEST(PreConnectQueueTest, ResumesFlushWhenAppFdFills) {
+    PreConnectQueue queue(256, 10000);
+    for (int i = 0; i < 256; ++i) {
+        push(queue, packet(1400, static_cast<uint8_t>(i)), 0);
+    }
+
+    SocketPair pair(4096);
+    const size_t left = queue.open(pair.app_fd(), 0);
+    ASSERT_GT(left, 0u);
+    EXPECT_TRUE(queue.backlog());
+
+    // A new packet queues behind the backlog instead of overtaking it
+    EXPECT_EQ(push(queue, packet(1400, 0xEE), 0), PreConnectResult::QUEUED);
+    int expected = 0;
+    while (expected <= 256) {
+        std::vector<uint8_t> p = pair.read_lib();
+        if (p.empty()) {
+            ASSERT_TRUE(queue.backlog()) << "stalled at " << expected;
+            queue.flush(0);   // CustomTunClient's read loop after each batch
+            continue;
+        }
+        ASSERT_EQ(p, packet(1400, expected < 256 ? static_cast<uint8_t>(expected) : 0xEE));
+        ++expected;
+    }
+    queue.flush(0);
+    EXPECT_FALSE(queue.backlog());
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(PreConnectQueueTest, ClearDropsEverything) {
+    PreConnectQueue queue(8, 10000);
+    push(queue, packet(60, 1), 0);
+    push(queue, packet(60, 2), 0);
+    queue.clear();
+    EXPECT_EQ(queue.size(), 0u);
+
+    SocketPair pair;
+    EXPECT_EQ(queue.open(pair.app_fd(), 0), 0u);
+    EXPECT_TRUE(pair.read_lib().empty());
+}
+
+TEST(PreConnectQueueTest, ConcurrentPushersAndFlushKeepEveryPacket) {
+    PreConnectQueue queue(4096, 100000);
+    SocketPair pair;
+    constexpr int PER_THREAD = 500;
+
+    std::vector<std::thread> pushers;
+    for (int t = 0; t < 4; ++t) {
+        pushers.emplace_back([&queue, t] {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                const auto p = packet(64, static_cast<uint8_t>(t));
+                queue.push(p.data(), p.size(), 0);
+            }
+        });
+    }
+    queue.open(pair.app_fd(), 0);
+
+    int received = 0;
+    while (received < 4 * PER_THREAD) {
+        if (pair.read_lib().empty()) {
+            queue.flush(0);
+            std::this_thread::yield();
+            continue;
+        }
+        ++received;
+    }
+    for (auto& pusher : pushers) {
+        pusher.join();
+    }
+    EXPECT_EQ(queue.stats().queue.enqueued.load() + queue.stats().sent_direct.load(),
+              static_cast<uint64_t>(4 * PER_THREAD));
+}
+
+TEST(PreConnectQueueTest, RegistryAndSlotShareOneQueuePerTunnel) {
+    std::shared_ptr<PreConnectQueue> queue = PreConnectQueueRegistry::instance().acquire("pcq-uk");
+    EXPECT_EQ(PreConnectQueueRegistry::instance().find("pcq-uk"), queue);
+
+    TunnelSlotTable table;
+    const int64_t handle = table.open("pcq-uk");
+    {
+        TunnelSlotTable::Pin pin = table.pin(handle);
+        ASSERT_TRUE(pin);
+        EXPECT_EQ(pin.pre_connect(), queue.get());
+    }
+    table.release(handle);
+    EXPECT_FALSE(table.pin(handle));
+
+    // Releasing the slot drops the registry entry; the next open gets a fresh queue
+    EXPECT_EQ(PreConnectQueueRegistry::instance().find("pcq-uk"), nullptr);
+    const int64_t reopened = table.open("pcq-uk");
+    {
+        TunnelSlotTable::Pin pin = table.pin(reopened);
+        ASSERT_TRUE(pin);
+        EXPECT_NE(pin.pre_connect(), nullptr);
+        EXPECT_EQ(pin.pre_connect(), PreConnectQueueRegistry::instance().find("pcq-uk").get());
+    }
+    table.release(reopened);
+    EXPECT_EQ(PreConnectQueueRegistry::instance().find("pcq-uk"), nullptr);
+}
+
+TEST(PreConnectQueueTest, RegistryEraseKeepsAReplacedQueue) {
+    PreConnectQueueRegistry& registry = PreConnectQueueRegistry::instance();
+    std::shared_ptr<PreConnectQueue> first = registry.acquire("pcq-de");
+    registry.erase("pcq-de", first.get());
+    std::shared_ptr<PreConnectQueue> second = registry.acquire("pcq-de");
+    ASSERT_NE(first, second);
+
+    // A late erase for the old queue leaves the new one registered
+    registry.erase("pcq-de", first.get());
+    EXPECT_EQ(registry.find("pcq-de"), second);
+    registry.erase("pcq-de", second.get());
+    EXPECT_EQ(registry.find("pcq-de"), nullptr);
+}
@@ -0,0 +1,239 @@
+/**
+ * Reconnect Scheduler Unit Tests
+ *
+ * Tests the scheduler that moves tunnels after a network change: bounded
+ * parallelism, per-tunnel merging of queued work, priority for tunnels with
+ * active flows, jittered backoff for repeat attempts, coalescing of duplicate
+ * network events, and cancel() waiting out a running task.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "reconnect_scheduler.h"
+
+using openvpn::ReconnectPolicy;
+using openvpn::ReconnectScheduler;
+
+namespace {
+
+ReconnectPolicy fast_policy(size_t max_parallel) {
+    ReconnectPolicy policy;
+    policy.max_parallel = max_parallel;
+    policy.stagger_ms = 20;
+    policy.base_backoff_ms = 40;
+    policy.max_backoff_ms = 200;
+    policy.backoff_reset_ms = 60000;
+    policy.coalesce_window_ms = 100;
+    return policy;
+}
+
+bool wait_executed(const ReconnectScheduler& scheduler, uint64_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (scheduler.executed() < count) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(ReconnectSchedulerTest, BackoffCapDoublesUpToMax) {
+    ReconnectPolicy policy = fast_policy(1);
+    EXPECT_EQ(ReconnectScheduler::backoff_cap_ms(policy, 1), 40);
+    EXPECT_EQ(ReconnectScheduler::backoff_cap_ms(policy, 2), 80);
+    EXPECT_EQ(ReconnectScheduler::backoff_cap_ms(policy, 3), 160);
+    EXPECT_EQ(ReconnectScheduler::backoff_cap_ms(policy, 4), 200);
+    EXPECT_EQ(ReconnectScheduler::backoff_cap_ms(policy, 40), 200);
+}
+
+TEST(ReconnectSchedulerTest, ActiveTunnelsSkipStaggerAndIdleOnesSpread) {
+    ReconnectScheduler scheduler(fast_policy(1), 7);
+    EXPECT_EQ(scheduler.schedule("active", 3, [] {}), 0);
+    for (int i = 0; i < 20; ++i) {
+        const int64_t delay = scheduler.schedule("idle" + std::to_string(i), 0, [] {});
+        EXPECT_GE(delay, 0);
+        EXPECT_LT(delay, 20);
+    }
+    ASSERT_TRUE(wait_executed(scheduler, 21));
+}
+
+TEST(ReconnectSchedulerTest, RunsAtMostMaxParallelTasks) {
+    ReconnectScheduler scheduler(fast_policy(2), 1);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    for (int i = 0; i < 8; ++i) {
+        scheduler.schedule("tunnel" + std::to_string(i), 1, [&] {
+            const int now = ++running;
+            int seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            running--;
+        });
+    }
+    ASSERT_TRUE(wait_executed(scheduler, 8));
+    EXPECT_EQ(peak.load(), 2);
+    EXPECT_EQ(scheduler.pending(), 0u);
+}
+
+TEST(ReconnectSchedulerTest, PrefersTunnelsWithMoreFlows) {
+    ReconnectScheduler scheduler(fast_policy(1), 3);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& name) {
+        return [&, name] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+        };
+    };
+
+    // Occupy the only worker so the rest are all ready when it frees up
+    scheduler.schedule("blocker", 1, [released] { released.wait(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    scheduler.schedule("quiet", 1, record("quiet"));
+    scheduler.schedule("busy", 50, record("busy"));
+    scheduler.schedule("some", 5, record("some"));
+    release.set_value();
+
+    ASSERT_TRUE(wait_executed(scheduler, 4));
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_EQ(order[0], "busy");
+    EXPECT_EQ(order[1], "some");
+    EXPECT_EQ(order[2], "quiet");
+}
+
+TEST(ReconnectSchedulerTest, RescheduleWhileQueuedReplacesTask) {
+    ReconnectScheduler scheduler(fast_policy(1), 5);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    scheduler.schedule("blocker", 1, [released] { released.wait(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+    scheduler.schedule("uk", 0, [&first] { first++; });
+    scheduler.schedule("uk", 2, [&second] { second++; });
+    EXPECT_EQ(scheduler.merged(), 1u);
+    EXPECT_EQ(scheduler.pending(), 2u);
+
+    release.set_value();
+    ASSERT_TRUE(wait_executed(scheduler, 2));
+    EXPECT_EQ(first.load(), 0);
+    EXPECT_EQ(second.load(), 1);
+}
+
+TEST(ReconnectSchedulerTest, RepeatAttemptsBackOffWithJitter) {
+    ReconnectScheduler scheduler(fast_policy(1), 11);
+    scheduler.schedule("us", 1, [] {});
+    ASSERT_TRUE(wait_executed(scheduler, 1));
+    EXPECT_EQ(scheduler.attempts("us"), 1u);
+
+    // Second attempt waits in [cap/2, cap] of the first backoff step
+    int64_t delay = scheduler.schedule("us", 1, [] {});
+    EXPECT_GE(delay, 20);
+    EXPECT_LE(delay, 40);
+    ASSERT_TRUE(wait_executed(scheduler, 2));
+
+    delay = scheduler.schedule("us", 1, [] {});
+    EXPECT_GE(delay, 40);
+    EXPECT_LE(delay, 80);
+    ASSERT_TRUE(wait_executed(scheduler, 3));
+
+    // Cancelling forgets the backoff
+    scheduler.cancel("us");
+    EXPECT_EQ(scheduler.attempts("us"), 0u);
+    EXPECT_EQ(scheduler.schedule("us", 1, [] {}), 0);
+    ASSERT_TRUE(wait_executed(scheduler, 4));
+}
+
+TEST(ReconnectSchedulerTest, QuietTunnelStartsOverAfterResetPeriod) {
+    ReconnectPolicy policy = fast_policy(1);
+    policy.backoff_reset_ms = 30;
+    ReconnectScheduler scheduler(policy, 13);
+    scheduler.schedule("de", 1, [] {});
+    ASSERT_TRUE(wait_executed(scheduler, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_EQ(scheduler.schedule("de", 1, [] {}), 0);
+    ASSERT_TRUE(wait_executed(scheduler, 2));
+}
+
+TEST(ReconnectSchedulerTest, CoalescesRepeatEventsForSameNetwork) {
+    ReconnectScheduler scheduler(fast_policy(1));
+    EXPECT_TRUE(scheduler.note_network_event(100, 1000));
+    EXPECT_FALSE(scheduler.note_network_event(100, 1050));
+    EXPECT_TRUE(scheduler.note_network_event(200, 1060));   // A different network is a real change
+    EXPECT_TRUE(scheduler.note_network_event(100, 1070));
+    EXPECT_TRUE(scheduler.note_network_event(100, 1170));   // Outside the window
+    EXPECT_EQ(scheduler.events_coalesced(), 1u);
+}
+
+TEST(ReconnectSchedulerTest, CancelDropsQueuedAndWaitsForRunningTask) {
+    ReconnectScheduler scheduler(fast_policy(1), 17);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> finished{false};
+    scheduler.schedule("fr", 1, [&started, released, &finished] {
+        started.set_value();
+        released.wait();
+        finished = true;
+    });
+    started.get_future().wait();
+
+    // A second task queued behind the running one is dropped by cancel()
+    std::atomic<bool> ran_queued{false};
+    scheduler.schedule("fr", 1, [&ran_queued] { ran_queued = true; });
+
+    std::atomic<bool> cancelled{false};
+    std::thread canceller([&] {
+        scheduler.cancel("fr");
+        cancelled = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(cancelled.load());
+    release.set_value();
+    canceller.join();
+
+    EXPECT_TRUE(finished.load());
+    EXPECT_EQ(scheduler.pending(), 0u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(ran_queued.load());
+}
+
+TEST(ReconnectSchedulerTest, ThrowingTaskStillCountsAndOthersRun) {
+    ReconnectScheduler scheduler(fast_policy(1), 19);
+    std::atomic<bool> ran{false};
+    scheduler.schedule("bad", 2, [] { throw std::runtime_error("reconnect failed"); });
+    scheduler.schedule("good", 1, [&ran] { ran = true; });
+    ASSERT_TRUE(wait_executed(scheduler, 2));
+    EXPECT_TRUE(ran.load());
+    EXPECT_EQ(scheduler.attempts("bad"), 1u);
+}
+
+TEST(ReconnectSchedulerTest, StopDropsQueuedTasksAndAllowsRestart) {
+    ReconnectPolicy policy = fast_policy(1);
+    policy.stagger_ms = 10000;
+    ReconnectScheduler scheduler(policy, 23);
+    std::atomic<int> ran{0};
+    scheduler.schedule("late", 0, [&ran] { ran++; });
+    scheduler.stop();
+    EXPECT_EQ(scheduler.pending(), 0u);
+    EXPECT_EQ(ran.load(), 0);
+
+    scheduler.schedule("now", 1, [&ran] { ran++; });
+    ASSERT_TRUE(wait_executed(scheduler, 1));
+    EXPECT_EQ(ran.load(), 1);
+}
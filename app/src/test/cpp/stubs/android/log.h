@@ -0,0 +1,32 @@
+/**
+ * Test stub for <android/log.h>
+ *
+ * Lets host tests include logging_config.h and count how many logcat
+ * writes a code path would make.
+ */
+
+#ifndef TEST_STUB_ANDROID_LOG_H
+#define TEST_STUB_ANDROID_LOG_H
+
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+inline int g_android_log_calls = 0;
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    (void)prio;
+    (void)tag;
+    (void)fmt;
+    return ++g_android_log_calls;
+}
+
+#endif // TEST_STUB_ANDROID_LOG_H
@@ -0,0 +1,231 @@
+/**
+ * TCP MSS Clamp Unit Tests
+ *
+ * Tests the per-tunnel MSS limit derived from tun-mtu and tunnel overhead,
+ * and the in-place rewrite of the MSS option on SYN / SYN-ACK packets: the
+ * incrementally patched checksum must match a full recomputation, and
+ * packets that need no change must be left byte-for-byte intact.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "tcp_mss_clamp.h"
+
+using openvpn::MssLimit;
+using openvpn::TunnelOverhead;
+using openvpn::clamp_tcp_mss;
+using openvpn::mss_limit;
+
+namespace {
+
+constexpr uint8_t SYN = 0x02;
+constexpr uint8_t ACK = 0x10;
+
+uint16_t be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// Full TCP checksum over the pseudo-header and segment
+uint16_t tcp_checksum(const std::vector<uint8_t>& packet, size_t tcp) {
+    uint32_t sum = 0;
+    auto add = [&sum](const uint8_t* p, size_t len) {
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            sum += be16(p + i);
+        }
+        if (len % 2) {
+            sum += static_cast<uint32_t>(p[len - 1]) << 8;
+        }
+    };
+    const size_t segment = packet.size() - tcp;
+    if ((packet[0] >> 4) == 4) {
+        add(&packet[12], 8);
+    } else {
+        add(&packet[8], 32);
+    }
+    sum += 6 + static_cast<uint32_t>(segment);
+    std::vector<uint8_t> copy(packet.begin() + tcp, packet.end());
+    copy[16] = copy[17] = 0;
+    add(copy.data(), copy.size());
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+void finish(std::vector<uint8_t>& packet, size_t tcp) {
+    const uint16_t checksum = tcp_checksum(packet, tcp);
+    packet[tcp + 16] = checksum >> 8;
+    packet[tcp + 17] = checksum & 0xFF;
+}
+
+// TCP segment with the given options (padded to a 4-byte multiple) and flags
+std::vector<uint8_t> tcp_segment(std::vector<uint8_t> options, uint8_t flags) {
+    while (options.size() % 4) {
+        options.push_back(0);
+    }
+    std::vector<uint8_t> tcp(20 + options.size(), 0);
+    tcp[0] = 0xC0; tcp[1] = 0x01;      // Source port 49153
+    tcp[2] = 0x01; tcp[3] = 0xBB;      // Destination port 443
+    tcp[4] = 0x12; tcp[7] = 0x34;      // Sequence number
+    tcp[12] = static_cast<uint8_t>((tcp.size() / 4) << 4);
+    tcp[13] = flags;
+    tcp[14] = 0xFF; tcp[15] = 0xFF;    // Window
+    std::copy(options.begin(), options.end(), tcp.begin() + 20);
+    return tcp;
+}
+
+std::vector<uint8_t> ipv4_packet(const std::vector<uint8_t>& tcp) {
+    std::vector<uint8_t> p(20, 0);
+    p[0] = 0x45;
+    p[2] = static_cast<uint8_t>((20 + tcp.size()) >> 8);
+    p[3] = static_cast<uint8_t>(20 + tcp.size());
+    p[8] = 64;
+    p[9] = 6;
+    p[12] = 10; p[13] = 100; p[14] = 0; p[15] = 2;
+    p[16] = 93; p[17] = 184; p[18] = 216; p[19] = 34;
+    p.insert(p.end(), tcp.begin(), tcp.end());
+    finish(p, 20);
+    return p;
+}
+
+std::vector<uint8_t> ipv6_packet(const std::vector<uint8_t>& tcp) {
+    std::vector<uint8_t> p(40, 0);
+    p[0] = 0x60;
+    p[4] = static_cast<uint8_t>(tcp.size() >> 8);
+    p[5] = static_cast<uint8_t>(tcp.size());
+    p[6] = 6;
+    p[7] = 64;
+    p[8] = 0xFD; p[23] = 2;
+    p[24] = 0x26; p[25] = 0x06; p[39] = 1;
+    p.insert(p.end(), tcp.begin(), tcp.end());
+    finish(p, 40);
+    return p;
+}
+
+std::vector<uint8_t> mss_option(uint16_t mss) {
+    return {2, 4, static_cast<uint8_t>(mss >> 8), static_cast<uint8_t>(mss & 0xFF)};
+}
+
+MssLimit limit(uint16_t ipv4, uint16_t ipv6) {
+    MssLimit mss;
+    mss.ipv4 = ipv4;
+    mss.ipv6 = ipv6;
+    return mss;
+}
+
+} // namespace
+
+TEST(TcpMssClampTest, LimitAccountsForTransportAndCipher) {
+    TunnelOverhead aead_udp;
+    EXPECT_EQ(openvpn::tunnel_overhead_bytes(aead_udp), 20u + 8 + 4 + 4 + 16 + 1);
+    MssLimit mss = mss_limit(1500, aead_udp, 1500);
+    EXPECT_EQ(mss.ipv4, 1500 - 53 - 40);
+    EXPECT_EQ(mss.ipv6, 1500 - 53 - 60);
+
+    // CBC with SHA256 over TCP on an IPv6 path costs more
+    TunnelOverhead cbc_tcp;
+    cbc_tcp.udp = false;
+    cbc_tcp.ipv6_transport = true;
+    cbc_tcp.aead = false;
+    cbc_tcp.hmac_bytes = openvpn::hmac_size("SHA256");
+    EXPECT_EQ(openvpn::tunnel_overhead_bytes(cbc_tcp), 40u + 22 + 4 + 4 + 32 + 16 + 16 + 1);
+    EXPECT_LT(mss_limit(1500, cbc_tcp, 1500).ipv4, mss.ipv4);
+
+    // A small tun-mtu is the tighter bound
+    EXPECT_EQ(mss_limit(1280, aead_udp, 1500).ipv4, 1240);
+
+    // A path too small for any sensible MSS disables clamping
+    EXPECT_FALSE(mss_limit(1500, aead_udp, 500));
+}
+
+TEST(TcpMssClampTest, CipherAndDigestNames) {
+    EXPECT_TRUE(openvpn::cipher_is_aead("AES-256-GCM"));
+    EXPECT_TRUE(openvpn::cipher_is_aead("CHACHA20-POLY1305"));
+    EXPECT_FALSE(openvpn::cipher_is_aead("AES-256-CBC"));
+    EXPECT_EQ(openvpn::hmac_size("SHA1"), 20u);
+    EXPECT_EQ(openvpn::hmac_size("NONE"), 0u);
+    EXPECT_EQ(openvpn::hmac_size("WHIRLPOOL"), 64u);
+}
+
+TEST(TcpMssClampTest, ClampsIpv4SynAndKeepsChecksumValid) {
+    auto packet = ipv4_packet(tcp_segment(mss_option(1460), SYN));
+    ASSERT_TRUE(clamp_tcp_mss(packet.data(), packet.size(), limit(1360, 1340)));
+    EXPECT_EQ(be16(&packet[40 + 2]), 1360);   // Option value right after the 20-byte TCP header
+    EXPECT_EQ(be16(&packet[20 + 16]), tcp_checksum(packet, 20));
+}
+
+TEST(TcpMssClampTest, ClampsSynAckAndUnalignedOption) {
+    // NOP, NOP, NOP first: the MSS value starts at an odd offset
+    std::vector<uint8_t> options = {1, 1, 1};
+    auto mss = mss_option(1460);
+    options.insert(options.end(), mss.begin(), mss.end());
+    auto packet = ipv4_packet(tcp_segment(options, SYN | ACK));
+
+    ASSERT_TRUE(clamp_tcp_mss(packet.data(), packet.size(), limit(1200, 1180)));
+    EXPECT_EQ(be16(&packet[20 + 20 + 5]), 1200);
+    EXPECT_EQ(be16(&packet[20 + 16]), tcp_checksum(packet, 20));
+}
+
+TEST(TcpMssClampTest, ClampsIpv6SynWithIpv6Limit) {
+    std::vector<uint8_t> options = {4, 2};   // SACK permitted before MSS
+    auto mss = mss_option(1440);
+    options.insert(options.end(), mss.begin(), mss.end());
+    auto packet = ipv6_packet(tcp_segment(options, SYN));
+
+    ASSERT_TRUE(clamp_tcp_mss(packet.data(), packet.size(), limit(1360, 1340)));
+    EXPECT_EQ(be16(&packet[40 + 20 + 4]), 1340);
+    EXPECT_EQ(be16(&packet[40 + 16]), tcp_checksum(packet, 40));
+}
+
+TEST(TcpMssClampTest, LeavesOtherPacketsUntouched) {
+    const MssLimit mss = limit(1360, 1340);
+
+    // Already small enough
+    auto small = ipv4_packet(tcp_segment(mss_option(1200), SYN));
+    auto original = small;
+    EXPECT_FALSE(clamp_tcp_mss(small.data(), small.size(), mss));
+    EXPECT_EQ(small, original);
+
+    // Not a SYN
+    auto data = ipv4_packet(tcp_segment(mss_option(1460), ACK));
+    original = data;
+    EXPECT_FALSE(clamp_tcp_mss(data.data(), data.size(), mss));
+    EXPECT_EQ(data, original);
+
+    // No MSS option
+    auto bare = ipv4_packet(tcp_segment({}, SYN));
+    EXPECT_FALSE(clamp_tcp_mss(bare.data(), bare.size(), mss));
+
+    // UDP
+    auto udp = ipv4_packet(tcp_segment(mss_option(1460), SYN));
+    udp[9] = 17;
+    EXPECT_FALSE(clamp_tcp_mss(udp.data(), udp.size(), mss));
+
+    // Non-first IPv4 fragment
+    auto fragment = ipv4_packet(tcp_segment(mss_option(1460), SYN));
+    fragment[7] = 0x10;
+    EXPECT_FALSE(clamp_tcp_mss(fragment.data(), fragment.size(), mss));
+
+    // Clamping disabled
+    auto syn = ipv4_packet(tcp_segment(mss_option(1460), SYN));
+    EXPECT_FALSE(clamp_tcp_mss(syn.data(), syn.size(), MssLimit()));
+}
+
+TEST(TcpMssClampTest, TruncatedOrMalformedHeadersAreSafe) {
+    const MssLimit mss = limit(1360, 1340);
+    auto packet = ipv4_packet(tcp_segment(mss_option(1460), SYN));
+    for (size_t len = 0; len < packet.size(); ++len) {
+        auto copy = packet;
+        EXPECT_FALSE(clamp_tcp_mss(copy.data(), len, mss)) << "length " << len;
+    }
+
+    // Option length running past the header
+    auto bad = ipv4_packet(tcp_segment({2, 40, 5, 0xB4}, SYN));
+    EXPECT_FALSE(clamp_tcp_mss(bad.data(), bad.size(), mss));
+
+    // Zero-length option must not loop
+    auto zero = ipv4_packet(tcp_segment({3, 0, 2, 4, 5, 0xB4}, SYN));
+    EXPECT_FALSE(clamp_tcp_mss(zero.data(), zero.size(), mss));
+}
@@ -0,0 +1,215 @@
+/**
+ * Thread Placement Unit Tests
+ *
+ * Tests splitting cores into big/little clusters by frequency, applying a
+ * role's cluster and scheduling to joining threads, re-applying the process
+ * default, and AUTO promotion/demotion from sampled CPU time. CPU time,
+ * affinity and scheduling are faked so results do not depend on the host.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+#include "thread_placement.h"
+
+using openvpn::CpuCluster;
+using openvpn::CpuTopology;
+using openvpn::RolePlacement;
+using openvpn::ThreadPlacement;
+using openvpn::ThreadPlacementConfig;
+using openvpn::ThreadRole;
+
+namespace {
+
+constexpr uint64_t MS = 1000000ull;
+
+// Four little cores at 1.8 GHz, three big at 2.4 GHz, one prime at 3.0 GHz
+CpuTopology phone_topology() {
+    return CpuTopology::from_max_freq({{0, 1800000}, {1, 1800000}, {2, 1800000}, {3, 1800000},
+                                       {4, 2400000}, {5, 2400000}, {6, 2400000}, {7, 3000000}});
+}
+
+// Fake per-thread CPU clocks plus the last affinity and scheduling set per tid
+struct FakeScheduler {
+    std::map<pthread_t, uint64_t> cpu_ns;
+    std::map<pid_t, std::vector<int>> affinity;
+    std::map<pid_t, RolePlacement> scheduling;
+    bool refuse = false;
+
+    ThreadPlacement make(CpuTopology topology) {
+        return ThreadPlacement(
+            std::move(topology),
+            [this](pthread_t thread) { return cpu_ns[thread]; },
+            [this](pid_t tid, const std::vector<int>& cpus) { affinity[tid] = cpus; return !refuse; },
+            [this](pid_t tid, const RolePlacement& placement) { scheduling[tid] = placement; return !refuse; });
+    }
+};
+
+pthread_t thread_id(int n) { return static_cast<pthread_t>(n); }
+
+ThreadPlacementConfig auto_data_path() {
+    ThreadPlacementConfig config;
+    config.data_path.cluster = CpuCluster::AUTO;
+    config.promote_permille = 400;
+    config.demote_permille = 100;
+    return config;
+}
+
+const std::vector<int> BIG = {4, 5, 6, 7};
+const std::vector<int> LITTLE = {0, 1, 2, 3};
+
+} // namespace
+
+TEST(ThreadPlacementTest, SlowestTierIsLittleAndEverythingFasterIsBig) {
+    CpuTopology topology = phone_topology();
+    EXPECT_EQ(topology.little, LITTLE);
+    EXPECT_EQ(topology.big, BIG);
+    EXPECT_TRUE(topology.heterogeneous());
+    EXPECT_EQ(topology.all().size(), 8u);
+}
+
+TEST(ThreadPlacementTest, HomogeneousOrUnknownFrequenciesPutEveryCoreInBoth) {
+    CpuTopology same = CpuTopology::from_max_freq({{0, 2000000}, {1, 2000000}});
+    EXPECT_EQ(same.big, (std::vector<int>{0, 1}));
+    EXPECT_EQ(same.little, (std::vector<int>{0, 1}));
+    EXPECT_FALSE(same.heterogeneous());
+
+    CpuTopology unknown = CpuTopology::from_max_freq({{0, 1800000}, {1, 0}});
+    EXPECT_EQ(unknown.big, unknown.little);
+    EXPECT_FALSE(CpuTopology::from_max_freq({}).big.empty());
+}
+
+TEST(ThreadPlacementTest, DefaultConfigLeavesThreadsAlone) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(phone_topology());
+    placement.join(101, thread_id(1), "tun-pump", ThreadRole::DATA_PATH, nullptr, true, 0);
+
+    EXPECT_TRUE(sched.affinity.empty());
+    EXPECT_TRUE(sched.scheduling.empty());
+    ASSERT_EQ(placement.threads().size(), 1u);
+    EXPECT_EQ(placement.threads()[0].cluster, CpuCluster::ANY);
+}
+
+TEST(ThreadPlacementTest, JoiningAppliesTheRolesClusterAndScheduling) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(phone_topology());
+    ThreadPlacementConfig config;
+    config.data_path = RolePlacement{CpuCluster::BIG, -4, SCHED_OTHER, 0};
+    config.control = RolePlacement{CpuCluster::LITTLE, 5, SCHED_BATCH, 0};
+    placement.configure(config);
+
+    placement.join(101, thread_id(1), "ovpn-uk", ThreadRole::DATA_PATH, nullptr, true, 0);
+    placement.join(102, thread_id(2), "ovpn-callbacks", ThreadRole::CONTROL, nullptr, true, 0);
+
+    EXPECT_EQ(sched.affinity[101], BIG);
+    EXPECT_EQ(sched.scheduling[101].nice, -4);
+    EXPECT_EQ(sched.affinity[102], LITTLE);
+    EXPECT_EQ(sched.scheduling[102].policy, SCHED_BATCH);
+    EXPECT_EQ(sched.scheduling[102].nice, 5);
+}
+
+TEST(ThreadPlacementTest, UnpinnedThreadOnlyGetsScheduling) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(phone_topology());
+    ThreadPlacementConfig config;
+    config.data_path = RolePlacement{CpuCluster::BIG, -2, SCHED_OTHER, 0};
+
+    // An IO lane owns this thread's affinity
+    placement.join(101, thread_id(1), "ovpn-uk", ThreadRole::DATA_PATH, &config, false, 0);
+    EXPECT_EQ(sched.affinity.count(101), 0u);
+    EXPECT_EQ(sched.scheduling[101].nice, -2);
+}
+
+TEST(ThreadPlacementTest, ConfigureReappliesOnlyToThreadsOnTheDefault) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(phone_topology());
+    ThreadPlacementConfig session;
+    session.data_path.cluster = CpuCluster::BIG;
+
+    placement.join(101, thread_id(1), "tun-pump", ThreadRole::DATA_PATH, nullptr, true, 0);
+    placement.join(102, thread_id(2), "ovpn-uk", ThreadRole::DATA_PATH, &session, true, 0);
+
+    ThreadPlacementConfig little;
+    little.data_path = RolePlacement{CpuCluster::LITTLE, 3, SCHED_OTHER, 0};
+    placement.configure(little);
+    EXPECT_EQ(sched.affinity[101], LITTLE);
+    EXPECT_EQ(sched.scheduling[101].nice, 3);
+    EXPECT_EQ(sched.affinity[102], BIG);   // Keeps its session snapshot
+
+    // Back to the defaults: the pin is undone and the priority reset
+    placement.configure(ThreadPlacementConfig{});
+    EXPECT_EQ(sched.affinity[101].size(), 8u);
+    EXPECT_EQ(sched.scheduling[101].nice, 0);
+    EXPECT_EQ(placement.config().data_path.cluster, CpuCluster::ANY);
+}
+
+TEST(ThreadPlacementTest, AutoStartsBigAndDemotesWhenIdle) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(phone_topology());
+    const ThreadPlacementConfig config = auto_data_path();
+    placement.join(101, thread_id(1), "ovpn-uk", ThreadRole::DATA_PATH, &config, true, 0);
+    EXPECT_EQ(sched.affinity[101], BIG);
+
+    sched.cpu_ns[thread_id(1)] = 50 * MS;   // 5% of the interval
+    EXPECT_EQ(placement.sample(1000 * MS), 1);
+    EXPECT_EQ(sched.affinity[101], LITTLE);
+    EXPECT_EQ(placement.demotions(), 1u);
+    EXPECT_EQ(placement.threads()[0].utilization_permille, 50u);
+}
+
+TEST(ThreadPlacementTest, AutoPromotesBusyThreadWithHysteresis) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(phone_topology());
+    const ThreadPlacementConfig config = auto_data_path();
+    placement.join(101, thread_id(1), "ovpn-uk", ThreadRole::DATA_PATH, &config, true, 0);
+    placement.sample(1000 * MS);   // Idle: down to LITTLE
+    ASSERT_EQ(sched.affinity[101], LITTLE);
+
+    // Between the marks: stays where it is
+    sched.cpu_ns[thread_id(1)] = 200 * MS;
+    EXPECT_EQ(placement.sample(2000 * MS), 0);
+    EXPECT_EQ(sched.affinity[101], LITTLE);
+
+    sched.cpu_ns[thread_id(1)] = 900 * MS;   // 70%
+    EXPECT_EQ(placement.sample(3000 * MS), 1);
+    EXPECT_EQ(sched.affinity[101], BIG);
+    EXPECT_EQ(placement.promotions(), 1u);
+
+    sched.cpu_ns[thread_id(1)] = 1100 * MS;   // 20%: above the demote mark
+    EXPECT_EQ(placement.sample(4000 * MS), 0);
+    EXPECT_EQ(sched.affinity[101], BIG);
+}
+
+TEST(ThreadPlacementTest, AutoDoesNotMoveOnHomogeneousCores) {
+    FakeScheduler sched;
+    ThreadPlacement placement = sched.make(CpuTopology::from_max_freq({{0, 2000000}, {1, 2000000}}));
+    const ThreadPlacementConfig config = auto_data_path();
+    placement.join(101, thread_id(1), "ovpn-uk", ThreadRole::DATA_PATH, &config, true, 0);
+    EXPECT_EQ(placement.sample(1000 * MS), 0);
+    EXPECT_EQ(placement.demotions(), 0u);
+}
+
+TEST(ThreadPlacementTest, LeaveForgetsThreadAndFailuresAreCounted) {
+    FakeScheduler sched;
+    sched.refuse = true;
+    ThreadPlacement placement = sched.make(phone_topology());
+    ThreadPlacementConfig config;
+    config.data_path = RolePlacement{CpuCluster::BIG, 0, SCHED_FIFO, 10};
+
+    placement.join(101, thread_id(1), "ovpn-uk", ThreadRole::DATA_PATH, &config, true, 0);
+    EXPECT_EQ(placement.failures(), 2u);   // Scheduling and affinity both refused
+
+    placement.leave(101);
+    EXPECT_TRUE(placement.threads().empty());
+    placement.leave(101);
+}
+
+TEST(ThreadPlacementTest, CurrentThreadCanJoinTheRealScheduler) {
+    ThreadPlacement placement(CpuTopology::detect());
+    const pid_t tid = placement.join_current_thread("test", ThreadRole::CONTROL);
+    EXPECT_EQ(tid, ThreadPlacement::current_tid());
+    EXPECT_EQ(placement.failures(), 0u);
+    placement.sample();
+    placement.leave(tid);
+}
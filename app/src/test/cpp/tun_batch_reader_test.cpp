@@ -0,0 +1,144 @@
+/**
+ * TUN Batch Reader Unit Tests
+ *
+ * Tests the recvmmsg()-based batch reader used by CustomTunClient's outbound path.
+ * A SOCK_SEQPACKET socketpair stands in for the app_fd/lib_fd pair.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <vector>
+
+#include "tun_batch_reader.h"
+
+using openvpn::TunBatchReader;
+using openvpn::TunBatchStats;
+
+class TunBatchReaderTest : public ::testing::Test {
+protected:
+    static constexpr size_t SLOT_SIZE = 2048;
+
+    int fds[2] = {-1, -1};
+    std::vector<uint8_t> storage;
+
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+        int flags = fcntl(fds[1], F_GETFL, 0);
+        ASSERT_EQ(fcntl(fds[1], F_SETFL, flags | O_NONBLOCK), 0);
+        storage.resize(TunBatchReader::MAX_BATCH_SIZE * SLOT_SIZE);
+    }
+
+    void TearDown() override {
+        if (fds[0] >= 0) close(fds[0]);
+        if (fds[1] >= 0) close(fds[1]);
+    }
+
+    void attach(TunBatchReader& reader, size_t slot_size = SLOT_SIZE) {
+        for (size_t i = 0; i < TunBatchReader::MAX_BATCH_SIZE; ++i) {
+            reader.set_slot(i, storage.data() + i * SLOT_SIZE, slot_size);
+        }
+    }
+
+    void send_packet(uint8_t marker, size_t len) {
+        std::vector<uint8_t> packet(len, marker);
+        ASSERT_EQ(write(fds[0], packet.data(), len), static_cast<ssize_t>(len));
+    }
+};
+
+TEST_F(TunBatchReaderTest, ReadsUpToBatchSizeInOneCall) {
+    TunBatchReader reader(4);
+    attach(reader);
+
+    for (uint8_t i = 0; i < 10; ++i) {
+        send_packet(i, 100 + i);
+    }
+
+    ASSERT_EQ(reader.read_batch(fds[1]), 4);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(reader.length(i), 100 + i);
+        EXPECT_EQ(storage[i * SLOT_SIZE], i) << "Packet order must be preserved";
+        EXPECT_FALSE(reader.truncated(i));
+    }
+
+    ASSERT_EQ(reader.read_batch(fds[1]), 4);
+    EXPECT_EQ(storage[0], 4);
+    ASSERT_EQ(reader.read_batch(fds[1]), 2);
+    EXPECT_EQ(reader.length(1), 109u);
+}
+
+TEST_F(TunBatchReaderTest, ReturnsZeroWhenNothingPending) {
+    TunBatchReader reader;
+    attach(reader);
+
+    EXPECT_EQ(reader.read_batch(fds[1]), 0);
+    EXPECT_EQ(reader.stats().empty_reads.load(), 1u);
+    EXPECT_EQ(reader.stats().batches.load(), 0u);
+}
+
+TEST_F(TunBatchReaderTest, PreservesMessageBoundaries) {
+    TunBatchReader reader(8);
+    attach(reader);
+
+    send_packet(0xAA, 1500);
+    send_packet(0xBB, 40);
+
+    ASSERT_EQ(reader.read_batch(fds[1]), 2);
+    EXPECT_EQ(reader.length(0), 1500u);
+    EXPECT_EQ(reader.length(1), 40u);
+    EXPECT_EQ(storage[1499], 0xAA);
+    EXPECT_EQ(storage[SLOT_SIZE], 0xBB);
+}
+
+TEST_F(TunBatchReaderTest, FlagsOversizedMessagesAsTruncated) {
+    TunBatchReader reader(2);
+    attach(reader, 64);
+
+    send_packet(0x01, 200);
+
+    ASSERT_EQ(reader.read_batch(fds[1]), 1);
+    EXPECT_TRUE(reader.truncated(0));
+    EXPECT_EQ(reader.stats().truncated.load(), 1u);
+}
+
+TEST_F(TunBatchReaderTest, RecordsFillStatistics) {
+    TunBatchReader reader(4);
+    attach(reader);
+
+    for (int i = 0; i < 5; ++i) {
+        send_packet(0x00, 60);
+    }
+
+    ASSERT_EQ(reader.read_batch(fds[1]), 4);
+    ASSERT_EQ(reader.read_batch(fds[1]), 1);
+
+    const TunBatchStats& stats = reader.stats();
+    EXPECT_EQ(stats.batches.load(), 2u);
+    EXPECT_EQ(stats.packets.load(), 5u);
+    EXPECT_EQ(stats.full_batches.load(), 1u);
+    EXPECT_EQ(stats.average_fill_x100(), 250u);
+    EXPECT_EQ(stats.fill_histogram[0].load(), 1u);  // Batch of 1
+    EXPECT_EQ(stats.fill_histogram[2].load(), 1u);  // Batch of 4 (4-7 bucket)
+}
+
+TEST_F(TunBatchReaderTest, ClampsBatchSize) {
+    TunBatchReader reader;
+    EXPECT_EQ(reader.batch_size(), static_cast<size_t>(TUN_READ_BATCH_SIZE));
+
+    reader.set_batch_size(0);
+    EXPECT_EQ(reader.batch_size(), 1u);
+
+    reader.set_batch_size(1000);
+    EXPECT_EQ(reader.batch_size(), TunBatchReader::MAX_BATCH_SIZE);
+}
+
+TEST(TunBatchStatsTest, BucketsArePowersOfTwo) {
+    EXPECT_EQ(TunBatchStats::bucket_for(1), 0u);
+    EXPECT_EQ(TunBatchStats::bucket_for(2), 1u);
+    EXPECT_EQ(TunBatchStats::bucket_for(3), 1u);
+    EXPECT_EQ(TunBatchStats::bucket_for(4), 2u);
+    EXPECT_EQ(TunBatchStats::bucket_for(64), 6u);
+    EXPECT_EQ(TunBatchStats::bucket_for(100000), TunBatchStats::FILL_BUCKETS - 1);
+}
@@ -0,0 +1,134 @@
+/**
+ * TUN Buffer Pool Unit Tests
+ *
+ * Tests the per-tunnel packet buffer pool used by CustomTunClient.
+ * A minimal buffer type stands in for openvpn::BufferAllocated.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "tun_buffer_pool.h"
+
+namespace {
+
+// Counts live allocations so tests can verify recycling
+struct MockBuffer {
+    static int allocations;
+
+    MockBuffer() = default;
+    MockBuffer(size_t capacity, int) : data(capacity) {
+        ++allocations;
+    }
+    MockBuffer(MockBuffer&&) = default;
+    MockBuffer& operator=(MockBuffer&&) = default;
+
+    size_t capacity() const { return data.size(); }
+
+    std::vector<uint8_t> data;
+};
+
+int MockBuffer::allocations = 0;
+
+} // namespace
+
+using openvpn::TunBufferPool;
+
+class TunBufferPoolTest : public ::testing::Test {
+protected:
+    static constexpr size_t BUFFER_SIZE = 256 + 1500 + 128;
+
+    void SetUp() override {
+        MockBuffer::allocations = 0;
+    }
+};
+
+TEST_F(TunBufferPoolTest, MissAllocatesAtConfiguredSize) {
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 4);
+
+    MockBuffer buf = pool.acquire();
+    EXPECT_EQ(buf.capacity(), BUFFER_SIZE);
+    EXPECT_EQ(pool.stats().misses.load(), 1u);
+    EXPECT_EQ(pool.stats().hits.load(), 0u);
+}
+
+TEST_F(TunBufferPoolTest, ReleasedBuffersAreReused) {
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 4);
+
+    MockBuffer buf = pool.acquire();
+    const uint8_t* storage = buf.data.data();
+    pool.release(std::move(buf));
+
+    MockBuffer again = pool.acquire();
+    EXPECT_EQ(again.data.data(), storage) << "Pool should hand back the same storage";
+    EXPECT_EQ(pool.stats().hits.load(), 1u);
+    EXPECT_EQ(MockBuffer::allocations, 1);
+}
+
+TEST_F(TunBufferPoolTest, PrefillAvoidsMisses) {
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 8);
+    pool.prefill(4);
+    EXPECT_EQ(pool.idle(), 4u);
+
+    std::vector<MockBuffer> held;
+    for (int i = 0; i < 4; ++i) {
+        held.push_back(pool.acquire());
+    }
+    EXPECT_EQ(pool.stats().hits.load(), 4u);
+    EXPECT_EQ(pool.stats().misses.load(), 0u);
+}
+
+TEST_F(TunBufferPoolTest, TracksHighWaterMark) {
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 8);
+
+    std::vector<MockBuffer> held;
+    for (int i = 0; i < 5; ++i) {
+        held.push_back(pool.acquire());
+    }
+    for (auto& buf : held) {
+        pool.release(std::move(buf));
+    }
+    held.clear();
+    held.push_back(pool.acquire());
+
+    EXPECT_EQ(pool.stats().high_water.load(), 5u);
+    EXPECT_EQ(pool.stats().in_use.load(), 1u);
+}
+
+TEST_F(TunBufferPoolTest, DiscardsBeyondIdleLimit) {
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 2);
+
+    std::vector<MockBuffer> held;
+    for (int i = 0; i < 3; ++i) {
+        held.push_back(pool.acquire());
+    }
+    for (auto& buf : held) {
+        pool.release(std::move(buf));
+    }
+
+    EXPECT_EQ(pool.idle(), 2u);
+    EXPECT_EQ(pool.stats().discards.load(), 1u);
+}
+
+TEST_F(TunBufferPoolTest, DiscardsUndersizedBuffers) {
+    // OpenVPN may swap a smaller work buffer into a slot during encryption
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 4);
+
+    MockBuffer buf = pool.acquire();
+    buf.data.resize(64);
+    pool.release(std::move(buf));
+
+    EXPECT_EQ(pool.idle(), 0u);
+    EXPECT_EQ(pool.stats().discards.load(), 1u);
+    EXPECT_EQ(pool.stats().in_use.load(), 0u);
+}
+
+TEST_F(TunBufferPoolTest, ConfigureDropsIdleBuffers) {
+    TunBufferPool<MockBuffer> pool(BUFFER_SIZE, 4);
+    pool.prefill(4);
+
+    pool.configure(BUFFER_SIZE * 2, 4);
+    EXPECT_EQ(pool.idle(), 0u);
+    EXPECT_EQ(pool.acquire().capacity(), BUFFER_SIZE * 2);
+}
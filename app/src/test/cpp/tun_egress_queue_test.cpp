@@ -0,0 +1,183 @@
+/**
+ * TUN Egress Queue Unit Tests
+ *
+ * Tests the bounded queue that holds decrypted packets while lib_fd is full,
+ * including each drop policy and the flush-on-writable pattern used by
+ * CustomTunClient::flush_egress().
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <vector>
+
+#include "tun_egress_queue.h"
+
+using openvpn::TunDropPolicy;
+using openvpn::TunEgressQueue;
+
+namespace {
+
+// Packet stand-in: one marker byte identifies each packet
+using Packet = std::vector<uint8_t>;
+
+Packet make_packet(uint8_t marker, size_t len = 100) {
+    return Packet(len, marker);
+}
+
+} // namespace
+
+class TunEgressQueueTest : public ::testing::Test {
+protected:
+    std::vector<Packet> dropped;
+
+    auto drop_fn() {
+        return [this](Packet&& p) { dropped.push_back(std::move(p)); };
+    }
+};
+
+TEST_F(TunEgressQueueTest, PreservesFifoOrder) {
+    TunEgressQueue<Packet> queue(8);
+
+    for (uint8_t i = 0; i < 5; ++i) {
+        EXPECT_TRUE(queue.push(make_packet(i), 0, drop_fn()));
+    }
+
+    for (uint8_t i = 0; i < 5; ++i) {
+        ASSERT_FALSE(queue.empty());
+        EXPECT_EQ(queue.front()[0], i);
+        queue.pop();
+    }
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.stats().flushed.load(), 5u);
+}
+
+TEST_F(TunEgressQueueTest, TailDropRejectsArrivingPacket) {
+    TunEgressQueue<Packet> queue(2, TunDropPolicy::TAIL_DROP);
+
+    EXPECT_TRUE(queue.push(make_packet(1), 0, drop_fn()));
+    EXPECT_TRUE(queue.push(make_packet(2), 0, drop_fn()));
+    EXPECT_FALSE(queue.push(make_packet(3), 0, drop_fn()));
+
+    ASSERT_EQ(dropped.size(), 1u);
+    EXPECT_EQ(dropped[0][0], 3);
+    EXPECT_EQ(queue.front()[0], 1);
+    EXPECT_EQ(queue.stats().tail_drops.load(), 1u);
+}
+
+TEST_F(TunEgressQueueTest, HeadDropEvictsOldestPacket) {
+    TunEgressQueue<Packet> queue(2, TunDropPolicy::HEAD_DROP);
+
+    queue.push(make_packet(1), 0, drop_fn());
+    queue.push(make_packet(2), 0, drop_fn());
+    EXPECT_TRUE(queue.push(make_packet(3), 0, drop_fn()));
+
+    ASSERT_EQ(dropped.size(), 1u);
+    EXPECT_EQ(dropped[0][0], 1);
+    EXPECT_EQ(queue.front()[0], 2);
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.stats().head_drops.load(), 1u);
+}
+
+TEST_F(TunEgressQueueTest, DropByAgeExpiresStalePackets) {
+    TunEgressQueue<Packet> queue(4, TunDropPolicy::DROP_BY_AGE, 50);
+
+    queue.push(make_packet(1), 1000, drop_fn());
+    queue.push(make_packet(2), 1040, drop_fn());
+    queue.push(make_packet(3), 1080, drop_fn());
+
+    queue.expire(1100, drop_fn());
+
+    ASSERT_EQ(dropped.size(), 2u);
+    EXPECT_EQ(queue.front()[0], 3);
+    EXPECT_EQ(queue.stats().age_drops.load(), 2u);
+}
+
+TEST_F(TunEgressQueueTest, DropByAgeFallsBackToTailDropWhenNothingIsStale) {
+    TunEgressQueue<Packet> queue(2, TunDropPolicy::DROP_BY_AGE, 50);
+
+    queue.push(make_packet(1), 1000, drop_fn());
+    queue.push(make_packet(2), 1010, drop_fn());
+    EXPECT_FALSE(queue.push(make_packet(3), 1020, drop_fn()));
+    EXPECT_EQ(queue.stats().tail_drops.load(), 1u);
+
+    // Once the head is stale, a full queue makes room by age
+    EXPECT_TRUE(queue.push(make_packet(4), 1200, drop_fn()));
+    EXPECT_EQ(queue.stats().age_drops.load(), 2u);
+    EXPECT_EQ(queue.front()[0], 4);
+}
+
+TEST_F(TunEgressQueueTest, ExpireIsNoOpForOtherPolicies) {
+    TunEgressQueue<Packet> queue(4, TunDropPolicy::TAIL_DROP, 1);
+
+    queue.push(make_packet(1), 0, drop_fn());
+    queue.expire(100000, drop_fn());
+    EXPECT_EQ(queue.size(), 1u);
+    EXPECT_TRUE(dropped.empty());
+}
+
+TEST_F(TunEgressQueueTest, RingWrapsAround) {
+    TunEgressQueue<Packet> queue(3);
+
+    for (uint8_t i = 0; i < 10; ++i) {
+        queue.push(make_packet(i), 0, drop_fn());
+        EXPECT_EQ(queue.pop()[0], i);
+    }
+    EXPECT_EQ(queue.stats().high_water.load(), 1u);
+}
+
+TEST_F(TunEgressQueueTest, FlushesIntoSocketpairAfterEagain) {
+    // Mirrors the tun_send()/flush_egress() flow: fill lib_fd until EAGAIN,
+    // queue the overflow, then drain app_fd and flush in order
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+    int app_fd = fds[0];
+    int lib_fd = fds[1];
+    fcntl(lib_fd, F_SETFL, fcntl(lib_fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(app_fd, F_SETFL, fcntl(app_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    TunEgressQueue<Packet> queue(64);
+    size_t written = 0;
+    uint8_t marker = 0;
+    for (;;) {
+        Packet p = make_packet(marker, 1400);
+        if (write(lib_fd, p.data(), p.size()) < 0) {
+            ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+        ++written;
+        ++marker;
+    }
+    ASSERT_GT(written, 0u);
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(queue.push(make_packet(marker++, 1400), 0, drop_fn()));
+    }
+
+    // App drains everything currently in the socket
+    uint8_t rx[2048];
+    size_t drained = 0;
+    while (read(app_fd, rx, sizeof(rx)) > 0) {
+        ++drained;
+    }
+    EXPECT_EQ(drained, written);
+
+    // Flush the queue now that lib_fd is writable
+    while (!queue.empty()) {
+        Packet& p = queue.front();
+        ASSERT_EQ(write(lib_fd, p.data(), p.size()), static_cast<ssize_t>(p.size()));
+        queue.pop();
+    }
+
+    uint8_t expected = static_cast<uint8_t>(written);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(read(app_fd, rx, sizeof(rx)), 1400);
+        EXPECT_EQ(rx[0], expected++) << "Queued packets must arrive in order";
+    }
+    EXPECT_TRUE(dropped.empty());
+
+    close(app_fd);
+    close(lib_fd);
+}
@@ -0,0 +1,231 @@
+/**
+ * TUN Pump Unit Tests
+ *
+ * Drives TunPump with SOCK_SEQPACKET socketpairs standing in for the TUN fd
+ * and a tunnel's createPipe()/CustomTunClient socketpair, and checks that
+ * learned flows are forwarded natively, misses reach take_miss(), and
+ * inbound packets land on the TUN side.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+#include "tun_pump.h"
+
+using openvpn::NativePacketRouter;
+using openvpn::TunPump;
+
+namespace {
+
+std::vector<uint8_t> udp_packet(uint16_t src_port, uint8_t marker) {
+    std::vector<uint8_t> p(32, marker);
+    p[0] = 0x45;
+    p[6] = 0; p[7] = 0;
+    p[9] = 17;
+    p[12] = 10; p[13] = 100; p[14] = 0; p[15] = 2;
+    p[16] = 8; p[17] = 8; p[18] = 8; p[19] = 8;
+    p[20] = src_port >> 8; p[21] = src_port & 0xFF;
+    p[22] = 0; p[23] = 53;
+    return p;
+}
+
+// The pump stamps lookups with steady_clock, so flows are learned on the same clock
+uint64_t steady_now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Reads one packet from fd, waiting up to timeout_ms
+std::vector<uint8_t> read_packet(int fd, int timeout_ms = 1000) {
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return {};
+    }
+    std::vector<uint8_t> buf(2048);
+    ssize_t n = recv(fd, buf.data(), buf.size(), 0);
+    buf.resize(n > 0 ? n : 0);
+    return buf;
+}
+
+} // namespace
+
+class TunPumpTest : public ::testing::Test {
+protected:
+    int tun[2] = {-1, -1};      // tun[0]: pump's "TUN fd", tun[1]: the kernel side
+    int tunnel[2] = {-1, -1};   // tunnel[0]: app_fd given to the pump, tunnel[1]: OpenVPN side
+
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, tun), 0);
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, tunnel), 0);
+    }
+
+    void TearDown() override {
+        for (int fd : {tun[0], tun[1], tunnel[0], tunnel[1]}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+};
+
+TEST_F(TunPumpTest, ForwardsLearnedFlowsToTheirTunnel) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    const int index = router.register_tunnel("nordvpn_UK");
+    auto packet = udp_packet(40000, 0xAB);
+    router.learn(packet.data(), packet.size(), index, 10123, steady_now_ms());
+
+    ASSERT_TRUE(pump.attach_tunnel(index, tunnel[0]));
+    ASSERT_TRUE(pump.start(tun[0]));
+
+    ASSERT_EQ(send(tun[1], packet.data(), packet.size(), 0), (ssize_t)packet.size());
+    EXPECT_EQ(read_packet(tunnel[1]), packet);
+
+    pump.stop();
+    EXPECT_EQ(pump.stats().routed.load(), 1u);
+    EXPECT_EQ(pump.stats().misses.load(), 0u);
+}
+
+TEST_F(TunPumpTest, UnknownFlowsGoToMissQueue) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    ASSERT_TRUE(pump.start(tun[0]));
+
+    auto packet = udp_packet(40001, 0xCD);
+    send(tun[1], packet.data(), packet.size(), 0);
+
+    uint8_t out[2048];
+    const ssize_t len = pump.take_miss(out, sizeof(out), 1000);
+    ASSERT_EQ(len, static_cast<ssize_t>(packet.size()));
+    EXPECT_EQ(std::vector<uint8_t>(out, out + len), packet);
+
+    // Nothing else pending
+    EXPECT_EQ(pump.take_miss(out, sizeof(out), 10), 0);
+    pump.stop();
+}
+
+TEST_F(TunPumpTest, OwnsTunNonBlockingAndRestoresFlagsOnStop) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    const int flags = fcntl(tun[0], F_GETFL);
+    ASSERT_FALSE(flags & O_NONBLOCK);
+    ASSERT_TRUE(pump.start(tun[0]));
+    EXPECT_EQ(fcntl(tun[0], F_GETFL), flags | O_NONBLOCK);
+
+    // Several packets in one readiness event: the batch ends at EAGAIN without blocking
+    auto packet = udp_packet(40003, 0x22);
+    send(tun[1], packet.data(), packet.size(), 0);
+    send(tun[1], packet.data(), packet.size(), 0);
+    uint8_t out[2048];
+    EXPECT_EQ(pump.take_miss(out, sizeof(out), 1000), static_cast<ssize_t>(packet.size()));
+    EXPECT_EQ(pump.take_miss(out, sizeof(out), 1000), static_cast<ssize_t>(packet.size()));
+
+    pump.stop();
+    EXPECT_EQ(fcntl(tun[0], F_GETFL), flags);
+    EXPECT_EQ(pump.take_miss(out, sizeof(out), 1000), -1);
+
+    ASSERT_TRUE(pump.start(tun[0]));
+    EXPECT_EQ(pump.take_miss(out, sizeof(out), 10), 0);
+    pump.stop();
+}
+
+TEST_F(TunPumpTest, InboundPacketsAreWrittenToTun) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    ASSERT_TRUE(pump.start(tun[0]));
+    ASSERT_TRUE(pump.attach_tunnel(0, tunnel[0]));   // Attached while running
+
+    auto packet = udp_packet(53, 0xEF);
+    send(tunnel[1], packet.data(), packet.size(), 0);
+    EXPECT_EQ(read_packet(tun[1]), packet);
+
+    pump.stop();
+    EXPECT_EQ(pump.stats().inbound_packets.load(), 1u);
+}
+
+TEST_F(TunPumpTest, DetachedTunnelFallsBackToMissQueue) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    const int index = router.register_tunnel("nordvpn_FR");
+    auto packet = udp_packet(40002, 0x11);
+    router.learn(packet.data(), packet.size(), index, 10456, steady_now_ms());
+
+    ASSERT_TRUE(pump.attach_tunnel(index, tunnel[0]));
+    ASSERT_TRUE(pump.start(tun[0]));
+    pump.detach_tunnel(index);
+
+    send(tun[1], packet.data(), packet.size(), 0);
+    uint8_t out[2048];
+    EXPECT_EQ(pump.take_miss(out, sizeof(out), 1000), static_cast<ssize_t>(packet.size()));
+    pump.stop();
+}
+
+TEST_F(TunPumpTest, RestartKeepsAttachedTunnels) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    ASSERT_TRUE(pump.attach_tunnel(0, tunnel[0]));
+    ASSERT_TRUE(pump.start(tun[0]));
+    pump.stop();
+    EXPECT_FALSE(pump.running());
+
+    // The pump holds its own dup, so the caller's fd can go away
+    int other_tun[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, other_tun), 0);
+    ASSERT_TRUE(pump.start(other_tun[0]));
+    close(other_tun[0]);
+
+    auto packet = udp_packet(53, 0x22);
+    send(tunnel[1], packet.data(), packet.size(), 0);
+    EXPECT_EQ(read_packet(other_tun[1]), packet);
+
+    pump.stop();
+    close(other_tun[1]);
+}
+
+TEST_F(TunPumpTest, RingAttachedTunnelUsesSharedMemoryRings) {
+    NativePacketRouter router;
+    TunPump pump(router);
+    auto rings = openvpn::PacketRingPair::create(16384);
+    ASSERT_NE(rings, nullptr);
+    const int index = router.register_tunnel("nordvpn_FR");
+    auto outbound = udp_packet(40001, 0x5A);
+    router.learn(outbound.data(), outbound.size(), index, 10124, steady_now_ms());
+
+    ASSERT_TRUE(pump.attach_tunnel(index, tunnel[0], rings));
+    EXPECT_TRUE(rings->app_attached());
+    ASSERT_TRUE(pump.start(tun[0]));
+
+    // Outbound: TUN → ring, nothing on the socketpair
+    openvpn::PacketRing& out_ring = rings->outbound();
+    ASSERT_TRUE(out_ring.park_consumer());
+    send(tun[1], outbound.data(), outbound.size(), 0);
+    pollfd pfd{out_ring.data_fd(), POLLIN, 0};
+    ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+    size_t len = 0;
+    const uint8_t* data = out_ring.front(len);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(std::vector<uint8_t>(data, data + len), outbound);
+    out_ring.pop();
+    out_ring.release();
+    EXPECT_TRUE(read_packet(tunnel[1], 50).empty());
+
+    // Inbound: ring → TUN, and the socketpair still drains during the handover
+    auto inbound = udp_packet(53, 0x6B);
+    auto queued = udp_packet(53, 0x7C);
+    send(tunnel[1], queued.data(), queued.size(), 0);
+    EXPECT_EQ(read_packet(tun[1]), queued);
+    ASSERT_TRUE(rings->inbound().push(inbound.data(), inbound.size()));
+    rings->inbound().publish();
+    EXPECT_EQ(read_packet(tun[1]), inbound);
+
+    pump.detach_tunnel(index);
+    pump.stop();
+    EXPECT_FALSE(rings->app_attached());
+    EXPECT_EQ(pump.stats().routed.load(), 1u);
+    EXPECT_EQ(pump.stats().inbound_packets.load(), 2u);
+}
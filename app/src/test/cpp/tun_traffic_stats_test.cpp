@@ -0,0 +1,84 @@
+/**
+ * TUN Traffic Stats Unit Tests
+ *
+ * Tests the per-tunnel packet/byte counters and the rate summary that
+ * replaces per-packet logging on the TUN data path.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "tun_traffic_stats.h"
+
+using openvpn::TunRateSummary;
+using openvpn::TunTrafficCounters;
+
+TEST(TunTrafficCountersTest, CountsPacketsAndBytesPerDirection) {
+    TunTrafficCounters counters;
+    counters.add_out(100);
+    counters.add_out(1400);
+    counters.add_in(60);
+
+    EXPECT_EQ(counters.packets_out.load(), 2u);
+    EXPECT_EQ(counters.bytes_out.load(), 1500u);
+    EXPECT_EQ(counters.packets_in.load(), 1u);
+    EXPECT_EQ(counters.bytes_in.load(), 60u);
+}
+
+TEST(TunRateSummaryTest, FirstSampleOnlySetsBaseline) {
+    TunTrafficCounters counters;
+    counters.add_out(1000);
+
+    TunRateSummary summary;
+    TunRateSummary::Rates rates = summary.sample(counters, 5000);
+    EXPECT_EQ(rates.interval_ms, 0u);
+    EXPECT_TRUE(rates.idle());
+}
+
+TEST(TunRateSummaryTest, ComputesRatesOverInterval) {
+    TunTrafficCounters counters;
+    TunRateSummary summary;
+    summary.sample(counters, 0);
+
+    // 2000 packets of 1250 bytes out, 500 packets of 100 bytes in, over 2 seconds
+    for (int i = 0; i < 2000; ++i) {
+        counters.add_out(1250);
+    }
+    for (int i = 0; i < 500; ++i) {
+        counters.add_in(100);
+    }
+
+    TunRateSummary::Rates rates = summary.sample(counters, 2000);
+    EXPECT_EQ(rates.interval_ms, 2000u);
+    EXPECT_EQ(rates.pps_out, 1000u);
+    EXPECT_EQ(rates.kbps_out, 10000u);  // 2.5 MB over 2 s = 10 Mbit/s
+    EXPECT_EQ(rates.pps_in, 250u);
+    EXPECT_EQ(rates.kbps_in, 200u);
+    EXPECT_FALSE(rates.idle());
+}
+
+TEST(TunRateSummaryTest, RatesAreDeltasNotTotals) {
+    TunTrafficCounters counters;
+    TunRateSummary summary;
+    summary.sample(counters, 0);
+
+    counters.add_out(100);
+    summary.sample(counters, 1000);
+
+    TunRateSummary::Rates rates = summary.sample(counters, 2000);
+    EXPECT_TRUE(rates.idle());
+    EXPECT_EQ(rates.pps_out, 0u);
+}
+
+TEST(TunRateSummaryTest, FormatsSingleLine) {
+    TunRateSummary::Rates rates;
+    rates.interval_ms = 10000;
+    rates.pps_out = 12;
+    rates.kbps_out = 34;
+    rates.pps_in = 56;
+    rates.kbps_in = 78;
+
+    char line[160];
+    TunRateSummary::format(line, sizeof(line), rates);
+    EXPECT_EQ(std::string(line), "out 12 pps / 34 kbps, in 56 pps / 78 kbps over 10000 ms");
+}
@@ -0,0 +1,204 @@
+/**
+ * Tunnel Slot Table Unit Tests
+ *
+ * Tests the generation-checked handles the JNI layer passes instead of
+ * tunnel ID strings: opening and finding slots, stale handles after release,
+ * slot reuse, and writers waiting for pinned readers before a session may be
+ * destroyed.
+ */
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "tunnel_slots.h"
+
+using openvpn::TunnelSlotTable;
+
+namespace {
+
+// Sessions are opaque to the table; any distinct addresses will do
+OpenVpnSession* fake_session(int n) {
+    static char storage[8];
+    return reinterpret_cast<OpenVpnSession*>(&storage[n]);
+}
+
+} // namespace
+
+TEST(TunnelSlotTableTest, OpenIsIdempotentPerTunnel) {
+    TunnelSlotTable table;
+    const int64_t uk = table.open("slots-uk");
+    const int64_t us = table.open("slots-us");
+    ASSERT_NE(uk, TunnelSlotTable::INVALID_HANDLE);
+    ASSERT_NE(us, TunnelSlotTable::INVALID_HANDLE);
+    EXPECT_NE(uk, us);
+
+    EXPECT_EQ(table.open("slots-uk"), uk);
+    EXPECT_EQ(table.find("slots-uk"), uk);
+    EXPECT_EQ(table.find("slots-fr"), TunnelSlotTable::INVALID_HANDLE);
+    EXPECT_EQ(table.tunnel_id(us), "slots-us");
+}
+
+TEST(TunnelSlotTableTest, PinReadsSlotFields) {
+    TunnelSlotTable table;
+    const int64_t handle = table.open("slots-pin");
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets), 0);
+    ASSERT_TRUE(table.set_pipe(handle, sockets[0], sockets[1]));
+    ASSERT_TRUE(table.attach_session(handle, fake_session(1)));
+
+    TunnelSlotTable::Pin pin = table.pin(handle);
+    ASSERT_TRUE(pin);
+    EXPECT_EQ(pin.session(), fake_session(1));
+    EXPECT_EQ(pin.openvpn_fd(), sockets[0]);
+    EXPECT_EQ(pin.kotlin_fd(), sockets[1]);
+    ASSERT_NE(pin.stats(), nullptr);
+    EXPECT_EQ(pin.stats(), openvpn::TunnelStatsRegistry::instance().find("slots-pin").get());
+
+    EXPECT_EQ(table.find_session(fake_session(1)), handle);
+    EXPECT_EQ(table.find_session(fake_session(2)), TunnelSlotTable::INVALID_HANDLE);
+}
+
+TEST(TunnelSlotTableTest, InvalidHandlesDoNotResolve) {
+    TunnelSlotTable table;
+    EXPECT_FALSE(table.pin(TunnelSlotTable::INVALID_HANDLE));
+    EXPECT_FALSE(table.pin(-1));
+    EXPECT_FALSE(table.pin(static_cast<int64_t>(1ULL << 32 | TunnelSlotTable::CAPACITY)));
+    EXPECT_FALSE(table.set_pipe(12345, 1, 2));
+    EXPECT_FALSE(table.attach_session(12345, fake_session(0)));
+    EXPECT_FALSE(table.release(12345));
+}
+
+TEST(TunnelSlotTableTest, ReleasedHandleGoesStaleWhenSlotIsReused) {
+    TunnelSlotTable table;
+    const int64_t first = table.open("slots-reuse-a");
+    table.attach_session(first, fake_session(3));
+    ASSERT_NE(openvpn::TunnelStatsRegistry::instance().find("slots-reuse-a"), nullptr);
+    ASSERT_TRUE(table.release(first));
+    EXPECT_EQ(openvpn::TunnelStatsRegistry::instance().find("slots-reuse-a"), nullptr);
+    EXPECT_FALSE(table.release(first));
+    EXPECT_FALSE(table.pin(first));
+    EXPECT_EQ(table.find("slots-reuse-a"), TunnelSlotTable::INVALID_HANDLE);
+    EXPECT_TRUE(table.sessions().empty());
+
+    // Same index, new generation: the old handle must not reach the new tunnel
+    const int64_t second = table.open("slots-reuse-b");
+    EXPECT_EQ(second & 0xffffffff, first & 0xffffffff);
+    EXPECT_NE(second, first);
+    EXPECT_FALSE(table.pin(first));
+    TunnelSlotTable::Pin pin = table.pin(second);
+    ASSERT_TRUE(pin);
+    EXPECT_EQ(pin.session(), nullptr);
+    EXPECT_EQ(pin.openvpn_fd(), -1);
+}
+
+TEST(TunnelSlotTableTest, ReleaseClosesThePipeOrHandsItToTheCaller) {
+    TunnelSlotTable table;
+    int first[2];
+    int second[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, first), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, second), 0);
+
+    const int64_t closed = table.open("slots-pipe-a");
+    ASSERT_TRUE(table.set_pipe(closed, first[0], first[1]));
+    ASSERT_TRUE(table.release(closed));
+    EXPECT_EQ(fcntl(first[0], F_GETFD), -1);
+    EXPECT_EQ(fcntl(first[1], F_GETFD), -1);
+
+    // Kept open until the session using it is gone
+    const int64_t handed = table.open("slots-pipe-b");
+    ASSERT_TRUE(table.set_pipe(handed, second[0], second[1]));
+    {
+        openvpn::SlotPipe pipe;
+        ASSERT_TRUE(table.release(handed, &pipe));
+        EXPECT_EQ(pipe.openvpn_fd(), second[0]);
+        EXPECT_NE(fcntl(second[0], F_GETFD), -1);
+    }
+    EXPECT_EQ(fcntl(second[0], F_GETFD), -1);
+    EXPECT_EQ(fcntl(second[1], F_GETFD), -1);
+}
+
+TEST(TunnelSlotTableTest, FullTableRejectsNewTunnels) {
+    TunnelSlotTable table;
+    for (size_t i = 0; i < TunnelSlotTable::CAPACITY; ++i) {
+        ASSERT_NE(table.open("slots-full-" + std::to_string(i)), TunnelSlotTable::INVALID_HANDLE);
+    }
+    EXPECT_EQ(table.open("slots-full-extra"), TunnelSlotTable::INVALID_HANDLE);
+    table.release(table.find("slots-full-7"));
+    EXPECT_NE(table.open("slots-full-extra"), TunnelSlotTable::INVALID_HANDLE);
+}
+
+TEST(TunnelSlotTableTest, SessionsListsOnlyAttachedSlots) {
+    TunnelSlotTable table;
+    const int64_t attached = table.open("slots-list-a");
+    table.open("slots-list-b");
+    table.attach_session(attached, fake_session(4));
+
+    const auto sessions = table.sessions();
+    ASSERT_EQ(sessions.size(), 1u);
+    EXPECT_EQ(sessions[0].first, attached);
+    EXPECT_EQ(sessions[0].second, "slots-list-a");
+}
+
+TEST(TunnelSlotTableTest, ReleaseWaitsForPinnedReader) {
+    TunnelSlotTable table;
+    const int64_t handle = table.open("slots-wait");
+    table.attach_session(handle, fake_session(5));
+
+    std::promise<void> pinned;
+    std::promise<void> unpin;
+    std::thread reader([&] {
+        TunnelSlotTable::Pin pin = table.pin(handle);
+        ASSERT_TRUE(pin);
+        pinned.set_value();
+        unpin.get_future().wait();
+        EXPECT_EQ(pin.session(), fake_session(5));
+    });
+    pinned.get_future().wait();
+
+    std::atomic<bool> released{false};
+    std::thread writer([&] {
+        table.release(handle);
+        released = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(released.load());
+    unpin.set_value();
+    reader.join();
+    writer.join();
+    EXPECT_TRUE(released.load());
+}
+
+TEST(TunnelSlotTableTest, ReplacingSessionWaitsForPinnedReader) {
+    TunnelSlotTable table;
+    const int64_t handle = table.open("slots-replace");
+    table.attach_session(handle, fake_session(6));
+
+    std::promise<void> pinned;
+    std::promise<void> unpin;
+    std::thread reader([&] {
+        TunnelSlotTable::Pin pin = table.pin(handle);
+        OpenVpnSession* seen = pin.session();
+        pinned.set_value();
+        unpin.get_future().wait();
+        EXPECT_EQ(seen, fake_session(6));
+    });
+    pinned.get_future().wait();
+
+    std::atomic<bool> attached{false};
+    std::thread writer([&] {
+        table.attach_session(handle, fake_session(7));
+        attached = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(attached.load());
+    unpin.set_value();
+    reader.join();
+    writer.join();
+    EXPECT_EQ(table.pin(handle).session(), fake_session(7));
+}
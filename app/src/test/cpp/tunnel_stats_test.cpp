@@ -0,0 +1,208 @@
+/**
+ * Tunnel Stats Unit Tests
+ *
+ * Tests the per-tunnel counters exposed through nativeGetTunnelStats():
+ * the packed array layout, latency bucketing, registry lifetime across
+ * reconnects, and egress queue, batch reader and buffer pool counters
+ * landing in the tunnel's stats.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "tunnel_stats.h"
+
+using openvpn::TunBatchReader;
+using openvpn::TunBufferPool;
+using openvpn::TunDropPolicy;
+using openvpn::TunEgressQueue;
+using openvpn::TunnelStats;
+using openvpn::TunnelStatsRegistry;
+
+TEST(TunnelStatsTest, PackWritesVersionAndCountersAtFixedIndices) {
+    TunnelStats stats;
+    stats.traffic.add_out(100);
+    stats.traffic.add_out(200);
+    stats.traffic.add_in(1500);
+    stats.drop_oversized.store(3);
+    stats.drop_halted.store(4);
+    stats.eagain_write.store(5);
+    stats.batch.empty_reads.store(10);
+    stats.egress_depth.store(6);
+    stats.mss_clamped.store(7);
+    stats.dns.cache_hits.store(8);
+    stats.dns.latency_us_total.store(9);
+    stats.record_latency(0);
+    stats.record_latency(5);
+
+    int64_t packed[openvpn::STAT_FIELD_COUNT];
+    stats.pack(packed);
+
+    EXPECT_EQ(packed[openvpn::STAT_LAYOUT_VERSION], TunnelStats::STATS_LAYOUT_VERSION);
+    EXPECT_EQ(packed[openvpn::STAT_PACKETS_OUT], 2);
+    EXPECT_EQ(packed[openvpn::STAT_BYTES_OUT], 300);
+    EXPECT_EQ(packed[openvpn::STAT_PACKETS_IN], 1);
+    EXPECT_EQ(packed[openvpn::STAT_BYTES_IN], 1500);
+    EXPECT_EQ(packed[openvpn::STAT_DROP_OVERSIZED], 3);
+    EXPECT_EQ(packed[openvpn::STAT_DROP_HALTED], 4);
+    EXPECT_EQ(packed[openvpn::STAT_EAGAIN_WRITE], 5);
+    EXPECT_EQ(packed[openvpn::STAT_EAGAIN_READ], 10);
+    EXPECT_EQ(packed[openvpn::STAT_EGRESS_QUEUE_DEPTH], 6);
+    EXPECT_EQ(packed[openvpn::STAT_LIB_FD_INQ_BYTES], 0);
+    EXPECT_EQ(packed[openvpn::STAT_LATENCY_US_BUCKET_0], 1);
+    EXPECT_EQ(packed[openvpn::STAT_LATENCY_US_BUCKET_0 + 3], 1);
+    EXPECT_EQ(packed[openvpn::STAT_MSS_CLAMPED], 7);
+    EXPECT_EQ(packed[openvpn::STAT_DNS_CACHE_HITS], 8);
+    EXPECT_EQ(packed[openvpn::STAT_DNS_LATENCY_US_TOTAL], 9);
+}
+
+// The Kotlin decoder hardcodes these; changing them needs a layout version bump
+TEST(TunnelStatsTest, LayoutMatchesKotlinDecoder) {
+    EXPECT_EQ(openvpn::STAT_BRIDGE_OUTQ_BYTES, 19u);
+    EXPECT_EQ(openvpn::STAT_LATENCY_US_BUCKET_0, 20u);
+    EXPECT_EQ(openvpn::STAT_MSS_CLAMPED, 36u);
+    EXPECT_EQ(openvpn::STAT_DNS_QUERIES, 37u);
+    EXPECT_EQ(openvpn::STAT_DNS_CACHE_ENTRIES, 42u);
+    EXPECT_EQ(openvpn::STAT_READ_BATCHES, 43u);
+    EXPECT_EQ(openvpn::STAT_READ_BATCH_FILL_BUCKET_0, 46u);
+    EXPECT_EQ(openvpn::STAT_POOL_HITS, 54u);
+    EXPECT_EQ(openvpn::STAT_POOL_HIGH_WATER, 57u);
+    EXPECT_EQ(openvpn::STAT_FIELD_COUNT, 58u);
+    EXPECT_EQ(TunnelStats::LATENCY_BUCKETS, 16u);
+}
+
+TEST(TunnelStatsTest, LatencyBucketsArePowersOfTwo) {
+    EXPECT_EQ(TunnelStats::latency_bucket(0), 0u);
+    EXPECT_EQ(TunnelStats::latency_bucket(1), 1u);
+    EXPECT_EQ(TunnelStats::latency_bucket(2), 2u);
+    EXPECT_EQ(TunnelStats::latency_bucket(3), 2u);
+    EXPECT_EQ(TunnelStats::latency_bucket(4), 3u);
+    EXPECT_EQ(TunnelStats::latency_bucket(1000), 10u);
+    EXPECT_EQ(TunnelStats::latency_bucket(UINT64_MAX), TunnelStats::LATENCY_BUCKETS - 1);
+}
+
+TEST(TunnelStatsTest, RegistryReturnsSameInstanceAcrossReconnects) {
+    TunnelStatsRegistry& registry = TunnelStatsRegistry::instance();
+    EXPECT_EQ(registry.find("stats_test_tunnel"), nullptr);
+
+    auto first = registry.acquire("stats_test_tunnel");
+    first->traffic.add_out(64);
+
+    // A reconnect creates a new CustomTunClient, which acquires again
+    auto second = registry.acquire("stats_test_tunnel");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(second->traffic.packets_out.load(), 1u);
+    EXPECT_EQ(registry.find("stats_test_tunnel"), first);
+    EXPECT_NE(registry.acquire("stats_test_other"), first);
+
+    // A late erase for a replaced instance leaves the current one registered
+    registry.erase("stats_test_tunnel", nullptr);
+    EXPECT_EQ(registry.find("stats_test_tunnel"), first);
+
+    registry.erase("stats_test_tunnel", first.get());
+    registry.erase("stats_test_other", registry.find("stats_test_other").get());
+    EXPECT_EQ(registry.find("stats_test_tunnel"), nullptr);
+}
+
+TEST(TunnelStatsTest, AttachedEgressQueueCountsIntoTunnelStats) {
+    using Packet = std::vector<uint8_t>;
+    TunnelStats stats;
+    auto drop = [](Packet&&) {};
+
+    {
+        TunEgressQueue<Packet> queue(2, TunDropPolicy::TAIL_DROP, 100);
+        queue.attach_stats(stats.egress);
+        queue.push(Packet(10), 0, drop);
+        queue.push(Packet(10), 0, drop);
+        queue.push(Packet(10), 0, drop);
+        EXPECT_EQ(&queue.stats(), &stats.egress);
+    }
+
+    // Totals outlive the queue
+    int64_t packed[openvpn::STAT_FIELD_COUNT];
+    stats.pack(packed);
+    EXPECT_EQ(packed[openvpn::STAT_DROP_QUEUE_TAIL], 1);
+    EXPECT_EQ(packed[openvpn::STAT_EGRESS_QUEUE_HIGH_WATER], 2);
+}
+
+TEST(TunnelStatsTest, AttachedReaderAndPoolCountIntoTunnelStats) {
+    TunnelStats stats;
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets), 0);
+
+    {
+        TunBatchReader reader(4);
+        reader.attach_stats(stats.batch);
+        TunBufferPool<std::vector<uint8_t>> pool(64, 2);
+        pool.attach_stats(stats.pool);
+
+        std::vector<uint8_t> slots[4] = {pool.acquire(), pool.acquire(), pool.acquire(), pool.acquire()};
+        for (size_t i = 0; i < 4; ++i) {
+            slots[i].resize(64);
+            reader.set_slot(i, slots[i].data(), slots[i].size());
+        }
+        const uint8_t packet[20] = {0x45};
+        ASSERT_EQ(write(sockets[0], packet, sizeof(packet)), 20);
+        ASSERT_EQ(write(sockets[0], packet, sizeof(packet)), 20);
+        EXPECT_EQ(reader.read_batch(sockets[1]), 2);
+        EXPECT_EQ(reader.read_batch(sockets[1]), 0);
+        for (auto& slot : slots) {
+            pool.release(std::move(slot));
+        }
+        EXPECT_EQ(&reader.stats(), &stats.batch);
+    }
+    close(sockets[0]);
+    close(sockets[1]);
+
+    // Totals outlive the reader and pool
+    int64_t packed[openvpn::STAT_FIELD_COUNT];
+    stats.pack(packed);
+    EXPECT_EQ(packed[openvpn::STAT_READ_BATCHES], 1);
+    EXPECT_EQ(packed[openvpn::STAT_READ_BATCH_PACKETS], 2);
+    EXPECT_EQ(packed[openvpn::STAT_READ_BATCHES_FULL], 0);
+    EXPECT_EQ(packed[openvpn::STAT_READ_BATCH_FILL_BUCKET_0 + 1], 1);
+    EXPECT_EQ(packed[openvpn::STAT_POOL_MISSES], 4);
+    EXPECT_EQ(packed[openvpn::STAT_POOL_DISCARDS], 2);
+    EXPECT_EQ(packed[openvpn::STAT_POOL_HIGH_WATER], 4);
+}
+
+// CustomTunClient lifetimes (attach, fill read slots and the egress queue,
+// cleanup) share one TunnelStats per tunnel; every reconnect must hand its
+// buffers back so in_use returns to 0 and high_water stays one session's peak
+TEST(TunnelStatsTest, ClientTeardownReturnsEveryPooledBuffer) {
+    using Packet = std::vector<uint8_t>;
+    TunnelStats stats;
+
+    for (int session = 0; session < 3; ++session) {
+        TunBufferPool<Packet> pool(64, 8);
+        pool.attach_stats(stats.pool);
+        TunEgressQueue<Packet> egress(4, TunDropPolicy::TAIL_DROP, 100);
+        egress.attach_stats(stats.egress);
+
+        // tun_start(): one slot per batch entry, plus packets parked on EAGAIN
+        std::vector<Packet> read_bufs(4);
+        for (Packet& slot : read_bufs) {
+            slot = pool.acquire();
+        }
+        for (int i = 0; i < 2; ++i) {
+            egress.push(pool.acquire(), 0, [&](Packet&& dropped) { pool.release(std::move(dropped)); });
+        }
+        EXPECT_EQ(stats.pool.in_use.load(), 6u);
+
+        // cleanup()
+        for (Packet& slot : read_bufs) {
+            if (slot.capacity() > 0) {
+                pool.release(std::move(slot));
+            }
+        }
+        read_bufs.clear();
+        egress.drain([&](Packet&& buf) { pool.release(std::move(buf)); });
+
+        EXPECT_TRUE(egress.empty());
+        EXPECT_EQ(stats.pool.in_use.load(), 0u);
+    }
+    EXPECT_EQ(stats.pool.high_water.load(), 6u);
+    EXPECT_EQ(stats.egress.total_drops(), 0u);
+}
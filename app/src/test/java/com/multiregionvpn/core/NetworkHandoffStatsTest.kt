@@ -0,0 +1,62 @@
+package com.multiregionvpn.core
+
+import org.junit.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertTrue
+
+/**
+ * Unit tests for decoding the packed nativeGetNetworkHandoffStats() array
+ */
+class NetworkHandoffStatsTest {
+
+    private fun row(direction: Int, path: Int, count: Long, lastMs: Long, minMs: Long, maxMs: Long,
+                    totalMs: Long, escalated: Long = 0, abandoned: Long = 0): LongArray =
+        longArrayOf(direction.toLong(), path.toLong(), count, lastMs, minMs, maxMs, totalMs, escalated, abandoned)
+
+    private fun packed(vararg rows: LongArray): LongArray =
+        longArrayOf(NetworkHandoffStats.LAYOUT_VERSION, rows.size.toLong(), NetworkHandoffStats.FIELD_COUNT.toLong()) +
+            rows.fold(LongArray(0)) { acc, r -> acc + r }
+
+    @Test
+    fun `fromPacked decodes rows per direction and path`() {
+        // GIVEN: Two quick rebinds leaving Wi-Fi and one escalated rebind back to Wi-Fi
+        val stats = NetworkHandoffStats.fromPacked(packed(
+            row(0, 0, 2, 180, 120, 180, 300),
+            row(1, 0, 0, 0, 0, 0, 0, escalated = 1),
+            row(1, 1, 1, 4200, 4200, 4200, 4200)
+        ))
+
+        assertEquals(3, stats.size)
+        assertEquals(NetworkHandoffStats.Direction.WIFI_TO_CELLULAR, stats[0].direction)
+        assertEquals(NetworkHandoffStats.Path.REBIND, stats[0].path)
+        assertEquals(150L, stats[0].averageMs)
+        assertEquals(1L, stats[1].escalated)
+        assertEquals(-1L, stats[1].averageMs)
+        assertEquals(NetworkHandoffStats.Direction.CELLULAR_TO_WIFI, stats[2].direction)
+        assertEquals(NetworkHandoffStats.Path.RECONNECT, stats[2].path)
+        assertEquals(4200L, stats[2].lastMs)
+    }
+
+    @Test
+    fun `fromPacked skips rows with unknown enums`() {
+        val stats = NetworkHandoffStats.fromPacked(packed(
+            row(7, 0, 1, 100, 100, 100, 100),
+            row(2, 1, 1, 900, 900, 900, 900)
+        ))
+
+        assertEquals(1, stats.size)
+        assertEquals(NetworkHandoffStats.Direction.OTHER, stats[0].direction)
+    }
+
+    @Test
+    fun `fromPacked rejects missing, truncated or mismatched arrays`() {
+        assertTrue(NetworkHandoffStats.fromPacked(null).isEmpty())
+        assertTrue(NetworkHandoffStats.fromPacked(LongArray(2)).isEmpty())
+
+        val truncated = packed(row(0, 0, 1, 100, 100, 100, 100))
+        assertTrue(NetworkHandoffStats.fromPacked(truncated.copyOf(truncated.size - 1)).isEmpty())
+
+        val wrongVersion = packed(row(0, 0, 1, 100, 100, 100, 100)).also { it[0] = 99 }
+        assertTrue(NetworkHandoffStats.fromPacked(wrongVersion).isEmpty())
+    }
+}
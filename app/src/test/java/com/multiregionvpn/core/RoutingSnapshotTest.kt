@@ -0,0 +1,84 @@
+package com.multiregionvpn.core
+
+import com.multiregionvpn.data.database.AppRule
+import org.junit.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertNull
+import kotlin.test.assertSame
+
+/**
+ * Unit tests for the precompiled UID -> tunnel routing snapshot
+ */
+class RoutingSnapshotTest {
+
+    private val uids = mapOf(
+        "com.bbc.iplayer" to 10100,
+        "fr.tf1.mytf1" to 10200,
+        "com.direct.app" to 10300
+    )
+
+    private val tunnelIds = mapOf(
+        "vpn-uk" to "nordvpn_UK",
+        "vpn-fr" to "nordvpn_FR"
+    )
+
+    @Test
+    fun `snapshot maps each rule's UID to its tunnel`() {
+        // GIVEN: Two routed apps and one direct app
+        val rules = listOf(
+            AppRule("com.bbc.iplayer", "vpn-uk"),
+            AppRule("fr.tf1.mytf1", "vpn-fr"),
+            AppRule("com.direct.app", null)
+        )
+
+        // WHEN: Building the snapshot
+        val snapshot = RoutingSnapshot.build(1, rules, tunnelIds) { uids[it] }
+
+        // THEN: UIDs and packages resolve without any further lookups
+        assertEquals("nordvpn_UK", snapshot.tunnelForUid(10100))
+        assertEquals("nordvpn_FR", snapshot.tunnelForUid(10200))
+        assertNull(snapshot.tunnelForUid(10300))
+        assertEquals("nordvpn_FR", snapshot.tunnelForPackage("fr.tf1.mytf1"))
+        assertEquals(2, snapshot.size)
+    }
+
+    @Test
+    fun `missing configs and uninstalled apps are skipped`() {
+        val rules = listOf(
+            AppRule("com.not.installed", "vpn-uk"),
+            AppRule("com.bbc.iplayer", "vpn-deleted"),
+            AppRule("fr.tf1.mytf1", "vpn-fr")
+        )
+
+        val snapshot = RoutingSnapshot.build(1, rules, tunnelIds) { uids[it] }
+
+        assertNull(snapshot.tunnelForUid(10100))
+        assertEquals("nordvpn_UK", snapshot.tunnelForPackage("com.not.installed"))
+
+        // Default route is the first rule that resolved to both a UID and a tunnel
+        val route = assertNotNull(snapshot.defaultRoute)
+        assertEquals("fr.tf1.mytf1", route.packageName)
+        assertEquals(10200, route.uid)
+        assertEquals("nordvpn_FR", route.tunnelId)
+    }
+
+    @Test
+    fun `publish swaps in a new snapshot and clear resets it`() {
+        val table = RoutingTable()
+        assertSame(RoutingSnapshot.EMPTY, table.current)
+
+        val first = table.publish(listOf(AppRule("com.bbc.iplayer", "vpn-uk")), tunnelIds) { uids[it] }
+        val held = table.current
+        val second = table.publish(listOf(AppRule("com.bbc.iplayer", "vpn-fr")), tunnelIds) { uids[it] }
+
+        // A reader holding the old snapshot keeps a consistent view
+        assertSame(first, held)
+        assertEquals("nordvpn_UK", held.tunnelForUid(10100))
+        assertEquals("nordvpn_FR", table.current.tunnelForUid(10100))
+        assertEquals(first.version + 1, second.version)
+
+        table.clear()
+        assertNull(table.current.tunnelForUid(10100))
+    }
+}
@@ -0,0 +1,66 @@
+package com.multiregionvpn.core.vpnclient
+
+import org.junit.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertTrue
+
+/**
+ * Unit tests for decoding the packed nativeGetConnectTimelines() array
+ */
+class ConnectTimelineTest {
+
+    private fun record(id: Long, reconnect: Boolean, open: Boolean, vararg marksMs: Long): LongArray {
+        val marks = LongArray(ConnectTimeline.MARK_COUNT) { -1L }
+        marksMs.forEachIndexed { i, ms -> marks[i] = if (ms < 0) -1 else ms * 1000 }
+        return longArrayOf(id, if (reconnect) 1 else 0, if (open) 1 else 0) + marks
+    }
+
+    private fun packed(vararg records: LongArray): LongArray =
+        longArrayOf(ConnectTimeline.LAYOUT_VERSION, records.size.toLong(), ConnectTimeline.FIELD_COUNT.toLong()) +
+            records.fold(LongArray(0)) { acc, r -> acc + r }
+
+    @Test
+    fun `fromPacked decodes records oldest first`() {
+        // GIVEN: A finished cold start and an open reconnect
+        val timelines = ConnectTimeline.fromPacked(packed(
+            record(1, false, false, 0, 5, 80, 120, 400, 410, 450, 455, 460, 700),
+            record(2, true, true, 0, 3)
+        ))
+
+        assertEquals(2, timelines.size)
+        assertEquals(1L, timelines[0].id)
+        assertFalse(timelines[0].open)
+        assertTrue(timelines[1].reconnect)
+        assertTrue(timelines[1].open)
+        assertEquals(3000L, timelines[1].markUs(ConnectTimeline.Mark.RESOLVE))
+        assertEquals(-1L, timelines[1].markUs(ConnectTimeline.Mark.TRANSPORT))
+    }
+
+    @Test
+    fun `phases run to the next reached mark`() {
+        // AUTH_OK and PUSH_REQUEST never fired: TLS runs until PUSH_REPLY
+        val timeline = ConnectTimeline.fromPacked(packed(
+            record(1, false, false, 0, 5, 80, 120, -1, -1, 450, 455, 460, 700)
+        )).single()
+
+        assertEquals(75_000L, timeline.phaseUs(ConnectTimeline.Mark.RESOLVE))
+        assertEquals(330_000L, timeline.phaseUs(ConnectTimeline.Mark.TLS))
+        assertEquals(-1L, timeline.phaseUs(ConnectTimeline.Mark.AUTH_OK))
+        assertEquals(-1L, timeline.phaseUs(ConnectTimeline.Mark.FIRST_PACKET))
+        assertEquals(ConnectTimeline.Mark.TLS, timeline.slowestPhase)
+    }
+
+    @Test
+    fun `fromPacked rejects missing, truncated or mismatched arrays`() {
+        assertTrue(ConnectTimeline.fromPacked(null).isEmpty())
+        assertTrue(ConnectTimeline.fromPacked(LongArray(2)).isEmpty())
+
+        val truncated = packed(record(1, false, true, 0))
+        assertTrue(ConnectTimeline.fromPacked(truncated.copyOf(truncated.size - 1)).isEmpty())
+
+        val wrongVersion = packed(record(1, false, true, 0))
+        wrongVersion[0] = ConnectTimeline.LAYOUT_VERSION + 1
+        assertTrue(ConnectTimeline.fromPacked(wrongVersion).isEmpty())
+    }
+}
@@ -0,0 +1,83 @@
+package com.multiregionvpn.core.vpnclient
+
+import org.junit.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertNull
+
+/**
+ * Unit tests for decoding the packed nativeGetTunnelStats() array
+ */
+class TunnelStatsTest {
+
+    private fun packed(): LongArray {
+        val values = LongArray(TunnelStats.FIELD_COUNT)
+        values[0] = TunnelStats.LAYOUT_VERSION
+        for (i in 1 until values.size) {
+            values[i] = i * 10L
+        }
+        return values
+    }
+
+    @Test
+    fun `fromPacked maps fields by native index`() {
+        // WHEN: Decoding an array whose value at index i is i * 10
+        val stats = TunnelStats.fromPacked(packed())
+
+        // THEN: Each field reads its own index
+        assertNotNull(stats)
+        assertEquals(10L, stats.packetsOut)
+        assertEquals(40L, stats.bytesIn)
+        assertEquals(70L, stats.dropQueueTail)
+        assertEquals(120L, stats.eagainWrite)
+        assertEquals(140L, stats.egressQueueDepth)
+        assertEquals(190L, stats.bridgeOutqBytes)
+        assertEquals(TunnelStats.LATENCY_BUCKETS, stats.latencyHistogramUs.size)
+        assertEquals(200L, stats.latencyHistogramUs[0])
+        assertEquals(350L, stats.latencyHistogramUs[15])
+        assertEquals(360L, stats.mssClamped)
+        assertEquals(370L, stats.dnsQueries)
+        assertEquals(420L, stats.dnsCacheEntries)
+        assertEquals(430L, stats.readBatches)
+        assertEquals(450L, stats.readBatchesFull)
+        assertEquals(TunnelStats.FILL_BUCKETS, stats.readBatchFillHistogram.size)
+        assertEquals(460L, stats.readBatchFillHistogram[0])
+        assertEquals(530L, stats.readBatchFillHistogram[7])
+        assertEquals(540L, stats.bufferPoolHits)
+        assertEquals(570L, stats.bufferPoolHighWater)
+    }
+
+    @Test
+    fun `totalDrops sums every drop reason`() {
+        val stats = TunnelStats.fromPacked(packed())
+
+        assertNotNull(stats)
+        assertEquals(50L + 60L + 70L + 80L + 90L + 100L + 110L, stats.totalDrops)
+    }
+
+    @Test
+    fun `dns rates divide by their own counters`() {
+        val stats = TunnelStats(dnsQueries = 8, dnsCacheHits = 6, dnsResponses = 2, dnsLatencyUsTotal = 9000)
+
+        assertEquals(0.75, stats.dnsHitRate)
+        assertEquals(4500L, stats.dnsAverageLatencyUs)
+        assertEquals(0.0, TunnelStats().dnsHitRate)
+        assertEquals(0L, TunnelStats().dnsAverageLatencyUs)
+    }
+
+    @Test
+    fun `read batch average fill divides packets by batches`() {
+        assertEquals(2.5, TunnelStats(readBatches = 4, readBatchPackets = 10).readBatchAverageFill)
+        assertEquals(0.0, TunnelStats().readBatchAverageFill)
+    }
+
+    @Test
+    fun `fromPacked rejects missing, short or mismatched arrays`() {
+        assertNull(TunnelStats.fromPacked(null))
+        assertNull(TunnelStats.fromPacked(LongArray(5)))
+
+        val wrongVersion = packed()
+        wrongVersion[0] = TunnelStats.LAYOUT_VERSION + 1
+        assertNull(TunnelStats.fromPacked(wrongVersion))
+    }
+}